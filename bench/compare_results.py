@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Compare two Google Benchmark JSON result files and flag per-stage regressions.
+
+Usage: compare_results.py <previous.json> <current.json> [--threshold 0.15] [--fail-on-regression]
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_times(path):
+    """Return {benchmark name: cpu time in ns}, preferring the median aggregate if present."""
+    with open(path) as f:
+        data = json.load(f)
+    to_ns = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+    times = {}
+    medians = {}
+    for b in data.get("benchmarks", []):
+        name = b.get("run_name", b["name"])
+        t = b["cpu_time"] * to_ns[b.get("time_unit", "ns")]
+        if b.get("run_type") == "aggregate":
+            if b.get("aggregate_name") == "median":
+                medians[name] = t
+        else:
+            times.setdefault(name, t)
+    times.update(medians)
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("previous")
+    parser.add_argument("current")
+    parser.add_argument(
+        "--threshold", type=float, default=0.15, help="relative slowdown reported as regression"
+    )
+    parser.add_argument(
+        "--fail-on-regression", action="store_true", help="exit with 1 if any stage regressed"
+    )
+    args = parser.parse_args()
+
+    previous = load_times(args.previous)
+    current = load_times(args.current)
+
+    regressions = []
+    print(f"{'Benchmark':<40} {'Previous [ns]':>14} {'Current [ns]':>14} {'Change':>9}")
+    for name in sorted(current):
+        cur = current[name]
+        if name not in previous:
+            print(f"{name:<40} {'-':>14} {cur:>14.1f} {'new':>9}")
+            continue
+        prev = previous[name]
+        change = (cur - prev) / prev if prev > 0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            regressions.append(name)
+            flag = "  <-- REGRESSION"
+        print(f"{name:<40} {prev:>14.1f} {cur:>14.1f} {change:>+8.1%}{flag}")
+    for name in sorted(set(previous) - set(current)):
+        print(f"{name:<40} {previous[name]:>14.1f} {'-':>14} {'removed':>9}")
+
+    if regressions:
+        print(f"\n{len(regressions)} stage(s) slower than previous run by more than "
+              f"{args.threshold:.0%}: {', '.join(regressions)}")
+        if args.fail_on_regression:
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,192 @@
+/**
+ * @file encryption_bench.cpp
+ * @brief Benchmarks of the authenticated encryption of teleop packets: sealing and opening one
+ * message of each size with each cipher, and one state packet through a pair of
+ * EncryptedTransport, leader to follower. The ciphers are checked against their test vectors by
+ * test/encryption_test.cpp. The budget is 2 us per state packet with the default cipher of this
+ * CPU, see DefaultAeadCipher(): the benchmark exits non-zero if the state packets took longer.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include <flexiv/omni/teleop/clock.hpp>
+#include <flexiv/omni/teleop/encryption.hpp>
+#include <flexiv/omni/teleop/wire_format.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace flexiv::omni::teleop;
+
+namespace {
+
+/** Time one state packet may take through a pair of transports with the default cipher [ns] */
+constexpr int64_t kStatePacketBudgetNs = 2000;
+
+/** Runs shorter than this are calibration runs, not held against the budget [iterations] */
+constexpr int64_t kBudgetMinIterations = 10000;
+
+/** State packets held against the budget so far, and the time they took [ns] */
+int64_t budget_packets = 0;
+int64_t budget_elapsed_ns = 0;
+
+/** Skip the benchmark if its cipher is unavailable, true if it may run */
+bool Prepare(benchmark::State& state, AeadCipher cipher)
+{
+    if (cipher == AeadCipher::kAes256Gcm && !HasAesNi()) {
+        state.SkipWithError("AES-NI is not available on this CPU");
+        return false;
+    }
+    return true;
+}
+
+/** Transport holding the last message sent, for a pair of transports without a network */
+class MailboxTransport : public Transport
+{
+public:
+    bool Send(const void* data, size_t size) override
+    {
+        std::memcpy(buffer_.data(), data, size);
+        size_ = size;
+        return true;
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        const size_t size = size_ <= capacity ? size_ : 0;
+        std::memcpy(buffer, buffer_.data(), size);
+        size_ = 0;
+        return size;
+    }
+
+private:
+    std::array<uint8_t, kMaxMessageSize> buffer_;
+    size_t size_ = 0;
+};
+
+}
+
+// Arguments: cipher, message size [bytes]
+// =================================================================================================
+static void BM_AeadSeal(benchmark::State& state)
+{
+    const auto cipher = static_cast<AeadCipher>(state.range(0));
+    if (!Prepare(state, cipher)) {
+        return;
+    }
+    const Aead aead(cipher, GenerateAeadKey());
+    std::vector<uint8_t> data(static_cast<size_t>(state.range(1)), 0x5A);
+    uint8_t header[sizeof(EncryptedPacketHeader)] = {};
+    uint8_t nonce[12] = {};
+    uint8_t tag[kAeadTagSize];
+    uint64_t counter = 0;
+    for (auto _ : state) {
+        // A fresh nonce per message, as EncryptedTransport uses
+        ++counter;
+        std::memcpy(nonce + 4, &counter, sizeof(counter));
+        aead.Seal(nonce, header, sizeof(header), data.data(), data.size(), tag);
+        benchmark::DoNotOptimize(tag);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(1));
+}
+
+static void BM_AeadOpen(benchmark::State& state)
+{
+    const auto cipher = static_cast<AeadCipher>(state.range(0));
+    if (!Prepare(state, cipher)) {
+        return;
+    }
+    const Aead aead(cipher, GenerateAeadKey());
+    const std::vector<uint8_t> plaintext(static_cast<size_t>(state.range(1)), 0x5A);
+    std::vector<uint8_t> sealed = plaintext, data(plaintext.size());
+    uint8_t header[sizeof(EncryptedPacketHeader)] = {};
+    uint8_t nonce[12] = {};
+    uint8_t tag[kAeadTagSize];
+    aead.Seal(nonce, header, sizeof(header), sealed.data(), sealed.size(), tag);
+    for (auto _ : state) {
+        std::memcpy(data.data(), sealed.data(), sealed.size());
+        if (!aead.Open(nonce, header, sizeof(header), data.data(), data.size(), tag)) {
+            state.SkipWithError("Authentic message failed to open");
+            break;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(1));
+}
+
+static void AeadArgs(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({"cipher", "bytes"});
+    for (const auto cipher : {AeadCipher::kAes256Gcm, AeadCipher::kChaCha20Poly1305}) {
+        for (const int64_t size : {int64_t {64}, static_cast<int64_t>(sizeof(StatePacket)),
+                 static_cast<int64_t>(kMaxMessageSize - kEncryptionOverhead)}) {
+            bench->Args({static_cast<int64_t>(cipher), size});
+        }
+    }
+}
+BENCHMARK(BM_AeadSeal)->Apply(AeadArgs);
+BENCHMARK(BM_AeadOpen)->Apply(AeadArgs);
+
+// One state packet encrypted by the leader's transport and decrypted by the follower's, replay
+// check included. Argument: cipher
+// =================================================================================================
+static void BM_EncryptedStatePacket(benchmark::State& state)
+{
+    EncryptionParams params;
+    params.cipher = static_cast<AeadCipher>(state.range(0));
+    if (!Prepare(state, params.cipher)) {
+        return;
+    }
+    params.key = GenerateAeadKey();
+    MailboxTransport wire;
+    params.role = EncryptionRole::kLeader;
+    EncryptedTransport leader(wire, params);
+    params.role = EncryptionRole::kFollower;
+    EncryptedTransport follower(wire, params);
+    StatePacket packet, received;
+    packet.header.type = MessageType::kLeaderState;
+    bool intact = true;
+    const int64_t start_ns = SteadyTimeNs();
+    for (auto _ : state) {
+        ++packet.header.sequence;
+        leader.Send(&packet, sizeof(packet));
+        if (follower.Receive(&received, sizeof(received)) != sizeof(received)
+            || received.header.sequence != packet.header.sequence) {
+            state.SkipWithError("State packet did not arrive intact");
+            intact = false;
+            break;
+        }
+    }
+    if (intact && params.cipher == DefaultAeadCipher()
+        && state.iterations() >= kBudgetMinIterations) {
+        budget_elapsed_ns += SteadyTimeNs() - start_ns;
+        budget_packets += state.iterations();
+    }
+    state.counters["overhead_bytes"] = static_cast<double>(kEncryptionOverhead);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EncryptedStatePacket)
+    ->ArgName("cipher")
+    ->Arg(static_cast<int64_t>(AeadCipher::kAes256Gcm))
+    ->Arg(static_cast<int64_t>(AeadCipher::kChaCha20Poly1305));
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    if (budget_packets > 0 && budget_elapsed_ns > kStatePacketBudgetNs * budget_packets) {
+        std::cerr << "A state packet took " << budget_elapsed_ns / budget_packets
+                  << " ns on average with the default cipher, over the budget of "
+                  << kStatePacketBudgetNs << " ns" << std::endl;
+        return 1;
+    }
+    return 0;
+}
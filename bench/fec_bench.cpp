@@ -0,0 +1,128 @@
+/**
+ * @file fec_bench.cpp
+ * @brief Benchmarks of the forward error correction over an emulated lossy link. Every iteration
+ * is one control cycle: a state packet is framed as an FEC data packet, followed by the parity
+ * packets when its group is full, each datagram is dropped by a Gilbert-Elliott loss model with
+ * the given loss ratio and mean burst length, and the survivors are decoded. Reports the
+ * bandwidth overhead, the share of packets still lost after recovery against the injected loss,
+ * the share of lost packets recovered, and how many cycles late recovered packets arrive.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include <flexiv/omni/teleop/fec.hpp>
+#include <flexiv/omni/teleop/wire_format.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace flexiv::omni::teleop;
+
+namespace {
+
+/** Bursty loss: a lossless and a lossy state, the lossy one lasting burst_length on average */
+class GilbertElliottLoss
+{
+public:
+    GilbertElliottLoss(double loss_ratio, double burst_length)
+    : leave_bad_(1.0 / burst_length)
+    , enter_bad_(loss_ratio / ((1.0 - loss_ratio) * burst_length))
+    , rng_(1)
+    {
+    }
+
+    bool Drop()
+    {
+        bad_ = uniform_(rng_) < (bad_ ? 1.0 - leave_bad_ : enter_bad_);
+        return bad_;
+    }
+
+private:
+    double leave_bad_;
+    double enter_bad_;
+    bool bad_ = false;
+    std::mt19937 rng_;
+    std::uniform_real_distribution<double> uniform_ {0.0, 1.0};
+};
+
+}
+
+// Arguments: group size, parity packets per group, loss ratio [%], mean burst length [packets]
+// =================================================================================================
+static void BM_FecStream(benchmark::State& state)
+{
+    FecParams params;
+    params.group_size = static_cast<unsigned>(state.range(0));
+    params.parity_count = static_cast<unsigned>(state.range(1));
+    GilbertElliottLoss link(state.range(2) / 100.0, static_cast<double>(state.range(3)));
+    FecEncoder encoder(params);
+    FecDecoder decoder(params);
+    std::array<uint8_t, kMaxMessageSize> datagram;
+    StatePacket packet;
+    packet.header.type = MessageType::kLeaderState;
+
+    uint64_t sequence = 0, dropped = 0, datagrams = 0, delivered = 0, recovered = 0, delay = 0;
+    std::vector<bool> arrived;
+    const auto deliver = [&](const uint8_t* data, size_t size, bool late) {
+        if (size != sizeof(StatePacket)) {
+            state.SkipWithError("Delivered message has the wrong size");
+            return;
+        }
+        StatePacket received;
+        std::memcpy(&received, data, size);
+        const uint64_t s = received.header.sequence;
+        if (s == 0 || s > sequence || arrived[s - 1]) {
+            state.SkipWithError("Delivered message is corrupt or a duplicate");
+            return;
+        }
+        arrived[s - 1] = true;
+        ++delivered;
+        if (late) {
+            ++recovered;
+            delay += sequence - s;
+        }
+    };
+    const auto transmit = [&](size_t size) {
+        ++datagrams;
+        if (link.Drop()) {
+            ++dropped;
+            return;
+        }
+        const uint8_t* data = nullptr;
+        const size_t message_size = decoder.Decode(datagram.data(), size, data);
+        if (message_size > 0) {
+            deliver(data, message_size, false);
+        }
+        for (size_t n; (n = decoder.PopRecovered(data)) > 0;) {
+            deliver(data, n, true);
+        }
+    };
+
+    for (auto _ : state) {
+        packet.header.sequence = ++sequence;
+        packet.q[0] = static_cast<double>(sequence);
+        arrived.push_back(false);
+        transmit(encoder.EncodeData(&packet, sizeof(packet), datagram.data()));
+        for (unsigned row = 0; row < encoder.parity_ready(); ++row) {
+            transmit(encoder.EncodeParity(row, datagram.data()));
+        }
+        benchmark::ClobberMemory();
+    }
+
+    const double packets = static_cast<double>(sequence);
+    state.counters["overhead_ratio"]
+        = static_cast<double>(params.parity_count) / params.group_size;
+    state.counters["injected_loss_ratio"] = static_cast<double>(dropped) / datagrams;
+    state.counters["residual_loss_ratio"] = (packets - delivered) / packets;
+    const double lost = recovered + (packets - delivered);
+    state.counters["recovery_ratio"] = lost > 0 ? recovered / lost : 1.0;
+    state.counters["recovery_delay_cycles"]
+        = recovered > 0 ? static_cast<double>(delay) / recovered : 0.0;
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FecStream)
+    ->ArgNames({"group", "parity", "loss_pct", "burst"})
+    ->ArgsProduct({{4, 8}, {1, 2}, {1, 3}, {1, 3}});
@@ -0,0 +1,114 @@
+/**
+ * @file network_io_bench.cpp
+ * @brief Benchmarks of the network I/O backends serving many teleop pairs. Every iteration is one
+ * control cycle: each pair's loop queues one packet, and the iteration ends when every packet was
+ * delivered to the peer loop. Both ends of each pair are hosted by one MultiPairServer and talk
+ * over loopback, so each packet passes the I/O thread twice, as it would on a leader and a
+ * follower host. Reports the CPU time the I/O thread and the kernel work it triggers cost per
+ * packet, and percentiles of the delivery latency.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include <flexiv/omni/teleop/clock.hpp>
+#include <flexiv/omni/teleop/multi_pair_server.hpp>
+#include <flexiv/omni/teleop/wire_format.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <time.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace flexiv::omni::teleop;
+
+namespace {
+
+/** First localhost UDP port, each pair uses two */
+constexpr uint16_t kBasePort = 27300;
+
+/** Longest wait for a packet before the benchmark gives up [ns] */
+constexpr int64_t kDeliveryTimeoutNs = 1000000000;
+
+int64_t CpuTimeNs(clockid_t clock)
+{
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+double PercentileUs(std::vector<int64_t>& samples_ns, double p)
+{
+    const size_t idx = std::min(samples_ns.size() - 1,
+        static_cast<size_t>(p / 100.0 * static_cast<double>(samples_ns.size())));
+    std::nth_element(samples_ns.begin(), samples_ns.begin() + idx, samples_ns.end());
+    return samples_ns[idx] / 1000.0;
+}
+
+}
+
+// Arguments: backend (0 = epoll, 1 = io_uring), number of pairs
+// =================================================================================================
+static void BM_MultiPairServerLoopback(benchmark::State& state)
+{
+    MultiPairServerParams params;
+    params.backend = static_cast<IoBackend>(state.range(0));
+    // Plain scheduling, the benchmark thread polls on the same cores
+    params.io_thread = {0, -1, false, 0, 0, false};
+    MultiPairServer server(params);
+    if (server.backend() != params.backend) {
+        state.SkipWithError("io_uring backend not supported by this kernel");
+        return;
+    }
+    const auto num_pairs = static_cast<size_t>(state.range(1));
+    std::vector<PairEndpoint*> senders, receivers;
+    for (size_t k = 0; k < num_pairs; ++k) {
+        const auto port = static_cast<uint16_t>(kBasePort + 2 * k);
+        senders.push_back(&server.AddPair(port, "127.0.0.1", port + 1));
+        receivers.push_back(&server.AddPair(port + 1, "127.0.0.1", port));
+    }
+    server.Start();
+
+    StatePacket packet, received;
+    packet.header.type = MessageType::kLeaderState;
+    std::vector<int64_t> latencies_ns;
+    const int64_t process_start_ns = CpuTimeNs(CLOCK_PROCESS_CPUTIME_ID);
+    const int64_t thread_start_ns = CpuTimeNs(CLOCK_THREAD_CPUTIME_ID);
+    for (auto _ : state) {
+        for (auto* sender : senders) {
+            packet.header.send_time_ns = SteadyTimeNs();
+            sender->Send(&packet, sizeof(packet));
+        }
+        for (auto* receiver : receivers) {
+            while (receiver->Receive(&received, sizeof(received)) == 0) {
+                if (SteadyTimeNs() - packet.header.send_time_ns > kDeliveryTimeoutNs) {
+                    state.SkipWithError("Packet was not delivered");
+                    return;
+                }
+                std::this_thread::yield();
+            }
+            latencies_ns.push_back(SteadyTimeNs() - received.header.send_time_ns);
+        }
+    }
+    // Everything but the polling benchmark thread is the I/O thread
+    const int64_t io_cpu_ns = (CpuTimeNs(CLOCK_PROCESS_CPUTIME_ID) - process_start_ns)
+                              - (CpuTimeNs(CLOCK_THREAD_CPUTIME_ID) - thread_start_ns);
+    server.Stop();
+
+    const auto packets = static_cast<double>(latencies_ns.size());
+    const auto metrics = server.metrics();
+    state.SetItemsProcessed(static_cast<int64_t>(latencies_ns.size()));
+    state.counters["io_cpu_per_packet_us"] = io_cpu_ns / packets / 1000.0;
+    state.counters["syscalls_per_packet"]
+        = (metrics.wakeup_count + metrics.notify_count + metrics.recv_call_count
+              + metrics.send_call_count + metrics.submit_call_count)
+          / packets;
+    state.counters["latency_p50_us"] = PercentileUs(latencies_ns, 50);
+    state.counters["latency_p99_us"] = PercentileUs(latencies_ns, 99);
+    state.counters["latency_p999_us"] = PercentileUs(latencies_ns, 99.9);
+}
+BENCHMARK(BM_MultiPairServerLoopback)
+    ->ArgNames({"io_uring", "pairs"})
+    ->ArgsProduct({{0, 1}, {1, 8}})
+    ->UseRealTime();
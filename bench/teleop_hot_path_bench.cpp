@@ -0,0 +1,358 @@
+/**
+ * @file teleop_hot_path_bench.cpp
+ * @brief Benchmarks of every operation executed once per teleop control cycle. Each benchmark
+ * corresponds to one stage of the 1 ms budget; run with --benchmark_out=<file>.json to produce
+ * results that compare_results.py can diff against a previous run.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include <flexiv/omni/teleop/batch_kinematics.hpp>
+#include <flexiv/omni/teleop/filters.hpp>
+#include <flexiv/omni/teleop/force_feedback.hpp>
+#include <flexiv/omni/teleop/ik_solver.hpp>
+#include <flexiv/omni/teleop/kinematics.hpp>
+#include <flexiv/omni/teleop/latest_value.hpp>
+#include <flexiv/omni/teleop/loop_timing.hpp>
+#include <flexiv/omni/teleop/motion_predictor.hpp>
+#include <flexiv/omni/teleop/passivity.hpp>
+#include <flexiv/omni/teleop/spsc_queue.hpp>
+#include <flexiv/omni/teleop/wire_format.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <random>
+
+using namespace flexiv::omni::teleop;
+
+namespace {
+
+/** Deterministic pseudo-random joint configuration within +/- 2 rad */
+JointArray RandomJoints(std::mt19937& rng)
+{
+    std::uniform_real_distribution<double> dist(-2.0, 2.0);
+    JointArray q;
+    for (auto& v : q) {
+        v = dist(rng);
+    }
+    return q;
+}
+
+RobotStates MakeStates()
+{
+    std::mt19937 rng(42);
+    RobotStates states;
+    states.q = RandomJoints(rng);
+    states.dq = RandomJoints(rng);
+    states.tau_ext = RandomJoints(rng);
+    states.tcp_pose = {0.5, 0.1, 0.3, 1.0, 0.0, 0.0, 0.0};
+    states.ext_wrench_in_world = {1.0, 2.0, 3.0, 0.1, 0.2, 0.3};
+    return states;
+}
+
+StatePacket MakePacket()
+{
+    StatePacket packet;
+    packet.header.sequence = 123456;
+    packet.header.send_time_ns = 987654321;
+    packet.header.echo_time_ns = 987000000;
+    packet.header.echo_receive_time_ns = 987000500;
+    WriteStates(MakeStates(), packet);
+    return packet;
+}
+
+} /* namespace */
+
+// Packet packing/unpacking
+// =================================================================================================
+static void BM_PacketWriteStates(benchmark::State& state)
+{
+    RobotStates states = MakeStates();
+    StatePacket packet;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(states);
+        WriteStates(states, packet);
+        benchmark::DoNotOptimize(packet);
+    }
+}
+BENCHMARK(BM_PacketWriteStates);
+
+static void BM_PacketValidate(benchmark::State& state)
+{
+    StatePacket packet = MakePacket();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(packet);
+        benchmark::DoNotOptimize(IsValidPacket(packet, sizeof(packet)));
+    }
+}
+BENCHMARK(BM_PacketValidate);
+
+// Pose transforms
+// =================================================================================================
+static void BM_ForwardKinematics(benchmark::State& state)
+{
+    const Kinematics kinematics;
+    std::mt19937 rng(1);
+    const JointArray q = RandomJoints(rng);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(kinematics.ForwardKinematics(q));
+    }
+}
+BENCHMARK(BM_ForwardKinematics);
+
+static void BM_ForwardKinematicsAndJacobian(benchmark::State& state)
+{
+    const Kinematics kinematics;
+    std::mt19937 rng(2);
+    const JointArray q = RandomJoints(rng);
+    Eigen::Isometry3d pose;
+    Jacobian jacobian;
+    for (auto _ : state) {
+        kinematics.Compute(q, pose, jacobian);
+        benchmark::DoNotOptimize(pose);
+        benchmark::DoNotOptimize(jacobian);
+    }
+}
+BENCHMARK(BM_ForwardKinematicsAndJacobian);
+
+static void BM_PoseArrayConversion(benchmark::State& state)
+{
+    const Eigen::Isometry3d T
+        = Kinematics().ForwardKinematics({0.1, -0.7, 0.2, 1.5, 0.1, 0.7, 0.3});
+    for (auto _ : state) {
+        const PoseArray pose = Kinematics::ToPoseArray(T);
+        benchmark::DoNotOptimize(Kinematics::FromPoseArray(pose));
+    }
+}
+BENCHMARK(BM_PoseArrayConversion);
+
+// Inverse kinematics, once per cycle against a moving target as when following a Cartesian leader.
+// That the solver never allocates is proven by test/ik_solver_allocation_test
+// =================================================================================================
+static void BM_IkSolverTracking(benchmark::State& state)
+{
+    // Target trajectory: TCP poses of a smooth joint motion sampled at 1 kHz
+    const Kinematics kinematics;
+    const JointArray home = {0.0, -0.698, 0.0, 1.571, 0.0, 0.698, 0.0};
+    std::vector<Eigen::Isometry3d> targets(2000);
+    for (size_t k = 0; k < targets.size(); ++k) {
+        const double t = k * kLoopPeriod;
+        JointArray q = home;
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            q[i] += 0.3 * std::sin(2.0 * M_PI * 0.5 * t + i);
+        }
+        targets[k] = kinematics.ForwardKinematics(q);
+    }
+
+    IkSolver solver(home);
+    uint64_t iterations = 0, failures = 0;
+    size_t k = 0;
+    for (auto _ : state) {
+        const auto& result = solver.Solve(targets[k]);
+        iterations += result.iterations;
+        failures += !result.converged;
+        k = (k + 1) % targets.size();
+    }
+    state.counters["iterations_per_solve"]
+        = benchmark::Counter(iterations, benchmark::Counter::kAvgIterations);
+    state.counters["failures"] = failures;
+}
+BENCHMARK(BM_IkSolverTracking);
+
+static void BM_IkSolverFarTarget(benchmark::State& state)
+{
+    // Worst case: a target far from the seed, every solve runs into the iteration bound
+    const JointArray seed = {0.0, -0.698, 0.0, 1.571, 0.0, 0.698, 0.0};
+    const Eigen::Isometry3d target
+        = Kinematics().ForwardKinematics({1.5, 0.3, -1.0, 0.5, 1.0, 2.0, -1.0});
+    IkParams params;
+    params.max_time_ns = 1000000000;
+    IkSolver solver(seed, params);
+    for (auto _ : state) {
+        solver.Reset(seed);
+        benchmark::DoNotOptimize(solver.Solve(target));
+    }
+}
+BENCHMARK(BM_IkSolverFarTarget);
+
+// Batch kinematics, e.g. candidate poses of a predictor, against the scalar reference looped over
+// the same configurations
+// =================================================================================================
+template <size_t N>
+std::unique_ptr<JointBatch<N>> RandomJointBatch()
+{
+    std::mt19937 rng(3);
+    auto q = std::make_unique<JointBatch<N>>();
+    for (size_t k = 0; k < N; ++k) {
+        q->Set(k, RandomJoints(rng));
+    }
+    return q;
+}
+
+template <size_t N>
+static void BM_ScalarKinematicsAndJacobianBatch(benchmark::State& state)
+{
+    const Kinematics kinematics;
+    const auto q = RandomJointBatch<N>();
+    std::array<JointArray, N> configs;
+    for (size_t k = 0; k < N; ++k) {
+        configs[k] = q->Get(k);
+    }
+    Eigen::Isometry3d pose;
+    Jacobian jacobian;
+    for (auto _ : state) {
+        for (const auto& config : configs) {
+            kinematics.Compute(config, pose, jacobian);
+            benchmark::DoNotOptimize(pose);
+            benchmark::DoNotOptimize(jacobian);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK_TEMPLATE(BM_ScalarKinematicsAndJacobianBatch, 16);
+BENCHMARK_TEMPLATE(BM_ScalarKinematicsAndJacobianBatch, 64);
+
+template <size_t N>
+static void BM_BatchKinematicsAndJacobian(benchmark::State& state)
+{
+    const BatchKinematics batch_kinematics;
+    const auto q = RandomJointBatch<N>();
+    auto poses = std::make_unique<PoseBatch<N>>();
+    auto jacobians = std::make_unique<JacobianBatch<N>>();
+    for (auto _ : state) {
+        batch_kinematics.Compute(*q, *poses, *jacobians);
+        benchmark::DoNotOptimize(poses->translation[0][0]);
+        benchmark::DoNotOptimize(jacobians->data[0][0][0]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+    state.counters["simd_width"] = batch_kinematics.simd_width();
+}
+BENCHMARK_TEMPLATE(BM_BatchKinematicsAndJacobian, 16);
+BENCHMARK_TEMPLATE(BM_BatchKinematicsAndJacobian, 64);
+
+template <size_t N>
+static void BM_BatchForwardKinematics(benchmark::State& state)
+{
+    const BatchKinematics batch_kinematics;
+    const auto q = RandomJointBatch<N>();
+    auto poses = std::make_unique<PoseBatch<N>>();
+    for (auto _ : state) {
+        batch_kinematics.ForwardKinematics(*q, *poses);
+        benchmark::DoNotOptimize(poses->translation[0][0]);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK_TEMPLATE(BM_BatchForwardKinematics, 64);
+
+// Force scaling and filtering
+// =================================================================================================
+static void BM_LowPassFilter(benchmark::State& state)
+{
+    LowPassFilter<kJointDoF> filter(50.0, kLoopPeriod);
+    std::mt19937 rng(3);
+    const JointArray input = RandomJoints(rng);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filter.Filter(input));
+    }
+}
+BENCHMARK(BM_LowPassFilter);
+
+static void BM_ForceFeedbackRender(benchmark::State& state)
+{
+    ForceFeedback force_feedback(0.5, 50.0);
+    std::mt19937 rng(4);
+    const JointArray tau_ext = RandomJoints(rng);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(force_feedback.Render(tau_ext));
+    }
+}
+BENCHMARK(BM_ForceFeedbackRender);
+
+static void BM_PassivityControllerApply(benchmark::State& state)
+{
+    PassivityController passivity;
+    std::mt19937 rng(5);
+    const JointArray feedback = RandomJoints(rng);
+    const JointArray dq = RandomJoints(rng);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(passivity.Apply(feedback, dq));
+    }
+}
+BENCHMARK(BM_PassivityControllerApply);
+
+static void BM_MotionPredictorUpdatePredict(benchmark::State& state)
+{
+    MotionPredictor predictor;
+    std::mt19937 rng(6);
+    const JointArray q = RandomJoints(rng);
+    const JointArray dq = RandomJoints(rng);
+    int64_t time_ns = 0;
+    for (auto _ : state) {
+        time_ns += kLoopPeriodNs;
+        predictor.Update(time_ns, q, dq);
+        JointArray q_command = q, dq_command = dq;
+        benchmark::DoNotOptimize(predictor.Predict(time_ns + 50000000, q_command, dq_command));
+        benchmark::DoNotOptimize(q_command);
+    }
+}
+BENCHMARK(BM_MotionPredictorUpdatePredict);
+
+// Queue hand-off between control and network threads, measured single-threaded as the
+// uncontended cost paid by each side
+// =================================================================================================
+static void BM_SpscQueuePushPop(benchmark::State& state)
+{
+    auto queue = std::make_unique<SpscQueue<StatePacket, 1024>>();
+    const StatePacket packet = MakePacket();
+    StatePacket out;
+    for (auto _ : state) {
+        queue->TryPush(packet);
+        queue->TryPop(out);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(BM_SpscQueuePushPop);
+
+static void BM_LatestValueWriteRead(benchmark::State& state)
+{
+    auto mailbox = std::make_unique<LatestValue<StatePacket>>();
+    const StatePacket packet = MakePacket();
+    StatePacket out;
+    for (auto _ : state) {
+        mailbox->Write(packet);
+        mailbox->TryRead(out);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(BM_LatestValueWriteRead);
+
+// Timing instrumentation added to every cycle
+// =================================================================================================
+static void BM_LatencyHistogramRecord(benchmark::State& state)
+{
+    auto histogram = std::make_unique<LatencyHistogram>();
+    int64_t value = 1000;
+    for (auto _ : state) {
+        histogram->Record(value);
+        value = (value * 7 + 13) & 0xFFFFF;
+    }
+}
+BENCHMARK(BM_LatencyHistogramRecord);
+
+static void BM_LoopTimingCycle(benchmark::State& state)
+{
+    auto timing = std::make_unique<LoopTimingRecorder>();
+    for (auto _ : state) {
+        timing->BeginCycle();
+        timing->EndStage(LoopStage::kReceive);
+        timing->EndStage(LoopStage::kCompute);
+        timing->EndStage(LoopStage::kCommand);
+        timing->EndStage(LoopStage::kSend);
+        timing->EndCycle();
+    }
+}
+BENCHMARK(BM_LoopTimingCycle);
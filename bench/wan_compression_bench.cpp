@@ -0,0 +1,181 @@
+/**
+ * @file wan_compression_bench.cpp
+ * @brief Benchmarks of the compressed WAN encoding of state packets. Every iteration is one
+ * control cycle of a simulated follower pressing into a wall: its state packet is encoded, sent
+ * over an emulated link with fixed delay and random loss, decoded on the far side, and the far
+ * side's keyframe acknowledgement travels back over the same link. Reports the bandwidth at the
+ * 1 kHz loop rate against uncompressed packets, and the worst reconstruction error per quantity.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include <flexiv/omni/teleop/sim_robot.hpp>
+#include <flexiv/omni/teleop/state_compression.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace flexiv::omni::teleop;
+
+namespace {
+
+/** Length of the recorded trajectory, played in a loop [cycles] */
+constexpr size_t kTrajectoryLength = 10000;
+
+/** IPv4 and UDP headers added to every datagram [bytes] */
+constexpr double kUdpOverhead = 28.0;
+
+/** States of a follower arm tracking a slow sinusoid and pressing into a wall every period */
+std::vector<StatePacket> MakeTrajectory()
+{
+    SimRobot robot;
+    VirtualWall wall;
+    wall.enabled = true;
+    wall.offset = robot.states().tcp_pose[2] - 0.01;
+    robot.SetVirtualWall(wall);
+    const JointArray home = robot.states().q;
+    std::vector<StatePacket> packets(kTrajectoryLength);
+    for (size_t k = 0; k < packets.size(); ++k) {
+        const double offset = 0.25 * std::sin(2.0 * M_PI * 0.5 * k * kLoopPeriod);
+        JointArray q = home, dq = {};
+        q[1] += offset;
+        q[3] -= offset;
+        robot.StreamJointPosition(q, dq);
+        robot.Step();
+        packets[k].header.type = MessageType::kFollowerState;
+        WriteStates(robot.states(), packets[k]);
+    }
+    return packets;
+}
+
+/** Largest absolute difference between two arrays */
+template <size_t N>
+double MaxError(const std::array<double, N>& a, const std::array<double, N>& b, size_t begin = 0,
+    size_t end = N)
+{
+    double error = 0.0;
+    for (size_t i = begin; i < end; ++i) {
+        error = std::max(error, std::abs(a[i] - b[i]));
+    }
+    return error;
+}
+
+/** One direction of the emulated link: fixed delay, random loss */
+struct DelayLine
+{
+    struct Slot
+    {
+        std::array<uint8_t, kMaxCompressedSize> data;
+        size_t size = 0;
+    };
+
+    explicit DelayLine(size_t delay_cycles)
+    : slots(delay_cycles + 1)
+    {
+    }
+
+    /** Put this cycle's message in, or nothing if lost, and take out the one sent delay ago */
+    const Slot& Shift(const uint8_t* data, size_t size)
+    {
+        Slot& slot = slots[cycle++ % slots.size()];
+        std::copy(data, data + size, slot.data.begin());
+        slot.size = size;
+        return slots[cycle % slots.size()];
+    }
+
+    std::vector<Slot> slots;
+    size_t cycle = 0;
+};
+
+}
+
+// Arguments: keyframe interval, loss ratio [%], one-way delay [ms]
+// =================================================================================================
+static void BM_CompressedStateStream(benchmark::State& state)
+{
+    static const auto trajectory = MakeTrajectory();
+    CompressionParams params;
+    params.keyframe_interval = static_cast<unsigned>(state.range(0));
+    const double loss_ratio = state.range(1) / 100.0;
+    const auto delay_cycles = static_cast<size_t>(state.range(2));
+
+    StateEncoder encoder(params);
+    StateDecoder decoder(params);
+    StateEncoder reverse_encoder(params);
+    StateDecoder reverse_decoder(params);
+    DelayLine forward(delay_cycles), backward(delay_cycles);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::array<uint8_t, kMaxCompressedSize> buffer;
+    StatePacket reverse, decoded;
+    reverse.header.type = MessageType::kLeaderState;
+    CompressedPacketHeader header;
+
+    uint64_t sequence = 0, bytes = 0, keyframes = 0, decoded_count = 0, missing_base = 0;
+    double q_error = 0.0, dq_error = 0.0, tau_error = 0.0, position_error = 0.0,
+           orientation_error = 0.0, wrench_error = 0.0;
+    for (auto _ : state) {
+        StatePacket packet = trajectory[sequence % trajectory.size()];
+        packet.header.sequence = ++sequence;
+        const size_t size = encoder.Encode(packet, 0, buffer.data());
+        bytes += size;
+        keyframes += encoder.keyframe();
+        const bool lost = uniform(rng) < loss_ratio;
+        const auto& arrived = forward.Shift(buffer.data(), lost ? 0 : size);
+
+        // The far side decodes and sends its own packet back, carrying the acknowledgement
+        if (arrived.size > 0) {
+            const auto result = decoder.Decode(arrived.data.data(), arrived.size, header, decoded);
+            if (result == StateDecoder::Result::kDecoded) {
+                ++decoded_count;
+                const auto& original = trajectory[(header.header.sequence - 1) % trajectory.size()];
+                q_error = std::max(q_error, MaxError(original.q, decoded.q));
+                dq_error = std::max(dq_error, MaxError(original.dq, decoded.dq));
+                tau_error = std::max(tau_error, MaxError(original.tau_ext, decoded.tau_ext));
+                position_error
+                    = std::max(position_error, MaxError(original.tcp_pose, decoded.tcp_pose, 0, 3));
+                orientation_error = std::max(
+                    orientation_error, MaxError(original.tcp_pose, decoded.tcp_pose, 3, 7));
+                wrench_error
+                    = std::max(wrench_error, MaxError(original.ext_wrench, decoded.ext_wrench));
+            } else {
+                missing_base += result == StateDecoder::Result::kMissingBase;
+            }
+        }
+        reverse.header.sequence = sequence;
+        const size_t reverse_size = reverse_encoder.Encode(reverse, decoder.ack(), buffer.data());
+        const auto& returned
+            = backward.Shift(buffer.data(), uniform(rng) < loss_ratio ? 0 : reverse_size);
+        if (returned.size > 0
+            && reverse_decoder.Decode(returned.data.data(), returned.size, header, decoded)
+                   != StateDecoder::Result::kMalformed) {
+            encoder.Acknowledge(header.ack);
+        }
+        benchmark::ClobberMemory();
+    }
+
+    const double packets = static_cast<double>(sequence);
+    const double bytes_per_packet = bytes / packets;
+    state.counters["bytes_per_packet"] = bytes_per_packet;
+    state.counters["kbit_per_s"] = (bytes_per_packet + kUdpOverhead) * 8.0 / kLoopPeriod / 1000.0;
+    state.counters["raw_kbit_per_s"]
+        = (sizeof(StatePacket) + kUdpOverhead) * 8.0 / kLoopPeriod / 1000.0;
+    state.counters["keyframe_ratio"] = keyframes / packets;
+    state.counters["undecodable_ratio"] = missing_base / packets;
+    state.counters["max_q_error_rad"] = q_error;
+    state.counters["max_dq_error_rad_s"] = dq_error;
+    state.counters["max_tau_error_nm"] = tau_error;
+    state.counters["max_position_error_m"] = position_error;
+    state.counters["max_orientation_error"] = orientation_error;
+    state.counters["max_wrench_error"] = wrench_error;
+    // Short runs end before the first packet made it through the delay
+    if (decoded_count == 0 && sequence > delay_cycles + params.keyframe_interval) {
+        state.SkipWithError("No packet was decoded");
+    }
+}
+BENCHMARK(BM_CompressedStateStream)
+    ->ArgNames({"keyframe_interval", "loss_pct", "delay_ms"})
+    ->ArgsProduct({{10, 100, 1000}, {0, 5}, {0, 300}});
@@ -0,0 +1,254 @@
+/**
+ * @example delayed_feedback_stability.cpp
+ * Benchmark the stability of force feedback over long links. A leader and a follower node drive
+ * two simulated arms in one thread, faster than real time, through an in-memory link with a fixed
+ * one-way delay. An emulated operator pushes the follower into a stiff virtual wall. For each
+ * delay the loop is run with plain force feedback and with the passivity controller, and the
+ * energy the force feedback injects into the operator's hand through the leader arm is reported:
+ * a passive channel absorbs energy (negative rate), an active one injects it, which shows up as
+ * the arms bouncing on the wall.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ * @author Flexiv
+ */
+
+#include <flexiv/omni/teleop/clock.hpp>
+#include <flexiv/omni/teleop/follower_node.hpp>
+#include <flexiv/omni/teleop/leader_node.hpp>
+#include <flexiv/omni/teleop/sim_robot.hpp>
+#include <flexiv/omni/teleop/utility.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+/** Emulated operator hand: joint impedance pulling the leader along a slow periodic motion */
+constexpr double kOperatorStiffness = 300.0;
+constexpr double kOperatorDamping = 20.0;
+constexpr double kOperatorAmplitude = 0.25;
+constexpr double kOperatorFreq = 0.5;
+
+/** Virtual wall below the follower's initial TCP position [m] */
+constexpr double kWallDepth = 0.04;
+
+/** Length of the windows the injected energy is evaluated over [s] */
+constexpr double kWindow = 1.0;
+
+/** One direction of the in-memory link */
+struct Channel
+{
+    struct Message
+    {
+        int64_t deliver_time_ns;
+        teleop::StatePacket packet;
+    };
+    std::deque<Message> queue;
+};
+
+/**
+ * Endpoint of an in-memory link that delivers every message a fixed delay after it was sent, on
+ * a shared clock
+ */
+class DelayedLink : public teleop::Transport
+{
+public:
+    DelayedLink(const teleop::Clock& clock, int64_t delay_ns, Channel& tx, Channel& rx)
+    : clock_(clock)
+    , delay_ns_(delay_ns)
+    , tx_(tx)
+    , rx_(rx)
+    {
+    }
+
+    bool Send(const void* data, size_t size) override
+    {
+        if (size != sizeof(teleop::StatePacket)) {
+            return false;
+        }
+        Channel::Message message;
+        message.deliver_time_ns = clock_.NowNs() + delay_ns_;
+        std::memcpy(&message.packet, data, size);
+        tx_.queue.push_back(message);
+        return true;
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        if (rx_.queue.empty() || rx_.queue.front().deliver_time_ns > clock_.NowNs()
+            || capacity < sizeof(teleop::StatePacket)) {
+            return 0;
+        }
+        std::memcpy(buffer, &rx_.queue.front().packet, sizeof(teleop::StatePacket));
+        rx_.queue.pop_front();
+        return sizeof(teleop::StatePacket);
+    }
+
+private:
+    const teleop::Clock& clock_;
+    int64_t delay_ns_;
+    Channel& tx_;
+    Channel& rx_;
+};
+
+/** Outcome of one run */
+struct RunResult
+{
+    /** Mean power injected by the force feedback, negative if the channel absorbs energy [W] */
+    double mean_injected_power = 0.0;
+
+    /** Largest energy injected within one window [J] */
+    double worst_window_energy = 0.0;
+
+    /** Number of times the follower hit the wall */
+    int wall_hits = 0;
+
+    /** Largest contact force on the follower [N] */
+    double peak_contact_force = 0.0;
+
+    /** Energy balance of the passivity controller */
+    teleop::PassivityMetrics passivity;
+};
+}
+
+/** @brief Print program usage help */
+void PrintHelp()
+{
+    // clang-format off
+    std::cout << "Optional arguments: [--delays-ms <list>] [--duration <seconds>] [--wall-stiffness <N/m>]" << std::endl;
+    std::cout << "                    [--feedback-scale <scale>]" << std::endl;
+    std::cout << "    --delays-ms       Comma-separated one-way delays to benchmark, default 0,50,100,200" << std::endl;
+    std::cout << "    --duration        Simulated duration of each run in seconds, default 20" << std::endl;
+    std::cout << "    --wall-stiffness  Stiffness of the virtual wall, default 5000" << std::endl;
+    std::cout << "    --feedback-scale  Scale of the force feedback, default 1" << std::endl;
+    std::cout << std::endl;
+    // clang-format on
+}
+
+/** @brief Simulate one session and measure the energy injected by the force feedback */
+RunResult Run(int64_t delay_ns, double duration, const teleop::VirtualWall& wall_params,
+    const teleop::LeaderParams& leader_params)
+{
+    teleop::ManualClock clock;
+    Channel to_follower, to_leader;
+    DelayedLink leader_link(clock, delay_ns, to_follower, to_leader);
+    DelayedLink follower_link(clock, delay_ns, to_leader, to_follower);
+
+    teleop::SimRobot leader_robot, follower_robot;
+    teleop::VirtualWall wall = wall_params;
+    wall.enabled = true;
+    wall.offset = follower_robot.states().tcp_pose[2] - kWallDepth;
+    follower_robot.SetVirtualWall(wall);
+    teleop::LeaderNode leader(leader_robot, leader_link, leader_params, clock);
+    teleop::FollowerNode follower(follower_robot, follower_link, {}, clock);
+
+    RunResult result;
+    const teleop::JointArray home = leader_robot.states().q;
+    const auto num_cycles = static_cast<size_t>(duration / teleop::kLoopPeriod);
+    const auto window_cycles = static_cast<size_t>(kWindow / teleop::kLoopPeriod);
+    double total_energy = 0.0, window_energy = 0.0;
+    bool in_contact = false;
+    for (size_t cycle = 0; cycle < num_cycles; ++cycle) {
+        clock.Set(static_cast<int64_t>(cycle) * teleop::kLoopPeriodNs);
+
+        // Emulated operator pushes joints 2 and 4 so the TCP moves up and down
+        const double t = cycle * teleop::kLoopPeriod;
+        const double offset = kOperatorAmplitude * std::sin(2.0 * M_PI * kOperatorFreq * t);
+        teleop::JointArray q_operator = home;
+        q_operator[1] += offset;
+        q_operator[3] -= offset;
+        const auto leader_states = leader_robot.states();
+        teleop::JointArray tau_operator;
+        for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+            tau_operator[i] = kOperatorStiffness * (q_operator[i] - leader_states.q[i])
+                              - kOperatorDamping * leader_states.dq[i];
+        }
+        leader_robot.SetExternalJointTorque(tau_operator);
+
+        leader.Step();
+        follower.Step();
+        leader_robot.Step();
+        follower_robot.Step();
+
+        // The work done by the feedback torques on the leader is the energy the channel injects
+        // into the operator's hand
+        const auto leader_after = leader_robot.states();
+        const auto follower_after = follower_robot.states();
+        double power = 0.0;
+        for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+            power += leader_after.tau[i] * leader_after.dq[i];
+        }
+        window_energy += power * teleop::kLoopPeriod;
+        if ((cycle + 1) % window_cycles == 0) {
+            result.worst_window_energy = std::max(result.worst_window_energy, window_energy);
+            total_energy += window_energy;
+            window_energy = 0.0;
+        }
+
+        const double contact_force = follower_after.ext_wrench_in_world[2];
+        if (contact_force > 0.0 && !in_contact) {
+            ++result.wall_hits;
+        }
+        in_contact = contact_force > 0.0;
+        result.peak_contact_force = std::max(result.peak_contact_force, contact_force);
+    }
+    result.mean_injected_power = total_energy / duration;
+    result.passivity = leader.status().passivity;
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    // Program Setup
+    // =============================================================================================
+    if (teleop::utility::ProgramArgsExist(argc, argv, {"-h", "--help"})) {
+        PrintHelp();
+        return 1;
+    }
+    std::vector<double> delays_ms;
+    std::stringstream delay_list(
+        teleop::utility::ProgramArgValue(argc, argv, "--delays-ms", "0,50,100,200"));
+    for (std::string item; std::getline(delay_list, item, ',');) {
+        delays_ms.push_back(std::stod(item));
+    }
+    const double duration
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--duration", "20"));
+    teleop::VirtualWall wall;
+    wall.stiffness
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--wall-stiffness", "5000"));
+    teleop::LeaderParams plain;
+    plain.feedback_scale
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--feedback-scale", "1"));
+    teleop::LeaderParams passive = plain;
+    passive.use_passivity_control = true;
+
+    // Benchmark
+    // =============================================================================================
+    std::cout << "Energy injected by the force feedback, negative if the channel absorbs it"
+              << std::endl;
+    std::cout << std::setw(10) << "delay[ms]" << std::setw(13) << "feedback" << std::setw(12)
+              << "mean[W]" << std::setw(16) << "worst 1 s[J]" << std::setw(12) << "wall hits"
+              << std::setw(16) << "peak force[N]" << std::setw(16) << "dissipated[J]"
+              << std::endl;
+    for (double delay_ms : delays_ms) {
+        const auto delay_ns = static_cast<int64_t>(delay_ms * 1e6);
+        for (const auto* params : {&plain, &passive}) {
+            const auto result = Run(delay_ns, duration, wall, *params);
+            std::cout << std::fixed << std::setw(10) << std::setprecision(0) << delay_ms
+                      << std::setw(13) << (params->use_passivity_control ? "passivity" : "plain")
+                      << std::setprecision(3) << std::setw(12) << result.mean_injected_power
+                      << std::setw(16) << result.worst_window_energy << std::setw(12)
+                      << result.wall_hits << std::setprecision(1) << std::setw(16)
+                      << result.peak_contact_force << std::setprecision(3) << std::setw(16)
+                      << result.passivity.dissipated_energy << std::endl;
+        }
+    }
+
+    return 0;
+}
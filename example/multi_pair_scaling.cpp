@@ -0,0 +1,350 @@
+/**
+ * @example multi_pair_scaling.cpp
+ * Benchmark how the latency of each teleop pair holds up as more pairs are hosted in one process.
+ * For every pair count, that many leader/follower pairs of simulated arms run over localhost
+ * UDP, each node in its own real-time loop, optionally pinned round-robin to a list of cores. The
+ * network side is either served by one MultiPairServer per side, whose single I/O thread batches
+ * all pairs' datagrams through epoll, recvmmsg and sendmmsg, or by a UdpTransport per node that
+ * makes its socket calls from the control loop. Each follower loop runs half a period after its
+ * leader's, so the one-way delay it measures is half a period plus the time the network side took
+ * to deliver the packet. Per-pair one-way and round-trip delays, the worst execution time of the
+ * nodes' Step(), deadline misses and the I/O threads' system calls per datagram are reported.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ * @author Flexiv
+ */
+
+#include <flexiv/omni/teleop/follower_node.hpp>
+#include <flexiv/omni/teleop/leader_node.hpp>
+#include <flexiv/omni/teleop/multi_pair_server.hpp>
+#include <flexiv/omni/teleop/rt_thread.hpp>
+#include <flexiv/omni/teleop/sim_robot.hpp>
+#include <flexiv/omni/teleop/udp_transport.hpp>
+#include <flexiv/omni/teleop/utility.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+/** Emulated operator hand: joint impedance pulling the leader along a slow periodic motion */
+constexpr double kOperatorStiffness = 300.0;
+constexpr double kOperatorDamping = 20.0;
+constexpr double kOperatorAmplitude = 0.25;
+constexpr double kOperatorFreq = 0.5;
+
+/** Delays measured in one pair over one run [ns] */
+struct PairSamples
+{
+    std::vector<int64_t> round_trips_ns;
+    std::vector<int64_t> one_way_ns;
+    uint64_t step_p99_ns = 0;
+    uint64_t leader_step_p99_ns = 0;
+    uint64_t deadline_misses = 0;
+    uint64_t leader_deadline_misses = 0;
+    uint64_t lost_count = 0;
+};
+
+/** Outcome of one run */
+struct RunResult
+{
+    std::vector<PairSamples> pairs;
+
+    /** System calls of both I/O threads per datagram moved, 0 without MultiPairServer */
+    double syscalls_per_datagram = 0.0;
+};
+}
+
+/** @brief Print program usage help */
+void PrintHelp()
+{
+    // clang-format off
+    std::cout << "Optional arguments: [--pairs <list>] [--duration <seconds>] [--port <port>] [--mode <hub|direct|both>]" << std::endl;
+    std::cout << "                    [--cpus <list>] [--io-cpu <core>] [--priority <1-99>] [--io-uring]" << std::endl;
+    std::cout << "    --pairs     Comma-separated numbers of pairs to run, default 1,2,4,8" << std::endl;
+    std::cout << "    --duration  Duration of each run in seconds, default 5" << std::endl;
+    std::cout << "    --port      First localhost UDP port, each pair uses two, default 26300" << std::endl;
+    std::cout << "    --mode      Serve the network through MultiPairServer (hub), a UdpTransport per node (direct) or both, default both" << std::endl;
+    std::cout << "    --cpus      Comma-separated CPU cores to pin the control loops to round-robin, default none" << std::endl;
+    std::cout << "    --io-cpu    CPU core to pin the I/O threads to, default -1 (not pinned)" << std::endl;
+    std::cout << "    --priority  SCHED_FIFO priority of the control loops, the I/O threads run 10 below, default 80" << std::endl;
+    std::cout << "    --io-uring  Run the MultiPairServer I/O threads on io_uring instead of epoll, if supported" << std::endl;
+    std::cout << std::endl;
+    // clang-format on
+}
+
+/** @brief Return the p-th percentile of sorted samples in [us] */
+double PercentileUs(const std::vector<int64_t>& sorted_ns, double p)
+{
+    if (sorted_ns.empty()) {
+        return 0.0;
+    }
+    const size_t idx = std::min(sorted_ns.size() - 1,
+        static_cast<size_t>(std::ceil(p / 100.0 * sorted_ns.size())) - 1);
+    return sorted_ns[idx] / 1000.0;
+}
+
+/**
+ * @brief Set up the calling thread for real-time, then run fn once per loop period from a given
+ * start time until stopped.
+ */
+template <typename Fn>
+void RunPeriodic(const teleop::RtThreadConfig& rt_config,
+    std::chrono::steady_clock::time_point start, const std::atomic<bool>& stop, Fn&& fn)
+{
+    teleop::ConfigureRtThread(rt_config);
+    const auto period = std::chrono::nanoseconds(teleop::kLoopPeriodNs);
+    auto next_wakeup = start;
+    std::this_thread::sleep_until(next_wakeup);
+    while (!stop) {
+        fn();
+        next_wakeup += period;
+        std::this_thread::sleep_until(next_wakeup);
+    }
+}
+
+/** @brief Run a number of pairs side by side for a while and collect their delays */
+RunResult Run(size_t num_pairs, bool use_hub, double duration, uint16_t port,
+    const std::vector<int>& cpus, int io_cpu, int priority, teleop::IoBackend backend)
+{
+    // Each pair's follower receives on port + 2k, its leader on port + 2k + 1
+    teleop::MultiPairServerParams server_params;
+    server_params.io_thread.priority = std::max(priority - 10, 1);
+    server_params.io_thread.cpu_core = io_cpu;
+    server_params.backend = backend;
+    teleop::MultiPairServer leader_server(server_params), follower_server(server_params);
+    std::vector<std::unique_ptr<teleop::UdpTransport>> udp_transports;
+    std::vector<teleop::Transport*> leader_links, follower_links;
+    for (size_t k = 0; k < num_pairs; ++k) {
+        const auto follower_port = static_cast<uint16_t>(port + 2 * k);
+        const auto leader_port = static_cast<uint16_t>(follower_port + 1);
+        if (use_hub) {
+            follower_links.push_back(
+                &follower_server.AddPair(follower_port, "127.0.0.1", leader_port));
+            leader_links.push_back(&leader_server.AddPair(leader_port, "127.0.0.1", follower_port));
+        } else {
+            udp_transports.push_back(std::make_unique<teleop::UdpTransport>(
+                follower_port, "127.0.0.1", leader_port));
+            follower_links.push_back(udp_transports.back().get());
+            udp_transports.push_back(std::make_unique<teleop::UdpTransport>(
+                leader_port, "127.0.0.1", follower_port));
+            leader_links.push_back(udp_transports.back().get());
+        }
+    }
+    if (use_hub) {
+        leader_server.Start();
+        follower_server.Start();
+    }
+
+    // Pre-allocate all sample storage so the loops never allocate
+    const auto num_cycles = static_cast<size_t>(duration / teleop::kLoopPeriod) + 100;
+    RunResult result;
+    result.pairs.resize(num_pairs);
+    for (auto& pair : result.pairs) {
+        pair.round_trips_ns.reserve(num_cycles);
+        pair.one_way_ns.reserve(num_cycles);
+    }
+
+    // All leader loops tick together, all follower loops half a period later
+    std::atomic<bool> stop = {false};
+    const auto leader_start = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    const auto follower_start = leader_start + std::chrono::nanoseconds(teleop::kLoopPeriodNs / 2);
+    std::vector<std::thread> threads;
+    size_t loop_index = 0;
+    auto loop_config = [&]() {
+        teleop::RtThreadConfig config;
+        config.priority = priority;
+        config.cpu_core = cpus.empty() ? -1 : cpus[loop_index++ % cpus.size()];
+        config.print_warnings = loop_index == 1;
+        return config;
+    };
+    for (size_t k = 0; k < num_pairs; ++k) {
+        auto& samples = result.pairs[k];
+        const auto leader_config = loop_config();
+        threads.emplace_back([&, k, leader_config]() {
+            teleop::SimRobot robot;
+            teleop::LeaderNode node(robot, *leader_links[k]);
+            const teleop::JointArray home = robot.states().q;
+            uint64_t last_rtt_count = 0;
+            size_t cycle = 0;
+            RunPeriodic(leader_config, leader_start, stop, [&]() {
+                // Emulated operator pushes joints 2 and 4 so the TCP moves up and down
+                const double t = cycle++ * teleop::kLoopPeriod;
+                const double offset
+                    = kOperatorAmplitude * std::sin(2.0 * M_PI * kOperatorFreq * t);
+                teleop::JointArray q_operator = home;
+                q_operator[1] += offset;
+                q_operator[3] -= offset;
+                const auto states = robot.states();
+                teleop::JointArray tau_operator;
+                for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+                    tau_operator[i] = kOperatorStiffness * (q_operator[i] - states.q[i])
+                                      - kOperatorDamping * states.dq[i];
+                }
+                robot.SetExternalJointTorque(tau_operator);
+                node.Step();
+                robot.Step();
+
+                const auto& status = node.status();
+                if (status.round_trip_count != last_rtt_count
+                    && samples.round_trips_ns.size() < samples.round_trips_ns.capacity()) {
+                    samples.round_trips_ns.push_back(status.round_trip_ns);
+                    last_rtt_count = status.round_trip_count;
+                }
+            });
+            samples.leader_step_p99_ns
+                = node.timing().execution().TakeSnapshot()->ValueAtPercentile(99);
+            samples.leader_deadline_misses = node.timing().deadline_miss_count();
+        });
+        const auto follower_config = loop_config();
+        threads.emplace_back([&, k, follower_config]() {
+            teleop::SimRobot robot;
+            teleop::FollowerNode node(robot, *follower_links[k]);
+            uint64_t last_received_count = 0;
+            RunPeriodic(follower_config, follower_start, stop, [&]() {
+                node.Step();
+                robot.Step();
+
+                const auto& status = node.status();
+                if (status.received_count != last_received_count && status.clock_sync.valid
+                    && samples.one_way_ns.size() < samples.one_way_ns.capacity()) {
+                    samples.one_way_ns.push_back(status.one_way_delay_ns);
+                }
+                last_received_count = status.received_count;
+            });
+            samples.step_p99_ns
+                = node.timing().execution().TakeSnapshot()->ValueAtPercentile(99);
+            samples.deadline_misses = node.timing().deadline_miss_count();
+            samples.lost_count = node.status().lost_count;
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(duration));
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    leader_server.Stop();
+    follower_server.Stop();
+
+    if (use_hub) {
+        uint64_t syscalls = 0, datagrams = 0;
+        for (const auto* server : {&leader_server, &follower_server}) {
+            const auto metrics = server->metrics();
+            syscalls += metrics.wakeup_count + metrics.notify_count + metrics.recv_call_count
+                        + metrics.send_call_count + metrics.submit_call_count;
+            datagrams += metrics.received_count + metrics.sent_count;
+        }
+        result.syscalls_per_datagram
+            = datagrams > 0 ? static_cast<double>(syscalls) / datagrams : 0.0;
+    }
+    return result;
+}
+
+/** @brief Parse a comma-separated list of integers */
+std::vector<int> ParseList(const std::string& list)
+{
+    std::vector<int> values;
+    std::stringstream stream(list);
+    for (std::string item; std::getline(stream, item, ',');) {
+        values.push_back(std::stoi(item));
+    }
+    return values;
+}
+
+int main(int argc, char* argv[])
+{
+    // Program Setup
+    // =============================================================================================
+    if (teleop::utility::ProgramArgsExist(argc, argv, {"-h", "--help"})) {
+        PrintHelp();
+        return 1;
+    }
+    const auto pair_counts
+        = ParseList(teleop::utility::ProgramArgValue(argc, argv, "--pairs", "1,2,4,8"));
+    const double duration
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--duration", "5"));
+    const auto port = static_cast<uint16_t>(
+        std::stoi(teleop::utility::ProgramArgValue(argc, argv, "--port", "26300")));
+    const std::string mode = teleop::utility::ProgramArgValue(argc, argv, "--mode", "both");
+    if (mode != "hub" && mode != "direct" && mode != "both") {
+        std::cerr << "Invalid mode: " << mode << std::endl;
+        return 1;
+    }
+    const auto cpus = ParseList(teleop::utility::ProgramArgValue(argc, argv, "--cpus"));
+    const int io_cpu = std::stoi(teleop::utility::ProgramArgValue(argc, argv, "--io-cpu", "-1"));
+    const int priority
+        = std::stoi(teleop::utility::ProgramArgValue(argc, argv, "--priority", "80"));
+    const auto backend = teleop::utility::ProgramArgsExist(argc, argv, {"--io-uring"})
+                             ? teleop::IoBackend::kIoUring
+                             : teleop::IoBackend::kEpoll;
+    std::vector<bool> modes;
+    if (mode != "direct") {
+        modes.push_back(true);
+    }
+    if (mode != "hub") {
+        modes.push_back(false);
+    }
+
+    // Benchmark
+    // =============================================================================================
+    std::cout << "Per-pair delays and Step() execution times [us], over all pairs and for the "
+                 "worst pair"
+              << std::endl;
+    std::cout << std::setw(8) << "mode" << std::setw(7) << "pairs" << std::setw(13)
+              << "one-way p50" << std::setw(9) << "p99" << std::setw(9) << "max" << std::setw(12)
+              << "worst p99" << std::setw(10) << "rtt p99" << std::setw(11) << "step p99"
+              << std::setw(8) << "misses" << std::setw(6) << "lost" << std::setw(16)
+              << "syscalls/dgram" << std::endl;
+    try {
+        for (int num_pairs : pair_counts) {
+            for (bool use_hub : modes) {
+                auto result = Run(static_cast<size_t>(num_pairs), use_hub, duration, port, cpus,
+                    io_cpu, priority, backend);
+                std::vector<int64_t> round_trips_ns, one_way_ns;
+                double worst_p99 = 0.0;
+                uint64_t step_p99_ns = 0, misses = 0, lost = 0;
+                for (auto& pair : result.pairs) {
+                    std::sort(pair.one_way_ns.begin(), pair.one_way_ns.end());
+                    worst_p99 = std::max(worst_p99, PercentileUs(pair.one_way_ns, 99));
+                    round_trips_ns.insert(round_trips_ns.end(), pair.round_trips_ns.begin(),
+                        pair.round_trips_ns.end());
+                    one_way_ns.insert(
+                        one_way_ns.end(), pair.one_way_ns.begin(), pair.one_way_ns.end());
+                    step_p99_ns
+                        = std::max({step_p99_ns, pair.step_p99_ns, pair.leader_step_p99_ns});
+                    misses += pair.deadline_misses + pair.leader_deadline_misses;
+                    lost += pair.lost_count;
+                }
+                std::sort(round_trips_ns.begin(), round_trips_ns.end());
+                std::sort(one_way_ns.begin(), one_way_ns.end());
+                std::cout << std::fixed << std::setprecision(1) << std::setw(8)
+                          << (use_hub ? "hub" : "direct") << std::setw(7) << num_pairs
+                          << std::setw(13) << PercentileUs(one_way_ns, 50) << std::setw(9)
+                          << PercentileUs(one_way_ns, 99) << std::setw(9)
+                          << PercentileUs(one_way_ns, 100) << std::setw(12) << worst_p99
+                          << std::setw(10) << PercentileUs(round_trips_ns, 99) << std::setw(11)
+                          << step_p99_ns / 1000.0 << std::setw(8) << misses << std::setw(6)
+                          << lost << std::setw(16) << std::setprecision(2);
+                if (use_hub) {
+                    std::cout << result.syscalls_per_datagram << std::endl;
+                } else {
+                    std::cout << "-" << std::endl;
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
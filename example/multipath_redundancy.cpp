@@ -0,0 +1,315 @@
+/**
+ * @example multipath_redundancy.cpp
+ * Compare the one-way latency of state packets sent over one of two emulated network paths with
+ * sending them over both and keeping the first copy to arrive. Each path is a pair of localhost
+ * UDP sockets whose receiving end delays every datagram by a sample of the path's delay
+ * distribution: a wired path with a low, steady delay that now and then stalls for tens to
+ * hundreds of milliseconds, as behind a congested switch or a Wi-Fi bridge retrying, and an LTE
+ * path with a higher, jittery delay, some loss and occasional handover outages. A sender thread
+ * sends one packet per control cycle, a busy-polling receiver thread measures the delay of each
+ * packet delivered, and the latency percentiles and losses of the three setups are reported.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ * @author Flexiv
+ */
+
+#include <flexiv/omni/teleop/clock.hpp>
+#include <flexiv/omni/teleop/multipath.hpp>
+#include <flexiv/omni/teleop/udp_transport.hpp>
+#include <flexiv/omni/teleop/utility.hpp>
+#include <flexiv/omni/teleop/wire_format.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+/**
+ * Delay distribution of one emulated path: a base delay plus exponential jitter, independent
+ * loss, and episodes that start at random: stalls, during which datagrams queue up until the
+ * stall ends, and outages, during which they are lost.
+ */
+struct PathModel
+{
+    std::string name;
+    double base_delay_ms = 0.0;
+    double mean_jitter_ms = 0.0;
+    double loss_ratio = 0.0;
+
+    /** Mean time between stalls, and the range of their durations [s] [ms] */
+    double mean_stall_interval_s = 0.0;
+    double min_stall_ms = 0.0;
+    double max_stall_ms = 0.0;
+
+    /** Mean time between outages, and their duration [s] [ms] */
+    double mean_outage_interval_s = 0.0;
+    double outage_ms = 0.0;
+};
+
+/** Receiving end of an emulated path: holds each datagram back until its sampled delay passed */
+class DelayedPath : public teleop::Transport
+{
+public:
+    DelayedPath(teleop::Transport& transport, const PathModel& model, uint32_t seed)
+    : transport_(transport)
+    , model_(model)
+    , rng_(seed)
+    {
+        held_.reserve(kCapacity);
+    }
+
+    bool Send(const void* data, size_t size) override { return transport_.Send(data, size); }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        const int64_t now = teleop::SteadyTimeNs();
+        Held incoming;
+        size_t size;
+        while (held_.size() < kCapacity
+               && (size = transport_.Receive(incoming.data.data(), incoming.data.size())) > 0) {
+            incoming.size = size;
+            if (Admit(now, incoming.release_ns)) {
+                held_.push_back(incoming);
+            }
+        }
+        auto due = std::min_element(held_.begin(), held_.end(),
+            [](const Held& a, const Held& b) { return a.release_ns < b.release_ns; });
+        if (due == held_.end() || due->release_ns > now || due->size > capacity) {
+            return 0;
+        }
+        std::memcpy(buffer, due->data.data(), due->size);
+        size = due->size;
+        *due = held_.back();
+        held_.pop_back();
+        return size;
+    }
+
+private:
+    static constexpr size_t kCapacity = 2048;
+
+    struct Held
+    {
+        int64_t release_ns = 0;
+        size_t size = 0;
+        std::array<uint8_t, teleop::kMaxMessageSize> data;
+    };
+
+    /** Sample what happens to a datagram arriving now, false if it is lost */
+    bool Admit(int64_t now, int64_t& release_ns)
+    {
+        if (next_stall_ns_ == 0) {
+            next_stall_ns_ = now + Interval(model_.mean_stall_interval_s);
+            next_outage_ns_ = now + Interval(model_.mean_outage_interval_s);
+        }
+        if (now >= next_stall_ns_) {
+            const double stall_ms = std::uniform_real_distribution<double>(
+                model_.min_stall_ms, model_.max_stall_ms)(rng_);
+            stall_end_ns_ = now + static_cast<int64_t>(stall_ms * 1e6);
+            next_stall_ns_ = stall_end_ns_ + Interval(model_.mean_stall_interval_s);
+        }
+        if (now >= next_outage_ns_) {
+            outage_end_ns_ = now + static_cast<int64_t>(model_.outage_ms * 1e6);
+            next_outage_ns_ = outage_end_ns_ + Interval(model_.mean_outage_interval_s);
+        }
+        if (now < outage_end_ns_ || uniform_(rng_) < model_.loss_ratio) {
+            return false;
+        }
+        double delay_ms = model_.base_delay_ms;
+        if (model_.mean_jitter_ms > 0.0) {
+            delay_ms += std::exponential_distribution<double>(1.0 / model_.mean_jitter_ms)(rng_);
+        }
+        release_ns = std::max(now + static_cast<int64_t>(delay_ms * 1e6),
+            now < stall_end_ns_ ? stall_end_ns_ : int64_t {0});
+        return true;
+    }
+
+    /** Exponentially distributed time to the next episode, never if the mean is 0 [ns] */
+    int64_t Interval(double mean_s)
+    {
+        if (mean_s <= 0.0) {
+            return INT64_MAX / 2;
+        }
+        std::exponential_distribution<double> interval(1.0 / mean_s);
+        return static_cast<int64_t>(interval(rng_) * 1e9);
+    }
+
+    teleop::Transport& transport_;
+    PathModel model_;
+    std::mt19937 rng_;
+    std::uniform_real_distribution<double> uniform_ {0.0, 1.0};
+    std::vector<Held> held_;
+    int64_t next_stall_ns_ = 0;
+    int64_t stall_end_ns_ = 0;
+    int64_t next_outage_ns_ = 0;
+    int64_t outage_end_ns_ = 0;
+};
+
+/** Outcome of one run */
+struct RunResult
+{
+    std::vector<int64_t> delays_ns;
+    uint64_t sent_count = 0;
+    teleop::MultipathStats stats;
+};
+
+/** @brief Stream packets for a while over the chosen paths and measure their one-way delays */
+RunResult Run(const std::vector<PathModel>& models, const std::vector<size_t>& used,
+    double duration, uint16_t port)
+{
+    // One socket pair per path, the receiving sockets delay what they receive
+    std::vector<std::unique_ptr<teleop::UdpTransport>> senders, receivers;
+    std::vector<std::unique_ptr<DelayedPath>> delayed;
+    std::vector<teleop::Transport*> send_paths, receive_paths;
+    for (size_t i : used) {
+        const auto base = static_cast<uint16_t>(port + 2 * i);
+        senders.push_back(std::make_unique<teleop::UdpTransport>(base, "127.0.0.1", base + 1));
+        receivers.push_back(std::make_unique<teleop::UdpTransport>(base + 1, "127.0.0.1", base));
+        delayed.push_back(std::make_unique<DelayedPath>(*receivers.back(), models[i], 7 + i));
+        send_paths.push_back(senders.back().get());
+        receive_paths.push_back(delayed.back().get());
+    }
+    teleop::MultipathTransport sender(send_paths);
+    teleop::MultipathTransport receiver(receive_paths);
+
+    RunResult result;
+    const auto num_packets = static_cast<size_t>(duration / teleop::kLoopPeriod);
+    result.delays_ns.reserve(num_packets);
+    std::atomic<bool> sending {true};
+    std::thread send_thread([&]() {
+        teleop::StatePacket packet;
+        packet.header.type = teleop::MessageType::kLeaderState;
+        auto next = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < num_packets; ++i) {
+            packet.header.sequence = i + 1;
+            packet.header.send_time_ns = teleop::SteadyTimeNs();
+            sender.Send(&packet, sizeof(packet));
+            next += std::chrono::nanoseconds(teleop::kLoopPeriodNs);
+            std::this_thread::sleep_until(next);
+        }
+        result.sent_count = num_packets;
+        sending = false;
+    });
+
+    // Busy-poll so that the measured delay is the path's, not the polling period's; keep polling
+    // after the last packet for as long as the slowest path may still deliver
+    const bool single_core = std::thread::hardware_concurrency() < 2;
+    teleop::StatePacket packet;
+    int64_t drain_end_ns = INT64_MAX;
+    while (teleop::SteadyTimeNs() < drain_end_ns) {
+        if (!sending && drain_end_ns == INT64_MAX) {
+            drain_end_ns = teleop::SteadyTimeNs() + 1000000000;
+        }
+        if (receiver.Receive(&packet, sizeof(packet)) == sizeof(packet)) {
+            result.delays_ns.push_back(teleop::SteadyTimeNs() - packet.header.send_time_ns);
+        } else if (single_core) {
+            std::this_thread::yield();
+        }
+    }
+    send_thread.join();
+    result.stats = receiver.stats();
+    return result;
+}
+
+/** Value at a percentile of sorted samples, in [ms] */
+double PercentileMs(const std::vector<int64_t>& sorted_ns, double percentile)
+{
+    if (sorted_ns.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(sorted_ns.size() - 1,
+        static_cast<size_t>(std::ceil(percentile / 100.0 * sorted_ns.size())) - 1);
+    return sorted_ns[index] / 1e6;
+}
+}
+
+/** @brief Print program usage help */
+void PrintHelp()
+{
+    // clang-format off
+    std::cout << "Optional arguments: [--duration <seconds>] [--port <port>]" << std::endl;
+    std::cout << "    --duration  Seconds of streaming per setup, default 20" << std::endl;
+    std::cout << "    --port      First of the localhost UDP ports, four are used, default 27600" << std::endl;
+    std::cout << std::endl;
+    // clang-format on
+}
+
+int main(int argc, char* argv[])
+{
+    // Program Setup
+    // =============================================================================================
+    if (teleop::utility::ProgramArgsExist(argc, argv, {"-h", "--help"})) {
+        PrintHelp();
+        return 1;
+    }
+    const double duration
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--duration", "20"));
+    const auto port = static_cast<uint16_t>(
+        std::stoi(teleop::utility::ProgramArgValue(argc, argv, "--port", "27600")));
+
+    PathModel wired;
+    wired.name = "wired";
+    wired.base_delay_ms = 2.0;
+    wired.mean_jitter_ms = 0.2;
+    wired.mean_stall_interval_s = 3.0;
+    wired.min_stall_ms = 50.0;
+    wired.max_stall_ms = 250.0;
+    PathModel lte;
+    lte.name = "lte";
+    lte.base_delay_ms = 12.0;
+    lte.mean_jitter_ms = 4.0;
+    lte.loss_ratio = 0.01;
+    lte.mean_outage_interval_s = 8.0;
+    lte.outage_ms = 150.0;
+    const std::vector<PathModel> models = {wired, lte};
+
+    // Streams
+    // =============================================================================================
+    std::cout << "One-way delay of one state packet per " << teleop::kLoopPeriodNs / 1000
+              << " us over " << duration << " s per setup" << std::endl;
+    std::cout << std::setw(13) << "paths" << std::setw(10) << "p50[ms]" << std::setw(10)
+              << "p99[ms]" << std::setw(11) << "p99.9[ms]" << std::setw(10) << "max[ms]"
+              << std::setw(10) << "loss[%]" << std::setw(12) << "duplicates"
+              << "  first arrivals per path" << std::endl;
+    std::vector<double> p99_ms;
+    for (const auto& used : {std::vector<size_t> {0}, std::vector<size_t> {1},
+             std::vector<size_t> {0, 1}}) {
+        auto result = Run(models, used, duration, port);
+        auto& samples = result.delays_ns;
+        std::sort(samples.begin(), samples.end());
+        std::string name;
+        for (size_t i : used) {
+            name += (name.empty() ? "" : "+") + models[i].name;
+        }
+        const double loss = 100.0 * (1.0 - static_cast<double>(samples.size())
+                                               / std::max<uint64_t>(result.sent_count, 1));
+        std::cout << std::fixed << std::setprecision(2) << std::setw(13) << name << std::setw(10)
+                  << PercentileMs(samples, 50) << std::setw(10) << PercentileMs(samples, 99)
+                  << std::setw(11) << PercentileMs(samples, 99.9) << std::setw(10)
+                  << (samples.empty() ? 0.0 : samples.back() / 1e6) << std::setw(10) << loss
+                  << std::setw(12) << result.stats.duplicate_count << " ";
+        for (size_t n = 0; n < used.size(); ++n) {
+            std::cout << " " << models[used[n]].name << " " << result.stats.paths[n].first_count;
+        }
+        std::cout << std::endl;
+        p99_ms.push_back(PercentileMs(samples, 99));
+    }
+
+    // Redundancy must beat each path on its own
+    if (p99_ms[2] >= std::min(p99_ms[0], p99_ms[1])) {
+        std::cerr << "Sending over both paths did not lower the p99 delay" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,188 @@
+/**
+ * @example session_reader.cpp
+ * Inspect a session log written by SessionRecorder: print a summary of the recording, i.e. its
+ * duration, cycle timing, packet loss and one-way delay variation, and optionally export all
+ * records to CSV for analysis in other tools.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ * @author Flexiv
+ */
+
+#include <flexiv/omni/teleop/session_log.hpp>
+#include <flexiv/omni/teleop/utility.hpp>
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using namespace flexiv::omni;
+
+/** @brief Print program usage help */
+void PrintHelp()
+{
+    // clang-format off
+    std::cout << "Required arguments: [log_file]" << std::endl;
+    std::cout << "    log_file: Session log written by SessionRecorder" << std::endl;
+    std::cout << "Optional arguments: [--csv <file>]" << std::endl;
+    std::cout << "    --csv    Export all records to a CSV file" << std::endl;
+    std::cout << std::endl;
+    // clang-format on
+}
+
+/** @brief Print p50/p99/max of a set of durations given in [ns] */
+void PrintPercentiles(const std::string& name, std::vector<int64_t>& samples_ns)
+{
+    if (samples_ns.empty()) {
+        return;
+    }
+    std::sort(samples_ns.begin(), samples_ns.end());
+    auto percentile_us = [&](double p) {
+        return samples_ns[std::min(samples_ns.size() - 1,
+                   static_cast<size_t>(p / 100.0 * samples_ns.size()))]
+               / 1000.0;
+    };
+    std::cout << std::fixed << std::setprecision(1) << "  " << name << " [us]: p50 = "
+              << percentile_us(50) << ", p99 = " << percentile_us(99)
+              << ", max = " << samples_ns.back() / 1000.0 << std::endl;
+}
+
+/** @brief Write the CSV column names of one array field */
+template <size_t N>
+void WriteColumns(std::ostream& out, const std::string& name, const std::array<double, N>&)
+{
+    for (size_t i = 0; i < N; ++i) {
+        out << "," << name << i;
+    }
+}
+
+/** @brief Write the values of one array field */
+template <size_t N>
+void WriteValues(std::ostream& out, const std::array<double, N>& values)
+{
+    for (double v : values) {
+        out << "," << v;
+    }
+}
+
+/** @brief Export all records to CSV, one line per record */
+void ExportCsv(teleop::SessionReader& reader, const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+    teleop::SessionRecord record;
+    out << "time_ns,kind,sequence,send_time_ns,echo_time_ns,echo_receive_time_ns";
+    WriteColumns(out, "q", record.packet.q);
+    WriteColumns(out, "dq", record.packet.dq);
+    WriteColumns(out, "tau_ext", record.packet.tau_ext);
+    WriteColumns(out, "tcp_pose", record.packet.tcp_pose);
+    WriteColumns(out, "ext_wrench", record.packet.ext_wrench);
+    WriteColumns(out, "cmd_q", record.command.q);
+    WriteColumns(out, "cmd_dq", record.command.dq);
+    WriteColumns(out, "cmd_tau", record.command.tau);
+    out << std::endl;
+
+    out << std::setprecision(std::numeric_limits<double>::max_digits10);
+    reader.Rewind();
+    while (reader.Next(record)) {
+        const auto& header = record.packet.header;
+        out << record.time_ns << ","
+            << (record.kind == teleop::RecordKind::kCycle ? "cycle" : "received") << ","
+            << header.sequence << "," << header.send_time_ns << "," << header.echo_time_ns << ","
+            << header.echo_receive_time_ns;
+        WriteValues(out, record.packet.q);
+        WriteValues(out, record.packet.dq);
+        WriteValues(out, record.packet.tau_ext);
+        WriteValues(out, record.packet.tcp_pose);
+        WriteValues(out, record.packet.ext_wrench);
+        WriteValues(out, record.command.q);
+        WriteValues(out, record.command.dq);
+        WriteValues(out, record.command.tau);
+        out << "\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Program Setup
+    // =============================================================================================
+    if (argc < 2 || teleop::utility::ProgramArgsExist(argc, argv, {"-h", "--help"})) {
+        PrintHelp();
+        return 1;
+    }
+    const std::string log_path = argv[1];
+    const std::string csv_path = teleop::utility::ProgramArgValue(argc, argv, "--csv");
+
+    try {
+        teleop::SessionReader reader(log_path);
+        const auto& file_header = reader.header();
+
+        // Summary
+        // =========================================================================================
+        uint64_t cycle_count = 0, received_count = 0, lost_count = 0;
+        int64_t first_time = 0, last_time = 0, last_cycle_time = 0;
+        uint64_t newest_sequence = 0;
+        int64_t min_transit = std::numeric_limits<int64_t>::max();
+        std::vector<int64_t> periods_ns, transits_ns;
+        teleop::SessionRecord record;
+        while (reader.Next(record)) {
+            if (cycle_count + received_count == 0) {
+                first_time = record.time_ns;
+            }
+            last_time = record.time_ns;
+            if (record.kind == teleop::RecordKind::kCycle) {
+                if (cycle_count++ > 0) {
+                    periods_ns.push_back(record.time_ns - last_cycle_time);
+                }
+                last_cycle_time = record.time_ns;
+            } else if (record.kind == teleop::RecordKind::kReceived) {
+                ++received_count;
+                // Transit includes the offset between the two clocks, only its variation counts
+                const int64_t transit = record.time_ns - record.packet.header.send_time_ns;
+                transits_ns.push_back(transit);
+                min_transit = std::min(min_transit, transit);
+                const uint64_t sequence = record.packet.header.sequence;
+                if (sequence > newest_sequence) {
+                    if (newest_sequence != 0) {
+                        lost_count += sequence - newest_sequence - 1;
+                    }
+                    newest_sequence = sequence;
+                }
+            }
+        }
+        for (auto& transit : transits_ns) {
+            transit -= min_transit;
+        }
+
+        const std::time_t start_time
+            = static_cast<std::time_t>(file_header.start_system_ns / 1000000000);
+        std::cout << "Session log of the "
+                  << (file_header.node == teleop::MessageType::kLeaderState ? "leader"
+                                                                            : "follower")
+                  << " node, started " << std::put_time(std::localtime(&start_time), "%F %T")
+                  << std::endl;
+        std::cout << "  duration: " << std::fixed << std::setprecision(3)
+                  << (last_time - first_time) * 1e-9 << " s" << std::endl;
+        std::cout << "  cycles: " << cycle_count << ", records dropped by the recorder: "
+                  << file_header.dropped_count << std::endl;
+        std::cout << "  received: " << received_count << " packets, " << lost_count
+                  << " skipped in sequence (lost or reordered)" << std::endl;
+        PrintPercentiles("cycle period", periods_ns);
+        PrintPercentiles("one-way delay above minimum", transits_ns);
+
+        if (!csv_path.empty()) {
+            ExportCsv(reader, csv_path);
+            std::cout << "Exported " << cycle_count + received_count << " records to " << csv_path
+                      << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * @example session_replay.cpp
+ * Replay a session recorded by a follower node through the follower pipeline against a simulated
+ * arm, faster than real time and deterministically. Replaying with the same pipeline settings as
+ * the recording reproduces the recorded commands exactly; replaying with different settings, e.g.
+ * with the jitter buffer enabled, shows how a change would have behaved on that session. Suitable
+ * for CI: the replay is run twice to check that it is deterministic, and the exit code reports
+ * whether the commands diverged from the recording by more than a given bound. Optionally reports
+ * how accurately the follower's motion predictor forecasts the recorded leader motion over a
+ * range of horizons.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ * @author Flexiv
+ */
+
+#include <flexiv/omni/teleop/session_replay.hpp>
+#include <flexiv/omni/teleop/utility.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace flexiv::omni;
+
+/** @brief Print program usage help */
+void PrintHelp()
+{
+    // clang-format off
+    std::cout << "Required arguments: [log_file]" << std::endl;
+    std::cout << "    log_file: Session log recorded by a follower node" << std::endl;
+    std::cout << "Optional arguments: [--jitter-buffer] [--cartesian] [--prediction] [--max-divergence <rad>]" << std::endl;
+    std::cout << "                    [--prediction-report] [--horizons-ms <list>]" << std::endl;
+    std::cout << "    --jitter-buffer      Replay with the follower's jitter buffer enabled" << std::endl;
+    std::cout << "    --cartesian          Replay with the follower tracking the leader's TCP pose through IK" << std::endl;
+    std::cout << "    --prediction         Replay with the follower forecasting the leader's motion" << std::endl;
+    std::cout << "    --max-divergence     Fail if replayed targets differ from recorded ones by more than this" << std::endl;
+    std::cout << "    --prediction-report  Print the motion predictor's error versus forecast horizon" << std::endl;
+    std::cout << "    --horizons-ms        Comma-separated horizons to report, default 0,10,20,40,60,100,150,200" << std::endl;
+    std::cout << std::endl;
+    // clang-format on
+}
+
+int main(int argc, char* argv[])
+{
+    // Program Setup
+    // =============================================================================================
+    if (argc < 2 || teleop::utility::ProgramArgsExist(argc, argv, {"-h", "--help"})) {
+        PrintHelp();
+        return 1;
+    }
+    const std::string log_path = argv[1];
+    teleop::SessionReplayParams params;
+    params.follower.use_jitter_buffer
+        = teleop::utility::ProgramArgsExist(argc, argv, {"--jitter-buffer"});
+    params.follower.use_cartesian_target
+        = teleop::utility::ProgramArgsExist(argc, argv, {"--cartesian"});
+    params.follower.use_prediction
+        = teleop::utility::ProgramArgsExist(argc, argv, {"--prediction"});
+    const std::string max_divergence
+        = teleop::utility::ProgramArgValue(argc, argv, "--max-divergence");
+    const bool prediction_report
+        = teleop::utility::ProgramArgsExist(argc, argv, {"--prediction-report"});
+    std::vector<int64_t> horizons_ns;
+    std::stringstream horizon_list(teleop::utility::ProgramArgValue(
+        argc, argv, "--horizons-ms", "0,10,20,40,60,100,150,200"));
+    for (std::string item; std::getline(horizon_list, item, ',');) {
+        horizons_ns.push_back(static_cast<int64_t>(std::stod(item) * 1e6));
+    }
+
+    try {
+        // Replay
+        // =========================================================================================
+        teleop::SessionReplay replay(log_path, params);
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = replay.Run();
+        const double elapsed
+            = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const auto repeated = replay.Run();
+
+        std::cout << "Replayed " << result.cycle_count << " cycles (" << std::fixed
+                  << std::setprecision(1) << result.recorded_duration << " s recorded) in "
+                  << std::setprecision(3) << elapsed << " s, "
+                  << std::setprecision(0) << result.recorded_duration / elapsed
+                  << "x real time" << std::endl;
+        std::cout << "Follower received " << result.status.received_count << " packets, discarded "
+                  << result.status.stale_count << " stale, " << result.status.lost_count
+                  << " lost, commanded " << result.status.commanded_count << " cycles"
+                  << std::endl;
+        std::cout << std::setprecision(3) << "Divergence from recorded targets [mrad]: max = "
+                  << result.divergence_max * 1e3 << ", rms = " << result.divergence_rms * 1e3
+                  << std::endl;
+        std::cout << "Simulated tracking error [mrad]: max = " << result.tracking_error_max * 1e3
+                  << ", rms = " << result.tracking_error_rms * 1e3 << std::endl;
+        if (params.follower.use_prediction) {
+            std::cout << "Latest forecast: horizon = "
+                      << result.status.prediction_horizon_ns * 1e-6
+                      << " ms, confidence = " << result.status.prediction_confidence << std::endl;
+        }
+        std::cout << "Command hash: " << std::hex << result.command_hash << std::dec << std::endl;
+
+        // Prediction report
+        // =========================================================================================
+        if (prediction_report) {
+            std::cout << std::endl
+                      << "Error versus forecast horizon, largest over joints [mrad]" << std::endl;
+            std::cout << std::setw(12) << "horizon[ms]" << std::setw(10) << "samples"
+                      << std::setw(11) << "hold rms" << std::setw(10) << "max"
+                      << std::setw(15) << "forecast rms" << std::setw(10) << "max"
+                      << std::setw(14) << "blended rms" << std::setw(10) << "max"
+                      << std::setw(13) << "confidence" << std::endl;
+            for (const auto& error : replay.EvaluatePrediction(horizons_ns)) {
+                std::cout << std::setprecision(0) << std::setw(12) << error.horizon_ns * 1e-6
+                          << std::setw(10) << error.sample_count << std::setprecision(3)
+                          << std::setw(11) << error.hold_rms * 1e3 << std::setw(10)
+                          << error.hold_max * 1e3 << std::setw(15) << error.forecast_rms * 1e3
+                          << std::setw(10) << error.forecast_max * 1e3 << std::setw(14)
+                          << error.blended_rms * 1e3 << std::setw(10) << error.blended_max * 1e3
+                          << std::setw(13) << error.mean_confidence << std::endl;
+            }
+        }
+
+        // Checks
+        // =========================================================================================
+        if (repeated.command_hash != result.command_hash) {
+            std::cerr << "Replay is not deterministic: second run produced different commands"
+                      << std::endl;
+            return 1;
+        }
+        if (!max_divergence.empty() && result.divergence_max > std::stod(max_divergence)) {
+            std::cerr << "Replayed targets diverged from the recording by more than "
+                      << max_divergence << " rad" << std::endl;
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
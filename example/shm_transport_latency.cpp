@@ -0,0 +1,384 @@
+/**
+ * @example shm_transport_latency.cpp
+ * Benchmark the shared-memory transport against loopback UDP for leader and follower processes
+ * on the same host. A child process echoes every message straight back, the parent measures the
+ * round-trip time of each state-packet-sized message, and both sides measure the CPU time they
+ * spend per round trip. Each transport runs with the receiver busy-polling, as in the control
+ * loops, and with the receiver sleeping until a message arrives, poll() for UDP and the futex in
+ * the segment for shared memory, which shows the cost of the wakeup itself. Finally the echoing
+ * process crashes with messages left unread in both directions and a new one opens the segment,
+ * which must take over and exchange only fresh messages.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ * @author Flexiv
+ */
+
+#include <flexiv/omni/teleop/clock.hpp>
+#include <flexiv/omni/teleop/shm_transport.hpp>
+#include <flexiv/omni/teleop/udp_transport.hpp>
+#include <flexiv/omni/teleop/utility.hpp>
+#include <flexiv/omni/teleop/wire_format.hpp>
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+/** Longest wait for one echo before the run is given up [ns] */
+constexpr int64_t kEchoTimeoutNs = 1000000000;
+
+/** Message that ends the echo loop */
+constexpr uint8_t kStopMessage = 0xFF;
+
+enum class Kind
+{
+    kUdp,
+    kShm,
+};
+
+/** One side of a run: its transport and how it waits for a message */
+struct Endpoint
+{
+    std::unique_ptr<teleop::Transport> transport;
+    Kind kind = Kind::kUdp;
+    bool sleep = false;
+
+    /** Give the peer the CPU between polls, busy-polling with a single core only burns it */
+    bool yield = false;
+
+    /** Wait up to timeout_ns for a message, then receive it; 0 on timeout */
+    size_t Receive(void* buffer, size_t capacity, int64_t timeout_ns)
+    {
+        const int64_t deadline = teleop::SteadyTimeNs() + timeout_ns;
+        while (true) {
+            const size_t size = transport->Receive(buffer, capacity);
+            const int64_t remaining = deadline - teleop::SteadyTimeNs();
+            if (size > 0 || remaining <= 0) {
+                return size;
+            }
+            if (!sleep) {
+                if (yield) {
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+            if (kind == Kind::kShm) {
+                static_cast<teleop::ShmTransport&>(*transport).WaitReadable(remaining);
+            } else {
+                pollfd fd {static_cast<teleop::UdpTransport&>(*transport).fd(), POLLIN, 0};
+                ::poll(&fd, 1, static_cast<int>(remaining / 1000000) + 1);
+            }
+        }
+    }
+};
+
+int64_t CpuTimeNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+/** Outcome of one run */
+struct RunResult
+{
+    std::vector<int64_t> round_trips_ns;
+    double parent_cpu_us = 0.0;
+    double child_cpu_us = 0.0;
+};
+
+/** Echo every message back until the stop message, then report the CPU time spent */
+[[noreturn]] void RunEcho(Endpoint endpoint, int report_fd)
+{
+    std::array<uint8_t, teleop::kMaxMessageSize> buffer;
+    int64_t cpu_start = -1;
+    while (true) {
+        const size_t size = endpoint.Receive(buffer.data(), buffer.size(), 10 * kEchoTimeoutNs);
+        if (size == 0 || (size == 1 && buffer[0] == kStopMessage)) {
+            break;
+        }
+        if (cpu_start < 0) {
+            cpu_start = CpuTimeNs();
+        }
+        endpoint.transport->Send(buffer.data(), size);
+    }
+    const int64_t cpu_ns = cpu_start < 0 ? 0 : CpuTimeNs() - cpu_start;
+    [[maybe_unused]] const auto written = ::write(report_fd, &cpu_ns, sizeof(cpu_ns));
+    // Skip destructors, the parent owns the shared-memory segment
+    ::_exit(0);
+}
+
+/** @brief Measure round trips through one transport to an echoing child process */
+RunResult Run(Kind kind, bool sleep, size_t num_messages, uint16_t port)
+{
+    const std::string shm_name = "/flexiv_teleop_latency_" + std::to_string(::getpid());
+    const bool single_core = std::thread::hardware_concurrency() < 2;
+    Endpoint endpoint;
+    endpoint.kind = kind;
+    endpoint.sleep = sleep;
+    endpoint.yield = single_core;
+    if (kind == Kind::kShm) {
+        endpoint.transport = teleop::ShmTransport::Create(shm_name);
+    } else {
+        endpoint.transport
+            = std::make_unique<teleop::UdpTransport>(port, "127.0.0.1", port + 1);
+    }
+
+    int report[2];
+    if (::pipe(report) < 0) {
+        throw std::runtime_error("Failed to create pipe");
+    }
+    const pid_t child = ::fork();
+    if (child < 0) {
+        throw std::runtime_error("Failed to fork");
+    }
+    if (child == 0) {
+        ::close(report[0]);
+        Endpoint echo;
+        echo.kind = kind;
+        echo.sleep = sleep;
+        echo.yield = single_core;
+        if (kind == Kind::kShm) {
+            echo.transport = teleop::ShmTransport::Open(shm_name);
+        } else {
+            echo.transport
+                = std::make_unique<teleop::UdpTransport>(port + 1, "127.0.0.1", port);
+        }
+        RunEcho(std::move(echo), report[1]);
+    }
+    ::close(report[1]);
+
+    // Ping until the child answers, its endpoint may not be up yet
+    teleop::StatePacket packet;
+    std::array<uint8_t, teleop::kMaxMessageSize> buffer;
+    bool connected = false;
+    for (int attempt = 0; attempt < 500 && !connected; ++attempt) {
+        endpoint.transport->Send(&packet, sizeof(packet));
+        connected = endpoint.Receive(buffer.data(), buffer.size(), 10000000) > 0;
+    }
+    // Drain late answers to the pings
+    while (endpoint.Receive(buffer.data(), buffer.size(), 10000000) > 0) {
+    }
+
+    RunResult result;
+    result.round_trips_ns.reserve(num_messages);
+    const int64_t cpu_start = CpuTimeNs();
+    for (size_t i = 0; connected && i < num_messages; ++i) {
+        packet.header.sequence = i + 1;
+        const int64_t start = teleop::SteadyTimeNs();
+        endpoint.transport->Send(&packet, sizeof(packet));
+        if (endpoint.Receive(buffer.data(), buffer.size(), kEchoTimeoutNs) == 0) {
+            std::cerr << "Echo timed out" << std::endl;
+            break;
+        }
+        result.round_trips_ns.push_back(teleop::SteadyTimeNs() - start);
+    }
+    const double round_trips = std::max<double>(result.round_trips_ns.size(), 1.0);
+    result.parent_cpu_us = (CpuTimeNs() - cpu_start) / 1000.0 / round_trips;
+
+    endpoint.transport->Send(&kStopMessage, 1);
+    int64_t child_cpu_ns = 0;
+    if (::read(report[0], &child_cpu_ns, sizeof(child_cpu_ns)) != sizeof(child_cpu_ns)) {
+        child_cpu_ns = 0;
+    }
+    ::close(report[0]);
+    ::waitpid(child, nullptr, 0);
+    result.child_cpu_us = child_cpu_ns / 1000.0 / round_trips;
+    return result;
+}
+
+/** Outcome of reopening a segment */
+struct ReopenResult
+{
+    /** Round trips whose echo was not the message just sent, e.g. a stale one */
+    size_t mismatches = 0;
+
+    /** Whether a second opening side was refused while the reopening one was attached */
+    bool second_refused = false;
+};
+
+/**
+ * @brief Let an opening process crash with messages unread in both directions, then open the
+ * segment again from a new echoing process.
+ */
+ReopenResult RunReopen(size_t num_messages)
+{
+    const std::string shm_name = "/flexiv_teleop_reopen_" + std::to_string(::getpid());
+    Endpoint endpoint;
+    endpoint.kind = Kind::kShm;
+    endpoint.yield = std::thread::hardware_concurrency() < 2;
+    endpoint.transport = teleop::ShmTransport::Create(shm_name);
+    teleop::StatePacket packet;
+
+    // The first peer sends messages nobody receives and exits without closing its transport
+    const pid_t crashed = ::fork();
+    if (crashed < 0) {
+        throw std::runtime_error("Failed to fork");
+    }
+    if (crashed == 0) {
+        auto transport = teleop::ShmTransport::Open(shm_name);
+        for (uint64_t s = 1; s <= 10; ++s) {
+            packet.header.sequence = s;
+            transport->Send(&packet, sizeof(packet));
+        }
+        ::_exit(0);
+    }
+    ::waitpid(crashed, nullptr, 0);
+    // Messages for the crashed peer the next one must not receive
+    for (uint64_t s = 11; s <= 20; ++s) {
+        packet.header.sequence = s;
+        endpoint.transport->Send(&packet, sizeof(packet));
+    }
+
+    int attached[2];
+    if (::pipe(attached) < 0) {
+        throw std::runtime_error("Failed to create pipe");
+    }
+    const pid_t child = ::fork();
+    if (child < 0) {
+        throw std::runtime_error("Failed to fork");
+    }
+    if (child == 0) {
+        ::close(attached[0]);
+        Endpoint echo;
+        echo.kind = Kind::kShm;
+        echo.yield = endpoint.yield;
+        echo.transport = teleop::ShmTransport::Open(shm_name);
+        const uint8_t ready = 1;
+        [[maybe_unused]] const auto written = ::write(attached[1], &ready, sizeof(ready));
+        RunEcho(std::move(echo), attached[1]);
+    }
+    ::close(attached[1]);
+    uint8_t ready = 0;
+    if (::read(attached[0], &ready, sizeof(ready)) != sizeof(ready)) {
+        throw std::runtime_error("Reopening process failed to attach");
+    }
+
+    // The segment is in use now, a third peer must not attach as well
+    ReopenResult result;
+    try {
+        teleop::ShmTransport::Open(shm_name, std::chrono::milliseconds(50));
+    } catch (const std::runtime_error&) {
+        result.second_refused = true;
+    }
+
+    std::array<uint8_t, teleop::kMaxMessageSize> buffer;
+    for (size_t i = 0; i < num_messages; ++i) {
+        packet.header.sequence = 1000 + i;
+        endpoint.transport->Send(&packet, sizeof(packet));
+        const size_t size = endpoint.Receive(buffer.data(), buffer.size(), kEchoTimeoutNs);
+        teleop::StatePacket echoed;
+        std::memcpy(&echoed, buffer.data(), std::min(size, sizeof(echoed)));
+        if (size != sizeof(echoed) || echoed.header.sequence != packet.header.sequence) {
+            ++result.mismatches;
+        }
+    }
+    endpoint.transport->Send(&kStopMessage, 1);
+    int64_t child_cpu_ns = 0;
+    [[maybe_unused]] const auto read = ::read(attached[0], &child_cpu_ns, sizeof(child_cpu_ns));
+    ::close(attached[0]);
+    ::waitpid(child, nullptr, 0);
+    return result;
+}
+
+/** Value at a percentile of sorted samples, in [us] */
+double PercentileUs(const std::vector<int64_t>& sorted_ns, double percentile)
+{
+    if (sorted_ns.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(sorted_ns.size() - 1,
+        static_cast<size_t>(std::ceil(percentile / 100.0 * sorted_ns.size())) - 1);
+    return sorted_ns[index] / 1000.0;
+}
+}
+
+/** @brief Print program usage help */
+void PrintHelp()
+{
+    // clang-format off
+    std::cout << "Optional arguments: [--messages <count>] [--port <port>] [--wait <poll|sleep|both>]" << std::endl;
+    std::cout << "    --messages  Round trips per run, default 100000" << std::endl;
+    std::cout << "    --port      Localhost UDP port of the parent, the child uses port + 1, default 27500" << std::endl;
+    std::cout << "    --wait      Receivers busy-poll, sleep until a message arrives, or both, default both" << std::endl;
+    std::cout << std::endl;
+    // clang-format on
+}
+
+int main(int argc, char* argv[])
+{
+    // Program Setup
+    // =============================================================================================
+    if (teleop::utility::ProgramArgsExist(argc, argv, {"-h", "--help"})) {
+        PrintHelp();
+        return 1;
+    }
+    const auto num_messages = static_cast<size_t>(
+        std::stoul(teleop::utility::ProgramArgValue(argc, argv, "--messages", "100000")));
+    const auto port = static_cast<uint16_t>(
+        std::stoi(teleop::utility::ProgramArgValue(argc, argv, "--port", "27500")));
+    const std::string wait = teleop::utility::ProgramArgValue(argc, argv, "--wait", "both");
+    if (wait != "poll" && wait != "sleep" && wait != "both") {
+        std::cerr << "Invalid wait mode: " << wait << std::endl;
+        return 1;
+    }
+
+    // Benchmark
+    // =============================================================================================
+    std::cout << "Round trips of " << sizeof(teleop::StatePacket)
+              << "-byte messages to an echoing process, CPU time per round trip" << std::endl;
+    if (std::thread::hardware_concurrency() < 2) {
+        std::cout << "Single CPU core: busy-polling receivers yield to the peer between polls"
+                  << std::endl;
+    }
+    std::cout << std::setw(11) << "transport" << std::setw(8) << "wait" << std::setw(11)
+              << "p50[us]" << std::setw(11) << "p99[us]" << std::setw(12) << "p99.9[us]"
+              << std::setw(11) << "max[us]" << std::setw(15) << "sender cpu[us]" << std::setw(13)
+              << "echo cpu[us]" << std::endl;
+    for (const Kind kind : {Kind::kUdp, Kind::kShm}) {
+        for (const bool sleep : {false, true}) {
+            if ((sleep && wait == "poll") || (!sleep && wait == "sleep")) {
+                continue;
+            }
+            auto result = Run(kind, sleep, num_messages, port);
+            auto& samples = result.round_trips_ns;
+            std::sort(samples.begin(), samples.end());
+            std::cout << std::fixed << std::setprecision(2) << std::setw(11)
+                      << (kind == Kind::kShm ? "shm" : "udp") << std::setw(8)
+                      << (sleep ? "sleep" : "poll") << std::setw(11) << PercentileUs(samples, 50)
+                      << std::setw(11) << PercentileUs(samples, 99) << std::setw(12)
+                      << PercentileUs(samples, 99.9) << std::setw(11)
+                      << (samples.empty() ? 0.0 : samples.back() / 1000.0) << std::setw(15)
+                      << result.parent_cpu_us << std::setw(13) << result.child_cpu_us
+                      << std::endl;
+            if (samples.size() != num_messages) {
+                return 1;
+            }
+        }
+    }
+
+    const size_t num_reopen_messages = std::min<size_t>(num_messages, 1000);
+    const auto reopen = RunReopen(num_reopen_messages);
+    std::cout << "shm reopened after the peer crashed: " << reopen.mismatches << " of "
+              << num_reopen_messages << " round trips echoed another message, a second peer was "
+              << (reopen.second_refused ? "refused" : "accepted") << std::endl;
+    if (reopen.mismatches != 0 || !reopen.second_refused) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,559 @@
+/**
+ * @example sim_loopback_teleop.cpp
+ * Run a complete leader -> follower -> force feedback loop between two simulated arms over
+ * localhost or shared memory, without any hardware. An emulated operator drives the leader arm
+ * into a virtual wall on the follower side and feels the contact through force feedback. Round-trip time percentiles
+ * and the per-stage timing histograms of both loops are reported at the end, and can also be
+ * dumped to a file every second while running. Both nodes can record the session to logs that
+ * session_reader inspects. The follower's clock can be offset and skewed from the leader's to
+ * check that the nodes' clock synchronization recovers the one-way delays. Packet loss,
+ * reordering and duplication can be injected in both directions to exercise the UDP transport's
+ * stale-packet dropping. Both directions can be compressed as on a bandwidth-limited WAN link,
+ * reporting the bytes sent per packet, and protected with forward error correction that recovers
+ * lost packets from parity packets, and encrypted and authenticated as over the public internet,
+ * reporting tampered and replayed packets dropped. UDP traffic can go through a relay server run in
+ * process, as between sites behind NAT, reporting the relay's per-session traffic. The follower can track the leader's TCP pose through IK instead of its
+ * joint positions, as with a non-Flexiv leader.
+ * Both loops run as real-time threads; without the privileges for that a warning is printed and
+ * the test still runs, and page faults and preemptions in the loops are reported.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ * @author Flexiv
+ */
+
+#include <flexiv/omni/teleop/encryption.hpp>
+#include <flexiv/omni/teleop/fec.hpp>
+#include <flexiv/omni/teleop/follower_node.hpp>
+#include <flexiv/omni/teleop/leader_node.hpp>
+#include <flexiv/omni/teleop/link_emulator.hpp>
+#include <flexiv/omni/teleop/loop_timing.hpp>
+#include <flexiv/omni/teleop/relay.hpp>
+#include <flexiv/omni/teleop/rt_thread.hpp>
+#include <flexiv/omni/teleop/session_recorder.hpp>
+#include <flexiv/omni/teleop/shm_transport.hpp>
+#include <flexiv/omni/teleop/sim_robot.hpp>
+#include <flexiv/omni/teleop/state_compression.hpp>
+#include <flexiv/omni/teleop/tcp_transport.hpp>
+#include <flexiv/omni/teleop/udp_transport.hpp>
+#include <flexiv/omni/teleop/utility.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+/** Emulated operator hand: joint impedance pulling the leader along a slow periodic motion */
+constexpr double kOperatorStiffness = 300.0;
+constexpr double kOperatorDamping = 20.0;
+constexpr double kOperatorAmplitude = 0.25;
+constexpr double kOperatorFreq = 0.5;
+
+/** Virtual wall below the follower's initial TCP position [m] */
+constexpr double kWallDepth = 0.04;
+
+std::atomic<bool> g_stop = {false};
+}
+
+/** @brief Print program usage help */
+void PrintHelp()
+{
+    // clang-format off
+    std::cout << "Optional arguments: [--duration <seconds>] [--port <port>] [--transport <tcp|udp|shm>]" << std::endl;
+    std::cout << "                    [--loss <ratio>] [--reorder <ratio>] [--duplicate <ratio>]" << std::endl;
+    std::cout << "                    [--leader-cpu <core>] [--follower-cpu <core>] [--priority <1-99>]" << std::endl;
+    std::cout << "                    [--timing-file <file>] [--record <prefix>]" << std::endl;
+    std::cout << "                    [--clock-offset-ms <ms>] [--clock-drift-ppm <ppm>] [--cartesian]" << std::endl;
+    std::cout << "                    [--compress] [--fec <group size>,<parity count>] [--encrypt]" << std::endl;
+    std::cout << "                    [--relay] [--link-watchdog]" << std::endl;
+    std::cout << "    --duration    Test duration in seconds, default 10" << std::endl;
+    std::cout << "    --port        Localhost port of the follower, the leader uses port + 1 for UDP, default 25300" << std::endl;
+    std::cout << "    --transport   Transport between leader and follower, shm is shared memory, default tcp" << std::endl;
+    std::cout << "    --loss        Ratio of packets dropped in each direction, default 0" << std::endl;
+    std::cout << "    --reorder     Ratio of packets delivered after the next one in each direction, default 0" << std::endl;
+    std::cout << "    --duplicate   Ratio of packets delivered twice in each direction, default 0" << std::endl;
+    std::cout << "    --leader-cpu  CPU core to pin the leader loop to, default -1 (not pinned)" << std::endl;
+    std::cout << "    --follower-cpu CPU core to pin the follower loop to, default -1 (not pinned)" << std::endl;
+    std::cout << "    --priority    SCHED_FIFO priority of both loops, default 80" << std::endl;
+    std::cout << "    --timing-file File to dump the loop timing histograms to every second while running" << std::endl;
+    std::cout << "    --record      Record the session to <prefix>_leader.log and <prefix>_follower.log" << std::endl;
+    std::cout << "    --clock-offset-ms  Offset of the follower's clock from the leader's, default 0" << std::endl;
+    std::cout << "    --clock-drift-ppm  Rate at which the follower's clock runs faster than the leader's, default 0" << std::endl;
+    std::cout << "    --cartesian   Follower tracks the leader's TCP pose through IK instead of its joints" << std::endl;
+    std::cout << "    --compress    Quantize and delta-code state packets in both directions" << std::endl;
+    std::cout << "    --fec         Send parity packets after every group of packets in both directions, e.g. 4,1" << std::endl;
+    std::cout << "    --encrypt     Encrypt and authenticate every packet in both directions under a random session key" << std::endl;
+    std::cout << "    --relay       Exchange UDP datagrams through a relay server on port + 2 instead of directly" << std::endl;
+    std::cout << "    --link-watchdog  Stop the follower when no leader state arrives for 8 cycles" << std::endl;
+    std::cout << std::endl;
+    // clang-format on
+}
+
+/** @brief Name of the shared-memory segment, per port so that several tests can run at once */
+std::string ShmName(uint16_t port)
+{
+    return "/flexiv_teleop_" + std::to_string(port);
+}
+
+/** @brief Print p50/p99/p99.9/max of a set of durations given in [ns] */
+void PrintPercentiles(const std::string& name, std::vector<int64_t>& samples_ns)
+{
+    if (samples_ns.empty()) {
+        std::cout << name << ": no samples" << std::endl;
+        return;
+    }
+    std::sort(samples_ns.begin(), samples_ns.end());
+    auto percentile_us = [&](double p) {
+        const size_t idx = std::min(samples_ns.size() - 1,
+            static_cast<size_t>(std::ceil(p / 100.0 * samples_ns.size())) - 1);
+        return samples_ns[idx] / 1000.0;
+    };
+    std::cout << std::fixed << std::setprecision(1) << name << " [us] over " << samples_ns.size()
+              << " samples: p50 = " << percentile_us(50) << ", p99 = " << percentile_us(99)
+              << ", p99.9 = " << percentile_us(99.9) << ", max = " << samples_ns.back() / 1000.0
+              << std::endl;
+}
+
+/** @brief Store the one-way delay of a node's newest packet if one arrived since the last call */
+template <typename Status>
+void RecordOneWayDelay(
+    const Status& status, uint64_t& last_received_count, std::vector<int64_t>& delays_ns)
+{
+    if (status.received_count != last_received_count && status.clock_sync.valid
+        && delays_ns.size() < delays_ns.capacity()) {
+        delays_ns.push_back(status.one_way_delay_ns);
+    }
+    last_received_count = status.received_count;
+}
+
+/** @brief Print page faults and context switches of a loop */
+void PrintUsage(const std::string& name, const teleop::RtUsageMonitor& usage)
+{
+    const auto& totals = usage.totals();
+    std::cout << name << " over " << usage.cycle_count()
+              << " cycles: page faults = " << totals.minor_faults + totals.major_faults << " in "
+              << usage.faulted_cycle_count()
+              << " cycles, involuntary context switches = " << totals.involuntary_switches
+              << " in " << usage.preempted_cycle_count() << " cycles" << std::endl;
+}
+
+/**
+ * @brief Set up the calling thread for real-time, then run fn once per loop period until stopped,
+ * recording the resource usage of each cycle.
+ */
+template <typename Fn>
+void RunPeriodic(const teleop::RtThreadConfig& rt_config, Fn&& fn, teleop::RtUsageMonitor& usage)
+{
+    teleop::ConfigureRtThread(rt_config);
+    teleop::RtUsageMonitor monitor;
+    const auto period = std::chrono::nanoseconds(teleop::kLoopPeriodNs);
+    auto next_wakeup = std::chrono::steady_clock::now();
+    bool first = true;
+    while (!g_stop) {
+        if (!first) {
+            monitor.Update();
+        }
+        first = false;
+
+        fn();
+
+        next_wakeup += period;
+        std::this_thread::sleep_until(next_wakeup);
+    }
+    usage = monitor;
+}
+
+int main(int argc, char* argv[])
+{
+    // Program Setup
+    // =============================================================================================
+    if (teleop::utility::ProgramArgsExist(argc, argv, {"-h", "--help"})) {
+        PrintHelp();
+        return 1;
+    }
+    const double duration
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--duration", "10"));
+    const auto port = static_cast<uint16_t>(
+        std::stoi(teleop::utility::ProgramArgValue(argc, argv, "--port", "25300")));
+    const std::string transport_type
+        = teleop::utility::ProgramArgValue(argc, argv, "--transport", "tcp");
+    if (transport_type != "tcp" && transport_type != "udp" && transport_type != "shm") {
+        std::cerr << "Invalid transport: " << transport_type << std::endl;
+        return 1;
+    }
+    teleop::LinkImpairment impairment;
+    impairment.loss_ratio = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--loss", "0"));
+    impairment.reorder_ratio
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--reorder", "0"));
+    impairment.duplicate_ratio
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--duplicate", "0"));
+    teleop::RtThreadConfig leader_rt, follower_rt;
+    leader_rt.priority = follower_rt.priority
+        = std::stoi(teleop::utility::ProgramArgValue(argc, argv, "--priority", "80"));
+    leader_rt.cpu_core
+        = std::stoi(teleop::utility::ProgramArgValue(argc, argv, "--leader-cpu", "-1"));
+    follower_rt.cpu_core
+        = std::stoi(teleop::utility::ProgramArgValue(argc, argv, "--follower-cpu", "-1"));
+    const size_t num_cycles = static_cast<size_t>(duration / teleop::kLoopPeriod);
+    const std::string timing_path = teleop::utility::ProgramArgValue(argc, argv, "--timing-file");
+    const std::string record_prefix = teleop::utility::ProgramArgValue(argc, argv, "--record");
+    const auto clock_offset_ns = static_cast<int64_t>(
+        std::stod(teleop::utility::ProgramArgValue(argc, argv, "--clock-offset-ms", "0")) * 1e6);
+    const double clock_drift_ppm
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--clock-drift-ppm", "0"));
+    teleop::FollowerParams follower_params;
+    follower_params.use_cartesian_target
+        = teleop::utility::ProgramArgsExist(argc, argv, {"--cartesian"});
+    follower_params.use_link_watchdog
+        = teleop::utility::ProgramArgsExist(argc, argv, {"--link-watchdog"});
+    const bool compress = teleop::utility::ProgramArgsExist(argc, argv, {"--compress"});
+    const std::string fec_layout = teleop::utility::ProgramArgValue(argc, argv, "--fec", "");
+    const bool use_fec = !fec_layout.empty();
+    teleop::FecParams fec_params;
+    if (use_fec) {
+        const auto comma = fec_layout.find(',');
+        fec_params.group_size = std::stoul(fec_layout.substr(0, comma));
+        if (comma != std::string::npos) {
+            fec_params.parity_count = std::stoul(fec_layout.substr(comma + 1));
+        }
+        if (fec_params.group_size < 1 || fec_params.group_size > teleop::kMaxFecGroupSize
+            || fec_params.parity_count < 1
+            || fec_params.parity_count > teleop::kMaxFecParityCount) {
+            std::cerr << "Invalid FEC layout: " << fec_layout << std::endl;
+            return 1;
+        }
+    }
+
+    // Both ends reach each other only through the relay, under a random session ID and token
+    const bool use_relay = teleop::utility::ProgramArgsExist(argc, argv, {"--relay"});
+    if (use_relay && transport_type != "udp") {
+        std::cerr << "The relay only forwards UDP datagrams, use --transport udp" << std::endl;
+        return 1;
+    }
+    std::unique_ptr<teleop::RelayServer> relay;
+    const uint64_t relay_session_id = (static_cast<uint64_t>(std::random_device()()) << 32)
+                                      | std::random_device()();
+    const teleop::RelayToken relay_token = teleop::GenerateRelayToken();
+    if (use_relay) {
+        teleop::RelayParams relay_params;
+        relay_params.port = port + 2;
+        relay = std::make_unique<teleop::RelayServer>(relay_params);
+        relay->Start();
+    }
+
+    // Both ends share one key per session, as handed out by a session setup over TLS
+    const bool encrypt = teleop::utility::ProgramArgsExist(argc, argv, {"--encrypt"});
+    teleop::EncryptionParams encryption_params;
+    encryption_params.key = teleop::GenerateAeadKey();
+
+    // Pre-allocate all sample storage so the loops never allocate
+    std::vector<int64_t> round_trips_ns, leader_one_way_ns, follower_one_way_ns;
+    round_trips_ns.reserve(num_cycles);
+    leader_one_way_ns.reserve(num_cycles);
+    follower_one_way_ns.reserve(num_cycles);
+    int64_t true_clock_offset_ns = 0;
+    double peak_contact_force = 0.0;
+    double peak_feedback_torque = 0.0;
+    teleop::LeaderStatus leader_status;
+    teleop::FollowerStatus follower_status;
+    teleop::CompressionStats leader_compression, follower_compression;
+    teleop::FecStats leader_fec, follower_fec;
+    teleop::EncryptionStats leader_encryption, follower_encryption;
+    teleop::RtUsageMonitor leader_usage, follower_usage;
+    std::ostringstream leader_timing, follower_timing;
+
+    // Loops register their timing recorders while they run
+    std::unique_ptr<teleop::TimingDumper> dumper;
+    if (!timing_path.empty()) {
+        dumper = std::make_unique<teleop::TimingDumper>(timing_path);
+        dumper->Start(std::chrono::seconds(1));
+    }
+    auto run_registered = [&](const std::string& name, const auto& node, auto&& loop) {
+        if (dumper) {
+            dumper->Add(name, node.timing());
+        }
+        try {
+            loop();
+        } catch (...) {
+            if (dumper) {
+                dumper->Remove(node.timing());
+            }
+            throw;
+        }
+        if (dumper) {
+            dumper->Remove(node.timing());
+        }
+    };
+
+    // Any error ends the whole test
+    auto run_guarded = [](auto&& body) {
+        try {
+            body();
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            g_stop = true;
+        }
+    };
+
+    // Follower side
+    // =============================================================================================
+    std::thread follower_thread([&]() {
+        run_guarded([&]() {
+            std::unique_ptr<teleop::Transport> relay_socket, transport;
+            if (use_relay) {
+                relay_socket = std::make_unique<teleop::UdpTransport>(port, "127.0.0.1", port + 2);
+                transport = std::make_unique<teleop::RelayTransport>(
+                    *relay_socket, relay_session_id, relay_token, teleop::RelayRole::kFollower);
+            } else if (transport_type == "udp") {
+                transport = std::make_unique<teleop::UdpTransport>(port, "127.0.0.1", port + 1);
+            } else if (transport_type == "shm") {
+                transport = teleop::ShmTransport::Create(ShmName(port));
+            } else {
+                transport = teleop::TcpTransport::Listen(port);
+            }
+            teleop::LinkEmulator link(*transport, impairment);
+            teleop::EncryptionParams follower_encryption_params = encryption_params;
+            follower_encryption_params.role = teleop::EncryptionRole::kFollower;
+            teleop::EncryptedTransport secure(link, follower_encryption_params);
+            teleop::Transport& wire = encrypt ? static_cast<teleop::Transport&>(secure) : link;
+            teleop::FecTransport fec(wire, fec_params);
+            teleop::Transport& protected_link
+                = use_fec ? static_cast<teleop::Transport&>(fec) : wire;
+            teleop::CompressedTransport compressed(protected_link);
+            teleop::Transport& node_link
+                = compress ? static_cast<teleop::Transport&>(compressed) : protected_link;
+            teleop::SimRobot robot;
+            teleop::VirtualWall wall;
+            wall.enabled = true;
+            wall.offset = robot.states().tcp_pose[2] - kWallDepth;
+            robot.SetVirtualWall(wall);
+            // The follower host's clock disagrees with the leader host's
+            const teleop::SkewedClock clock(
+                teleop::DefaultClock(), clock_offset_ns, clock_drift_ppm);
+            teleop::FollowerNode node(robot, node_link, follower_params, clock);
+            uint64_t last_received_count = 0;
+            std::unique_ptr<teleop::SessionRecorder> recorder;
+            if (!record_prefix.empty()) {
+                recorder = std::make_unique<teleop::SessionRecorder>(
+                    record_prefix + "_follower.log", teleop::MessageType::kFollowerState);
+                node.SetRecorder(recorder.get());
+            }
+
+            run_registered("follower", node, [&]() {
+                RunPeriodic(
+                    follower_rt,
+                    [&]() {
+                        node.Step();
+                        robot.Step();
+                        peak_contact_force
+                            = std::max(peak_contact_force, robot.states().ext_wrench_in_world[2]);
+                        RecordOneWayDelay(node.status(), last_received_count, follower_one_way_ns);
+                    },
+                    follower_usage);
+            });
+            follower_status = node.status();
+            follower_compression = compressed.stats();
+            follower_fec = fec.stats();
+            follower_encryption = secure.stats();
+            true_clock_offset_ns = clock.NowNs() - teleop::DefaultClock().NowNs();
+            teleop::WriteTimingReport("Follower", node.timing(), follower_timing);
+        });
+    });
+
+    // Leader side
+    // =============================================================================================
+    std::thread leader_thread([&]() {
+        run_guarded([&]() {
+            std::unique_ptr<teleop::Transport> relay_socket, transport;
+            if (use_relay) {
+                relay_socket
+                    = std::make_unique<teleop::UdpTransport>(port + 1, "127.0.0.1", port + 2);
+                transport = std::make_unique<teleop::RelayTransport>(
+                    *relay_socket, relay_session_id, relay_token, teleop::RelayRole::kLeader);
+            } else if (transport_type == "udp") {
+                transport = std::make_unique<teleop::UdpTransport>(port + 1, "127.0.0.1", port);
+            } else if (transport_type == "shm") {
+                transport = teleop::ShmTransport::Open(ShmName(port));
+            } else {
+                transport = teleop::TcpTransport::Connect("127.0.0.1", port);
+            }
+            // Impair the two directions independently
+            teleop::LinkImpairment leader_impairment = impairment;
+            leader_impairment.seed += 1;
+            teleop::LinkEmulator link(*transport, leader_impairment);
+            teleop::EncryptedTransport secure(link, encryption_params);
+            teleop::Transport& wire = encrypt ? static_cast<teleop::Transport&>(secure) : link;
+            teleop::FecTransport fec(wire, fec_params);
+            teleop::Transport& protected_link
+                = use_fec ? static_cast<teleop::Transport&>(fec) : wire;
+            teleop::CompressedTransport compressed(protected_link);
+            teleop::Transport& node_link
+                = compress ? static_cast<teleop::Transport&>(compressed) : protected_link;
+            teleop::SimRobot robot;
+            teleop::LeaderNode node(robot, node_link);
+            std::unique_ptr<teleop::SessionRecorder> recorder;
+            if (!record_prefix.empty()) {
+                recorder = std::make_unique<teleop::SessionRecorder>(
+                    record_prefix + "_leader.log", teleop::MessageType::kLeaderState);
+                node.SetRecorder(recorder.get());
+            }
+            const teleop::JointArray home = robot.states().q;
+            uint64_t last_rtt_count = 0, last_received_count = 0;
+            size_t cycle = 0;
+
+            run_registered("leader", node, [&]() {
+                RunPeriodic(
+                    leader_rt,
+                    [&]() {
+                        // Emulated operator pushes joints 2 and 4 so the TCP moves up and down
+                        const double t = cycle++ * teleop::kLoopPeriod;
+                        const double offset
+                            = kOperatorAmplitude * std::sin(2.0 * M_PI * kOperatorFreq * t);
+                        teleop::JointArray q_operator = home;
+                        q_operator[1] += offset;
+                        q_operator[3] -= offset;
+                        const auto states = robot.states();
+                        teleop::JointArray tau_operator;
+                        for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+                            tau_operator[i] = kOperatorStiffness * (q_operator[i] - states.q[i])
+                                              - kOperatorDamping * states.dq[i];
+                        }
+                        robot.SetExternalJointTorque(tau_operator);
+
+                        node.Step();
+                        robot.Step();
+
+                        const auto& status = node.status();
+                        if (status.round_trip_count != last_rtt_count
+                            && round_trips_ns.size() < round_trips_ns.capacity()) {
+                            round_trips_ns.push_back(status.round_trip_ns);
+                            last_rtt_count = status.round_trip_count;
+                        }
+                        for (double tau : status.feedback_torque) {
+                            peak_feedback_torque = std::max(peak_feedback_torque, std::abs(tau));
+                        }
+                        RecordOneWayDelay(status, last_received_count, leader_one_way_ns);
+                    },
+                    leader_usage);
+            });
+            leader_status = node.status();
+            leader_compression = compressed.stats();
+            leader_fec = fec.stats();
+            leader_encryption = secure.stats();
+            teleop::WriteTimingReport("Leader", node.timing(), leader_timing);
+        });
+    });
+
+    const auto deadline
+        = std::chrono::steady_clock::now() + std::chrono::duration<double>(duration);
+    while (!g_stop && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    const bool failed = g_stop;
+    g_stop = true;
+    leader_thread.join();
+    follower_thread.join();
+    if (failed) {
+        return 1;
+    }
+
+    // Report
+    // =============================================================================================
+    PrintPercentiles("Round-trip time", round_trips_ns);
+    PrintPercentiles("Leader -> follower one-way delay", follower_one_way_ns);
+    PrintPercentiles("Follower -> leader one-way delay", leader_one_way_ns);
+    std::cout << std::fixed << std::setprecision(1)
+              << "Follower clock offset [us]: true = " << true_clock_offset_ns / 1000.0
+              << ", estimated by leader = " << leader_status.clock_sync.offset_ns / 1000.0
+              << ", by follower = " << -follower_status.clock_sync.offset_ns / 1000.0 << std::endl;
+    std::cout << std::setprecision(2) << "Follower clock drift [ppm]: true = " << clock_drift_ppm
+              << ", estimated by leader = " << leader_status.clock_sync.drift_ppm
+              << ", by follower = " << -follower_status.clock_sync.drift_ppm << std::endl;
+    std::cout << leader_timing.str() << follower_timing.str();
+    PrintUsage("Leader loop", leader_usage);
+    PrintUsage("Follower loop", follower_usage);
+    std::cout << "Leader received " << leader_status.received_count << " packets, discarded "
+              << leader_status.stale_count << " stale, " << leader_status.lost_count << " lost"
+              << std::endl;
+    std::cout << "Follower received " << follower_status.received_count << " packets, discarded "
+              << follower_status.stale_count << " stale, " << follower_status.lost_count << " lost"
+              << std::endl;
+    if (compress) {
+        for (const auto& side : {std::make_pair("Leader", &leader_compression),
+                 std::make_pair("Follower", &follower_compression)}) {
+            const auto& stats = *side.second;
+            const double average_size = static_cast<double>(stats.compressed_bytes)
+                                        / std::max<uint64_t>(stats.sent_count, 1);
+            std::cout << side.first << " sent " << stats.sent_count << " packets of "
+                      << std::setprecision(1) << average_size << " bytes on average instead of "
+                      << sizeof(teleop::StatePacket) << ", " << stats.keyframe_count
+                      << " keyframes; peer deltas undecodable: " << stats.missing_base_count
+                      << std::endl;
+        }
+    }
+    if (use_fec) {
+        for (const auto& side : {std::make_pair("Leader", &leader_fec),
+                 std::make_pair("Follower", &follower_fec)}) {
+            const auto& stats = *side.second;
+            const double overhead = 100.0 * stats.overhead_bytes
+                                    / std::max<uint64_t>(stats.payload_bytes, 1);
+            std::cout << side.first << " sent " << stats.parity_sent_count
+                      << " parity packets, " << std::setprecision(1) << overhead
+                      << "% overhead; recovered " << stats.decoder.recovered_count
+                      << " lost peer packets, " << stats.decoder.unrecoverable_count
+                      << " unrecoverable" << std::endl;
+        }
+    }
+    if (encrypt) {
+        std::cout << "Encrypted with "
+                  << (encryption_params.cipher == teleop::AeadCipher::kAes256Gcm
+                             ? "AES-256-GCM (AES-NI)"
+                             : "ChaCha20-Poly1305")
+                  << ", " << teleop::kEncryptionOverhead << " bytes per packet" << std::endl;
+        for (const auto& side : {std::make_pair("Leader", &leader_encryption),
+                 std::make_pair("Follower", &follower_encryption)}) {
+            const auto& stats = *side.second;
+            std::cout << side.first << " sealed " << stats.sealed_count << " packets, opened "
+                      << stats.opened_count << "; dropped " << stats.replay_count
+                      << " replayed, " << stats.auth_failure_count << " unauthentic, "
+                      << stats.rejected_count << " foreign" << std::endl;
+        }
+    }
+    if (relay) {
+        relay->Stop();
+        const auto metrics = relay->metrics();
+        std::cout << "Relay forwarded " << metrics.forwarded_count << " of "
+                  << metrics.received_count << " datagrams in " << metrics.recv_call_count
+                  << " recvmmsg and " << metrics.send_call_count << " sendmmsg calls" << std::endl;
+        for (const auto& session : relay->sessions()) {
+            std::cout << "Relay session " << std::hex << session.session_id << std::dec
+                      << ": leader -> follower " << session.forwarded_count[0]
+                      << ", follower -> leader " << session.forwarded_count[1] << ", unpaired "
+                      << session.unpaired_count << ", unauthentic " << session.unauthentic_count
+                      << std::endl;
+        }
+    }
+    if (follower_params.use_cartesian_target) {
+        std::cout << "Follower IK failed to converge in " << follower_status.ik_failure_count
+                  << " of " << follower_status.commanded_count << " cycles" << std::endl;
+    }
+    if (follower_params.use_link_watchdog) {
+        const auto& watchdog = follower_status.link_watchdog;
+        std::cout << "Follower link watchdog tripped " << watchdog.trip_count << " times, resumed "
+                  << watchdog.resume_count << " times, longest gap without a leader state "
+                  << watchdog.longest_gap_cycles << " cycles" << std::endl;
+    }
+    std::cout << std::setprecision(2) << "Peak follower contact force = " << peak_contact_force
+              << " N, peak leader feedback torque = " << peak_feedback_torque << " Nm"
+              << std::endl;
+
+    return 0;
+}
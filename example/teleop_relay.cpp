@@ -0,0 +1,109 @@
+/**
+ * @example teleop_relay.cpp
+ * Relay server for teleop sessions whose leader and follower sites cannot reach each other
+ * directly, e.g. both behind carrier-grade NAT. Run it on a host both sites can reach, and have
+ * each end wrap its UdpTransport to that host in a RelayTransport with the session's ID and
+ * token. Traffic of every session is printed periodically. sim_loopback_teleop --relay runs the same relay in
+ * process, between its two nodes on localhost.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ * @author Flexiv
+ */
+
+#include <flexiv/omni/teleop/clock.hpp>
+#include <flexiv/omni/teleop/relay.hpp>
+#include <flexiv/omni/teleop/utility.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace flexiv::omni;
+
+namespace {
+std::atomic<bool> g_stop = {false};
+
+void PrintSessions(const teleop::RelayServer& relay)
+{
+    const auto metrics = relay.metrics();
+    const auto sessions = relay.sessions();
+    std::cout << "Relayed " << metrics.forwarded_count << " of " << metrics.received_count
+              << " datagrams in " << metrics.recv_call_count << " recvmmsg and "
+              << metrics.send_call_count << " sendmmsg calls; dropped " << metrics.malformed_count
+              << " malformed, " << metrics.rejected_count << " over the session limit, "
+              << metrics.unauthentic_count << " unauthentic, " << metrics.send_error_count
+              << " unsendable; " << sessions.size() << " sessions, " << metrics.expired_count
+              << " expired" << std::endl;
+    const int64_t now = teleop::SteadyTimeNs();
+    for (const auto& session : sessions) {
+        std::cout << "  session " << std::hex << std::setw(16) << std::setfill('0')
+                  << session.session_id << std::dec << std::setfill(' ') << ": leader "
+                  << (session.registered[0] ? "up" : "--") << ", follower "
+                  << (session.registered[1] ? "up" : "--") << ", leader -> follower "
+                  << session.forwarded_count[0] << " (" << session.forwarded_bytes[0] / 1024
+                  << " KiB), follower -> leader " << session.forwarded_count[1] << " ("
+                  << session.forwarded_bytes[1] / 1024 << " KiB), unpaired "
+                  << session.unpaired_count << ", unauthentic " << session.unauthentic_count
+                  << ", address changes "
+                  << session.address_change_count << ", idle "
+                  << (now - session.last_seen_ns) / 1000000 << " ms" << std::endl;
+    }
+}
+}
+
+/** @brief Print program usage help */
+void PrintHelp()
+{
+    // clang-format off
+    std::cout << "Optional arguments: [--port <port>] [--stats-interval <seconds>] [--duration <seconds>]" << std::endl;
+    std::cout << "    --port            UDP port to relay on, default 25400" << std::endl;
+    std::cout << "    --stats-interval  Seconds between session reports, default 5" << std::endl;
+    std::cout << "    --duration        Seconds to run before exiting, default 0 (until Ctrl-C)" << std::endl;
+    std::cout << std::endl;
+    // clang-format on
+}
+
+int main(int argc, char* argv[])
+{
+    // Program Setup
+    // =============================================================================================
+    if (teleop::utility::ProgramArgsExist(argc, argv, {"-h", "--help"})) {
+        PrintHelp();
+        return 1;
+    }
+    teleop::RelayParams params;
+    params.port = static_cast<uint16_t>(
+        std::stoi(teleop::utility::ProgramArgValue(argc, argv, "--port", "25400")));
+    const double stats_interval
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--stats-interval", "5"));
+    const double duration
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--duration", "0"));
+    std::signal(SIGINT, [](int) { g_stop = true; });
+    std::signal(SIGTERM, [](int) { g_stop = true; });
+
+    // Relay
+    // =============================================================================================
+    teleop::RelayServer relay(params);
+    relay.Start();
+    std::cout << "Relaying teleop sessions on UDP port " << params.port << std::endl;
+    const auto start = std::chrono::steady_clock::now();
+    auto next_report = start + std::chrono::duration<double>(stats_interval);
+    while (!g_stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= next_report) {
+            PrintSessions(relay);
+            next_report += std::chrono::duration<double>(stats_interval);
+        }
+        if (duration > 0 && now - start >= std::chrono::duration<double>(duration)) {
+            break;
+        }
+    }
+    relay.Stop();
+    PrintSessions(relay);
+
+    return 0;
+}
@@ -0,0 +1,479 @@
+/**
+ * @file batch_kinematics.hpp
+ * @brief Forward kinematics and Jacobian of many joint configurations at once, vectorized over
+ * configurations with AVX2 when the CPU running the program has it.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "kinematics.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define FLEXIV_TELEOP_HAS_AVX2 1
+#else
+#define FLEXIV_TELEOP_HAS_AVX2 0
+#endif
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/** Batch sizes must be a multiple of this, so that every SIMD lane group is full */
+constexpr size_t kBatchAlignment = 4;
+
+/**
+ * @struct JointBatch
+ * @brief Joint positions of N configurations in structure-of-arrays layout: q[joint][config].
+ * @tparam N Number of configurations, a multiple of kBatchAlignment.
+ */
+template <size_t N>
+struct JointBatch
+{
+    static_assert(N > 0 && N % kBatchAlignment == 0, "N must be a multiple of kBatchAlignment");
+
+    /** Joint positions [rad] */
+    alignas(32) std::array<std::array<double, N>, kJointDoF> q = {};
+
+    /**
+     * @brief Store one configuration.
+     * @param[in] k Index of the configuration.
+     * @param[in] positions Joint positions [rad].
+     */
+    void Set(size_t k, const JointArray& positions)
+    {
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            q[i][k] = positions[i];
+        }
+    }
+
+    /** Configuration k */
+    JointArray Get(size_t k) const
+    {
+        JointArray positions;
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            positions[i] = q[i][k];
+        }
+        return positions;
+    }
+};
+
+/**
+ * @struct PoseBatch
+ * @brief TCP poses of N configurations in structure-of-arrays layout.
+ * @tparam N Number of configurations, a multiple of kBatchAlignment.
+ */
+template <size_t N>
+struct PoseBatch
+{
+    static_assert(N > 0 && N % kBatchAlignment == 0, "N must be a multiple of kBatchAlignment");
+
+    /** Rotation matrices in the world frame, rotation[row][col][config] */
+    alignas(32) std::array<std::array<std::array<double, N>, 3>, 3> rotation = {};
+
+    /** Positions in the world frame, translation[axis][config] [m] */
+    alignas(32) std::array<std::array<double, N>, 3> translation = {};
+
+    /** Pose k */
+    Eigen::Isometry3d Get(size_t k) const
+    {
+        Eigen::Isometry3d T = Eigen::Isometry3d::Identity();
+        for (size_t r = 0; r < 3; ++r) {
+            for (size_t c = 0; c < 3; ++c) {
+                T.linear()(r, c) = rotation[r][c][k];
+            }
+            T.translation()[r] = translation[r][k];
+        }
+        return T;
+    }
+};
+
+/**
+ * @struct JacobianBatch
+ * @brief Geometric Jacobians of N configurations in structure-of-arrays layout.
+ * @tparam N Number of configurations, a multiple of kBatchAlignment.
+ */
+template <size_t N>
+struct JacobianBatch
+{
+    static_assert(N > 0 && N % kBatchAlignment == 0, "N must be a multiple of kBatchAlignment");
+
+    /** Jacobian entries, data[row][joint][config], same layout as Jacobian per config */
+    alignas(32) std::array<std::array<std::array<double, N>, kJointDoF>, kCartDoF> data = {};
+
+    /** Jacobian k */
+    Jacobian Get(size_t k) const
+    {
+        Jacobian jacobian;
+        for (size_t r = 0; r < kCartDoF; ++r) {
+            for (size_t c = 0; c < kJointDoF; ++c) {
+                jacobian(r, c) = data[r][c][k];
+            }
+        }
+        return jacobian;
+    }
+};
+
+namespace detail {
+
+/** Portable kernel: one configuration at a time */
+struct ScalarPack
+{
+    static constexpr size_t kWidth = 1;
+    double v;
+
+    static ScalarPack Load(const double* p) { return {*p}; }
+    static ScalarPack Broadcast(double x) { return {x}; }
+    void Store(double* p) const { *p = v; }
+};
+
+inline ScalarPack operator+(ScalarPack a, ScalarPack b) { return {a.v + b.v}; }
+inline ScalarPack operator-(ScalarPack a, ScalarPack b) { return {a.v - b.v}; }
+inline ScalarPack operator*(ScalarPack a, ScalarPack b) { return {a.v * b.v}; }
+inline ScalarPack operator-(ScalarPack a) { return {-a.v}; }
+
+/** a * b + c */
+inline ScalarPack MulAdd(ScalarPack a, ScalarPack b, ScalarPack c) { return {a.v * b.v + c.v}; }
+
+inline void SinCos(ScalarPack x, ScalarPack& s, ScalarPack& c)
+{
+    s.v = std::sin(x.v);
+    c.v = std::cos(x.v);
+}
+
+#if FLEXIV_TELEOP_HAS_AVX2
+#define FLEXIV_TELEOP_AVX2_TARGET __attribute__((target("avx2,fma")))
+
+/**
+ * Four configurations processed together in AVX2 registers. Everything touching its lanes is
+ * compiled for AVX2 and FMA whatever the build flags, so only run it where HasAvx2() is true. The
+ * lanes are kept as plain doubles rather than __m256d, so that passing a pack between code built
+ * for different targets does not change its calling convention, e.g. in unoptimized builds;
+ * once inlined, they stay in registers.
+ */
+struct Avx2Pack
+{
+    static constexpr size_t kWidth = 4;
+    double v[kWidth];
+
+    FLEXIV_TELEOP_AVX2_TARGET static Avx2Pack Load(const double* p)
+    {
+        return Make(_mm256_load_pd(p));
+    }
+    FLEXIV_TELEOP_AVX2_TARGET static Avx2Pack Broadcast(double x) { return Make(_mm256_set1_pd(x)); }
+    FLEXIV_TELEOP_AVX2_TARGET void Store(double* p) const { _mm256_store_pd(p, Get()); }
+
+    FLEXIV_TELEOP_AVX2_TARGET __m256d Get() const { return _mm256_loadu_pd(v); }
+    FLEXIV_TELEOP_AVX2_TARGET static Avx2Pack Make(__m256d x)
+    {
+        Avx2Pack pack;
+        _mm256_storeu_pd(pack.v, x);
+        return pack;
+    }
+};
+
+FLEXIV_TELEOP_AVX2_TARGET inline Avx2Pack operator+(const Avx2Pack& a, const Avx2Pack& b)
+{
+    return Avx2Pack::Make(_mm256_add_pd(a.Get(), b.Get()));
+}
+FLEXIV_TELEOP_AVX2_TARGET inline Avx2Pack operator-(const Avx2Pack& a, const Avx2Pack& b)
+{
+    return Avx2Pack::Make(_mm256_sub_pd(a.Get(), b.Get()));
+}
+FLEXIV_TELEOP_AVX2_TARGET inline Avx2Pack operator*(const Avx2Pack& a, const Avx2Pack& b)
+{
+    return Avx2Pack::Make(_mm256_mul_pd(a.Get(), b.Get()));
+}
+FLEXIV_TELEOP_AVX2_TARGET inline Avx2Pack operator-(const Avx2Pack& a)
+{
+    return Avx2Pack::Make(_mm256_xor_pd(a.Get(), _mm256_set1_pd(-0.0)));
+}
+
+/** a * b + c */
+FLEXIV_TELEOP_AVX2_TARGET inline Avx2Pack MulAdd(
+    const Avx2Pack& a, const Avx2Pack& b, const Avx2Pack& c)
+{
+    return Avx2Pack::Make(_mm256_fmadd_pd(a.Get(), b.Get(), c.Get()));
+}
+
+/**
+ * Sine and cosine of four angles, Cephes algorithm: reduction to [-pi/4, pi/4] in three steps,
+ * then the minimax polynomial of sine or cosine depending on the octant. Accurate to ~1 ulp for
+ * |x| < 1e8, far beyond any joint angle.
+ */
+FLEXIV_TELEOP_AVX2_TARGET inline void SinCos(const Avx2Pack& angle, Avx2Pack& s, Avx2Pack& c)
+{
+    const __m256d x = angle.Get();
+    const __m256d sign_mask = _mm256_set1_pd(-0.0);
+    const __m256d x_abs = _mm256_andnot_pd(sign_mask, x);
+
+    // Octant j = floor(|x| / (pi/4)) rounded up to even, so that z is in [-pi/4, pi/4]
+    __m256d y = _mm256_floor_pd(_mm256_mul_pd(x_abs, _mm256_set1_pd(4.0 / M_PI)));
+    __m128i j = _mm256_cvtpd_epi32(y);
+    j = _mm_add_epi32(j, _mm_and_si128(j, _mm_set1_epi32(1)));
+    y = _mm256_cvtepi32_pd(j);
+    j = _mm_and_si128(j, _mm_set1_epi32(7));
+    __m256d z = _mm256_fnmadd_pd(y, _mm256_set1_pd(7.85398125648498535156E-1), x_abs);
+    z = _mm256_fnmadd_pd(y, _mm256_set1_pd(3.77489470793079817668E-8), z);
+    z = _mm256_fnmadd_pd(y, _mm256_set1_pd(2.69515142907905952645E-15), z);
+    const __m256d zz = _mm256_mul_pd(z, z);
+
+    // sin(z) = z + z^3 P(z^2)
+    __m256d p = _mm256_set1_pd(1.58962301576546568060E-10);
+    p = _mm256_fmadd_pd(p, zz, _mm256_set1_pd(-2.50507477628578072866E-8));
+    p = _mm256_fmadd_pd(p, zz, _mm256_set1_pd(2.75573136213857245213E-6));
+    p = _mm256_fmadd_pd(p, zz, _mm256_set1_pd(-1.98412698295895385996E-4));
+    p = _mm256_fmadd_pd(p, zz, _mm256_set1_pd(8.33333333332211858878E-3));
+    p = _mm256_fmadd_pd(p, zz, _mm256_set1_pd(-1.66666666666666307295E-1));
+    const __m256d sin_z = _mm256_fmadd_pd(_mm256_mul_pd(p, zz), z, z);
+
+    // cos(z) = 1 - z^2 / 2 + z^4 Q(z^2)
+    __m256d q = _mm256_set1_pd(-1.13585365213876817300E-11);
+    q = _mm256_fmadd_pd(q, zz, _mm256_set1_pd(2.08757008419747316778E-9));
+    q = _mm256_fmadd_pd(q, zz, _mm256_set1_pd(-2.75573141792967388112E-7));
+    q = _mm256_fmadd_pd(q, zz, _mm256_set1_pd(2.48015872888517045348E-5));
+    q = _mm256_fmadd_pd(q, zz, _mm256_set1_pd(-1.38888888888730564116E-3));
+    q = _mm256_fmadd_pd(q, zz, _mm256_set1_pd(4.16666666666665929218E-2));
+    const __m256d cos_z = _mm256_add_pd(
+        _mm256_fnmadd_pd(zz, _mm256_set1_pd(0.5), _mm256_set1_pd(1.0)),
+        _mm256_mul_pd(_mm256_mul_pd(zz, zz), q));
+
+    // Octants 2 and 6 swap sine and cosine; the sign follows from the octant
+    const __m256i j64 = _mm256_cvtepi32_epi64(j);
+    const __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(
+        _mm256_and_si256(j64, _mm256_set1_epi64x(2)), _mm256_set1_epi64x(2)));
+    const __m256d sin_sign = _mm256_xor_pd(
+        _mm256_and_pd(x, sign_mask), _mm256_castsi256_pd(_mm256_slli_epi64(
+                                           _mm256_and_si256(j64, _mm256_set1_epi64x(4)), 61)));
+    const __m256d cos_sign = _mm256_castsi256_pd(_mm256_slli_epi64(
+        _mm256_and_si256(_mm256_add_epi64(j64, _mm256_set1_epi64x(2)), _mm256_set1_epi64x(4)),
+        61));
+    s = Avx2Pack::Make(_mm256_xor_pd(_mm256_blendv_pd(sin_z, cos_z, swap), sin_sign));
+    c = Avx2Pack::Make(_mm256_xor_pd(_mm256_blendv_pd(cos_z, sin_z, swap), cos_sign));
+}
+#endif
+
+/** 3D vector of packs */
+template <class Pack>
+struct Vec3Pack
+{
+    Pack x, y, z;
+};
+
+template <class Pack>
+inline Vec3Pack<Pack> Cross(const Vec3Pack<Pack>& a, const Vec3Pack<Pack>& b)
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+} /* namespace detail */
+
+/**
+ * @brief Whether this CPU runs the AVX2 and FMA kernel of BatchKinematics.
+ */
+inline bool HasAvx2()
+{
+#if FLEXIV_TELEOP_HAS_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @class BatchKinematics
+ * @brief Same forward kinematics and geometric Jacobian as Kinematics, for N configurations at
+ * once, e.g. to check candidate poses of a predictor or seed IK. Configurations are stored
+ * structure-of-arrays so that consecutive configurations fill the lanes of a SIMD register.
+ * On x86-64 CPUs with AVX2 and FMA, detected at run time whatever the build flags, four
+ * configurations are processed per instruction and sine and cosine are evaluated by a vectorized
+ * polynomial; results then match Kinematics to within a few ulp rather than bit for bit.
+ * Elsewhere a portable scalar kernel is used. Never allocates.
+ */
+class BatchKinematics
+{
+public:
+    /**
+     * @param[in] params Kinematic parameters.
+     * @param[in] allow_simd False to use the portable kernel even where AVX2 is available, e.g.
+     * to compare against it.
+     */
+    explicit BatchKinematics(
+        const DhParams& params = DhParams::Rizon4(), bool allow_simd = true)
+    : params_(params)
+    , use_avx2_(allow_simd && HasAvx2())
+    {
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            cos_alpha_[i] = std::cos(params.alpha[i]);
+            sin_alpha_[i] = std::sin(params.alpha[i]);
+        }
+    }
+
+    /**
+     * @brief [Real-time] Compute the TCP poses of all configurations.
+     * @param[in] q Joint positions.
+     * @param[out] poses TCP poses in the world frame.
+     */
+    template <size_t N>
+    void ForwardKinematics(const JointBatch<N>& q, PoseBatch<N>& poses) const
+    {
+#if FLEXIV_TELEOP_HAS_AVX2
+        if (use_avx2_) {
+            ComputeAvx2<N, false>(q, poses, nullptr);
+            return;
+        }
+#endif
+        ComputeAll<detail::ScalarPack, N, false>(q, poses, nullptr);
+    }
+
+    /**
+     * @brief [Real-time] Compute the TCP poses and geometric Jacobians of all configurations.
+     * @param[in] q Joint positions.
+     * @param[out] poses TCP poses in the world frame.
+     * @param[out] jacobians Jacobians expressed in the world frame.
+     */
+    template <size_t N>
+    void Compute(const JointBatch<N>& q, PoseBatch<N>& poses, JacobianBatch<N>& jacobians) const
+    {
+#if FLEXIV_TELEOP_HAS_AVX2
+        if (use_avx2_) {
+            ComputeAvx2<N, true>(q, poses, &jacobians);
+            return;
+        }
+#endif
+        ComputeAll<detail::ScalarPack, N, true>(q, poses, &jacobians);
+    }
+
+    /** Kinematic parameters in use */
+    const DhParams& params() const { return params_; }
+
+    /** Number of configurations processed per instruction on this CPU */
+    size_t simd_width() const { return use_avx2_ ? 4 : 1; }
+
+private:
+#if FLEXIV_TELEOP_HAS_AVX2
+    /** The AVX2 kernel, with everything it calls inlined so it is all compiled for AVX2 */
+    template <size_t N, bool kWithJacobian>
+    FLEXIV_TELEOP_AVX2_TARGET __attribute__((flatten)) void ComputeAvx2(
+        const JointBatch<N>& q, PoseBatch<N>& poses, JacobianBatch<N>* jacobians) const
+    {
+        ComputeAll<detail::Avx2Pack, N, kWithJacobian>(q, poses, jacobians);
+    }
+#endif
+
+    /** Run the kernel of one pack type over all configurations */
+    template <class Pack, size_t N, bool kWithJacobian>
+    void ComputeAll(const JointBatch<N>& q, PoseBatch<N>& poses, JacobianBatch<N>* jacobians) const
+    {
+        for (size_t k = 0; k < N; k += Pack::kWidth) {
+            ComputeLanes<Pack, N, kWithJacobian>(q, k, poses, jacobians);
+        }
+    }
+
+    /** Chain the link transforms of the configurations in lanes [k, k + kWidth) */
+    template <class Pack, size_t N, bool kWithJacobian>
+    void ComputeLanes(const JointBatch<N>& q, size_t k, PoseBatch<N>& poses,
+        JacobianBatch<N>* jacobians) const
+    {
+        using Vec3 = detail::Vec3Pack<Pack>;
+
+        // Frame of the current link: rotation columns and origin, starting at the world frame
+        const Pack zero = Pack::Broadcast(0.0), one = Pack::Broadcast(1.0);
+        Vec3 col_x {one, zero, zero}, col_y {zero, one, zero}, col_z {zero, zero, one};
+        Vec3 origin {zero, zero, zero};
+        std::array<Vec3, kJointDoF> z_axes, origins;
+
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            // Joint i rotates about z of frame i-1
+            if (kWithJacobian) {
+                z_axes[i] = col_z;
+                origins[i] = origin;
+            }
+            Pack st, ct;
+            detail::SinCos(Pack::Load(&q.q[i][k]) + Pack::Broadcast(params_.theta_offset[i]),
+                st, ct);
+            const Pack ca = Pack::Broadcast(cos_alpha_[i]);
+            const Pack sa = Pack::Broadcast(sin_alpha_[i]);
+
+            // R * Rz(theta) gives u, v; R * Rx(alpha) then mixes v with the old z column
+            const Vec3 u {MulAdd(col_x.x, ct, col_y.x * st), MulAdd(col_x.y, ct, col_y.y * st),
+                MulAdd(col_x.z, ct, col_y.z * st)};
+            const Vec3 v {MulAdd(col_y.x, ct, -(col_x.x * st)),
+                MulAdd(col_y.y, ct, -(col_x.y * st)), MulAdd(col_y.z, ct, -(col_x.z * st))};
+
+            // p += R * [a cos(theta), a sin(theta), d] = a u + d z
+            const Pack a = Pack::Broadcast(params_.a[i]);
+            const Pack d = Pack::Broadcast(params_.d[i]);
+            origin = {MulAdd(a, u.x, MulAdd(d, col_z.x, origin.x)),
+                MulAdd(a, u.y, MulAdd(d, col_z.y, origin.y)),
+                MulAdd(a, u.z, MulAdd(d, col_z.z, origin.z))};
+
+            const Vec3 z_new {MulAdd(col_z.x, ca, -(v.x * sa)),
+                MulAdd(col_z.y, ca, -(v.y * sa)), MulAdd(col_z.z, ca, -(v.z * sa))};
+            col_y = {MulAdd(v.x, ca, col_z.x * sa), MulAdd(v.y, ca, col_z.y * sa),
+                MulAdd(v.z, ca, col_z.z * sa)};
+            col_x = u;
+            col_z = z_new;
+        }
+
+        // TCP = T * flange_to_tcp
+        const Eigen::Matrix3d& R_f = params_.flange_to_tcp.linear();
+        const Eigen::Vector3d& p_f = params_.flange_to_tcp.translation();
+        Vec3 tcp_cols[3];
+        for (size_t c = 0; c < 3; ++c) {
+            tcp_cols[c] = Transform(col_x, col_y, col_z, R_f.col(c), {zero, zero, zero});
+        }
+        const Vec3 p_tcp = Transform(col_x, col_y, col_z, p_f, origin);
+
+        for (size_t c = 0; c < 3; ++c) {
+            tcp_cols[c].x.Store(&poses.rotation[0][c][k]);
+            tcp_cols[c].y.Store(&poses.rotation[1][c][k]);
+            tcp_cols[c].z.Store(&poses.rotation[2][c][k]);
+        }
+        p_tcp.x.Store(&poses.translation[0][k]);
+        p_tcp.y.Store(&poses.translation[1][k]);
+        p_tcp.z.Store(&poses.translation[2][k]);
+
+        if (kWithJacobian) {
+            for (size_t i = 0; i < kJointDoF; ++i) {
+                const Vec3& z = z_axes[i];
+                const Vec3 linear = detail::Cross(z,
+                    {p_tcp.x - origins[i].x, p_tcp.y - origins[i].y, p_tcp.z - origins[i].z});
+                linear.x.Store(&jacobians->data[0][i][k]);
+                linear.y.Store(&jacobians->data[1][i][k]);
+                linear.z.Store(&jacobians->data[2][i][k]);
+                z.x.Store(&jacobians->data[3][i][k]);
+                z.y.Store(&jacobians->data[4][i][k]);
+                z.z.Store(&jacobians->data[5][i][k]);
+            }
+        }
+    }
+
+    /** offset + [x y z] w, a lambda would not be compiled for AVX2 along with its caller */
+    template <class Pack>
+    static detail::Vec3Pack<Pack> Transform(const detail::Vec3Pack<Pack>& x,
+        const detail::Vec3Pack<Pack>& y, const detail::Vec3Pack<Pack>& z,
+        const Eigen::Vector3d& w, const detail::Vec3Pack<Pack>& offset)
+    {
+        const Pack w0 = Pack::Broadcast(w[0]), w1 = Pack::Broadcast(w[1]),
+                   w2 = Pack::Broadcast(w[2]);
+        return {MulAdd(x.x, w0, MulAdd(y.x, w1, MulAdd(z.x, w2, offset.x))),
+            MulAdd(x.y, w0, MulAdd(y.y, w1, MulAdd(z.y, w2, offset.y))),
+            MulAdd(x.z, w0, MulAdd(y.z, w1, MulAdd(z.z, w2, offset.z)))};
+    }
+
+    DhParams params_;
+    JointArray cos_alpha_ = {};
+    JointArray sin_alpha_ = {};
+    bool use_avx2_ = false;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
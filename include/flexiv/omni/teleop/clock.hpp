@@ -0,0 +1,123 @@
+/**
+ * @file clock.hpp
+ * @brief Time sources used to timestamp teleop data.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @brief Current time of the monotonic steady clock.
+ * @return Time since an arbitrary epoch [ns].
+ */
+inline int64_t SteadyTimeNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @class Clock
+ * @brief Time source of the teleop nodes. Production nodes use the steady clock; replay and
+ * simulation substitute their own so that runs are reproducible and can go faster than real
+ * time.
+ */
+class Clock
+{
+public:
+    virtual ~Clock() = default;
+
+    /** [Real-time] Current time [ns] */
+    virtual int64_t NowNs() const = 0;
+};
+
+/**
+ * @class SteadyClock
+ * @brief Clock backed by the monotonic steady clock, see SteadyTimeNs().
+ */
+class SteadyClock : public Clock
+{
+public:
+    int64_t NowNs() const override { return SteadyTimeNs(); }
+};
+
+/**
+ * @class ManualClock
+ * @brief Clock that only moves when told to, for deterministic replay and simulation.
+ */
+class ManualClock : public Clock
+{
+public:
+    /**
+     * @param[in] start_ns Initial time [ns].
+     */
+    explicit ManualClock(int64_t start_ns = 0)
+    : now_ns_(start_ns)
+    {
+    }
+
+    int64_t NowNs() const override { return now_ns_; }
+
+    /** Jump to a time [ns] */
+    void Set(int64_t now_ns) { now_ns_ = now_ns; }
+
+    /** Move forward by a duration [ns] */
+    void Advance(int64_t duration_ns) { now_ns_ += duration_ns; }
+
+private:
+    int64_t now_ns_;
+};
+
+/**
+ * @class SkewedClock
+ * @brief Clock that runs offset from and at a different rate than a base clock, to emulate two
+ * hosts whose clocks disagree, e.g. to exercise ClockSync over loopback.
+ */
+class SkewedClock : public Clock
+{
+public:
+    /**
+     * @param[in] base Clock to derive from, must outlive this one.
+     * @param[in] offset_ns Offset from the base clock at construction [ns].
+     * @param[in] drift_ppm Rate at which this clock runs faster than the base clock [ppm].
+     */
+    SkewedClock(const Clock& base, int64_t offset_ns, double drift_ppm)
+    : base_(base)
+    , start_ns_(base.NowNs())
+    , offset_ns_(offset_ns)
+    , drift_(drift_ppm * 1e-6)
+    {
+    }
+
+    int64_t NowNs() const override
+    {
+        const int64_t base_ns = base_.NowNs();
+        return base_ns + offset_ns_
+               + static_cast<int64_t>(drift_ * static_cast<double>(base_ns - start_ns_));
+    }
+
+private:
+    const Clock& base_;
+    int64_t start_ns_;
+    int64_t offset_ns_;
+    double drift_;
+};
+
+/** Shared steady clock used by default wherever a Clock is taken */
+inline const Clock& DefaultClock()
+{
+    static const SteadyClock clock;
+    return clock;
+}
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,222 @@
+/**
+ * @file clock_sync.hpp
+ * @brief NTP-style estimation of the offset and drift between the clocks of two teleop nodes.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct ClockSyncEstimate
+ * @brief Current estimate of the peer clock relative to the local clock.
+ */
+struct ClockSyncEstimate
+{
+    /** Whether enough exchanges were seen for the estimate to be usable */
+    bool valid = false;
+
+    /** Peer clock minus local clock, at the local time of the latest exchange [ns] */
+    int64_t offset_ns = 0;
+
+    /** Rate at which the peer clock runs faster than the local clock [ppm] */
+    double drift_ppm = 0.0;
+
+    /** Smallest network round-trip time seen in the latest block, excluding peer hold time [ns] */
+    int64_t round_trip_ns = 0;
+
+    /** Number of timestamp exchanges processed */
+    uint64_t exchange_count = 0;
+};
+
+/**
+ * @class ClockSync
+ * @brief Estimates the offset and drift of the peer's clock from the four timestamps of each
+ * request/echo exchange, like NTP: t1 local send, t2 peer receive, t3 peer send, t4 local
+ * receive. Each exchange gives offset ((t2 - t1) + (t3 - t4)) / 2 and delay (t4 - t1) - (t3 - t2).
+ * Queuing delay in either direction corrupts the offset, so exchanges are grouped in blocks and
+ * only the one with the smallest delay in each block is kept (the NTP clock filter). A least
+ * squares line through the kept offsets of the latest blocks gives the drift, and the offset is
+ * read off that line, so it stays accurate between blocks while the clocks drift apart.
+ * Fixed-size storage, no allocation.
+ */
+class ClockSync
+{
+public:
+    /** Maximum number of blocks the drift is fitted over */
+    static constexpr size_t kMaxWindowBlocks = 128;
+
+    /**
+     * @param[in] block_size Number of exchanges per block, the best of which is kept.
+     * @param[in] window_blocks Number of latest blocks the drift is fitted over, at most
+     * kMaxWindowBlocks.
+     */
+    explicit ClockSync(size_t block_size = 100, size_t window_blocks = 100)
+    : block_size_(std::max<size_t>(block_size, 1))
+    , window_blocks_(std::clamp<size_t>(window_blocks, 2, kMaxWindowBlocks))
+    {
+    }
+
+    /**
+     * @brief [Real-time] Add one exchange. Exchanges with missing or inconsistent timestamps are
+     * ignored.
+     * @param[in] t1 Local time the request was sent [ns].
+     * @param[in] t2 Peer time the request was received [ns].
+     * @param[in] t3 Peer time the echo was sent [ns].
+     * @param[in] t4 Local time the echo was received [ns].
+     * @return Network round-trip time of the exchange, excluding the peer's hold time, or -1 if
+     * the exchange was ignored [ns].
+     */
+    int64_t AddExchange(int64_t t1, int64_t t2, int64_t t3, int64_t t4)
+    {
+        const int64_t delay = (t4 - t1) - (t3 - t2);
+        if (t1 == 0 || t2 == 0 || t4 < t1 || t3 < t2 || delay < 0) {
+            return -1;
+        }
+        ++estimate_.exchange_count;
+        if (delay < block_best_delay_) {
+            block_best_delay_ = delay;
+            block_best_offset_ = ((t2 - t1) + (t3 - t4)) / 2;
+            // Centre of the exchange on the local clock
+            block_best_time_ = t1 + (t4 - t1) / 2;
+        }
+        if (++block_count_ < block_size_) {
+            return delay;
+        }
+
+        // Block complete: keep its best exchange and refit
+        blocks_[next_block_] = {block_best_time_, block_best_offset_};
+        next_block_ = (next_block_ + 1) % window_blocks_;
+        block_total_ = std::min(block_total_ + 1, window_blocks_);
+        estimate_.round_trip_ns = block_best_delay_;
+        block_count_ = 0;
+        block_best_delay_ = std::numeric_limits<int64_t>::max();
+        Fit();
+        return delay;
+    }
+
+    /**
+     * @brief [Real-time] Peer clock minus local clock at a given local time.
+     * @param[in] local_time_ns Local time [ns].
+     * @return Offset [ns], 0 until the estimate is valid.
+     */
+    int64_t OffsetAt(int64_t local_time_ns) const
+    {
+        if (!estimate_.valid) {
+            return 0;
+        }
+        return fit_offset_
+               + static_cast<int64_t>(
+                   fit_drift_ * static_cast<double>(local_time_ns - fit_reference_time_));
+    }
+
+    /**
+     * @brief [Real-time] Convert a peer timestamp to the local timebase.
+     * @param[in] peer_time_ns Time on the peer clock [ns].
+     * @return Same instant on the local clock [ns].
+     */
+    int64_t PeerToLocal(int64_t peer_time_ns) const
+    {
+        // OffsetAt() takes a local time, and the peer time is off from it by the whole offset,
+        // which the drift would turn into a large error. The offset at the reference time gives
+        // a local time off by the drift since then only, one more step leaves its square
+        const int64_t local_time_ns = peer_time_ns - OffsetAt(fit_reference_time_);
+        return peer_time_ns - OffsetAt(local_time_ns);
+    }
+
+    /**
+     * @brief [Real-time] Convert a local timestamp to the peer timebase.
+     * @param[in] local_time_ns Time on the local clock [ns].
+     * @return Same instant on the peer clock [ns].
+     */
+    int64_t LocalToPeer(int64_t local_time_ns) const
+    {
+        return local_time_ns + OffsetAt(local_time_ns);
+    }
+
+    /** Current estimate */
+    ClockSyncEstimate estimate() const
+    {
+        ClockSyncEstimate estimate = estimate_;
+        estimate.offset_ns = OffsetAt(fit_reference_time_);
+        estimate.drift_ppm = fit_drift_ * 1e6;
+        return estimate;
+    }
+
+    /** Forget all exchanges, e.g. after the peer restarted */
+    void Reset()
+    {
+        *this = ClockSync(block_size_, window_blocks_);
+    }
+
+private:
+    struct Block
+    {
+        int64_t time_ns;
+        int64_t offset_ns;
+    };
+
+    void Fit()
+    {
+        // Least squares line offset = a + b * (t - t_ref), centred on the newest block for
+        // numerical conditioning
+        const size_t newest = (next_block_ + window_blocks_ - 1) % window_blocks_;
+        const int64_t t_ref = blocks_[newest].time_ns;
+        if (block_total_ < kMinFitBlocks) {
+            fit_offset_ = blocks_[newest].offset_ns;
+            fit_drift_ = 0.0;
+            fit_reference_time_ = t_ref;
+            estimate_.valid = true;
+            return;
+        }
+        double sum_t = 0.0, sum_o = 0.0, sum_tt = 0.0, sum_to = 0.0;
+        const int64_t o_ref = blocks_[newest].offset_ns;
+        for (size_t i = 0; i < block_total_; ++i) {
+            const double t = static_cast<double>(blocks_[i].time_ns - t_ref);
+            const double o = static_cast<double>(blocks_[i].offset_ns - o_ref);
+            sum_t += t;
+            sum_o += o;
+            sum_tt += t * t;
+            sum_to += t * o;
+        }
+        const double n = static_cast<double>(block_total_);
+        const double denominator = n * sum_tt - sum_t * sum_t;
+        fit_drift_ = denominator > 0.0 ? (n * sum_to - sum_t * sum_o) / denominator : 0.0;
+        const double intercept = (sum_o - fit_drift_ * sum_t) / n;
+        fit_offset_ = o_ref + static_cast<int64_t>(intercept);
+        fit_reference_time_ = t_ref;
+        estimate_.valid = true;
+    }
+
+    /** Blocks needed before drift is fitted rather than assumed zero */
+    static constexpr size_t kMinFitBlocks = 4;
+
+    size_t block_size_;
+    size_t window_blocks_;
+
+    size_t block_count_ = 0;
+    int64_t block_best_delay_ = std::numeric_limits<int64_t>::max();
+    int64_t block_best_offset_ = 0;
+    int64_t block_best_time_ = 0;
+
+    std::array<Block, kMaxWindowBlocks> blocks_ = {};
+    size_t next_block_ = 0;
+    size_t block_total_ = 0;
+
+    int64_t fit_offset_ = 0;
+    double fit_drift_ = 0.0;
+    int64_t fit_reference_time_ = 0;
+    ClockSyncEstimate estimate_;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
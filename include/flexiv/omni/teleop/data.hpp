@@ -0,0 +1,71 @@
+/**
+ * @file data.hpp
+ * @brief Constants and data structures shared by leader and follower.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/** Joint-space degrees of freedom of the supported arms */
+constexpr size_t kJointDoF = 7;
+
+/** Size of pose arrays: position [x y z] in [m] followed by quaternion [qw qx qy qz] */
+constexpr size_t kPoseSize = 7;
+
+/** Cartesian-space degrees of freedom: linear [x y z] followed by angular [rx ry rz] */
+constexpr size_t kCartDoF = 6;
+
+/** Period of the teleop control loop [s] */
+constexpr double kLoopPeriod = 0.001;
+
+/** Period of the teleop control loop [ns] */
+constexpr int64_t kLoopPeriodNs = 1000000;
+
+/** Joint-space array, e.g. positions, velocities, torques */
+using JointArray = std::array<double, kJointDoF>;
+
+/** Pose array in [x y z qw qx qy qz] format */
+using PoseArray = std::array<double, kPoseSize>;
+
+/** Cartesian-space array, e.g. twists and wrenches */
+using CartArray = std::array<double, kCartDoF>;
+
+/**
+ * @struct RobotStates
+ * @brief Measured states of one arm. All Cartesian quantities are expressed in the world frame.
+ */
+struct RobotStates
+{
+    /** Joint positions [rad] */
+    JointArray q = {};
+
+    /** Joint velocities [rad/s] */
+    JointArray dq = {};
+
+    /** Measured joint torques [Nm] */
+    JointArray tau = {};
+
+    /** Estimated external joint torques, i.e. torques applied by the environment [Nm] */
+    JointArray tau_ext = {};
+
+    /** TCP pose [m][] */
+    PoseArray tcp_pose = {};
+
+    /** TCP velocity [m/s][rad/s] */
+    CartArray tcp_vel = {};
+
+    /** Estimated external wrench applied on TCP [N][Nm] */
+    CartArray ext_wrench_in_world = {};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,1023 @@
+/**
+ * @file encryption.hpp
+ * @brief Authenticated encryption of teleop packets for links over untrusted networks.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "epoch_tracker.hpp"
+#include "transport.hpp"
+
+#include <sys/random.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define FLEXIV_TELEOP_HAS_AES_NI 1
+#else
+#define FLEXIV_TELEOP_HAS_AES_NI 0
+#endif
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/** Magic number at the start of every encrypted datagram, "FOTE" in little-endian byte order */
+constexpr uint32_t kEncryptedPacketMagic = 0x45544F46;
+
+/** Size of a session key [bytes] */
+constexpr size_t kAeadKeySize = 32;
+
+/** Size of the authentication tag appended to every datagram [bytes] */
+constexpr size_t kAeadTagSize = 16;
+
+/** Session key shared by both ends */
+using AeadKey = std::array<uint8_t, kAeadKeySize>;
+
+/**
+ * @enum AeadCipher
+ * @brief Authenticated cipher, both ends must use the same.
+ */
+enum class AeadCipher : uint8_t
+{
+    /** AES-256 in Galois/counter mode, needs the AES-NI and PCLMULQDQ instructions */
+    kAes256Gcm = 1,
+
+    /** ChaCha20-Poly1305 of RFC 8439, fast in plain C++ on any CPU */
+    kChaCha20Poly1305 = 2,
+};
+
+/**
+ * @brief Whether this CPU runs AES-256-GCM with the AES-NI and PCLMULQDQ instructions.
+ */
+inline bool HasAesNi()
+{
+#if FLEXIV_TELEOP_HAS_AES_NI
+    static const bool supported = __builtin_cpu_supports("aes") && __builtin_cpu_supports("pclmul")
+                                  && __builtin_cpu_supports("ssse3");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Fastest cipher on this CPU: AES-256-GCM with AES-NI if available, else
+ * ChaCha20-Poly1305. Both ends must agree, so pick explicitly if the hosts differ.
+ */
+inline AeadCipher DefaultAeadCipher()
+{
+    return HasAesNi() ? AeadCipher::kAes256Gcm : AeadCipher::kChaCha20Poly1305;
+}
+
+/**
+ * @brief Draw a session key from the kernel's random number generator.
+ * @throw std::runtime_error if the kernel has no randomness to give.
+ */
+inline AeadKey GenerateAeadKey()
+{
+    AeadKey key;
+    size_t filled = 0;
+    while (filled < key.size()) {
+        const ssize_t ret = ::getrandom(key.data() + filled, key.size() - filled, 0);
+        if (ret < 0 && errno != EINTR) {
+            throw std::runtime_error(
+                std::string("[flexiv::omni::teleop::GenerateAeadKey] getrandom failed: ")
+                + std::strerror(errno));
+        }
+        filled += ret > 0 ? static_cast<size_t>(ret) : 0;
+    }
+    return key;
+}
+
+namespace detail {
+
+inline uint32_t LoadLe32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+           | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t LoadLe64(const uint8_t* p)
+{
+    return static_cast<uint64_t>(LoadLe32(p)) | (static_cast<uint64_t>(LoadLe32(p + 4)) << 32);
+}
+
+inline void StoreLe32(uint8_t* p, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<uint8_t>(v >> (8 * i));
+    }
+}
+
+inline void StoreLe64(uint8_t* p, uint64_t v)
+{
+    StoreLe32(p, static_cast<uint32_t>(v));
+    StoreLe32(p + 4, static_cast<uint32_t>(v >> 32));
+}
+
+/** Compare two tags in time independent of where they differ */
+inline bool TagsEqual(const uint8_t* a, const uint8_t* b)
+{
+    uint8_t diff = 0;
+    for (size_t i = 0; i < kAeadTagSize; ++i) {
+        diff |= a[i] ^ b[i];
+    }
+    return diff == 0;
+}
+
+/**
+ * @class ChaCha20Poly1305
+ * @brief ChaCha20-Poly1305 AEAD of RFC 8439 with a 96-bit nonce.
+ */
+class ChaCha20Poly1305
+{
+public:
+    explicit ChaCha20Poly1305(const AeadKey& key)
+    {
+        for (size_t i = 0; i < 8; ++i) {
+            key_[i] = LoadLe32(key.data() + 4 * i);
+        }
+    }
+
+    /**
+     * @brief HChaCha20 of XChaCha20 (draft-irtf-cfrg-xchacha): a subkey derived from a key and a
+     * 16-byte input, unrelated to the subkeys of any other input.
+     */
+    static AeadKey HChaCha20(const AeadKey& key, const uint8_t* input)
+    {
+        uint32_t x[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+        for (size_t i = 0; i < 8; ++i) {
+            x[4 + i] = LoadLe32(key.data() + 4 * i);
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            x[12 + i] = LoadLe32(input + 4 * i);
+        }
+        Rounds(x);
+        AeadKey subkey;
+        for (size_t i = 0; i < 4; ++i) {
+            StoreLe32(subkey.data() + 4 * i, x[i]);
+            StoreLe32(subkey.data() + 16 + 4 * i, x[12 + i]);
+        }
+        return subkey;
+    }
+
+    /** Encrypt data in place and compute its tag over aad and the ciphertext */
+    void Seal(const uint8_t* nonce, const uint8_t* aad, size_t aad_size, uint8_t* data,
+        size_t size, uint8_t* tag) const
+    {
+        Poly1305 mac = MakeMac(nonce);
+        Crypt(nonce, data, size);
+        Authenticate(mac, aad, aad_size, data, size, tag);
+    }
+
+    /** Check the tag over aad and the ciphertext, then decrypt data in place if it matches */
+    bool Open(const uint8_t* nonce, const uint8_t* aad, size_t aad_size, uint8_t* data,
+        size_t size, const uint8_t* tag) const
+    {
+        Poly1305 mac = MakeMac(nonce);
+        uint8_t expected[kAeadTagSize];
+        Authenticate(mac, aad, aad_size, data, size, expected);
+        if (!TagsEqual(expected, tag)) {
+            return false;
+        }
+        Crypt(nonce, data, size);
+        return true;
+    }
+
+private:
+    /** One-time authenticator with 44/44/42-bit limbs */
+    class Poly1305
+    {
+    public:
+        explicit Poly1305(const uint8_t* key)
+        {
+            const uint64_t t0 = LoadLe64(key), t1 = LoadLe64(key + 8);
+            r0_ = t0 & 0xffc0fffffff;
+            r1_ = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffff;
+            r2_ = (t1 >> 24) & 0x00ffffffc0f;
+            s1_ = r1_ * (5 << 2);
+            s2_ = r2_ * (5 << 2);
+            pad0_ = LoadLe64(key + 16);
+            pad1_ = LoadLe64(key + 24);
+        }
+
+        /** Absorb one full 16-byte block */
+        void Block(const uint8_t* m)
+        {
+            using u128 = unsigned __int128;
+            const uint64_t t0 = LoadLe64(m), t1 = LoadLe64(m + 8);
+            h0_ += t0 & kMask44;
+            h1_ += ((t0 >> 44) | (t1 << 20)) & kMask44;
+            h2_ += ((t1 >> 24) & kMask42) | (1ull << 40);
+            const u128 d0 = static_cast<u128>(h0_) * r0_ + static_cast<u128>(h1_) * s2_
+                            + static_cast<u128>(h2_) * s1_;
+            u128 d1 = static_cast<u128>(h0_) * r1_ + static_cast<u128>(h1_) * r0_
+                      + static_cast<u128>(h2_) * s2_;
+            u128 d2 = static_cast<u128>(h0_) * r2_ + static_cast<u128>(h1_) * r1_
+                      + static_cast<u128>(h2_) * r0_;
+            uint64_t c = static_cast<uint64_t>(d0 >> 44);
+            h0_ = static_cast<uint64_t>(d0) & kMask44;
+            d1 += c;
+            c = static_cast<uint64_t>(d1 >> 44);
+            h1_ = static_cast<uint64_t>(d1) & kMask44;
+            d2 += c;
+            c = static_cast<uint64_t>(d2 >> 42);
+            h2_ = static_cast<uint64_t>(d2) & kMask42;
+            h0_ += c * 5;
+            c = h0_ >> 44;
+            h0_ &= kMask44;
+            h1_ += c;
+        }
+
+        /** Final tag */
+        void Finish(uint8_t* tag)
+        {
+            // Fully carry h, then subtract p = 2^130 - 5 if h >= p
+            uint64_t c = h1_ >> 44;
+            h1_ &= kMask44;
+            h2_ += c;
+            c = h2_ >> 42;
+            h2_ &= kMask42;
+            h0_ += c * 5;
+            c = h0_ >> 44;
+            h0_ &= kMask44;
+            h1_ += c;
+            c = h1_ >> 44;
+            h1_ &= kMask44;
+            h2_ += c;
+            c = h2_ >> 42;
+            h2_ &= kMask42;
+            h0_ += c * 5;
+            c = h0_ >> 44;
+            h0_ &= kMask44;
+            h1_ += c;
+
+            uint64_t g0 = h0_ + 5;
+            c = g0 >> 44;
+            g0 &= kMask44;
+            uint64_t g1 = h1_ + c;
+            c = g1 >> 44;
+            g1 &= kMask44;
+            uint64_t g2 = h2_ + c - (1ull << 42);
+            c = (g2 >> 63) - 1;
+            g0 &= c;
+            g1 &= c;
+            g2 &= c;
+            c = ~c;
+            h0_ = (h0_ & c) | g0;
+            h1_ = (h1_ & c) | g1;
+            h2_ = (h2_ & c) | g2;
+
+            // h + pad mod 2^128
+            h0_ += pad0_ & kMask44;
+            c = h0_ >> 44;
+            h0_ &= kMask44;
+            h1_ += (((pad0_ >> 44) | (pad1_ << 20)) & kMask44) + c;
+            c = h1_ >> 44;
+            h1_ &= kMask44;
+            h2_ += ((pad1_ >> 24) & kMask42) + c;
+            h2_ &= kMask42;
+            StoreLe64(tag, h0_ | (h1_ << 44));
+            StoreLe64(tag + 8, (h1_ >> 20) | (h2_ << 24));
+        }
+
+    private:
+        static constexpr uint64_t kMask44 = 0xfffffffffff;
+        static constexpr uint64_t kMask42 = 0x3ffffffffff;
+        uint64_t r0_, r1_, r2_, s1_, s2_, pad0_, pad1_;
+        uint64_t h0_ = 0, h1_ = 0, h2_ = 0;
+    };
+
+    static uint32_t Rotl(uint32_t v, int n) { return (v << n) | (v >> (32 - n)); }
+
+    static void QuarterRound(uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d)
+    {
+        a += b;
+        d = Rotl(d ^ a, 16);
+        c += d;
+        b = Rotl(b ^ c, 12);
+        a += b;
+        d = Rotl(d ^ a, 8);
+        c += d;
+        b = Rotl(b ^ c, 7);
+    }
+
+    /** The 20 rounds of the ChaCha20 block function, in place */
+    static void Rounds(uint32_t* x)
+    {
+        for (int i = 0; i < 10; ++i) {
+            QuarterRound(x[0], x[4], x[8], x[12]);
+            QuarterRound(x[1], x[5], x[9], x[13]);
+            QuarterRound(x[2], x[6], x[10], x[14]);
+            QuarterRound(x[3], x[7], x[11], x[15]);
+            QuarterRound(x[0], x[5], x[10], x[15]);
+            QuarterRound(x[1], x[6], x[11], x[12]);
+            QuarterRound(x[2], x[7], x[8], x[13]);
+            QuarterRound(x[3], x[4], x[9], x[14]);
+        }
+    }
+
+    /** One 64-byte key stream block */
+    void KeyBlock(const uint8_t* nonce, uint32_t counter, uint8_t* out) const
+    {
+        uint32_t state[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574, key_[0], key_[1],
+            key_[2], key_[3], key_[4], key_[5], key_[6], key_[7], counter, LoadLe32(nonce),
+            LoadLe32(nonce + 4), LoadLe32(nonce + 8)};
+        uint32_t x[16];
+        std::memcpy(x, state, sizeof(x));
+        Rounds(x);
+        for (int i = 0; i < 16; ++i) {
+            StoreLe32(out + 4 * i, x[i] + state[i]);
+        }
+    }
+
+    /** The Poly1305 key is the first half of key stream block 0 */
+    std::array<uint8_t, 32> PolyKey(const uint8_t* nonce) const
+    {
+        uint8_t block[64];
+        KeyBlock(nonce, 0, block);
+        std::array<uint8_t, 32> key;
+        std::memcpy(key.data(), block, key.size());
+        return key;
+    }
+
+    Poly1305 MakeMac(const uint8_t* nonce) const { return Poly1305(PolyKey(nonce).data()); }
+
+    /** XOR data with the key stream from block 1 on */
+    void Crypt(const uint8_t* nonce, uint8_t* data, size_t size) const
+    {
+        uint8_t block[64];
+        for (size_t offset = 0, counter = 1; offset < size; offset += 64, ++counter) {
+            KeyBlock(nonce, static_cast<uint32_t>(counter), block);
+            const size_t n = std::min<size_t>(64, size - offset);
+            for (size_t i = 0; i < n; ++i) {
+                data[offset + i] ^= block[i];
+            }
+        }
+    }
+
+    /** MAC over aad, ciphertext, each zero-padded to 16 bytes, and their lengths */
+    static void Authenticate(Poly1305& mac, const uint8_t* aad, size_t aad_size,
+        const uint8_t* data, size_t size, uint8_t* tag)
+    {
+        for (const auto& [bytes, n] : {std::make_pair(aad, aad_size), std::make_pair(data, size)}) {
+            size_t offset = 0;
+            for (; offset + 16 <= n; offset += 16) {
+                mac.Block(bytes + offset);
+            }
+            if (offset < n) {
+                uint8_t last[16] = {};
+                std::memcpy(last, bytes + offset, n - offset);
+                mac.Block(last);
+            }
+        }
+        uint8_t lengths[16];
+        StoreLe64(lengths, aad_size);
+        StoreLe64(lengths + 8, size);
+        mac.Block(lengths);
+        mac.Finish(tag);
+    }
+
+    uint32_t key_[8];
+};
+
+#if FLEXIV_TELEOP_HAS_AES_NI
+
+#define FLEXIV_TELEOP_AES_NI_TARGET __attribute__((target("aes,pclmul,ssse3")))
+
+/**
+ * @class Aes256Gcm
+ * @brief AES-256-GCM with a 96-bit nonce, on the AES-NI and PCLMULQDQ instructions. Only
+ * construct it where HasAesNi() is true.
+ */
+class Aes256Gcm
+{
+public:
+    FLEXIV_TELEOP_AES_NI_TARGET explicit Aes256Gcm(const AeadKey& key) { Rekey(key); }
+
+    /** Switch to another key */
+    FLEXIV_TELEOP_AES_NI_TARGET void Rekey(const AeadKey& key)
+    {
+        ExpandKey(key.data());
+        h_powers_[0] = ByteSwap(EncryptBlock(_mm_setzero_si128()));
+        for (size_t i = 1; i < 4; ++i) {
+            h_powers_[i] = GfMul(h_powers_[i - 1], h_powers_[0]);
+        }
+    }
+
+    /** Encrypt data in place and compute its tag over aad and the ciphertext */
+    FLEXIV_TELEOP_AES_NI_TARGET void Seal(const uint8_t* nonce, const uint8_t* aad,
+        size_t aad_size, uint8_t* data, size_t size, uint8_t* tag) const
+    {
+        Crypt(nonce, data, size);
+        ComputeTag(nonce, aad, aad_size, data, size, tag);
+    }
+
+    /** Check the tag over aad and the ciphertext, then decrypt data in place if it matches */
+    FLEXIV_TELEOP_AES_NI_TARGET bool Open(const uint8_t* nonce, const uint8_t* aad,
+        size_t aad_size, uint8_t* data, size_t size, const uint8_t* tag) const
+    {
+        uint8_t expected[kAeadTagSize];
+        ComputeTag(nonce, aad, aad_size, data, size, expected);
+        if (!TagsEqual(expected, tag)) {
+            return false;
+        }
+        Crypt(nonce, data, size);
+        return true;
+    }
+
+private:
+    FLEXIV_TELEOP_AES_NI_TARGET static __m128i ByteSwap(__m128i x)
+    {
+        return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    }
+
+    FLEXIV_TELEOP_AES_NI_TARGET static __m128i ExpandStep(__m128i key, __m128i assist)
+    {
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+        return _mm_xor_si128(key, assist);
+    }
+
+    /** AES-256 key schedule: 15 round keys, the rcon of each step must be an immediate */
+    FLEXIV_TELEOP_AES_NI_TARGET void ExpandKey(const uint8_t* key)
+    {
+        __m128i* k = round_keys_;
+        k[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+        k[1] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key + 16));
+#define FLEXIV_TELEOP_AES_EXPAND(i, rcon)                                                         \
+    k[i] = ExpandStep(k[i - 2], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k[i - 1], rcon), 0xff)); \
+    k[i + 1] = ExpandStep(k[i - 1], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k[i], 0), 0xaa));
+        FLEXIV_TELEOP_AES_EXPAND(2, 0x01)
+        FLEXIV_TELEOP_AES_EXPAND(4, 0x02)
+        FLEXIV_TELEOP_AES_EXPAND(6, 0x04)
+        FLEXIV_TELEOP_AES_EXPAND(8, 0x08)
+        FLEXIV_TELEOP_AES_EXPAND(10, 0x10)
+        FLEXIV_TELEOP_AES_EXPAND(12, 0x20)
+#undef FLEXIV_TELEOP_AES_EXPAND
+        k[14] = ExpandStep(
+            k[12], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k[13], 0x40), 0xff));
+    }
+
+    FLEXIV_TELEOP_AES_NI_TARGET __m128i EncryptBlock(__m128i block) const
+    {
+        block = _mm_xor_si128(block, round_keys_[0]);
+        for (size_t i = 1; i < 14; ++i) {
+            block = _mm_aesenc_si128(block, round_keys_[i]);
+        }
+        return _mm_aesenclast_si128(block, round_keys_[14]);
+    }
+
+    /** Counter block: the nonce followed by a 32-bit big-endian counter */
+    FLEXIV_TELEOP_AES_NI_TARGET static __m128i CounterBlock(const uint8_t* nonce, uint32_t counter)
+    {
+        alignas(16) uint8_t block[16];
+        std::memcpy(block, nonce, 12);
+        block[12] = static_cast<uint8_t>(counter >> 24);
+        block[13] = static_cast<uint8_t>(counter >> 16);
+        block[14] = static_cast<uint8_t>(counter >> 8);
+        block[15] = static_cast<uint8_t>(counter);
+        return _mm_load_si128(reinterpret_cast<const __m128i*>(block));
+    }
+
+    /** XOR data with the key stream from counter 2 on, counter 1 masks the tag */
+    FLEXIV_TELEOP_AES_NI_TARGET void Crypt(const uint8_t* nonce, uint8_t* data, size_t size) const
+    {
+        uint32_t counter = 2;
+        size_t offset = 0;
+        // Four blocks through the rounds together hide the latency of AESENC
+        for (; offset + 64 <= size; offset += 64, counter += 4) {
+            __m128i b[4];
+            for (uint32_t i = 0; i < 4; ++i) {
+                b[i] = _mm_xor_si128(CounterBlock(nonce, counter + i), round_keys_[0]);
+            }
+            for (size_t r = 1; r < 14; ++r) {
+                for (auto& block : b) {
+                    block = _mm_aesenc_si128(block, round_keys_[r]);
+                }
+            }
+            for (size_t i = 0; i < 4; ++i) {
+                auto* p = reinterpret_cast<__m128i*>(data + offset + 16 * i);
+                _mm_storeu_si128(p, _mm_xor_si128(_mm_loadu_si128(p),
+                                        _mm_aesenclast_si128(b[i], round_keys_[14])));
+            }
+        }
+        for (; offset + 16 <= size; offset += 16) {
+            auto* p = reinterpret_cast<__m128i*>(data + offset);
+            _mm_storeu_si128(p,
+                _mm_xor_si128(_mm_loadu_si128(p), EncryptBlock(CounterBlock(nonce, counter++))));
+        }
+        if (offset < size) {
+            alignas(16) uint8_t stream[16];
+            _mm_store_si128(
+                reinterpret_cast<__m128i*>(stream), EncryptBlock(CounterBlock(nonce, counter)));
+            for (size_t i = 0; offset + i < size; ++i) {
+                data[offset + i] ^= stream[i];
+            }
+        }
+    }
+
+    /** Product in GF(2^128) of byte-swapped operands (Gueron and Kounavis, Intel, 2010) */
+    FLEXIV_TELEOP_AES_NI_TARGET static __m128i GfMul(__m128i a, __m128i b)
+    {
+        __m128i t3 = _mm_clmulepi64_si128(a, b, 0x00);
+        __m128i t4 = _mm_clmulepi64_si128(a, b, 0x10);
+        __m128i t5 = _mm_clmulepi64_si128(a, b, 0x01);
+        __m128i t6 = _mm_clmulepi64_si128(a, b, 0x11);
+        t4 = _mm_xor_si128(t4, t5);
+        t5 = _mm_slli_si128(t4, 8);
+        t4 = _mm_srli_si128(t4, 8);
+        t3 = _mm_xor_si128(t3, t5);
+        t6 = _mm_xor_si128(t6, t4);
+
+        // Shift the 256-bit product left by one, GCM's bit order is reflected
+        __m128i t7 = _mm_srli_epi32(t3, 31);
+        __m128i t8 = _mm_srli_epi32(t6, 31);
+        t3 = _mm_slli_epi32(t3, 1);
+        t6 = _mm_slli_epi32(t6, 1);
+        __m128i t9 = _mm_srli_si128(t7, 12);
+        t8 = _mm_slli_si128(t8, 4);
+        t7 = _mm_slli_si128(t7, 4);
+        t3 = _mm_or_si128(t3, t7);
+        t6 = _mm_or_si128(t6, t8);
+        t6 = _mm_or_si128(t6, t9);
+
+        // Reduce modulo x^128 + x^7 + x^2 + x + 1
+        t7 = _mm_slli_epi32(t3, 31);
+        t8 = _mm_slli_epi32(t3, 30);
+        t9 = _mm_slli_epi32(t3, 25);
+        t7 = _mm_xor_si128(t7, t8);
+        t7 = _mm_xor_si128(t7, t9);
+        t8 = _mm_srli_si128(t7, 4);
+        t7 = _mm_slli_si128(t7, 12);
+        t3 = _mm_xor_si128(t3, t7);
+        __m128i t2 = _mm_srli_epi32(t3, 1);
+        t4 = _mm_srli_epi32(t3, 2);
+        t5 = _mm_srli_epi32(t3, 7);
+        t2 = _mm_xor_si128(t2, t4);
+        t2 = _mm_xor_si128(t2, t5);
+        t2 = _mm_xor_si128(t2, t8);
+        t3 = _mm_xor_si128(t3, t2);
+        return _mm_xor_si128(t6, t3);
+    }
+
+    /** GHASH over aad and ciphertext, each zero-padded, and their bit lengths, then masked */
+    FLEXIV_TELEOP_AES_NI_TARGET void ComputeTag(const uint8_t* nonce, const uint8_t* aad,
+        size_t aad_size, const uint8_t* data, size_t size, uint8_t* tag) const
+    {
+        const __m128i h = h_powers_[0];
+        __m128i x = _mm_setzero_si128();
+        for (const auto& [bytes, n] : {std::make_pair(aad, aad_size), std::make_pair(data, size)}) {
+            size_t offset = 0;
+            // x * H^4 + b0 * H^4 + b1 * H^3 + b2 * H^2 + b3 * H: four independent products
+            for (; offset + 64 <= n; offset += 64) {
+                const auto* p = reinterpret_cast<const __m128i*>(bytes + offset);
+                x = _mm_xor_si128(
+                    _mm_xor_si128(GfMul(_mm_xor_si128(x, ByteSwap(_mm_loadu_si128(p))), h_powers_[3]),
+                        GfMul(ByteSwap(_mm_loadu_si128(p + 1)), h_powers_[2])),
+                    _mm_xor_si128(GfMul(ByteSwap(_mm_loadu_si128(p + 2)), h_powers_[1]),
+                        GfMul(ByteSwap(_mm_loadu_si128(p + 3)), h)));
+            }
+            for (; offset + 16 <= n; offset += 16) {
+                const __m128i block
+                    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + offset));
+                x = GfMul(_mm_xor_si128(x, ByteSwap(block)), h);
+            }
+            if (offset < n) {
+                alignas(16) uint8_t last[16] = {};
+                std::memcpy(last, bytes + offset, n - offset);
+                const __m128i block = _mm_load_si128(reinterpret_cast<const __m128i*>(last));
+                x = GfMul(_mm_xor_si128(x, ByteSwap(block)), h);
+            }
+        }
+        const __m128i lengths = _mm_set_epi64x(static_cast<long long>(aad_size) * 8,
+            static_cast<long long>(size) * 8);
+        x = GfMul(_mm_xor_si128(x, lengths), h);
+        x = _mm_xor_si128(ByteSwap(x), EncryptBlock(CounterBlock(nonce, 1)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(tag), x);
+    }
+
+    __m128i round_keys_[15];
+
+    /** H, H^2, H^3 and H^4, byte-swapped, H being the encrypted zero block */
+    __m128i h_powers_[4];
+};
+
+#endif /* FLEXIV_TELEOP_HAS_AES_NI */
+
+} /* namespace detail */
+
+/**
+ * @class Aead
+ * @brief Authenticated encryption with associated data under one session key, in place.
+ * Encrypting two messages with the same key and nonce breaks both ciphers, so every message
+ * under a key needs its own nonce.
+ */
+class Aead
+{
+public:
+    /**
+     * @param[in] cipher Cipher to use.
+     * @param[in] key Session key.
+     * @throw std::invalid_argument if AES-256-GCM is asked for and this CPU lacks AES-NI.
+     */
+    Aead(AeadCipher cipher, const AeadKey& key)
+    : cipher_(cipher)
+    , chacha_(key)
+    {
+        if (cipher == AeadCipher::kAes256Gcm) {
+#if FLEXIV_TELEOP_HAS_AES_NI
+            if (HasAesNi()) {
+                aes_ = std::make_unique<detail::Aes256Gcm>(key);
+                return;
+            }
+#endif
+            throw std::invalid_argument(
+                "[flexiv::omni::teleop::Aead] AES-256-GCM needs AES-NI, which this CPU lacks");
+        } else if (cipher != AeadCipher::kChaCha20Poly1305) {
+            throw std::invalid_argument("[flexiv::omni::teleop::Aead] Unknown cipher");
+        }
+    }
+
+    /**
+     * @brief [Real-time] Encrypt a message in place and compute its tag.
+     * @param[in] nonce 12-byte nonce, never used before with this key.
+     * @param[in] aad Data authenticated but not encrypted, e.g. a header.
+     * @param[in] aad_size Size of aad [bytes].
+     * @param[in,out] data Message, replaced by its ciphertext.
+     * @param[in] size Size of the message [bytes].
+     * @param[out] tag kAeadTagSize-byte authentication tag.
+     */
+    void Seal(const uint8_t* nonce, const uint8_t* aad, size_t aad_size, uint8_t* data,
+        size_t size, uint8_t* tag) const
+    {
+#if FLEXIV_TELEOP_HAS_AES_NI
+        if (aes_) {
+            aes_->Seal(nonce, aad, aad_size, data, size, tag);
+            return;
+        }
+#endif
+        chacha_.Seal(nonce, aad, aad_size, data, size, tag);
+    }
+
+    /**
+     * @brief [Real-time] Verify a ciphertext and its tag, and decrypt it in place if authentic.
+     * @return True if authentic, false if data or aad were tampered with, leaving data as is.
+     */
+    bool Open(const uint8_t* nonce, const uint8_t* aad, size_t aad_size, uint8_t* data,
+        size_t size, const uint8_t* tag) const
+    {
+#if FLEXIV_TELEOP_HAS_AES_NI
+        if (aes_) {
+            return aes_->Open(nonce, aad, aad_size, data, size, tag);
+        }
+#endif
+        return chacha_.Open(nonce, aad, aad_size, data, size, tag);
+    }
+
+    /**
+     * @brief [Real-time] Switch to another key of the same cipher, without allocating.
+     * @param[in] key New key.
+     */
+    void Rekey(const AeadKey& key)
+    {
+        chacha_ = detail::ChaCha20Poly1305(key);
+#if FLEXIV_TELEOP_HAS_AES_NI
+        if (aes_) {
+            aes_->Rekey(key);
+        }
+#endif
+    }
+
+    /** Cipher in use */
+    AeadCipher cipher() const { return cipher_; }
+
+private:
+    AeadCipher cipher_;
+    detail::ChaCha20Poly1305 chacha_;
+#if FLEXIV_TELEOP_HAS_AES_NI
+    std::unique_ptr<detail::Aes256Gcm> aes_;
+#endif
+};
+
+/**
+ * @enum EncryptionRole
+ * @brief Which end of the link a transport is. The two directions use disjoint nonces under the
+ * shared key, so the two ends must take different roles.
+ */
+enum class EncryptionRole : uint8_t
+{
+    kLeader = 0,
+    kFollower = 1,
+};
+
+/**
+ * @struct EncryptionParams
+ * @brief Session key and cipher of an EncryptedTransport.
+ */
+struct EncryptionParams
+{
+    /**
+     * Key shared by both ends, e.g. handed out by the session setup over TLS. Each transport
+     * encrypts under a subkey of it and a random salt of its own, so a restarted transport that
+     * counts its nonces from 1 again never reuses one. Datagrams recorded before a restart still
+     * authenticate under the same key though: the receiver drops those of every salt its peer
+     * left behind, but a restarted receiver knows none, so a fresh key per session is what rules
+     * out their replay for good.
+     */
+    AeadKey key = {};
+
+    /**
+     * Cipher, must match the peer's. The default is the fastest one on this CPU, see
+     * DefaultAeadCipher(): only AES-256-GCM with AES-NI meets the budget of 2 us per state
+     * packet. Set it explicitly if the two hosts' CPUs differ.
+     */
+    AeadCipher cipher = DefaultAeadCipher();
+
+    /** End of the link this transport is */
+    EncryptionRole role = EncryptionRole::kLeader;
+};
+
+/**
+ * @struct EncryptedPacketHeader
+ * @brief Header in front of every encrypted datagram, authenticated but not encrypted. The
+ * ciphertext follows it, and the tag ends the datagram.
+ */
+struct EncryptedPacketHeader
+{
+    uint32_t magic = kEncryptedPacketMagic;
+
+    /** Cipher, see AeadCipher */
+    uint8_t cipher = 0;
+
+    /** Role of the sender, see EncryptionRole */
+    uint8_t role = 0;
+
+    uint16_t reserved = 0;
+
+    /** Random value drawn by the sender when created, its subkey is derived from it */
+    uint64_t salt = 0;
+
+    /** Datagram counter of the sender, starting from 1, the nonce and the replay check */
+    uint64_t counter = 0;
+};
+static_assert(sizeof(EncryptedPacketHeader) == 24, "EncryptedPacketHeader must have no padding");
+
+/** Bytes each datagram grows by when encrypted */
+constexpr size_t kEncryptionOverhead = sizeof(EncryptedPacketHeader) + kAeadTagSize;
+
+/**
+ * @struct EncryptionStats
+ * @brief Traffic of an EncryptedTransport so far.
+ */
+struct EncryptionStats
+{
+    /** Messages encrypted and sent */
+    uint64_t sealed_count = 0;
+
+    /** Datagrams authenticated and decrypted */
+    uint64_t opened_count = 0;
+
+    /** Datagrams dropped for failing authentication: tampered, forged or under another key */
+    uint64_t auth_failure_count = 0;
+
+    /** Authentic datagrams dropped for having been received before, or being too old to tell */
+    uint64_t replay_count = 0;
+
+    /** Datagrams dropped for not being encrypted datagrams of this session's cipher and peer */
+    uint64_t rejected_count = 0;
+
+    /**
+     * Authentic datagrams dropped for carrying a salt not confirmed yet, the first few after the
+     * peer restarted
+     */
+    uint64_t unconfirmed_count = 0;
+
+    /** Times the peer started over with a new salt, i.e. restarted, and its counters with it */
+    uint64_t peer_restart_count = 0;
+};
+
+/**
+ * @class EncryptedTransport
+ * @brief Wraps a transport and encrypts and authenticates every message sent through it, for
+ * teleop over the public internet. Unlike a TLS or VPN tunnel it works per datagram: no
+ * handshake, no head-of-line blocking, a lost packet costs only itself. Each datagram carries
+ * the sender's salt and counter in the clear. The salt, drawn at random by every transport,
+ * selects the subkey the datagram is encrypted under, and the counter forms the nonce together
+ * with the sender's role, so no nonce is used twice under a subkey even when the key outlives the
+ * transport. The receiver rejects any counter it has seen before or that is older than a sliding
+ * window, so captured packets cannot be replayed. A new salt means the peer restarted: once an
+ * EpochTracker confirmed it over several authentic datagrams, it takes over and starts the window
+ * over, and every salt before it is retired for the transport's lifetime, so that datagrams
+ * recorded under it are never accepted again, however many. Anything that does not authenticate is
+ * dropped, nothing passes through unprotected. Messages are encrypted in place in a buffer
+ * allocated with the transport. Wrap it directly around the network transport, under any other
+ * decorators.
+ */
+class EncryptedTransport : public Transport
+{
+public:
+    /**
+     * @param[in] transport Wrapped transport, must outlive this one.
+     * @param[in] params Session key, cipher and role.
+     * @throw std::invalid_argument if the cipher is unavailable on this CPU.
+     */
+    EncryptedTransport(Transport& transport, const EncryptionParams& params)
+    : transport_(transport)
+    , key_(params.key)
+    , salt_(NewSalt())
+    , tx_aead_(params.cipher, SubKey(params.key, salt_))
+    , rx_aead_(params.cipher, params.key)
+    , candidate_aead_(params.cipher, params.key)
+    , role_(static_cast<uint8_t>(params.role))
+    {
+    }
+
+    bool Send(const void* data, size_t size) override
+    {
+        if (size + kEncryptionOverhead > kMaxMessageSize) {
+            return false;
+        }
+        EncryptedPacketHeader header;
+        header.cipher = static_cast<uint8_t>(tx_aead_.cipher());
+        header.role = role_;
+        header.salt = salt_;
+        header.counter = ++counter_;
+        std::memcpy(tx_buffer_.data(), &header, sizeof(header));
+        uint8_t* payload = tx_buffer_.data() + sizeof(header);
+        std::memcpy(payload, data, size);
+        uint8_t nonce[12];
+        MakeNonce(header, nonce);
+        tx_aead_.Seal(nonce, tx_buffer_.data(), sizeof(header), payload, size, payload + size);
+        ++stats_.sealed_count;
+        return transport_.Send(tx_buffer_.data(), size + kEncryptionOverhead);
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        size_t size;
+        while ((size = transport_.Receive(rx_buffer_.data(), rx_buffer_.size())) > 0) {
+            EncryptedPacketHeader header;
+            if (size < kEncryptionOverhead) {
+                ++stats_.rejected_count;
+                continue;
+            }
+            std::memcpy(&header, rx_buffer_.data(), sizeof(header));
+            // Packets of our own role would be our own, reflected back
+            if (header.magic != kEncryptedPacketMagic
+                || header.cipher != static_cast<uint8_t>(rx_aead_.cipher())
+                || header.role == role_ || header.role > 1 || header.counter == 0) {
+                ++stats_.rejected_count;
+                continue;
+            }
+            const bool new_salt = !salts_.started() || header.salt != salts_.current();
+            // Datagrams under a salt left behind are as stale as replayed ones
+            if (new_salt ? salts_.IsRetired(header.salt) : !replay_window_.Check(header.counter)) {
+                ++stats_.replay_count;
+                continue;
+            }
+            const size_t payload_size = size - kEncryptionOverhead;
+            uint8_t* payload = rx_buffer_.data() + sizeof(header);
+            uint8_t nonce[12];
+            MakeNonce(header, nonce);
+            // A new salt is tried under its own subkey, the current one stays until it takes over
+            if (new_salt && (!has_candidate_ || header.salt != candidate_salt_)) {
+                candidate_aead_.Rekey(SubKey(key_, header.salt));
+                candidate_salt_ = header.salt;
+                has_candidate_ = true;
+            }
+            if (!(new_salt ? candidate_aead_ : rx_aead_)
+                     .Open(nonce, rx_buffer_.data(), sizeof(header), payload, payload_size,
+                         payload + payload_size)) {
+                ++stats_.auth_failure_count;
+                continue;
+            }
+            using Verdict = EpochTracker<uint64_t>::Verdict;
+            const Verdict verdict = salts_.Observe(header.salt, header.counter);
+            if (verdict == Verdict::kPending) {
+                ++stats_.unconfirmed_count;
+                continue;
+            }
+            if (new_salt) {
+                std::swap(rx_aead_, candidate_aead_);
+                has_candidate_ = false;
+                stats_.peer_restart_count = salts_.restart_count();
+                replay_window_.Reset();
+            }
+            // Only authentic counters move the window, forged ones must not shift it
+            replay_window_.Update(header.counter);
+            ++stats_.opened_count;
+            if (payload_size > capacity) {
+                continue;
+            }
+            std::memcpy(buffer, payload, payload_size);
+            return payload_size;
+        }
+        return 0;
+    }
+
+    /** Traffic so far */
+    const EncryptionStats& stats() const { return stats_; }
+
+private:
+    /**
+     * Anti-replay window of the newest counter and a bitmap of the ones before it, as in
+     * IPsec (RFC 4303)
+     */
+    class ReplayWindow
+    {
+    public:
+        /** Whether a counter is new and not too old */
+        bool Check(uint64_t counter) const
+        {
+            if (counter > newest_) {
+                return true;
+            }
+            const uint64_t age = newest_ - counter;
+            return age < kSize && !(seen_ & (1ull << age));
+        }
+
+        /** Forget every counter, for a peer that starts over */
+        void Reset()
+        {
+            newest_ = 0;
+            seen_ = 0;
+        }
+
+        /** Mark an authentic counter as seen */
+        void Update(uint64_t counter)
+        {
+            if (counter > newest_) {
+                const uint64_t shift = counter - newest_;
+                seen_ = shift < kSize ? (seen_ << shift) | 1 : 1;
+                newest_ = counter;
+            } else {
+                seen_ |= 1ull << (newest_ - counter);
+            }
+        }
+
+    private:
+        static constexpr uint64_t kSize = 64;
+        uint64_t newest_ = 0;
+        uint64_t seen_ = 0;
+    };
+
+    /** Role in the first byte, counter in the last eight: the directions never share a nonce */
+    static void MakeNonce(const EncryptedPacketHeader& header, uint8_t* nonce)
+    {
+        nonce[0] = header.role;
+        nonce[1] = nonce[2] = nonce[3] = 0;
+        detail::StoreLe64(nonce + 4, header.counter);
+    }
+
+    /** Salt of a new transport, drawn like a key from the kernel's random number generator */
+    static uint64_t NewSalt() { return detail::LoadLe64(GenerateAeadKey().data()); }
+
+    /** Subkey a sender of a salt encrypts under */
+    static AeadKey SubKey(const AeadKey& key, uint64_t salt)
+    {
+        uint8_t input[16] = {};
+        detail::StoreLe64(input, salt);
+        return detail::ChaCha20Poly1305::HChaCha20(key, input);
+    }
+
+    Transport& transport_;
+    AeadKey key_;
+    uint64_t salt_;
+
+    /** Seals with this transport's subkey */
+    Aead tx_aead_;
+
+    /** Opens with the subkey of the peer's current salt, once one authenticated */
+    Aead rx_aead_;
+
+    /** Opens with the subkey of a salt not confirmed yet */
+    Aead candidate_aead_;
+
+    uint8_t role_;
+    uint64_t counter_ = 0;
+    EpochTracker<uint64_t> salts_;
+    uint64_t candidate_salt_ = 0;
+    bool has_candidate_ = false;
+    ReplayWindow replay_window_;
+    EncryptionStats stats_;
+    std::array<uint8_t, kMaxMessageSize> tx_buffer_ = {};
+    std::array<uint8_t, kMaxMessageSize> rx_buffer_ = {};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,120 @@
+/**
+ * @file epoch_tracker.hpp
+ * @brief Detection of a restarted peer from the epoch its packets carry.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @class EpochTracker
+ * @brief Follows the epoch of a peer, a random number it draws whenever it starts, see NewEpoch().
+ * A packet of a new epoch means the peer may have restarted, but one packet proves little: it can
+ * be a late packet from two epochs back or a stray one, and switching on it would discard the
+ * live peer from then on. So a new epoch is taken only once kConfirmCount packets of it with
+ * rising sequence numbers arrived without a packet of the current epoch in between, and every
+ * epoch left behind is retired for good: its late and replayed packets never take over again.
+ * @tparam Epoch Type of the epoch, e.g. uint32_t for PacketHeader::epoch.
+ */
+template <typename Epoch>
+class EpochTracker
+{
+public:
+    /** Packets of a new epoch in a row that make it the current one */
+    static constexpr unsigned kConfirmCount = 3;
+
+    /** Retired epochs there is room for up front, restarts beyond allocate */
+    static constexpr size_t kRetiredReserve = 64;
+
+    /** What the epoch of a packet says about it */
+    enum class Verdict
+    {
+        kCurrent,   ///< of the current epoch, or the first packet seen
+        kRestarted, ///< confirmed a new epoch, which is the current one from now on
+        kPending,   ///< of a new epoch that is not confirmed yet
+        kRetired,   ///< of an epoch left behind, i.e. late or replayed
+    };
+
+    EpochTracker() { retired_.reserve(kRetiredReserve); }
+
+    /**
+     * @brief [Real-time] Take the epoch of a received packet. Does not allocate unless the peer
+     * restarted more than kRetiredReserve times.
+     * @param[in] epoch Epoch of the packet.
+     * @param[in] sequence Sequence number of the packet within its epoch.
+     * @return What the epoch says about the packet.
+     */
+    Verdict Observe(Epoch epoch, uint64_t sequence)
+    {
+        if (!started_) {
+            started_ = true;
+            current_ = epoch;
+            return Verdict::kCurrent;
+        }
+        if (epoch == current_) {
+            // The current epoch is alive, whatever came in between was no restart
+            candidate_count_ = 0;
+            return Verdict::kCurrent;
+        }
+        if (IsRetired(epoch)) {
+            return Verdict::kRetired;
+        }
+        if (candidate_count_ == 0 || epoch != candidate_) {
+            candidate_ = epoch;
+            candidate_sequence_ = sequence;
+            candidate_count_ = 1;
+        } else if (sequence > candidate_sequence_) {
+            // Duplicates prove nothing, only packets the peer sent later do
+            candidate_sequence_ = sequence;
+            ++candidate_count_;
+        }
+        if (candidate_count_ < kConfirmCount) {
+            return Verdict::kPending;
+        }
+        retired_.push_back(current_);
+        current_ = epoch;
+        candidate_count_ = 0;
+        ++restart_count_;
+        return Verdict::kRestarted;
+    }
+
+    /**
+     * @brief [Real-time] Whether an epoch was left behind, so that a caller can drop its packets
+     * before doing any work on them.
+     */
+    bool IsRetired(Epoch epoch) const
+    {
+        return std::find(retired_.begin(), retired_.end(), epoch) != retired_.end();
+    }
+
+    /** Whether any packet was observed, and thus current() is valid */
+    bool started() const { return started_; }
+
+    /** Epoch of the peer as it runs now */
+    Epoch current() const { return current_; }
+
+    /** Number of times the peer was detected restarting, i.e. a new epoch was confirmed */
+    uint64_t restart_count() const { return restart_count_; }
+
+private:
+    bool started_ = false;
+    Epoch current_ = {};
+    Epoch candidate_ = {};
+    uint64_t candidate_sequence_ = 0;
+    unsigned candidate_count_ = 0;
+    uint64_t restart_count_ = 0;
+    std::vector<Epoch> retired_;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
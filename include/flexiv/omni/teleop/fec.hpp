@@ -0,0 +1,692 @@
+/**
+ * @file fec.hpp
+ * @brief Forward error correction across small groups of packets for lossy links.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "epoch_tracker.hpp"
+#include "transport.hpp"
+#include "wire_format.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/** Magic number at the start of every FEC datagram, "FOTF" in little-endian byte order */
+constexpr uint32_t kFecMagic = 0x46544F46;
+
+/** Largest number of packets protected together */
+constexpr unsigned kMaxFecGroupSize = 16;
+
+/** Largest number of parity packets per group */
+constexpr unsigned kMaxFecParityCount = 4;
+
+/**
+ * @struct FecParams
+ * @brief Group layout of the forward error correction. Up to parity_count packets lost out of
+ * the group_size + parity_count packets of a group are recovered. Overhead is parity_count /
+ * group_size, and a recovered packet arrives with the group's parity, at most group_size - 1
+ * cycles after it was sent.
+ */
+struct FecParams
+{
+    /** Packets protected together [1-kMaxFecGroupSize] */
+    unsigned group_size = 4;
+
+    /** Parity packets sent after each group, 1 is a plain XOR [1-kMaxFecParityCount] */
+    unsigned parity_count = 1;
+};
+
+/**
+ * @struct FecHeader
+ * @brief Header in front of every FEC datagram. Data datagrams carry the protected message as is
+ * after it, parity datagrams a parity symbol.
+ */
+struct FecHeader
+{
+    uint32_t magic = kFecMagic;
+
+    /**
+     * Random number drawn by the sender when it starts, see NewEpoch(). A new epoch tells the
+     * receiver that the sender restarted and its group counter starts over.
+     */
+    uint32_t epoch = 0;
+
+    /** Group counter of the sender, starting from 1 in every epoch */
+    uint32_t group = 0;
+
+    /** Position in the group, data packets first, then parity packets */
+    uint8_t index = 0;
+
+    /** Group layout of the sender, see FecParams */
+    uint8_t group_size = 0;
+    uint8_t parity_count = 0;
+    uint8_t reserved = 0;
+};
+static_assert(sizeof(FecHeader) == 16, "FecHeader must have no padding");
+
+/**
+ * Every message is coded as a symbol of its length in 2 bytes followed by its bytes, so that
+ * messages of different lengths can be recovered
+ */
+constexpr size_t kFecLengthSize = 2;
+
+/** Largest message that is protected, larger ones pass through unprotected [bytes] */
+constexpr size_t kMaxFecPayloadSize = kMaxMessageSize - sizeof(FecHeader) - kFecLengthSize;
+
+/** Largest symbol [bytes] */
+constexpr size_t kMaxFecSymbolSize = kMaxFecPayloadSize + kFecLengthSize;
+
+namespace detail {
+
+/** Log and exponent tables of GF(2^8) with the polynomial x^8 + x^4 + x^3 + x^2 + 1 */
+struct GaloisTables
+{
+    constexpr GaloisTables()
+    : exp()
+    , log()
+    {
+        unsigned x = 1;
+        for (unsigned i = 0; i < 255; ++i) {
+            exp[i] = exp[i + 255] = static_cast<uint8_t>(x);
+            log[x] = static_cast<uint8_t>(i);
+            x <<= 1;
+            if (x & 0x100) {
+                x ^= 0x11D;
+            }
+        }
+    }
+
+    uint8_t exp[510];
+    uint8_t log[256];
+};
+
+inline constexpr GaloisTables kGalois {};
+
+/** Product in GF(2^8) */
+inline uint8_t GaloisMul(uint8_t a, uint8_t b)
+{
+    return a && b ? kGalois.exp[kGalois.log[a] + kGalois.log[b]] : 0;
+}
+
+/** Quotient in GF(2^8), b must not be 0 */
+inline uint8_t GaloisDiv(uint8_t a, uint8_t b)
+{
+    return a ? kGalois.exp[kGalois.log[a] + 255 - kGalois.log[b]] : 0;
+}
+
+/** dst += coefficient * src over size bytes, in GF(2^8) */
+inline void GaloisMulAdd(uint8_t* dst, const uint8_t* src, uint8_t coefficient, size_t size)
+{
+    if (coefficient == 0) {
+        return;
+    }
+    if (coefficient == 1) {
+        for (size_t i = 0; i < size; ++i) {
+            dst[i] ^= src[i];
+        }
+        return;
+    }
+    const unsigned log_coefficient = kGalois.log[coefficient];
+    for (size_t i = 0; i < size; ++i) {
+        if (src[i]) {
+            dst[i] ^= kGalois.exp[log_coefficient + kGalois.log[src[i]]];
+        }
+    }
+}
+
+/**
+ * Coefficient of data packet column in parity packet row: a Cauchy matrix with its columns
+ * scaled so that the first row is all ones. Every square submatrix of it is invertible, so any
+ * group_size of a group's packets recover the rest, and a single parity packet is a plain XOR.
+ */
+inline uint8_t FecCoefficient(unsigned row, unsigned column)
+{
+    const auto y = static_cast<uint8_t>(kMaxFecParityCount + column);
+    return GaloisDiv(y, static_cast<uint8_t>(row ^ y));
+}
+
+/** Throw if a group layout is out of range */
+inline void ValidateFecParams(const FecParams& params)
+{
+    if (params.group_size < 1 || params.group_size > kMaxFecGroupSize || params.parity_count < 1
+        || params.parity_count > kMaxFecParityCount) {
+        throw std::invalid_argument(
+            "flexiv::omni::teleop::FecParams: group_size or parity_count out of range");
+    }
+}
+
+} /* namespace detail */
+
+/**
+ * @class FecEncoder
+ * @brief Frames messages as the data packets of FEC groups, and codes the parity packets of each
+ * group once its last data packet was framed.
+ */
+class FecEncoder
+{
+public:
+    /**
+     * @param[in] params Group layout.
+     * @throw std::invalid_argument if the group layout is out of range.
+     */
+    explicit FecEncoder(const FecParams& params = {})
+    : params_(params)
+    , epoch_(NewEpoch())
+    {
+        detail::ValidateFecParams(params);
+    }
+
+    /**
+     * @brief [Real-time] Frame a message as the next data packet of the current group.
+     * @param[in] data Message to protect.
+     * @param[in] size Size of the message, at most kMaxFecPayloadSize [bytes].
+     * @param[out] out Datagram, at least size + sizeof(FecHeader) bytes.
+     * @return Size of the datagram, 0 if the message is too large to protect.
+     */
+    size_t EncodeData(const void* data, size_t size, uint8_t* out)
+    {
+        if (size > kMaxFecPayloadSize) {
+            return 0;
+        }
+        if (filled_ == params_.group_size) {
+            filled_ = 0;
+            symbol_size_ = 0;
+        }
+        if (filled_ == 0) {
+            ++group_;
+        }
+        auto& symbol = symbols_[filled_];
+        symbol[0] = static_cast<uint8_t>(size);
+        symbol[1] = static_cast<uint8_t>(size >> 8);
+        std::memcpy(symbol.data() + kFecLengthSize, data, size);
+        sizes_[filled_] = size + kFecLengthSize;
+        symbol_size_ = std::max(symbol_size_, sizes_[filled_]);
+
+        WriteHeader(filled_++, out);
+        std::memcpy(out + sizeof(FecHeader), data, size);
+        return sizeof(FecHeader) + size;
+    }
+
+    /** Number of parity packets to send after the latest data packet, 0 until a group is full */
+    unsigned parity_ready() const
+    {
+        return filled_ == params_.group_size ? params_.parity_count : 0;
+    }
+
+    /**
+     * @brief [Real-time] Code a parity packet of the group just filled.
+     * @param[in] row Which parity packet, less than parity_ready().
+     * @param[out] out Datagram, at least sizeof(FecHeader) + kMaxFecSymbolSize bytes.
+     * @return Size of the datagram, 0 if there is no such parity packet.
+     */
+    size_t EncodeParity(unsigned row, uint8_t* out)
+    {
+        if (row >= parity_ready()) {
+            return 0;
+        }
+        WriteHeader(params_.group_size + row, out);
+        uint8_t* parity = out + sizeof(FecHeader);
+        std::memset(parity, 0, symbol_size_);
+        for (unsigned column = 0; column < params_.group_size; ++column) {
+            detail::GaloisMulAdd(parity, symbols_[column].data(),
+                detail::FecCoefficient(row, column), sizes_[column]);
+        }
+        return sizeof(FecHeader) + symbol_size_;
+    }
+
+    /** Group layout */
+    const FecParams& params() const { return params_; }
+
+private:
+    void WriteHeader(unsigned index, uint8_t* out) const
+    {
+        FecHeader header;
+        header.epoch = epoch_;
+        header.group = group_;
+        header.index = static_cast<uint8_t>(index);
+        header.group_size = static_cast<uint8_t>(params_.group_size);
+        header.parity_count = static_cast<uint8_t>(params_.parity_count);
+        std::memcpy(out, &header, sizeof(header));
+    }
+
+    FecParams params_;
+    uint32_t epoch_;
+    uint32_t group_ = 0;
+    unsigned filled_ = 0;
+    size_t symbol_size_ = 0;
+    std::array<size_t, kMaxFecGroupSize> sizes_ = {};
+    std::array<std::array<uint8_t, kMaxFecSymbolSize>, kMaxFecGroupSize> symbols_;
+};
+
+/**
+ * @struct FecDecoderStats
+ * @brief Outcome of decoding so far.
+ */
+struct FecDecoderStats
+{
+    /** Data and parity packets received */
+    uint64_t data_count = 0;
+    uint64_t parity_count = 0;
+
+    /** Lost data packets recovered from parity */
+    uint64_t recovered_count = 0;
+
+    /** Lost data packets not recovered, in groups of which at least one packet arrived */
+    uint64_t unrecoverable_count = 0;
+
+    /** Data packets dropped for having been delivered already, e.g. recovered before they arrived */
+    uint64_t duplicate_count = 0;
+
+    /** Datagrams dropped for being malformed or of a different group layout */
+    uint64_t malformed_count = 0;
+
+    /** Times the sender was detected restarting, i.e. starting a new epoch */
+    uint64_t restart_count = 0;
+};
+
+/**
+ * @class FecDecoder
+ * @brief Passes data packets on as they arrive, and recovers lost ones once enough packets of
+ * their group arrived. Keeps the latest few groups so that reordered packets still count.
+ * Allocates its group buffers once on construction. Once an EpochTracker confirms a new epoch,
+ * the sender restarted: the groups start over with it. Data packets of the epochs before, and
+ * the few ones before the confirmation, are passed on unprotected, their parity is dropped.
+ */
+class FecDecoder
+{
+public:
+    /**
+     * @param[in] params Group layout, must match the sender's.
+     * @throw std::invalid_argument if the group layout is out of range.
+     */
+    explicit FecDecoder(const FecParams& params = {})
+    : params_(params)
+    , symbols_(kGroupSlots * (params.group_size + params.parity_count))
+    {
+        detail::ValidateFecParams(params);
+    }
+
+    /**
+     * @brief [Real-time] Decode a received FEC datagram.
+     * @param[in] datagram Received datagram, starting with a FecHeader.
+     * @param[in] size Size of the datagram [bytes].
+     * @param[out] data Set to the message carried by a data packet, valid until the next call.
+     * @return Size of the message to deliver, 0 if there is none. Lost messages this datagram
+     * recovered are then available from PopRecovered().
+     */
+    size_t Decode(const uint8_t* datagram, size_t size, const uint8_t*& data)
+    {
+        FecHeader header;
+        if (size < sizeof(header)) {
+            ++stats_.malformed_count;
+            return 0;
+        }
+        std::memcpy(&header, datagram, sizeof(header));
+        const size_t payload_size = size - sizeof(header);
+        const bool is_data = header.index < params_.group_size;
+        if (header.magic != kFecMagic || header.group_size != params_.group_size
+            || header.parity_count != params_.parity_count
+            || header.index >= params_.group_size + params_.parity_count || header.group == 0
+            || payload_size > (is_data ? kMaxFecPayloadSize : kMaxFecSymbolSize)) {
+            ++stats_.malformed_count;
+            return 0;
+        }
+        stats_.data_count += is_data;
+        stats_.parity_count += !is_data;
+        if (is_data) {
+            data = datagram + sizeof(header);
+        }
+        using Verdict = EpochTracker<uint32_t>::Verdict;
+        const uint64_t sequence
+            = uint64_t {header.group} * (params_.group_size + params_.parity_count) + header.index;
+        const Verdict verdict = epochs_.Observe(header.epoch, sequence);
+        if (verdict == Verdict::kRestarted) {
+            groups_ = {};
+            ++stats_.restart_count;
+        }
+        Group* group = verdict == Verdict::kRetired || verdict == Verdict::kPending
+                           ? nullptr
+                           : FindGroup(header.group);
+        // Too old to be kept or not of the current epoch: deliver data as is
+        if (!group) {
+            return is_data ? payload_size : 0;
+        }
+        const uint32_t bit = 1u << header.index;
+        if (group->received & bit) {
+            stats_.duplicate_count += is_data;
+            return 0;
+        }
+        group->received |= bit;
+        auto& symbol = Symbol(*group, header.index);
+        if (is_data) {
+            symbol[0] = static_cast<uint8_t>(payload_size);
+            symbol[1] = static_cast<uint8_t>(payload_size >> 8);
+            std::memcpy(symbol.data() + kFecLengthSize, data, payload_size);
+            group->sizes[header.index] = payload_size + kFecLengthSize;
+        } else {
+            // Parity carries no length prefix of its own, the whole payload is the symbol
+            std::memcpy(symbol.data(), datagram + sizeof(header), payload_size);
+            group->sizes[header.index] = payload_size;
+        }
+        Recover(*group);
+        return is_data ? payload_size : 0;
+    }
+
+    /**
+     * @brief [Real-time] Take the next recovered message.
+     * @param[out] data Set to the message, valid until the next call to Decode().
+     * @return Size of the message, 0 if there is none.
+     */
+    size_t PopRecovered(const uint8_t*& data)
+    {
+        if (recovered_begin_ == recovered_end_) {
+            return 0;
+        }
+        const auto& [slot, index] = recovered_[recovered_begin_++];
+        const auto& symbol = symbols_[slot * (params_.group_size + params_.parity_count) + index];
+        data = symbol.data() + kFecLengthSize;
+        return symbol[0] | (static_cast<size_t>(symbol[1]) << 8);
+    }
+
+    /** Outcome of decoding so far */
+    const FecDecoderStats& stats() const { return stats_; }
+
+private:
+    /** Groups kept for recovery, so that packets reordered across groups still count */
+    static constexpr size_t kGroupSlots = 4;
+
+    using SymbolBuffer = std::array<uint8_t, kMaxFecSymbolSize>;
+
+    struct Group
+    {
+        uint32_t id = 0;
+        uint32_t received = 0;
+        bool recovered = false;
+        std::array<size_t, kMaxFecGroupSize + kMaxFecParityCount> sizes = {};
+    };
+
+    SymbolBuffer& Symbol(const Group& group, unsigned index)
+    {
+        const auto slot = static_cast<size_t>(&group - groups_.data());
+        return symbols_[slot * (params_.group_size + params_.parity_count) + index];
+    }
+
+    /** Slot of a group, evicting the oldest one for a new group, nullptr if the group is too old */
+    Group* FindGroup(uint32_t id)
+    {
+        Group& group = groups_[id % kGroupSlots];
+        if (group.id == id) {
+            return &group;
+        }
+        if (group.id > id) {
+            return nullptr;
+        }
+        if (group.id != 0 && !group.recovered) {
+            stats_.unrecoverable_count += MissingData(group);
+        }
+        group = Group();
+        group.id = id;
+        return &group;
+    }
+
+    unsigned MissingData(const Group& group) const
+    {
+        unsigned missing = 0;
+        for (unsigned i = 0; i < params_.group_size; ++i) {
+            missing += !(group.received & (1u << i));
+        }
+        return missing;
+    }
+
+    /** Solve for the missing data packets once as many packets as data packets arrived */
+    void Recover(Group& group)
+    {
+        if (group.recovered) {
+            return;
+        }
+        const unsigned missing = MissingData(group);
+        if (missing == 0) {
+            group.recovered = true;
+            return;
+        }
+        std::array<unsigned, kMaxFecParityCount> lost = {}, rows = {};
+        unsigned lost_count = 0, row_count = 0;
+        for (unsigned i = 0; i < params_.group_size; ++i) {
+            if (!(group.received & (1u << i))) {
+                lost[lost_count++] = i;
+            }
+        }
+        for (unsigned row = 0; row < params_.parity_count && row_count < missing; ++row) {
+            if (group.received & (1u << (params_.group_size + row))) {
+                rows[row_count++] = row;
+            }
+        }
+        if (row_count < missing) {
+            return;
+        }
+
+        // Subtract the data packets that arrived from each parity packet, leaving a combination
+        // of the lost ones only. Every parity packet of a group has the full symbol size
+        const size_t symbol_size = group.sizes[params_.group_size + rows[0]];
+        for (unsigned r = 0; r < row_count; ++r) {
+            const unsigned index = params_.group_size + rows[r];
+            if (group.sizes[index] != symbol_size) {
+                ++stats_.malformed_count;
+                return;
+            }
+            auto& syndrome = Symbol(group, index);
+            for (unsigned column = 0; column < params_.group_size; ++column) {
+                if (!(group.received & (1u << column))) {
+                    continue;
+                }
+                if (group.sizes[column] > symbol_size) {
+                    ++stats_.malformed_count;
+                    group.recovered = true;
+                    return;
+                }
+                detail::GaloisMulAdd(syndrome.data(), Symbol(group, column).data(),
+                    detail::FecCoefficient(rows[r], column), group.sizes[column]);
+            }
+        }
+
+        // Invert the square matrix of the lost packets' coefficients by Gauss-Jordan elimination
+        std::array<std::array<uint8_t, kMaxFecParityCount>, kMaxFecParityCount> matrix = {},
+                                                                                 inverse = {};
+        for (unsigned r = 0; r < missing; ++r) {
+            for (unsigned c = 0; c < missing; ++c) {
+                matrix[r][c] = detail::FecCoefficient(rows[r], lost[c]);
+            }
+            inverse[r][r] = 1;
+        }
+        for (unsigned c = 0; c < missing; ++c) {
+            unsigned pivot = c;
+            while (matrix[pivot][c] == 0) {
+                ++pivot;
+            }
+            std::swap(matrix[pivot], matrix[c]);
+            std::swap(inverse[pivot], inverse[c]);
+            const uint8_t scale = detail::GaloisDiv(1, matrix[c][c]);
+            for (unsigned k = 0; k < missing; ++k) {
+                matrix[c][k] = detail::GaloisMul(matrix[c][k], scale);
+                inverse[c][k] = detail::GaloisMul(inverse[c][k], scale);
+            }
+            for (unsigned r = 0; r < missing; ++r) {
+                const uint8_t factor = matrix[r][c];
+                if (r == c || factor == 0) {
+                    continue;
+                }
+                for (unsigned k = 0; k < missing; ++k) {
+                    matrix[r][k] ^= detail::GaloisMul(factor, matrix[c][k]);
+                    inverse[r][k] ^= detail::GaloisMul(factor, inverse[c][k]);
+                }
+            }
+        }
+
+        const auto slot = static_cast<size_t>(&group - groups_.data());
+        for (unsigned c = 0; c < missing; ++c) {
+            auto& symbol = Symbol(group, lost[c]);
+            std::memset(symbol.data(), 0, symbol_size);
+            for (unsigned r = 0; r < missing; ++r) {
+                detail::GaloisMulAdd(symbol.data(),
+                    Symbol(group, params_.group_size + rows[r]).data(), inverse[c][r],
+                    symbol_size);
+            }
+            const size_t size = symbol[0] | (static_cast<size_t>(symbol[1]) << 8);
+            if (size + kFecLengthSize > symbol_size) {
+                ++stats_.malformed_count;
+                continue;
+            }
+            group.received |= 1u << lost[c];
+            group.sizes[lost[c]] = size + kFecLengthSize;
+            ++stats_.recovered_count;
+            if (recovered_begin_ == recovered_end_) {
+                recovered_begin_ = recovered_end_ = 0;
+            }
+            if (recovered_end_ < recovered_.size()) {
+                recovered_[recovered_end_++] = {slot, lost[c]};
+            }
+        }
+        group.recovered = true;
+    }
+
+    FecParams params_;
+    std::array<Group, kGroupSlots> groups_ = {};
+    std::vector<SymbolBuffer> symbols_;
+    EpochTracker<uint32_t> epochs_;
+    FecDecoderStats stats_;
+    std::array<std::pair<size_t, unsigned>, kMaxFecParityCount> recovered_ = {};
+    size_t recovered_begin_ = 0;
+    size_t recovered_end_ = 0;
+};
+
+/**
+ * @struct FecStats
+ * @brief Traffic of a FecTransport so far.
+ */
+struct FecStats
+{
+    /** Messages sent protected and their total size [bytes] */
+    uint64_t sent_count = 0;
+    uint64_t payload_bytes = 0;
+
+    /** Parity packets sent, and bytes added by them and the FEC headers [bytes] */
+    uint64_t parity_sent_count = 0;
+    uint64_t overhead_bytes = 0;
+
+    /** Outcome of decoding the peer's packets */
+    FecDecoderStats decoder;
+};
+
+/**
+ * @class FecTransport
+ * @brief Wraps a transport and protects the messages sent through it with forward error
+ * correction, so that the peer recovers isolated losses without retransmission, which would
+ * arrive too late for control data anyway. After every group_size messages, parity_count parity
+ * packets follow; losing up to parity_count of the group's packets loses nothing. Messages are
+ * passed on as soon as they arrive, recovered ones as soon as enough of their group did, which
+ * is in time for a jitter buffer's playout delay. Both ends must be wrapped with the same
+ * parameters; datagrams that are not FEC datagrams, and messages too large to protect, pass
+ * through unchanged.
+ */
+class FecTransport : public Transport
+{
+public:
+    /**
+     * @param[in] transport Wrapped transport, must outlive this one.
+     * @param[in] params Group layout, must match the peer's.
+     * @throw std::invalid_argument if the group layout is out of range.
+     */
+    explicit FecTransport(Transport& transport, const FecParams& params = {})
+    : transport_(transport)
+    , encoder_(params)
+    , decoder_(params)
+    {
+    }
+
+    bool Send(const void* data, size_t size) override
+    {
+        const size_t datagram_size = encoder_.EncodeData(data, size, tx_buffer_.data());
+        if (datagram_size == 0) {
+            return transport_.Send(data, size);
+        }
+        ++stats_.sent_count;
+        stats_.payload_bytes += size;
+        stats_.overhead_bytes += sizeof(FecHeader);
+        const bool ok = transport_.Send(tx_buffer_.data(), datagram_size);
+
+        // A lost parity packet only costs its group's protection
+        for (unsigned row = 0; row < encoder_.parity_ready(); ++row) {
+            const size_t parity_size = encoder_.EncodeParity(row, tx_buffer_.data());
+            ++stats_.parity_sent_count;
+            stats_.overhead_bytes += parity_size;
+            transport_.Send(tx_buffer_.data(), parity_size);
+        }
+        return ok;
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        // Recovered messages first, they are older than anything still to be received
+        const uint8_t* data = nullptr;
+        size_t size;
+        while ((size = decoder_.PopRecovered(data)) > 0) {
+            if (size <= capacity) {
+                std::memcpy(buffer, data, size);
+                return size;
+            }
+        }
+        while ((size = transport_.Receive(rx_buffer_.data(), rx_buffer_.size())) > 0) {
+            uint32_t magic = 0;
+            if (size >= sizeof(magic)) {
+                std::memcpy(&magic, rx_buffer_.data(), sizeof(magic));
+            }
+            if (magic != kFecMagic) {
+                if (size > capacity) {
+                    continue;
+                }
+                std::memcpy(buffer, rx_buffer_.data(), size);
+                return size;
+            }
+            size = decoder_.Decode(rx_buffer_.data(), size, data);
+            if (size == 0) {
+                size = decoder_.PopRecovered(data);
+            }
+            if (size > 0 && size <= capacity) {
+                std::memcpy(buffer, data, size);
+                return size;
+            }
+        }
+        return 0;
+    }
+
+    /** Traffic so far */
+    const FecStats& stats()
+    {
+        stats_.decoder = decoder_.stats();
+        return stats_;
+    }
+
+private:
+    Transport& transport_;
+    FecEncoder encoder_;
+    FecDecoder decoder_;
+    FecStats stats_;
+    std::array<uint8_t, kMaxMessageSize> tx_buffer_ = {};
+    std::array<uint8_t, kMaxMessageSize> rx_buffer_ = {};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,78 @@
+/**
+ * @file filters.hpp
+ * @brief Fixed-size signal filters used in the teleop loop.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @class LowPassFilter
+ * @brief First-order IIR low-pass filter applied element-wise to an N-dimensional signal.
+ * @tparam N Signal dimension.
+ */
+template <size_t N>
+class LowPassFilter
+{
+public:
+    /**
+     * @brief Create a filter.
+     * @param[in] cutoff_freq Cutoff frequency [Hz]. Non-positive disables filtering.
+     * @param[in] sample_period Sampling period [s].
+     * @throw std::invalid_argument if sample_period is not positive.
+     */
+    LowPassFilter(double cutoff_freq, double sample_period)
+    {
+        if (sample_period <= 0.0) {
+            throw std::invalid_argument(
+                "[flexiv::omni::teleop::LowPassFilter] Sample period must be positive");
+        }
+        if (cutoff_freq > 0.0) {
+            const double rc = 1.0 / (2.0 * M_PI * cutoff_freq);
+            alpha_ = sample_period / (rc + sample_period);
+        }
+    }
+
+    /**
+     * @brief Feed one sample and get the filtered output. The first sample initializes the
+     * filter state to avoid a start-up transient.
+     * @param[in] input New sample.
+     * @return Filtered signal.
+     */
+    const std::array<double, N>& Filter(const std::array<double, N>& input)
+    {
+        if (!initialized_) {
+            output_ = input;
+            initialized_ = true;
+            return output_;
+        }
+        for (size_t i = 0; i < N; ++i) {
+            output_[i] += alpha_ * (input[i] - output_[i]);
+        }
+        return output_;
+    }
+
+    /** Reset the filter so the next sample re-initializes it */
+    void Reset() { initialized_ = false; }
+
+    /** Latest filter output */
+    const std::array<double, N>& output() const { return output_; }
+
+private:
+    double alpha_ = 1.0;
+    bool initialized_ = false;
+    std::array<double, N> output_ = {};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
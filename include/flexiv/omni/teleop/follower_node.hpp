@@ -0,0 +1,419 @@
+/**
+ * @file follower_node.hpp
+ * @brief Follower-side teleop pipeline: tracks the leader and reports contact back.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "clock.hpp"
+#include "clock_sync.hpp"
+#include "ik_solver.hpp"
+#include "jitter_buffer.hpp"
+#include "link_watchdog.hpp"
+#include "loop_timing.hpp"
+#include "motion_predictor.hpp"
+#include "rate_control.hpp"
+#include "robot_interface.hpp"
+#include "sequence_filter.hpp"
+#include "session_recorder.hpp"
+#include "transport.hpp"
+#include "wire_format.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct FollowerParams
+ * @brief Tuning of the follower-side pipeline.
+ */
+struct FollowerParams
+{
+    /**
+     * Play the leader stream out through an adaptive jitter buffer instead of acting on the
+     * newest packet immediately. Trades a small, adaptive delay for smooth motion on links with
+     * variable delay, recommended for WAN sessions.
+     */
+    bool use_jitter_buffer = false;
+
+    /** Tuning of the jitter buffer, only used if use_jitter_buffer is true */
+    JitterBufferParams jitter_buffer;
+
+    /**
+     * Track the leader's TCP pose through inverse kinematics instead of its joint positions, for
+     * leaders whose joints do not map onto the follower's, e.g. non-Flexiv devices. Targets are
+     * commanded with zero velocity.
+     */
+    bool use_cartesian_target = false;
+
+    /** Tuning of the IK solver, only used if use_cartesian_target is true */
+    IkParams ik;
+
+    /**
+     * Forecast the leader's joint motion to the current time on the leader's clock and command the
+     * forecast instead of the delayed target, blended back to the target as the forecast's
+     * confidence drops. Removes the one-way delay, plus the playout delay of the jitter buffer if
+     * enabled, from the follower's lag behind the operator. Needs a valid clock sync estimate and
+     * is not applied to Cartesian targets.
+     */
+    bool use_prediction = false;
+
+    /** Tuning of the motion predictor, only used if use_prediction is true */
+    MotionPredictorParams prediction;
+
+    /**
+     * Blend towards each new leader target over the leader's send interval instead of stepping
+     * to it, for leaders that lower their send rate under congestion, see
+     * LeaderParams::use_rate_control. Delays targets by the send interval less one cycle, so not
+     * at all at the full rate. Not applied with the jitter buffer, which interpolates itself.
+     */
+    bool use_target_interpolation = false;
+
+    /** Lower the rate follower states are streamed at while the link congests, see LeaderParams */
+    bool use_rate_control = false;
+
+    /** Tuning of the rate controller, only used if use_rate_control is true */
+    RateControlParams rate_control;
+
+    /**
+     * Brake the follower arm to a jerk-limited stop when no leader state arrives for a few
+     * cycles, and blend back onto the leader once the stream returns, instead of holding the last
+     * target, or with prediction enabled, following the forecast while the link is down.
+     */
+    bool use_link_watchdog = false;
+
+    /** Tuning of the link watchdog, only used if use_link_watchdog is true */
+    LinkWatchdogParams link_watchdog;
+
+    /** Longest acceptable time between the start of two cycles, longer counts as deadline miss */
+    int64_t deadline_ns = kLoopPeriodNs + kLoopPeriodNs / 2;
+};
+
+/**
+ * @struct FollowerStatus
+ * @brief Counters of the follower-side pipeline.
+ */
+struct FollowerStatus
+{
+    /** Number of packets sent to the leader */
+    uint64_t sent_count = 0;
+
+    /** Number of valid packets received from the leader */
+    uint64_t received_count = 0;
+
+    /** Number of leader packets discarded for arriving after a newer one */
+    uint64_t stale_count = 0;
+
+    /** Number of leader packets missing from the sequence */
+    uint64_t lost_count = 0;
+
+    /** Number of times the leader was seen restarting, i.e. sending under a new epoch */
+    uint64_t restart_count = 0;
+
+    /** Number of cycles in which a leader target was commanded to the follower arm */
+    uint64_t commanded_count = 0;
+
+    /** Jitter buffer state, only updated if FollowerParams::use_jitter_buffer is true */
+    JitterBufferMetrics jitter_buffer;
+
+    /** Outcome of the latest IK solve, only updated if use_cartesian_target is true */
+    IkResult ik;
+
+    /** Number of IK solves that did not converge within their bounds */
+    uint64_t ik_failure_count = 0;
+
+    /** Estimate of the leader's clock relative to this node's clock */
+    ClockSyncEstimate clock_sync;
+
+    /** One-way delay of the newest leader packet, 0 until clock_sync is valid [ns] */
+    int64_t one_way_delay_ns = 0;
+
+    /**
+     * Time the latest command was forecast ahead of the newest leader packet, 0 while not
+     * predicting [ns]
+     */
+    int64_t prediction_horizon_ns = 0;
+
+    /** Lowest per-joint confidence of the latest forecast, 0 while not predicting */
+    double prediction_confidence = 0.0;
+
+    /** State of the send rate control, only updated if use_rate_control is true */
+    RateControlMetrics rate_control;
+
+    /** State of the link watchdog, only updated if use_link_watchdog is true */
+    LinkWatchdogMetrics link_watchdog;
+};
+
+/**
+ * @class FollowerNode
+ * @brief Runs the follower side of one teleop pair. Call Step() once per control cycle from the
+ * real-time thread. Each cycle the node consumes the newest leader state, or the jitter buffer's
+ * playout sample if enabled, optionally forecasts it to the present, streams it to the follower
+ * arm as joint impedance target, and sends the follower arm's states back to the leader. If
+ * enabled, the link watchdog stops the arm while the leader stream is lost.
+ */
+class FollowerNode
+{
+public:
+    /**
+     * @brief Create the node. Referenced objects must outlive it.
+     * @param[in] robot Follower arm.
+     * @param[in] transport Link to the leader node.
+     * @param[in] params Pipeline tuning.
+     * @param[in] clock Time source for timestamps and jitter buffer playout.
+     */
+    FollowerNode(RobotInterface& robot, Transport& transport, const FollowerParams& params = {},
+        const Clock& clock = DefaultClock())
+    : robot_(robot)
+    , transport_(transport)
+    , clock_(clock)
+    , params_(params)
+    , jitter_buffer_(params.jitter_buffer)
+    , ik_solver_(robot.states().q, params.ik, DhParams::Rizon4(), clock)
+    , predictor_(params.prediction)
+    , rate_controller_(params.rate_control)
+    , link_watchdog_(params.link_watchdog)
+    , timing_(params.deadline_ns)
+    {
+        tx_packet_.header.type = MessageType::kFollowerState;
+        tx_packet_.header.epoch = NewEpoch();
+    }
+
+    /** [Real-time] Run one control cycle */
+    void Step()
+    {
+        // Consume all pending leader packets and keep the newest, discarding any that arrive after
+        // a newer one. Packets are received straight into the spare buffer, which is swapped in
+        // when accepted, so they are never copied
+        timing_.BeginCycle();
+        const int64_t now = clock_.NowNs();
+        bool has_target = false;
+        for (size_t i = 0; i < kMaxReceivePerCycle; ++i) {
+            StatePacket& spare = rx_packets_[1 - latest_index_];
+            const size_t size = transport_.Receive(&spare, sizeof(spare));
+            if (size == 0) {
+                break;
+            }
+            if (IsValidPacket(spare, size) && spare.header.type == MessageType::kLeaderState) {
+                ++status_.received_count;
+                // A restarted peer's new sequence is taken once its epoch is confirmed, its clock
+                // estimate and the samples buffered from it are void, and stragglers must not feed
+                // the new ones
+                const bool newest
+                    = sequence_filter_.Accept(spare.header.sequence, spare.header.epoch);
+                if (sequence_filter_.restart_count() != status_.restart_count) {
+                    status_.restart_count = sequence_filter_.restart_count();
+                    clock_sync_.Reset();
+                    jitter_buffer_.Reset();
+                    predictor_.Reset();
+                }
+                if (spare.header.epoch != sequence_filter_.epoch()) {
+                    continue;
+                }
+                const int64_t network_rtt = clock_sync_.AddExchange(spare.header.echo_time_ns,
+                    spare.header.echo_receive_time_ns, spare.header.send_time_ns, now);
+                if (params_.use_rate_control) {
+                    rate_controller_.AddRoundTrip(network_rtt);
+                }
+                if (recorder_) {
+                    recorder_->Record(MakeRecord(RecordKind::kReceived, now, spare));
+                }
+                // The jitter buffer puts late packets back in order itself
+                if (params_.use_jitter_buffer) {
+                    jitter_buffer_.Push(spare, now);
+                }
+                if (newest) {
+                    if (params_.use_prediction) {
+                        predictor_.Update(spare.header.send_time_ns, spare.q, spare.dq);
+                    }
+                    latest_index_ = 1 - latest_index_;
+                    latest_arrival_ns_ = now;
+                    has_target = true;
+                }
+            }
+        }
+        status_.stale_count = sequence_filter_.stale_count();
+        status_.lost_count = sequence_filter_.lost_count();
+        const StatePacket& leader = rx_packets_[latest_index_];
+        status_.clock_sync = clock_sync_.estimate();
+        if (status_.clock_sync.valid && latest_arrival_ns_ == now) {
+            status_.one_way_delay_ns = now - clock_sync_.PeerToLocal(leader.header.send_time_ns);
+        }
+        timing_.EndStage(LoopStage::kReceive);
+
+        // Track the leader, hold the last target if nothing new arrived
+        const StatePacket* target = has_target ? &leader : nullptr;
+        if (params_.use_jitter_buffer) {
+            target = jitter_buffer_.Pop(now, playout_) ? &playout_ : nullptr;
+            status_.jitter_buffer = jitter_buffer_.metrics();
+        } else if (params_.use_target_interpolation) {
+            target = Interpolate(has_target, now);
+        }
+        // The forecast moves on while no new target arrives, so keep commanding the last one
+        const bool predict = params_.use_prediction && !params_.use_cartesian_target
+                             && status_.clock_sync.valid && status_.commanded_count > 0;
+        if (predict && !target) {
+            target = params_.use_jitter_buffer ? &playout_ : &leader;
+        }
+        if (target) {
+            record_.command.q = target->q;
+            record_.command.dq = target->dq;
+            if (params_.use_cartesian_target) {
+                status_.ik = ik_solver_.Solve(Kinematics::FromPoseArray(target->tcp_pose));
+                status_.ik_failure_count += !status_.ik.converged;
+                record_.command.q = ik_solver_.solution();
+                record_.command.dq = {};
+            }
+        }
+        status_.prediction_horizon_ns = 0;
+        status_.prediction_confidence = 0.0;
+        if (predict) {
+            const int64_t leader_now_ns = clock_sync_.LocalToPeer(now);
+            status_.prediction_horizon_ns = leader_now_ns - predictor_.time_ns();
+            status_.prediction_confidence
+                = predictor_.Predict(leader_now_ns, record_.command.q, record_.command.dq);
+        }
+        // The watchdog takes over the command while the leader stream is lost
+        bool command = target != nullptr;
+        if (params_.use_link_watchdog) {
+            command = link_watchdog_.Update(
+                has_target, command, record_.command.q, record_.command.dq);
+            status_.link_watchdog = link_watchdog_.metrics();
+        }
+        timing_.EndStage(LoopStage::kCompute);
+        if (command) {
+            robot_.StreamJointPosition(record_.command.q, record_.command.dq);
+        }
+        if (target) {
+            ++status_.commanded_count;
+        }
+        timing_.EndStage(LoopStage::kCommand);
+
+        // Report follower states, echoing the leader timestamp for round-trip measurement, every
+        // cycle unless the rate controller holds back
+        const bool send = !params_.use_rate_control
+                          || rate_controller_.Update(
+                              now, status_.received_count, status_.lost_count);
+        if (params_.use_rate_control) {
+            status_.rate_control = rate_controller_.metrics();
+        }
+        WriteStates(robot_.states(), tx_packet_);
+        if (send) {
+            tx_packet_.header.sequence = ++sequence_;
+            tx_packet_.header.send_time_ns = clock_.NowNs();
+            tx_packet_.header.echo_time_ns = leader.header.send_time_ns;
+            tx_packet_.header.echo_receive_time_ns = latest_arrival_ns_;
+            if (transport_.Send(&tx_packet_, sizeof(tx_packet_))) {
+                ++status_.sent_count;
+            }
+        }
+        if (recorder_) {
+            recorder_->Record(MakeRecord(RecordKind::kCycle, now, tx_packet_));
+        }
+        timing_.EndStage(LoopStage::kSend);
+        timing_.EndCycle();
+    }
+
+    /** Counters */
+    const FollowerStatus& status() const { return status_; }
+
+    /** Per-stage cycle timing, safe to read from any thread while the node runs */
+    const LoopTimingRecorder& timing() const { return timing_; }
+
+    /**
+     * @brief Log every cycle and every valid packet received from now on. Call before the loop
+     * starts or from the real-time thread.
+     * @param[in] recorder Recorder to feed, must outlive the node. Nullptr to stop logging.
+     */
+    void SetRecorder(SessionRecorder* recorder) { recorder_ = recorder; }
+
+    /** Newest state received from the leader */
+    const StatePacket& latest_leader() const { return rx_packets_[latest_index_]; }
+
+private:
+    /** Upper bound on packets consumed per cycle to keep the cycle time bounded */
+    static constexpr size_t kMaxReceivePerCycle = 32;
+
+    /** Longest leader send interval blended over, longer gaps are losses, not a lowered rate */
+    static constexpr int64_t kMaxInterpolationIntervalNs = 10 * kLoopPeriodNs;
+
+    /**
+     * @brief Blend from where the previous target had got to towards the newest leader state.
+     * @param[in] has_target Whether a new leader state was accepted this cycle.
+     * @param[in] now Current local time [ns].
+     * @return Target to command, nullptr once the newest state was reached.
+     */
+    const StatePacket* Interpolate(bool has_target, int64_t now)
+    {
+        const StatePacket& leader = rx_packets_[latest_index_];
+        if (has_target) {
+            // The last output is where the previous target had got to, or the previous target
+            const bool first = interpolation_send_time_ns_ == 0;
+            interpolation_from_ = first ? leader : interpolated_;
+            interpolation_interval_ns_
+                = first ? kLoopPeriodNs
+                        : std::clamp(leader.header.send_time_ns - interpolation_send_time_ns_,
+                            kLoopPeriodNs, kMaxInterpolationIntervalNs);
+            interpolation_send_time_ns_ = leader.header.send_time_ns;
+            interpolation_start_ns_ = now;
+            interpolating_ = true;
+        }
+        if (!interpolating_) {
+            return nullptr;
+        }
+        // The new state is reached one interval after it arrived, i.e. right away at full rate
+        const double ratio = std::min(1.0,
+            static_cast<double>(now - interpolation_start_ns_ + kLoopPeriodNs)
+                / static_cast<double>(interpolation_interval_ns_));
+        InterpolatePackets(interpolation_from_, leader, ratio, interpolated_);
+        interpolating_ = ratio < 1.0;
+        return &interpolated_;
+    }
+
+    /** Fill the reusable log record */
+    const SessionRecord& MakeRecord(RecordKind kind, int64_t time_ns, const StatePacket& packet)
+    {
+        record_.time_ns = time_ns;
+        record_.kind = kind;
+        record_.packet = packet;
+        return record_;
+    }
+
+    RobotInterface& robot_;
+    Transport& transport_;
+    const Clock& clock_;
+    FollowerParams params_;
+    JitterBuffer jitter_buffer_;
+    StatePacket playout_;
+    IkSolver ik_solver_;
+    MotionPredictor predictor_;
+    RateController rate_controller_;
+    LinkWatchdog link_watchdog_;
+    LoopTimingRecorder timing_;
+
+    FollowerStatus status_;
+    uint64_t sequence_ = 0;
+    StatePacket tx_packet_;
+    std::array<StatePacket, 2> rx_packets_ = {};
+    size_t latest_index_ = 0;
+    int64_t latest_arrival_ns_ = 0;
+    ClockSync clock_sync_;
+    SequenceFilter sequence_filter_;
+    SessionRecorder* recorder_ = nullptr;
+    SessionRecord record_;
+
+    StatePacket interpolation_from_;
+    StatePacket interpolated_;
+    int64_t interpolation_send_time_ns_ = 0;
+    int64_t interpolation_start_ns_ = 0;
+    int64_t interpolation_interval_ns_ = kLoopPeriodNs;
+    bool interpolating_ = false;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
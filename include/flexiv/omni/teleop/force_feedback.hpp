@@ -0,0 +1,60 @@
+/**
+ * @file force_feedback.hpp
+ * @brief Conversion of follower contact torques into leader force feedback.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "data.hpp"
+#include "filters.hpp"
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @class ForceFeedback
+ * @brief Scales the follower's external joint torques and low-pass filters them to obtain the
+ * torques rendered on the leader arm.
+ */
+class ForceFeedback
+{
+public:
+    /**
+     * @brief Create the renderer.
+     * @param[in] scale Scale applied to the follower's external joint torques [].
+     * @param[in] cutoff_freq Cutoff frequency of the low-pass filter, non-positive to disable [Hz].
+     * @param[in] sample_period Period at which Render() is called [s].
+     */
+    ForceFeedback(double scale, double cutoff_freq, double sample_period = kLoopPeriod)
+    : scale_(scale)
+    , filter_(cutoff_freq, sample_period)
+    {
+    }
+
+    /**
+     * @brief [Real-time] Compute feedback torques from a new follower sample.
+     * @param[in] follower_tau_ext External joint torques measured on the follower [Nm].
+     * @return Feedback torques to render on the leader [Nm].
+     */
+    const JointArray& Render(const JointArray& follower_tau_ext)
+    {
+        JointArray scaled;
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            scaled[i] = scale_ * follower_tau_ext[i];
+        }
+        return filter_.Filter(scaled);
+    }
+
+    /** Latest feedback torques [Nm] */
+    const JointArray& output() const { return filter_.output(); }
+
+private:
+    double scale_;
+    LowPassFilter<kJointDoF> filter_;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
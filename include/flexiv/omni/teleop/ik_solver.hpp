@@ -0,0 +1,200 @@
+/**
+ * @file ik_solver.hpp
+ * @brief Real-time damped least-squares inverse kinematics with warm start and bounded cost.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "clock.hpp"
+#include "kinematics.hpp"
+
+#include <Eigen/Cholesky>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct IkParams
+ * @brief Tuning and hard limits of the IK solver.
+ */
+struct IkParams
+{
+    /** Hard upper bound on iterations per Solve() */
+    size_t max_iterations = 20;
+
+    /** Hard upper bound on the time spent per Solve(), checked after every iteration [ns] */
+    int64_t max_time_ns = 200000;
+
+    /** Damping of the least-squares step, trades accuracy near singularities for bounded steps */
+    double damping = 0.05;
+
+    /** Largest change of any joint per iteration [rad] */
+    double max_step = 0.2;
+
+    /** Position error below which the solution is accepted [m] */
+    double position_tolerance = 1e-5;
+
+    /** Orientation error below which the solution is accepted [rad] */
+    double orientation_tolerance = 1e-4;
+
+    /** Lower joint limits, nominal Rizon 4 values [rad] */
+    JointArray q_min = {-2.7925, -2.2689, -2.9671, -1.8675, -2.9671, -1.3963, -2.9671};
+
+    /** Upper joint limits, nominal Rizon 4 values [rad] */
+    JointArray q_max = {2.7925, 2.2689, 2.9671, 2.6878, 2.9671, 4.5379, 2.9671};
+};
+
+/**
+ * @struct IkResult
+ * @brief Outcome of one Solve() call.
+ */
+struct IkResult
+{
+    /** Whether both errors are within tolerance */
+    bool converged = false;
+
+    /** Whether the time bound cut the iterations short */
+    bool timed_out = false;
+
+    /** Iterations performed */
+    size_t iterations = 0;
+
+    /** Remaining TCP position error of the solution kept [m] */
+    double position_error = 0.0;
+
+    /** Remaining TCP orientation error of the solution kept [rad] */
+    double orientation_error = 0.0;
+};
+
+/**
+ * @class IkSolver
+ * @brief Maps TCP poses to joint positions with damped least-squares (Levenberg-Marquardt)
+ * steps dq = J^T (J J^T + lambda^2 I)^-1 e, clamped to the joint limits. Meant to be called once
+ * per control cycle with a slowly moving target, e.g. to drive a follower from a leader that only
+ * reports Cartesian poses: each call warm-starts from the previous solution, so one or two
+ * iterations usually suffice, and the number of iterations and the time spent are hard-bounded
+ * so that a far target costs a bounded amount of the cycle instead of a spike. When a bound cuts
+ * a solve short, the iterate with the smallest error so far is kept, by the norm of the error
+ * that the steps minimize, metres and radians alike, and the next call continues from it. All
+ * matrices are fixed-size, the solver never allocates.
+ */
+class IkSolver
+{
+public:
+    /**
+     * @param[in] seed Joint positions to start from, e.g. the arm's current positions [rad].
+     * @param[in] params Tuning and limits.
+     * @param[in] dh_params Kinematics of the arm.
+     * @param[in] clock Time source for the time bound, must outlive the solver.
+     */
+    explicit IkSolver(const JointArray& seed, const IkParams& params = IkParams(),
+        const DhParams& dh_params = DhParams::Rizon4(), const Clock& clock = DefaultClock())
+    : params_(params)
+    , kinematics_(dh_params)
+    , clock_(clock)
+    {
+        Reset(seed);
+    }
+
+    /**
+     * @brief [Real-time] Solve for a target pose, starting from the previous solution.
+     * @param[in] target Target TCP pose in the world frame.
+     * @return Outcome, the joint positions are available from solution().
+     */
+    const IkResult& Solve(const Eigen::Isometry3d& target)
+    {
+        const int64_t start_ns = clock_.NowNs();
+        result_ = IkResult();
+        Eigen::Isometry3d pose;
+        Jacobian jacobian;
+        Eigen::Matrix<double, kCartDoF, 1> error;
+        JointArray best = solution_;
+        double best_error = std::numeric_limits<double>::infinity();
+        while (true) {
+            kinematics_.Compute(solution_, pose, jacobian);
+            ComputeError(target, pose, error);
+            const double position_error = error.head<3>().norm();
+            const double orientation_error = error.tail<3>().norm();
+            const bool converged = position_error <= params_.position_tolerance
+                                   && orientation_error <= params_.orientation_tolerance;
+            if (converged || error.squaredNorm() < best_error) {
+                best_error = error.squaredNorm();
+                best = solution_;
+                result_.position_error = position_error;
+                result_.orientation_error = orientation_error;
+            }
+            if (converged) {
+                result_.converged = true;
+                break;
+            }
+            if (result_.iterations >= params_.max_iterations) {
+                break;
+            }
+            if (result_.iterations > 0 && clock_.NowNs() - start_ns >= params_.max_time_ns) {
+                result_.timed_out = true;
+                break;
+            }
+
+            // Damped least-squares step, scaled down as a whole so that its direction is kept
+            Eigen::Matrix<double, kCartDoF, kCartDoF> jjt = jacobian * jacobian.transpose();
+            jjt.diagonal().array() += params_.damping * params_.damping;
+            ldlt_.compute(jjt);
+            const Eigen::Matrix<double, kJointDoF, 1> step
+                = jacobian.transpose() * ldlt_.solve(error);
+            const double largest = step.cwiseAbs().maxCoeff();
+            const double scale = largest > params_.max_step ? params_.max_step / largest : 1.0;
+            for (size_t i = 0; i < kJointDoF; ++i) {
+                solution_[i] = std::clamp(
+                    solution_[i] + scale * step[i], params_.q_min[i], params_.q_max[i]);
+            }
+            ++result_.iterations;
+        }
+        // A step can overshoot, e.g. near a singularity or into a joint limit
+        solution_ = best;
+        return result_;
+    }
+
+    /**
+     * @brief Restart from given joint positions, e.g. after the arm was moved by other means.
+     * @param[in] seed Joint positions [rad], clamped to the joint limits.
+     */
+    void Reset(const JointArray& seed)
+    {
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            solution_[i] = std::clamp(seed[i], params_.q_min[i], params_.q_max[i]);
+        }
+    }
+
+    /** Joint positions found by the latest Solve(), or the seed before the first one [rad] */
+    const JointArray& solution() const { return solution_; }
+
+    /** Outcome of the latest Solve() */
+    const IkResult& result() const { return result_; }
+
+private:
+    /** Position error on top, orientation error as rotation vector below, world frame */
+    static void ComputeError(const Eigen::Isometry3d& target, const Eigen::Isometry3d& pose,
+        Eigen::Matrix<double, kCartDoF, 1>& error)
+    {
+        error.head<3>() = target.translation() - pose.translation();
+        const Eigen::AngleAxisd rotation(target.linear() * pose.linear().transpose());
+        error.tail<3>() = rotation.angle() * rotation.axis();
+    }
+
+    IkParams params_;
+    Kinematics kinematics_;
+    const Clock& clock_;
+    Eigen::LDLT<Eigen::Matrix<double, kCartDoF, kCartDoF>> ldlt_;
+    JointArray solution_ = {};
+    IkResult result_;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
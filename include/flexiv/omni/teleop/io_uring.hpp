@@ -0,0 +1,359 @@
+/**
+ * @file io_uring.hpp
+ * @brief Minimal io_uring ring on raw system calls, for the network I/O backends.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+// Multishot receive appeared in the Linux 6.0 headers, after provided buffer rings. The register
+// opcodes are enumerators, so only the flag can be tested by the preprocessor.
+#if defined(IORING_RECV_MULTISHOT)
+#define FLEXIV_TELEOP_HAS_IO_URING 1
+#else
+#define FLEXIV_TELEOP_HAS_IO_URING 0
+#endif
+
+#if FLEXIV_TELEOP_HAS_IO_URING
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+namespace detail {
+
+/**
+ * @class IoUring
+ * @brief Submission and completion rings of one io_uring instance, set up with raw system calls
+ * so that no liburing is needed. Single-threaded: the thread that calls Init() must be the only
+ * one using the ring.
+ */
+class IoUring
+{
+public:
+    IoUring() = default;
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    ~IoUring()
+    {
+        if (sqes_) {
+            ::munmap(sqes_, sqes_size_);
+        }
+        if (cq_ptr_ && cq_ptr_ != sq_ptr_) {
+            ::munmap(cq_ptr_, cq_size_);
+        }
+        if (sq_ptr_) {
+            ::munmap(sq_ptr_, sq_size_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    /**
+     * @brief Create the ring and map its queues.
+     * @param[in] entries Submission queue entries, rounded up to a power of 2 by the kernel.
+     * @param[in] cq_entries Completion queue entries.
+     * @return False with errno set if the kernel does not support or allows io_uring.
+     */
+    bool Init(unsigned entries, unsigned cq_entries)
+    {
+        io_uring_params params {};
+        params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER
+                       | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_DEFER_TASKRUN;
+        params.cq_entries = cq_entries;
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0 && errno == EINVAL) {
+            // Task run tuning needs Linux 6.1, the ring works without it
+            params = io_uring_params {};
+            params.flags = IORING_SETUP_CQSIZE;
+            params.cq_entries = cq_entries;
+            fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+        }
+        if (fd_ < 0) {
+            return false;
+        }
+
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        }
+        sq_ptr_ = Map(sq_size_, IORING_OFF_SQ_RING);
+        if (!sq_ptr_) {
+            return false;
+        }
+        cq_ptr_ = (params.features & IORING_FEAT_SINGLE_MMAP) ? sq_ptr_
+                                                              : Map(cq_size_, IORING_OFF_CQ_RING);
+        if (!cq_ptr_) {
+            return false;
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = static_cast<io_uring_sqe*>(Map(sqes_size_, IORING_OFF_SQES));
+        if (!sqes_) {
+            return false;
+        }
+
+        auto* sq = static_cast<uint8_t*>(sq_ptr_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        // Submission slots map one to one onto entries
+        auto* sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        for (unsigned i = 0; i < sq_entries_; ++i) {
+            sq_array[i] = i;
+        }
+        sqe_tail_ = *sq_tail_;
+
+        auto* cq = static_cast<uint8_t*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    /**
+     * @brief Get a cleared submission entry to fill in, submitted with the next Enter().
+     * @return Entry, or nullptr if the submission queue is full.
+     */
+    io_uring_sqe* GetSqe()
+    {
+        if (sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+            return nullptr;
+        }
+        io_uring_sqe* sqe = &sqes_[sqe_tail_ & sq_mask_];
+        ++sqe_tail_;
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    /** Number of entries filled in but not yet submitted */
+    unsigned pending() const { return sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE); }
+
+    /**
+     * @brief Submit all filled in entries and optionally wait for completions.
+     * @param[in] wait_count Completions to wait for, 0 to return right after submitting.
+     * @return Entries submitted, or -errno.
+     */
+    int Enter(unsigned wait_count)
+    {
+        __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+        const unsigned flags = wait_count > 0 ? IORING_ENTER_GETEVENTS : 0;
+        const long ret
+            = ::syscall(__NR_io_uring_enter, fd_, pending(), wait_count, flags, nullptr, 0);
+        return ret < 0 ? -errno : static_cast<int>(ret);
+    }
+
+    /**
+     * @brief Hand every available completion to a function, then release them to the kernel.
+     * @param[in] fn Called with each const io_uring_cqe&.
+     * @return Number of completions handled.
+     */
+    template <typename Fn>
+    unsigned ForEachCompletion(Fn&& fn)
+    {
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        const unsigned count = tail - head;
+        for (; head != tail; ++head) {
+            fn(cqes_[head & cq_mask_]);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    /**
+     * @brief Register resources with the ring.
+     * @return 0, or -errno.
+     */
+    int Register(unsigned opcode, const void* arg, unsigned count)
+    {
+        const long ret = ::syscall(__NR_io_uring_register, fd_, opcode, arg, count);
+        return ret < 0 ? -errno : 0;
+    }
+
+private:
+    void* Map(size_t size, uint64_t offset)
+    {
+        void* ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+            static_cast<off_t>(offset));
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+    int fd_ = -1;
+    void* sq_ptr_ = nullptr;
+    void* cq_ptr_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sq_size_ = 0;
+    size_t cq_size_ = 0;
+    size_t sqes_size_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned sqe_tail_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+};
+
+/**
+ * @class ProvidedBuffers
+ * @brief Pool of equally sized receive buffers registered with a ring as a provided buffer ring.
+ * Multishot receives pick a buffer from it for each datagram and report its id in the completion;
+ * the buffer is handed back with Recycle() once consumed.
+ */
+class ProvidedBuffers
+{
+public:
+    ProvidedBuffers() = default;
+    ProvidedBuffers(const ProvidedBuffers&) = delete;
+    ProvidedBuffers& operator=(const ProvidedBuffers&) = delete;
+
+    ~ProvidedBuffers()
+    {
+        if (ring_) {
+            ::munmap(ring_, ring_size_);
+        }
+    }
+
+    /**
+     * @brief Allocate the buffers and register them with a ring.
+     * @param[in] ring Ring to register with, must outlive this pool.
+     * @param[in] group Buffer group id that receives select from.
+     * @param[in] count Number of buffers, a power of 2.
+     * @param[in] size Size of each buffer [bytes].
+     * @return 0, or -errno, e.g. -EINVAL before Linux 5.19.
+     */
+    int Init(IoUring& ring, uint16_t group, unsigned count, unsigned size)
+    {
+        ring_size_ = count * sizeof(io_uring_buf);
+        void* ptr = ::mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE,
+            MAP_ANONYMOUS | MAP_PRIVATE | MAP_POPULATE, -1, 0);
+        if (ptr == MAP_FAILED) {
+            return -errno;
+        }
+        ring_ = static_cast<io_uring_buf_ring*>(ptr);
+        mask_ = count - 1;
+        size_ = size;
+        storage_.assign(static_cast<size_t>(count) * size, 0);
+
+        io_uring_buf_reg reg {};
+        reg.ring_addr = reinterpret_cast<uint64_t>(ring_);
+        reg.ring_entries = count;
+        reg.bgid = group;
+        const int ret = ring.Register(IORING_REGISTER_PBUF_RING, &reg, 1);
+        if (ret < 0) {
+            return ret;
+        }
+        for (unsigned id = 0; id < count; ++id) {
+            Add(static_cast<uint16_t>(id));
+        }
+        Commit();
+        return 0;
+    }
+
+    /** Start of a buffer */
+    uint8_t* data(uint16_t id) { return storage_.data() + static_cast<size_t>(id) * size_; }
+
+    /** @brief Hand a consumed buffer back to the kernel, effective after Commit(). */
+    void Recycle(uint16_t id) { Add(id); }
+
+    /** @brief Publish all recycled buffers to the kernel. */
+    void Commit() { __atomic_store_n(&ring_->tail, tail_, __ATOMIC_RELEASE); }
+
+private:
+    void Add(uint16_t id)
+    {
+        // The entries start at the ring itself, the header's flexible array member is offset by
+        // an empty struct when compiled as C++
+        io_uring_buf& buf = reinterpret_cast<io_uring_buf*>(ring_)[tail_ & mask_];
+        buf.addr = reinterpret_cast<uint64_t>(data(id));
+        buf.len = size_;
+        buf.bid = id;
+        ++tail_;
+    }
+
+    io_uring_buf_ring* ring_ = nullptr;
+    size_t ring_size_ = 0;
+    unsigned mask_ = 0;
+    unsigned size_ = 0;
+    uint16_t tail_ = 0;
+    std::vector<uint8_t> storage_;
+};
+
+/**
+ * @brief Check that the running kernel supports what the io_uring network backend uses: a ring,
+ * a provided buffer ring and multishot receive of datagrams (Linux 6.0). Sends one datagram to
+ * itself over loopback.
+ * @return Whether the io_uring backend can be used.
+ */
+inline bool ProbeIoUring()
+{
+    // Declared first so that the ring is torn down before its buffers
+    ProvidedBuffers buffers;
+    IoUring ring;
+    if (!ring.Init(4, 8)) {
+        return false;
+    }
+    if (buffers.Init(ring, 0, 2, 64 + sizeof(io_uring_recvmsg_out)) < 0) {
+        return false;
+    }
+    const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    bool supported = false;
+    msghdr msg {};
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0
+        && ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0) {
+        io_uring_sqe* sqe = ring.GetSqe();
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(&msg);
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = 0;
+        const char byte = 0;
+        if (ring.Enter(0) == 1
+            && ::sendto(fd, &byte, 1, 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 1
+            && ring.Enter(1) >= 0) {
+            ring.ForEachCompletion([&](const io_uring_cqe& cqe) {
+                supported = cqe.res > 0 && (cqe.flags & IORING_CQE_F_MORE);
+            });
+        }
+    }
+    ::close(fd);
+    return supported;
+}
+
+} /* namespace detail */
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
+
+#endif /* FLEXIV_TELEOP_HAS_IO_URING */
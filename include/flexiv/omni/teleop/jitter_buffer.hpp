@@ -0,0 +1,310 @@
+/**
+ * @file jitter_buffer.hpp
+ * @brief Receiver-side adaptive jitter buffer with interpolation and extrapolation.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "wire_format.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct JitterBufferParams
+ * @brief Tuning of the jitter buffer.
+ */
+struct JitterBufferParams
+{
+    /** Lower bound of the buffer depth [ns] */
+    int64_t min_depth_ns = 1000000;
+
+    /** Upper bound of the buffer depth [ns] */
+    int64_t max_depth_ns = 100000000;
+
+    /** Target depth as a multiple of the measured inter-arrival jitter [] */
+    double jitter_multiplier = 3.0;
+
+    /** Rate at which the depth shrinks towards a lower target, in [ns] per [s] of playout */
+    int64_t shrink_rate_ns_per_s = 2000000;
+
+    /** Longest time a sample is extrapolated past the newest one before holding it [ns] */
+    int64_t max_extrapolation_ns = 20000000;
+
+    /** Number of packets over which the minimum transit time is tracked */
+    size_t transit_window = 2000;
+};
+
+/**
+ * @struct JitterBufferMetrics
+ * @brief Current state and counters of the jitter buffer.
+ */
+struct JitterBufferMetrics
+{
+    /** Current buffer depth, i.e. delay added on top of the minimum transit time [ns] */
+    int64_t depth_ns = 0;
+
+    /** Total delay from send time to playout: minimum transit time plus depth [ns] */
+    int64_t playout_delay_ns = 0;
+
+    /** Smoothed inter-arrival jitter estimate [ns] */
+    int64_t jitter_ns = 0;
+
+    /** Number of samples currently buffered */
+    size_t buffered_count = 0;
+
+    /** Number of times playout ran past the newest sample */
+    uint64_t underrun_count = 0;
+
+    /** Number of playout cycles served by extrapolation */
+    uint64_t extrapolated_count = 0;
+
+    /** Number of packets discarded because their playout time had already passed */
+    uint64_t late_count = 0;
+
+    /** Number of packets discarded because they were already buffered */
+    uint64_t discarded_count = 0;
+
+    /** Number of samples evicted unplayed, oldest first, to make room in a full buffer */
+    uint64_t overflow_count = 0;
+};
+
+/**
+ * @class JitterBuffer
+ * @brief Delays received samples by an adaptive depth so that playout is smooth despite
+ * variable network delay, and reconstructs the sender's signal at the playout time.
+ * @details Each sample is scheduled for playout at its send time plus the minimum observed
+ * transit time plus the buffer depth. Transit times include any offset between the two clocks,
+ * which cancels out because only their variation matters. The depth tracks a multiple of the
+ * RFC 3550 inter-arrival jitter: it grows immediately when jitter rises or an underrun occurs,
+ * and shrinks slowly so that playout speeds up imperceptibly. At playout, joint states,
+ * torques and wrenches are linearly interpolated between the two bracketing samples and the TCP
+ * orientation is normalized-lerped. When the newest sample is already in the past, joints are
+ * extrapolated with their last velocity for a bounded time. All storage is fixed-size.
+ * @note Not thread-safe, call Push() and Pop() from the same thread.
+ */
+class JitterBuffer
+{
+public:
+    explicit JitterBuffer(const JitterBufferParams& params = JitterBufferParams())
+    : params_(params)
+    , depth_ns_(params.min_depth_ns)
+    {
+    }
+
+    /**
+     * @brief [Real-time] Add a received packet.
+     * @param[in] packet Received packet.
+     * @param[in] arrival_time_ns Local time the packet arrived [ns].
+     * @return True if the packet was buffered, false if it was late, redundant, or older than
+     * everything in a full buffer.
+     * @note A full buffer evicts its oldest sample, so the newest state is never the one lost.
+     */
+    bool Push(const StatePacket& packet, int64_t arrival_time_ns)
+    {
+        const int64_t send_time = packet.header.send_time_ns;
+        UpdateDelayEstimates(send_time, arrival_time_ns);
+
+        if (has_played_ && send_time <= last_playout_time_ns_) {
+            ++metrics_.late_count;
+            return false;
+        }
+
+        // Insert sorted by send time, searching from the back since packets mostly arrive in order
+        size_t pos = count_;
+        while (pos > 0 && At(pos - 1).header.send_time_ns > send_time) {
+            --pos;
+        }
+        if (pos > 0 && At(pos - 1).header.send_time_ns == send_time) {
+            ++metrics_.discarded_count;
+            return false;
+        }
+        if (count_ == kCapacity) {
+            ++metrics_.overflow_count;
+            if (pos == 0) {
+                return false;
+            }
+            head_ = (head_ + 1) % kCapacity;
+            --count_;
+            --pos;
+        }
+        for (size_t i = count_; i > pos; --i) {
+            At(i) = At(i - 1);
+        }
+        At(pos) = packet;
+        ++count_;
+        return true;
+    }
+
+    /**
+     * @brief [Real-time] Get the sample to act on now.
+     * @param[in] now_ns Current local time [ns].
+     * @param[out] sample Reconstructed sample, header of the newest sample used.
+     * @return False if nothing has been received yet.
+     */
+    bool Pop(int64_t now_ns, StatePacket& sample)
+    {
+        if (count_ == 0) {
+            return false;
+        }
+        AdaptDepth(now_ns);
+        const int64_t playout_time = now_ns - base_transit_ns_ - depth_ns_;
+
+        // Samples older than the one right before the playout time are no longer needed
+        while (count_ >= 2 && At(1).header.send_time_ns <= playout_time) {
+            head_ = (head_ + 1) % kCapacity;
+            --count_;
+        }
+
+        const StatePacket& first = At(0);
+        if (playout_time <= first.header.send_time_ns) {
+            // Depth grew or playout just started: hold the oldest sample
+            sample = first;
+            in_underrun_ = false;
+        } else if (count_ >= 2) {
+            const StatePacket& second = At(1);
+            const double ratio = static_cast<double>(playout_time - first.header.send_time_ns)
+                                 / static_cast<double>(second.header.send_time_ns
+                                                       - first.header.send_time_ns);
+            InterpolatePackets(first, second, ratio, sample);
+            in_underrun_ = false;
+        } else {
+            // Playout ran past the newest sample
+            if (!in_underrun_) {
+                ++metrics_.underrun_count;
+                in_underrun_ = true;
+                // Make room for this much extra delay next time
+                depth_ns_ = std::min(
+                    params_.max_depth_ns, depth_ns_ + (playout_time - first.header.send_time_ns));
+            }
+            ++metrics_.extrapolated_count;
+            Extrapolate(first,
+                std::min(playout_time - first.header.send_time_ns, params_.max_extrapolation_ns),
+                sample);
+        }
+
+        last_playout_time_ns_ = std::max(last_playout_time_ns_, playout_time);
+        has_played_ = true;
+        return true;
+    }
+
+    /** Current state and counters */
+    JitterBufferMetrics metrics() const
+    {
+        JitterBufferMetrics metrics = metrics_;
+        metrics.depth_ns = depth_ns_;
+        metrics.playout_delay_ns = base_transit_ns_ + depth_ns_;
+        metrics.jitter_ns = static_cast<int64_t>(jitter_ns_);
+        metrics.buffered_count = count_;
+        return metrics;
+    }
+
+    /** Drop all samples and estimates, e.g. after the link was re-established */
+    void Reset()
+    {
+        head_ = 0;
+        count_ = 0;
+        depth_ns_ = params_.min_depth_ns;
+        jitter_ns_ = 0.0;
+        has_transit_ = false;
+        base_transit_ns_ = 0;
+        current_block_min_ = std::numeric_limits<int64_t>::max();
+        previous_block_min_ = std::numeric_limits<int64_t>::max();
+        block_count_ = 0;
+        last_adapt_time_ns_ = 0;
+        shrink_remainder_ = 0;
+        last_playout_time_ns_ = std::numeric_limits<int64_t>::min();
+        has_played_ = false;
+        in_underrun_ = false;
+        metrics_ = JitterBufferMetrics();
+    }
+
+private:
+    /** Enough for max_depth_ns of a few hundred ms at 1 kHz, deeper buffers evict the oldest */
+    static constexpr size_t kCapacity = 256;
+
+    StatePacket& At(size_t i) { return buffer_[(head_ + i) % kCapacity]; }
+
+    void UpdateDelayEstimates(int64_t send_time_ns, int64_t arrival_time_ns)
+    {
+        const int64_t transit = arrival_time_ns - send_time_ns;
+
+        // RFC 3550 interarrival jitter: smoothed absolute change in transit time
+        if (has_transit_) {
+            const double d = std::abs(static_cast<double>(transit - last_transit_ns_));
+            jitter_ns_ += (d - jitter_ns_) / 16.0;
+        }
+        last_transit_ns_ = transit;
+        has_transit_ = true;
+
+        // Windowed minimum transit over two alternating blocks, so it can also rise again when
+        // the path gets slower or the clocks drift apart
+        current_block_min_ = std::min(current_block_min_, transit);
+        if (++block_count_ >= params_.transit_window / 2) {
+            previous_block_min_ = current_block_min_;
+            current_block_min_ = std::numeric_limits<int64_t>::max();
+            block_count_ = 0;
+        }
+        base_transit_ns_ = std::min(previous_block_min_, current_block_min_);
+    }
+
+    void AdaptDepth(int64_t now_ns)
+    {
+        const int64_t target = std::clamp(
+            static_cast<int64_t>(params_.jitter_multiplier * jitter_ns_), params_.min_depth_ns,
+            params_.max_depth_ns);
+        if (target > depth_ns_) {
+            depth_ns_ = target;
+            shrink_remainder_ = 0;
+        } else if (last_adapt_time_ns_ != 0) {
+            // Carry what the division leaves over, or a slow rate never shrinks at all per cycle
+            const int64_t elapsed = std::max<int64_t>(0, now_ns - last_adapt_time_ns_);
+            const int64_t amount = params_.shrink_rate_ns_per_s * elapsed + shrink_remainder_;
+            shrink_remainder_ = amount % 1000000000;
+            depth_ns_ = std::max(target, depth_ns_ - amount / 1000000000);
+        }
+        last_adapt_time_ns_ = now_ns;
+    }
+
+    static void Extrapolate(const StatePacket& last, int64_t horizon_ns, StatePacket& out)
+    {
+        out = last;
+        const double dt = static_cast<double>(horizon_ns) * 1e-9;
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            out.q[i] += last.dq[i] * dt;
+        }
+    }
+
+    JitterBufferParams params_;
+    std::array<StatePacket, kCapacity> buffer_ = {};
+    size_t head_ = 0;
+    size_t count_ = 0;
+
+    int64_t depth_ns_;
+    double jitter_ns_ = 0.0;
+    int64_t last_transit_ns_ = 0;
+    bool has_transit_ = false;
+    int64_t base_transit_ns_ = 0;
+    int64_t current_block_min_ = std::numeric_limits<int64_t>::max();
+    int64_t previous_block_min_ = std::numeric_limits<int64_t>::max();
+    size_t block_count_ = 0;
+
+    int64_t last_adapt_time_ns_ = 0;
+    int64_t shrink_remainder_ = 0;
+    int64_t last_playout_time_ns_ = std::numeric_limits<int64_t>::min();
+    bool has_played_ = false;
+    bool in_underrun_ = false;
+    JitterBufferMetrics metrics_;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,183 @@
+/**
+ * @file kinematics.hpp
+ * @brief Scalar forward kinematics and Jacobian of 7-DoF serial arms described by DH parameters.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "data.hpp"
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+#include <cmath>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/** 6 x 7 geometric Jacobian, linear rows on top, expressed in the world frame */
+using Jacobian = Eigen::Matrix<double, kCartDoF, kJointDoF>;
+
+/**
+ * @struct DhParams
+ * @brief Standard Denavit-Hartenberg parameters, one entry per joint. Link i transforms as
+ * Rz(q[i] + theta_offset[i]) * Tz(d[i]) * Tx(a[i]) * Rx(alpha[i]).
+ */
+struct DhParams
+{
+    /** Link lengths along x [m] */
+    JointArray a = {};
+
+    /** Link twists about x [rad] */
+    JointArray alpha = {};
+
+    /** Link offsets along z [m] */
+    JointArray d = {};
+
+    /** Joint angle offsets [rad] */
+    JointArray theta_offset = {};
+
+    /** Fixed transform from the last link frame to the TCP */
+    Eigen::Isometry3d flange_to_tcp = Eigen::Isometry3d::Identity();
+
+    /**
+     * @brief Nominal parameters approximating a Rizon 4 arm. Suitable for simulation and
+     * workspace checks, not a substitute for the calibrated model reported by the robot.
+     */
+    static DhParams Rizon4()
+    {
+        constexpr double kHalfPi = M_PI / 2.0;
+        DhParams p;
+        p.a = {0.0, 0.0, 0.02, -0.02, 0.0, 0.11, 0.0};
+        p.alpha = {-kHalfPi, kHalfPi, kHalfPi, -kHalfPi, kHalfPi, -kHalfPi, 0.0};
+        p.d = {0.365, 0.03, 0.395, -0.02, 0.385, 0.0, 0.124};
+        p.theta_offset = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        return p;
+    }
+};
+
+/**
+ * @class Kinematics
+ * @brief Reference scalar implementation of forward kinematics and geometric Jacobian. All
+ * methods work on fixed-size Eigen types and never allocate.
+ */
+class Kinematics
+{
+public:
+    explicit Kinematics(const DhParams& params = DhParams::Rizon4())
+    : params_(params)
+    {
+    }
+
+    /**
+     * @brief Compute TCP pose in the world frame.
+     * @param[in] q Joint positions [rad].
+     * @return TCP pose.
+     */
+    Eigen::Isometry3d ForwardKinematics(const JointArray& q) const
+    {
+        Eigen::Isometry3d T = Eigen::Isometry3d::Identity();
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            T = T * LinkTransform(i, q[i]);
+        }
+        return T * params_.flange_to_tcp;
+    }
+
+    /**
+     * @brief Compute TCP pose and geometric Jacobian in one pass.
+     * @param[in] q Joint positions [rad].
+     * @param[out] tcp_pose TCP pose in the world frame.
+     * @param[out] jacobian Geometric Jacobian mapping joint velocities to TCP twist.
+     */
+    void Compute(const JointArray& q, Eigen::Isometry3d& tcp_pose, Jacobian& jacobian) const
+    {
+        Eigen::Matrix<double, 3, kJointDoF> z_axes;
+        Eigen::Matrix<double, 3, kJointDoF> origins;
+
+        // Joint i rotates about z of frame i-1
+        Eigen::Isometry3d T = Eigen::Isometry3d::Identity();
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            z_axes.col(i) = T.linear().col(2);
+            origins.col(i) = T.translation();
+            T = T * LinkTransform(i, q[i]);
+        }
+        tcp_pose = T * params_.flange_to_tcp;
+
+        const Eigen::Vector3d p_tcp = tcp_pose.translation();
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            const Eigen::Vector3d z = z_axes.col(i);
+            jacobian.block<3, 1>(0, i) = z.cross(p_tcp - origins.col(i));
+            jacobian.block<3, 1>(3, i) = z;
+        }
+    }
+
+    /**
+     * @brief Compute geometric Jacobian.
+     * @param[in] q Joint positions [rad].
+     * @return Jacobian expressed in the world frame.
+     */
+    Jacobian ComputeJacobian(const JointArray& q) const
+    {
+        Eigen::Isometry3d tcp_pose;
+        Jacobian jacobian;
+        Compute(q, tcp_pose, jacobian);
+        return jacobian;
+    }
+
+    /** Kinematic parameters in use */
+    const DhParams& params() const { return params_; }
+
+    /**
+     * @brief Convert a transform to [x y z qw qx qy qz] format.
+     * @param[in] T Transform to convert.
+     * @return Pose array, quaternion normalized with non-negative qw.
+     */
+    static PoseArray ToPoseArray(const Eigen::Isometry3d& T)
+    {
+        Eigen::Quaterniond quat(T.linear());
+        quat.normalize();
+        if (quat.w() < 0) {
+            quat.coeffs() = -quat.coeffs();
+        }
+        const Eigen::Vector3d& p = T.translation();
+        return {p.x(), p.y(), p.z(), quat.w(), quat.x(), quat.y(), quat.z()};
+    }
+
+    /**
+     * @brief Convert a [x y z qw qx qy qz] pose array to a transform.
+     * @param[in] pose Pose array to convert.
+     * @return Corresponding transform.
+     */
+    static Eigen::Isometry3d FromPoseArray(const PoseArray& pose)
+    {
+        Eigen::Isometry3d T = Eigen::Isometry3d::Identity();
+        T.translation() << pose[0], pose[1], pose[2];
+        T.linear() = Eigen::Quaterniond(pose[3], pose[4], pose[5], pose[6])
+                         .normalized()
+                         .toRotationMatrix();
+        return T;
+    }
+
+private:
+    Eigen::Isometry3d LinkTransform(size_t i, double q) const
+    {
+        const double theta = q + params_.theta_offset[i];
+        const double ct = std::cos(theta);
+        const double st = std::sin(theta);
+        const double ca = std::cos(params_.alpha[i]);
+        const double sa = std::sin(params_.alpha[i]);
+
+        Eigen::Isometry3d T = Eigen::Isometry3d::Identity();
+        T.linear() << ct, -st * ca, st * sa, st, ct * ca, -ct * sa, 0.0, sa, ca;
+        T.translation() << params_.a[i] * ct, params_.a[i] * st, params_.d[i];
+        return T;
+    }
+
+    DhParams params_;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
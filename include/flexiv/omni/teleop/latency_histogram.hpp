@@ -0,0 +1,172 @@
+/**
+ * @file latency_histogram.hpp
+ * @brief Fixed-size, allocation-free latency histogram that is recorded by one real-time thread
+ * and read by any other thread without locking.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @class LatencyHistogram
+ * @brief HDR-style log-linear histogram of durations in [ns]. Every power-of-two range is split
+ * into kSubBucketCount linear buckets, and values are reported as the middle of their bucket, so
+ * with a relative error below 1 / (2 * kSubBucketCount), i.e. 1.6%, up to kMaxValueNs. Larger
+ * values are counted in the top bucket. Record() is a handful of arithmetic instructions and
+ * relaxed stores.
+ * @note Only one thread may call Record() and Reset(); any thread may call TakeSnapshot().
+ */
+class LatencyHistogram
+{
+public:
+    /** Number of linear buckets per power of two */
+    static constexpr int kSubBucketBits = 5;
+    static constexpr uint64_t kSubBucketCount = uint64_t(1) << kSubBucketBits;
+
+    /** Largest value resolved, about 550 s [ns] */
+    static constexpr int kMaxValueBits = 39;
+    static constexpr uint64_t kMaxValueNs = (uint64_t(1) << kMaxValueBits) - 1;
+
+    /** Total number of buckets */
+    static constexpr size_t kBucketCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+
+    /**
+     * @struct Snapshot
+     * @brief Copy of the histogram taken at one point in time, to be analysed off the real-time
+     * thread. Allocated on the heap by TakeSnapshot() since it holds all buckets.
+     */
+    struct Snapshot
+    {
+        std::array<uint64_t, kBucketCount> counts = {};
+
+        /** Number of recorded values */
+        uint64_t count = 0;
+
+        /** Sum of recorded values [ns] */
+        uint64_t sum_ns = 0;
+
+        /** Largest recorded value [ns] */
+        uint64_t max_ns = 0;
+
+        /** Mean of recorded values [ns] */
+        double mean_ns() const { return count > 0 ? static_cast<double>(sum_ns) / count : 0.0; }
+
+        /**
+         * @brief Value below or at which the given percentage of recorded values fall, reported
+         * as the middle of its bucket and never above the recorded maximum.
+         * @param[in] percentile Percentage [0-100].
+         * @return Value [ns], 0 if nothing was recorded.
+         */
+        uint64_t ValueAtPercentile(double percentile) const
+        {
+            if (count == 0) {
+                return 0;
+            }
+            const double clamped = std::clamp(percentile, 0.0, 100.0);
+            const auto rank = std::max<uint64_t>(
+                1, static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(count) + 0.5));
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < kBucketCount; ++i) {
+                cumulative += counts[i];
+                if (cumulative >= rank) {
+                    return std::min(BucketMidpoint(i), max_ns);
+                }
+            }
+            return max_ns;
+        }
+    };
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief [Real-time] Record one duration.
+     * @param[in] value_ns Duration [ns], negative values are recorded as 0.
+     */
+    void Record(int64_t value_ns)
+    {
+        const uint64_t value = value_ns > 0 ? static_cast<uint64_t>(value_ns) : 0;
+        // Single writer, so plain load + store is enough and avoids locked instructions
+        Increment(counts_[BucketIndex(value)], 1);
+        Increment(sum_ns_, value);
+        if (value > max_ns_.load(std::memory_order_relaxed)) {
+            max_ns_.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /** Clear all counts. Call from the recording thread */
+    void Reset()
+    {
+        for (auto& count : counts_) {
+            count.store(0, std::memory_order_relaxed);
+        }
+        sum_ns_.store(0, std::memory_order_relaxed);
+        max_ns_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Copy the current state. Values recorded concurrently may or may not be included,
+     * the snapshot is self-consistent in that its count equals the sum of its buckets.
+     * @return Heap-allocated snapshot.
+     */
+    std::unique_ptr<Snapshot> TakeSnapshot() const
+    {
+        auto snapshot = std::make_unique<Snapshot>();
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            snapshot->counts[i] = counts_[i].load(std::memory_order_relaxed);
+            snapshot->count += snapshot->counts[i];
+        }
+        snapshot->sum_ns = sum_ns_.load(std::memory_order_relaxed);
+        snapshot->max_ns = max_ns_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    /** Index of the bucket a value falls into */
+    static size_t BucketIndex(uint64_t value)
+    {
+        if (value < kSubBucketCount) {
+            return static_cast<size_t>(value);
+        }
+        value = std::min(value, kMaxValueNs);
+        const int msb = 63 - __builtin_clzll(value);
+        const int shift = msb - kSubBucketBits;
+        return static_cast<size_t>(shift + 1) * kSubBucketCount
+               + static_cast<size_t>((value >> shift) - kSubBucketCount);
+    }
+
+    /** Middle of the range of values that fall into a bucket */
+    static uint64_t BucketMidpoint(size_t index)
+    {
+        if (index < kSubBucketCount) {
+            return index;
+        }
+        const int shift = static_cast<int>(index / kSubBucketCount) - 1;
+        const uint64_t sub_bucket = index % kSubBucketCount + kSubBucketCount;
+        return (sub_bucket << shift) + ((uint64_t(1) << shift) >> 1);
+    }
+
+private:
+    static void Increment(std::atomic<uint64_t>& counter, uint64_t amount)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, kBucketCount> counts_ = {};
+    std::atomic<uint64_t> sum_ns_ = {0};
+    std::atomic<uint64_t> max_ns_ = {0};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
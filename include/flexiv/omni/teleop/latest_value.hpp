@@ -0,0 +1,119 @@
+/**
+ * @file latest_value.hpp
+ * @brief Seqlock-based single-writer mailbox that always holds the newest sample.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "spsc_queue.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @class LatestValue
+ * @brief Mailbox holding the most recently written value of T. Unlike SpscQueue, older samples
+ * are overwritten rather than queued, which is what a control loop wants for state such as poses
+ * and wrenches: the reader always acts on the freshest data and can never fall behind.
+ * @details Implemented as a seqlock. Write() is wait-free and never blocks on readers. TryRead()
+ * is wait-free and fails only if it overlapped with a write. The payload is stored as relaxed
+ * atomic words, so concurrent access is free of data races under the C++ memory model.
+ * @tparam T Value type, must be trivially copyable.
+ * @warning There must be only one writer thread. Any number of threads may read.
+ */
+template <typename T>
+class LatestValue
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+        "LatestValue value type must be trivially copyable");
+
+public:
+    LatestValue() = default;
+    LatestValue(const LatestValue&) = delete;
+    LatestValue& operator=(const LatestValue&) = delete;
+
+    /**
+     * @brief [Writer only] Publish a new value, replacing the previous one. Wait-free.
+     * @param[in] value Value to publish.
+     */
+    void Write(const T& value) noexcept
+    {
+        std::array<uint64_t, kNumWords> words {};
+        std::memcpy(words.data(), &value, sizeof(T));
+
+        const uint64_t seq = seq_.load(std::memory_order_relaxed);
+        // Odd sequence marks a write in progress
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kNumWords; ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief [Any thread] Single read attempt. Wait-free.
+     * @param[out] value Receives the newest value on success, untouched on failure.
+     * @param[out] version Optional. Receives the number of writes so far on success, which the
+     * caller can compare against a previous version to tell whether the value is new.
+     * @return True on success, false if nothing has been written yet or a write was in progress.
+     */
+    bool TryRead(T& value, uint64_t* version = nullptr) const noexcept
+    {
+        const uint64_t seq_before = seq_.load(std::memory_order_acquire);
+        if (seq_before == 0 || (seq_before & 1)) {
+            return false;
+        }
+        std::array<uint64_t, kNumWords> words;
+        for (size_t i = 0; i < kNumWords; ++i) {
+            words[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) != seq_before) {
+            return false;
+        }
+        std::memcpy(&value, words.data(), sizeof(T));
+        if (version) {
+            *version = seq_before / 2;
+        }
+        return true;
+    }
+
+    /**
+     * @brief [Any thread] Read the newest value, retrying while a write overlaps. Since a write
+     * takes only as long as copying sizeof(T) bytes, at most a few retries are ever needed.
+     * @param[out] value Receives the newest value on success.
+     * @param[out] version Optional. Same as in TryRead().
+     * @return True on success, false if nothing has been written yet.
+     */
+    bool Read(T& value, uint64_t* version = nullptr) const noexcept
+    {
+        while (seq_.load(std::memory_order_relaxed) != 0) {
+            if (TryRead(value, version)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** [Any thread] Number of completed writes so far */
+    uint64_t version() const noexcept { return seq_.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t kNumWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    alignas(kCacheLineSize) std::atomic<uint64_t> seq_ {0};
+    std::array<std::atomic<uint64_t>, kNumWords> words_ {};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
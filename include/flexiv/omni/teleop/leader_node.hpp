@@ -0,0 +1,288 @@
+/**
+ * @file leader_node.hpp
+ * @brief Leader-side teleop pipeline: streams leader states and renders force feedback.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "clock.hpp"
+#include "clock_sync.hpp"
+#include "force_feedback.hpp"
+#include "loop_timing.hpp"
+#include "passivity.hpp"
+#include "rate_control.hpp"
+#include "robot_interface.hpp"
+#include "sequence_filter.hpp"
+#include "session_recorder.hpp"
+#include "transport.hpp"
+#include "wire_format.hpp"
+
+#include <array>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct LeaderParams
+ * @brief Tuning of the leader-side pipeline.
+ */
+struct LeaderParams
+{
+    /** Scale applied to the follower's external joint torques before rendering them [] */
+    double feedback_scale = 1.0;
+
+    /** Cutoff frequency of the force feedback low-pass filter, non-positive to disable [Hz] */
+    double feedback_cutoff_freq = 50.0;
+
+    /**
+     * Pass the force feedback through a time-domain passivity controller, which adds damping on
+     * the leader only when the delayed feedback would inject energy. Keeps stiff contacts stable
+     * over long links without lowering feedback_scale, recommended for WAN sessions.
+     */
+    bool use_passivity_control = false;
+
+    /** Tuning of the passivity controller, only used if use_passivity_control is true */
+    PassivityParams passivity;
+
+    /**
+     * Lower the rate leader states are streamed at while the link congests, and raise it again
+     * once it recovered. Keeps latency bounded on links whose bandwidth drops below what the full
+     * rate needs; pair with FollowerParams::use_target_interpolation.
+     */
+    bool use_rate_control = false;
+
+    /** Tuning of the rate controller, only used if use_rate_control is true */
+    RateControlParams rate_control;
+
+    /** Longest acceptable time between the start of two cycles, longer counts as deadline miss */
+    int64_t deadline_ns = kLoopPeriodNs + kLoopPeriodNs / 2;
+};
+
+/**
+ * @struct LeaderStatus
+ * @brief Counters and latest measurements of the leader-side pipeline.
+ */
+struct LeaderStatus
+{
+    /** Number of packets sent to the follower */
+    uint64_t sent_count = 0;
+
+    /** Number of valid packets received from the follower */
+    uint64_t received_count = 0;
+
+    /** Number of follower packets discarded for arriving after a newer one */
+    uint64_t stale_count = 0;
+
+    /** Number of follower packets missing from the sequence */
+    uint64_t lost_count = 0;
+
+    /** Number of times the follower was seen restarting, i.e. sending under a new epoch */
+    uint64_t restart_count = 0;
+
+    /** Number of round-trip time samples taken so far */
+    uint64_t round_trip_count = 0;
+
+    /** Latest round-trip time, from sending a leader state to receiving its echo [ns] */
+    int64_t round_trip_ns = 0;
+
+    /** Force feedback torques rendered in the latest cycle [Nm] */
+    JointArray feedback_torque = {};
+
+    /** Energy balance of the force feedback, only updated if use_passivity_control is true */
+    PassivityMetrics passivity;
+
+    /** State of the send rate control, only updated if use_rate_control is true */
+    RateControlMetrics rate_control;
+
+    /** Estimate of the follower's clock relative to this node's clock */
+    ClockSyncEstimate clock_sync;
+
+    /** One-way delay of the newest follower packet, 0 until clock_sync is valid [ns] */
+    int64_t one_way_delay_ns = 0;
+};
+
+/**
+ * @class LeaderNode
+ * @brief Runs the leader side of one teleop pair. Call Step() once per control cycle from the
+ * real-time thread. Each cycle the node sends the leader arm's states to the follower, consumes
+ * the newest follower state and renders the follower's external torques on the leader arm.
+ */
+class LeaderNode
+{
+public:
+    /**
+     * @brief Create the node. Referenced objects must outlive it.
+     * @param[in] robot Leader arm.
+     * @param[in] transport Link to the follower node.
+     * @param[in] params Pipeline tuning.
+     * @param[in] clock Time source for timestamps and delay measurement.
+     */
+    LeaderNode(RobotInterface& robot, Transport& transport, const LeaderParams& params = {},
+        const Clock& clock = DefaultClock())
+    : robot_(robot)
+    , transport_(transport)
+    , clock_(clock)
+    , params_(params)
+    , force_feedback_(params.feedback_scale, params.feedback_cutoff_freq)
+    , passivity_(params.passivity)
+    , rate_controller_(params.rate_control)
+    , timing_(params.deadline_ns)
+    {
+        tx_packet_.header.type = MessageType::kLeaderState;
+        tx_packet_.header.epoch = NewEpoch();
+    }
+
+    /** [Real-time] Run one control cycle */
+    void Step()
+    {
+        // Consume all pending follower packets and keep the newest, discarding any that arrive
+        // after a newer one. Packets are received straight into the spare buffer, which is swapped
+        // in when accepted, so they are never copied
+        timing_.BeginCycle();
+        const int64_t now = clock_.NowNs();
+        bool has_feedback = false;
+        for (size_t i = 0; i < kMaxReceivePerCycle; ++i) {
+            StatePacket& spare = rx_packets_[1 - latest_index_];
+            const size_t size = transport_.Receive(&spare, sizeof(spare));
+            if (size == 0) {
+                break;
+            }
+            if (IsValidPacket(spare, size) && spare.header.type == MessageType::kFollowerState) {
+                ++status_.received_count;
+                // A restarted peer's new sequence is taken once its epoch is confirmed, its clock
+                // estimate is void and stragglers from before the restart must not feed the new one
+                const bool newest
+                    = sequence_filter_.Accept(spare.header.sequence, spare.header.epoch);
+                if (sequence_filter_.restart_count() != status_.restart_count) {
+                    status_.restart_count = sequence_filter_.restart_count();
+                    clock_sync_.Reset();
+                }
+                if (spare.header.epoch != sequence_filter_.epoch()) {
+                    continue;
+                }
+                const int64_t network_rtt = clock_sync_.AddExchange(spare.header.echo_time_ns,
+                    spare.header.echo_receive_time_ns, spare.header.send_time_ns, now);
+                if (params_.use_rate_control) {
+                    rate_controller_.AddRoundTrip(network_rtt);
+                }
+                if (recorder_) {
+                    recorder_->Record(MakeRecord(RecordKind::kReceived, now, spare));
+                }
+                if (newest) {
+                    latest_index_ = 1 - latest_index_;
+                    latest_arrival_ns_ = now;
+                    has_feedback = true;
+                }
+            }
+        }
+        status_.stale_count = sequence_filter_.stale_count();
+        status_.lost_count = sequence_filter_.lost_count();
+        const StatePacket& follower = rx_packets_[latest_index_];
+        status_.clock_sync = clock_sync_.estimate();
+        if (status_.clock_sync.valid && latest_arrival_ns_ == now) {
+            status_.one_way_delay_ns = now - clock_sync_.PeerToLocal(follower.header.send_time_ns);
+        }
+        timing_.EndStage(LoopStage::kReceive);
+
+        // Each leader state is echoed back by the follower at least once, measure it only once
+        if (has_feedback && follower.header.echo_time_ns > last_echo_time_ns_) {
+            last_echo_time_ns_ = follower.header.echo_time_ns;
+            status_.round_trip_ns = now - follower.header.echo_time_ns;
+            ++status_.round_trip_count;
+        }
+
+        // Render force feedback, the passivity controller runs every cycle since energy flows
+        // whenever the leader moves
+        if (has_feedback) {
+            status_.feedback_torque = force_feedback_.Render(follower.tau_ext);
+        }
+        if (params_.use_passivity_control) {
+            status_.feedback_torque
+                = passivity_.Apply(force_feedback_.output(), robot_.states().dq);
+            status_.passivity = passivity_.metrics();
+        }
+        timing_.EndStage(LoopStage::kCompute);
+        robot_.StreamJointTorque(status_.feedback_torque);
+        timing_.EndStage(LoopStage::kCommand);
+
+        // Stream leader states, every cycle unless the rate controller holds back
+        const bool send = !params_.use_rate_control
+                          || rate_controller_.Update(
+                              now, status_.received_count, status_.lost_count);
+        if (params_.use_rate_control) {
+            status_.rate_control = rate_controller_.metrics();
+        }
+        WriteStates(robot_.states(), tx_packet_);
+        if (send) {
+            tx_packet_.header.sequence = ++sequence_;
+            tx_packet_.header.send_time_ns = clock_.NowNs();
+            tx_packet_.header.echo_time_ns = follower.header.send_time_ns;
+            tx_packet_.header.echo_receive_time_ns = latest_arrival_ns_;
+            if (transport_.Send(&tx_packet_, sizeof(tx_packet_))) {
+                ++status_.sent_count;
+            }
+        }
+        if (recorder_) {
+            record_.command.tau = status_.feedback_torque;
+            recorder_->Record(MakeRecord(RecordKind::kCycle, now, tx_packet_));
+        }
+        timing_.EndStage(LoopStage::kSend);
+        timing_.EndCycle();
+    }
+
+    /** Counters and latest measurements */
+    const LeaderStatus& status() const { return status_; }
+
+    /** Per-stage cycle timing, safe to read from any thread while the node runs */
+    const LoopTimingRecorder& timing() const { return timing_; }
+
+    /**
+     * @brief Log every cycle and every valid packet received from now on. Call before the loop
+     * starts or from the real-time thread.
+     * @param[in] recorder Recorder to feed, must outlive the node. Nullptr to stop logging.
+     */
+    void SetRecorder(SessionRecorder* recorder) { recorder_ = recorder; }
+
+    /** Newest state received from the follower */
+    const StatePacket& latest_follower() const { return rx_packets_[latest_index_]; }
+
+private:
+    /** Upper bound on packets consumed per cycle to keep the cycle time bounded */
+    static constexpr size_t kMaxReceivePerCycle = 32;
+
+    /** Fill the reusable log record */
+    const SessionRecord& MakeRecord(RecordKind kind, int64_t time_ns, const StatePacket& packet)
+    {
+        record_.time_ns = time_ns;
+        record_.kind = kind;
+        record_.packet = packet;
+        return record_;
+    }
+
+    RobotInterface& robot_;
+    Transport& transport_;
+    const Clock& clock_;
+    LeaderParams params_;
+    ForceFeedback force_feedback_;
+    PassivityController passivity_;
+    RateController rate_controller_;
+    LoopTimingRecorder timing_;
+
+    LeaderStatus status_;
+    uint64_t sequence_ = 0;
+    int64_t last_echo_time_ns_ = 0;
+    StatePacket tx_packet_;
+    std::array<StatePacket, 2> rx_packets_ = {};
+    size_t latest_index_ = 0;
+    int64_t latest_arrival_ns_ = 0;
+    ClockSync clock_sync_;
+    SequenceFilter sequence_filter_;
+    SessionRecorder* recorder_ = nullptr;
+    SessionRecord record_;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,138 @@
+/**
+ * @file link_emulator.hpp
+ * @brief Transport decorator that injects network impairments, for testing over loopback.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "transport.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct LinkImpairment
+ * @brief Impairments applied independently to each sent message.
+ */
+struct LinkImpairment
+{
+    /** Probability that a message is dropped [0-1] */
+    double loss_ratio = 0.0;
+
+    /** Probability that a message is held back and delivered after the next one [0-1] */
+    double reorder_ratio = 0.0;
+
+    /** Probability that a message is delivered twice [0-1] */
+    double duplicate_ratio = 0.0;
+
+    /** Seed of the random generator, the same seed reproduces the same impairment pattern */
+    uint32_t seed = 1;
+};
+
+/**
+ * @struct LinkEmulatorStats
+ * @brief Counts of impairments injected so far.
+ */
+struct LinkEmulatorStats
+{
+    /** Messages handed to the wrapped transport, including duplicates */
+    uint64_t forwarded_count = 0;
+
+    /** Messages dropped */
+    uint64_t dropped_count = 0;
+
+    /** Messages delivered after a newer one */
+    uint64_t reordered_count = 0;
+
+    /** Extra copies delivered */
+    uint64_t duplicated_count = 0;
+};
+
+/**
+ * @class LinkEmulator
+ * @brief Wraps a transport and impairs the messages sent through it, reproducing loss,
+ * reordering and duplication deterministically without netem or root privileges. Received
+ * messages pass through untouched, so wrap both ends to impair both directions.
+ */
+class LinkEmulator : public Transport
+{
+public:
+    /**
+     * @param[in] transport Wrapped transport, must outlive the emulator.
+     * @param[in] impairment Impairments to inject.
+     */
+    LinkEmulator(Transport& transport, const LinkImpairment& impairment)
+    : transport_(transport)
+    , impairment_(impairment)
+    , rng_(impairment.seed)
+    {
+    }
+
+    bool Send(const void* data, size_t size) override
+    {
+        if (size > kMaxMessageSize) {
+            return false;
+        }
+        if (Chance(impairment_.loss_ratio)) {
+            ++stats_.dropped_count;
+            return true;
+        }
+        // Hold this message back so that the next one overtakes it
+        if (held_size_ == 0 && Chance(impairment_.reorder_ratio)) {
+            std::memcpy(held_.data(), data, size);
+            held_size_ = size;
+            return true;
+        }
+
+        bool ok = Forward(data, size);
+        if (Chance(impairment_.duplicate_ratio)) {
+            ok = Forward(data, size) && ok;
+            ++stats_.duplicated_count;
+        }
+        if (held_size_ > 0) {
+            Forward(held_.data(), held_size_);
+            held_size_ = 0;
+            ++stats_.reordered_count;
+        }
+        return ok;
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        return transport_.Receive(buffer, capacity);
+    }
+
+    /** Impairments injected so far */
+    const LinkEmulatorStats& stats() const { return stats_; }
+
+private:
+    bool Chance(double probability)
+    {
+        return probability > 0.0 && uniform_(rng_) < probability;
+    }
+
+    bool Forward(const void* data, size_t size)
+    {
+        ++stats_.forwarded_count;
+        return transport_.Send(data, size);
+    }
+
+    Transport& transport_;
+    LinkImpairment impairment_;
+    std::mt19937 rng_;
+    std::uniform_real_distribution<double> uniform_ {0.0, 1.0};
+    LinkEmulatorStats stats_;
+    std::array<uint8_t, kMaxMessageSize> held_ = {};
+    size_t held_size_ = 0;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,321 @@
+/**
+ * @file link_watchdog.hpp
+ * @brief Detection of a lost leader stream within a few cycles, and a jerk-limited stop of the
+ * follower until the stream returns.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "data.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct LinkWatchdogParams
+ * @brief Tuning of the link watchdog.
+ */
+struct LinkWatchdogParams
+{
+    /**
+     * Number of cycles without a new leader state after which the link is taken as lost. Must
+     * exceed the leader's longest send interval, e.g. RateControlParams::max_rate_divider with
+     * rate control, or a slowed-down stream is taken as a lost one.
+     */
+    unsigned timeout_cycles = 8;
+
+    /** Largest deceleration of each joint while stopping [rad/s^2] */
+    double max_deceleration = 5.0;
+
+    /** Largest jerk of each joint while stopping [rad/s^3] */
+    double max_jerk = 100.0;
+
+    /**
+     * Number of leader states that must arrive, each within timeout_cycles of the previous one,
+     * before the follower resumes tracking, so that a flapping link does not restart motion
+     */
+    unsigned resume_updates = 20;
+
+    /**
+     * Shortest time the follower blends from where it stopped back onto the leader [ns]. A wider
+     * gap to the leader is blended over longer, so that closing it stays within
+     * max_deceleration and max_jerk.
+     */
+    int64_t resume_blend_ns = 500000000;
+};
+
+/**
+ * @enum LinkWatchdogState
+ * @brief What the watchdog does with the command.
+ */
+enum class LinkWatchdogState
+{
+    /** No leader state arrived yet, the command passes through */
+    kWaiting,
+    /** Leader states arrive in time, the command passes through */
+    kTracking,
+    /** The link was lost, the follower brakes to a stop */
+    kStopping,
+    /** The follower stands still where it stopped */
+    kHolding,
+    /** The link returned, the follower blends back onto the leader */
+    kResuming,
+};
+
+/**
+ * @struct LinkWatchdogMetrics
+ * @brief Current state and counters of the link watchdog.
+ */
+struct LinkWatchdogMetrics
+{
+    LinkWatchdogState state = LinkWatchdogState::kWaiting;
+
+    /** Cycles since the newest leader state arrived */
+    unsigned cycles_since_update = 0;
+
+    /** Longest run of cycles without a leader state so far */
+    unsigned longest_gap_cycles = 0;
+
+    /** Number of times the link was taken as lost */
+    uint64_t trip_count = 0;
+
+    /** Number of times the follower blended back onto the leader */
+    uint64_t resume_count = 0;
+};
+
+/**
+ * @class LinkWatchdog
+ * @brief Watches the leader stream on the follower's control cycle and takes over the command
+ * when it stops. The link is taken as lost after timeout_cycles cycles without a new leader
+ * state, i.e. within milliseconds, long before a socket or session timeout would notice. The
+ * follower is then braked from the last command to a standstill with bounded deceleration and
+ * jerk per joint, and held there. Once leader states arrive steadily again, the command blends
+ * from the stopped pose back onto the leader's with a quintic weight, so position, velocity and
+ * acceleration stay continuous, over a time long enough that closing the gap stays within the
+ * same limits. If the link drops again meanwhile, the follower brakes from wherever the blend had
+ * got to. Fixed-size state, no allocation.
+ */
+class LinkWatchdog
+{
+public:
+    /**
+     * @param[in] params Tuning.
+     * @throw std::invalid_argument if a parameter is out of range.
+     */
+    explicit LinkWatchdog(const LinkWatchdogParams& params = LinkWatchdogParams())
+    : params_(params)
+    {
+        if (params.timeout_cycles == 0 || params.max_deceleration <= 0.0 || params.max_jerk <= 0.0
+            || params.resume_blend_ns < 0) {
+            throw std::invalid_argument(
+                "[flexiv::omni::teleop::LinkWatchdog] timeout_cycles, max_deceleration and "
+                "max_jerk must be positive, resume_blend_ns must not be negative");
+        }
+    }
+
+    /**
+     * @brief [Real-time] Run one cycle, once per control cycle.
+     * @param[in] updated Whether a new leader state arrived this cycle.
+     * @param[in] has_command Whether q and dq hold a command from the leader this cycle.
+     * @param[in,out] q Joint position command, replaced while the link is not tracked [rad].
+     * @param[in,out] dq Joint velocity command, replaced likewise [rad/s].
+     * @return Whether to stream q and dq to the arm this cycle.
+     */
+    bool Update(bool updated, bool has_command, JointArray& q, JointArray& dq)
+    {
+        if (has_command) {
+            target_q_ = q;
+            target_dq_ = dq;
+            has_target_ = true;
+        }
+        if (updated) {
+            metrics_.cycles_since_update = 0;
+        } else if (metrics_.state != LinkWatchdogState::kWaiting) {
+            ++metrics_.cycles_since_update;
+            metrics_.longest_gap_cycles
+                = std::max(metrics_.longest_gap_cycles, metrics_.cycles_since_update);
+        }
+        const bool timed_out = metrics_.cycles_since_update >= params_.timeout_cycles;
+
+        switch (metrics_.state) {
+            case LinkWatchdogState::kWaiting:
+                if (updated) {
+                    metrics_.state = LinkWatchdogState::kTracking;
+                }
+                break;
+            case LinkWatchdogState::kTracking:
+                if (timed_out) {
+                    Trip();
+                }
+                break;
+            case LinkWatchdogState::kStopping:
+            case LinkWatchdogState::kHolding:
+                if (timed_out) {
+                    healthy_updates_ = 0;
+                } else if (updated && ++healthy_updates_ >= params_.resume_updates
+                           && has_target_) {
+                    metrics_.state = LinkWatchdogState::kResuming;
+                    blend_cycle_ = 0;
+                    blend_cycles_ = BlendCycles();
+                }
+                break;
+            case LinkWatchdogState::kResuming:
+                if (timed_out) {
+                    Trip();
+                }
+                break;
+        }
+
+        switch (metrics_.state) {
+            case LinkWatchdogState::kWaiting:
+            case LinkWatchdogState::kTracking:
+                if (has_command) {
+                    Output(q, dq);
+                } else {
+                    // The arm holds the last command, which thus does not accelerate
+                    last_ddq_ = {};
+                }
+                return has_command;
+            case LinkWatchdogState::kStopping:
+            case LinkWatchdogState::kHolding:
+                Brake();
+                q = stop_q_;
+                dq = stop_v_;
+                break;
+            case LinkWatchdogState::kResuming:
+                Brake();
+                Blend(q, dq);
+                if (++blend_cycle_ >= blend_cycles_) {
+                    metrics_.state = LinkWatchdogState::kTracking;
+                    ++metrics_.resume_count;
+                }
+                break;
+        }
+        Output(q, dq);
+        return true;
+    }
+
+    /** Current state and counters */
+    const LinkWatchdogMetrics& metrics() const { return metrics_; }
+
+private:
+    /** Start braking from the last command streamed */
+    void Trip()
+    {
+        metrics_.state = LinkWatchdogState::kStopping;
+        ++metrics_.trip_count;
+        healthy_updates_ = 0;
+        stop_q_ = last_q_;
+        stop_v_ = last_dq_;
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            stop_a_[i] = std::clamp(last_ddq_[i], -params_.max_deceleration,
+                params_.max_deceleration);
+        }
+    }
+
+    /**
+     * Advance the stop by one cycle. Each joint's acceleration follows, at most max_jerk away,
+     * the deceleration from which ramping down at max_jerk still ends with both velocity and
+     * acceleration at zero, about sqrt(2 j |v|), capped at max_deceleration. The velocity left
+     * over in the last cycle is removed in one, which stays within about one cycle's jerk.
+     */
+    void Brake()
+    {
+        const double dt = kLoopPeriod;
+        const double jerk = params_.max_jerk;
+        bool moving = false;
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            double& v = stop_v_[i];
+            double& a = stop_a_[i];
+            if (v == 0.0) {
+                a = 0.0;
+                continue;
+            }
+            // Velocity removed by ramping down from a in steps of j dt is a^2 / 2j + a dt / 2
+            const double ramp_down
+                = jerk * (std::sqrt(0.25 * dt * dt + 2.0 * std::abs(v) / jerk) - 0.5 * dt);
+            const double desired = -std::copysign(std::min(params_.max_deceleration, ramp_down), v);
+            a += std::clamp(desired - a, -jerk * dt, jerk * dt);
+            double v_next = v + a * dt;
+            if (v_next == 0.0 || (v_next > 0.0) != (v > 0.0)) {
+                // Standstill reached within this cycle
+                a = -v / dt;
+                v_next = 0.0;
+            }
+            stop_q_[i] += 0.5 * (v + v_next) * dt;
+            v = v_next;
+            moving = true;
+        }
+        if (!moving && metrics_.state == LinkWatchdogState::kStopping) {
+            metrics_.state = LinkWatchdogState::kHolding;
+        }
+    }
+
+    /**
+     * Cycles to blend over: resume_blend_ns, or longer if the widest gap from the stop to the
+     * leader's command needs it. The quintic weight's second and third derivatives peak at
+     * 10 / sqrt(3) / T^2 and 60 / T^3, so closing a gap d takes T >= sqrt(5.77 d / max
+     * deceleration) and T >= cbrt(60 d / max jerk). The leader's own motion comes on top.
+     */
+    int64_t BlendCycles() const
+    {
+        double gap = 0.0;
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            gap = std::max(gap, std::abs(target_q_[i] - stop_q_[i]));
+        }
+        const double time = std::max({params_.resume_blend_ns * 1e-9,
+            std::sqrt(10.0 / std::sqrt(3.0) * gap / params_.max_deceleration),
+            std::cbrt(60.0 * gap / params_.max_jerk)});
+        return std::max<int64_t>(1, static_cast<int64_t>(std::ceil(time / kLoopPeriod)));
+    }
+
+    /** Blend from the stop onto the leader's command with a quintic weight */
+    void Blend(JointArray& q, JointArray& dq) const
+    {
+        const double T = static_cast<double>(blend_cycles_) * kLoopPeriod;
+        const double s = static_cast<double>(blend_cycle_ + 1) / blend_cycles_;
+        const double w = s * s * s * (10.0 + s * (-15.0 + 6.0 * s));
+        const double dw = 30.0 * s * s * (1.0 - s) * (1.0 - s) / T;
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            q[i] = (1.0 - w) * stop_q_[i] + w * target_q_[i];
+            dq[i] = (1.0 - w) * stop_v_[i] + w * target_dq_[i] + dw * (target_q_[i] - stop_q_[i]);
+        }
+    }
+
+    /** Remember the command streamed, to brake from it */
+    void Output(const JointArray& q, const JointArray& dq)
+    {
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            last_ddq_[i] = (dq[i] - last_dq_[i]) / kLoopPeriod;
+        }
+        last_q_ = q;
+        last_dq_ = dq;
+    }
+
+    LinkWatchdogParams params_;
+    LinkWatchdogMetrics metrics_;
+    int64_t blend_cycles_ = 1;
+    int64_t blend_cycle_ = 0;
+    unsigned healthy_updates_ = 0;
+
+    JointArray target_q_ = {};
+    JointArray target_dq_ = {};
+    bool has_target_ = false;
+    JointArray last_q_ = {};
+    JointArray last_dq_ = {};
+    JointArray last_ddq_ = {};
+    JointArray stop_q_ = {};
+    JointArray stop_v_ = {};
+    JointArray stop_a_ = {};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
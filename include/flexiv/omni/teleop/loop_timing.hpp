@@ -0,0 +1,283 @@
+/**
+ * @file loop_timing.hpp
+ * @brief Always-on per-stage timing of the teleop control cycle, and export of the recorded
+ * histograms to a file from a background thread.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "clock.hpp"
+#include "data.hpp"
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @enum LoopStage
+ * @brief Stages of one teleop control cycle, in execution order.
+ */
+enum class LoopStage
+{
+    kReceive = 0, ///< Consume packets from the peer
+    kCompute,     ///< Derive the command from the received data
+    kCommand,     ///< Hand the command to the robot
+    kSend,        ///< Send own states to the peer
+};
+
+/** Number of values of LoopStage */
+constexpr size_t kLoopStageCount = 4;
+
+/** Names of LoopStage values, for reports */
+constexpr const char* kLoopStageNames[kLoopStageCount] = {"receive", "compute", "command", "send"};
+
+/**
+ * @class LoopTimingRecorder
+ * @brief Records, for every control cycle, the duration of each LoopStage, the total execution
+ * time and the period since the previous cycle started, plus the number of deadline misses, i.e.
+ * cycles that started later than the deadline after the previous one. Such a miss is what the
+ * operator perceives as lag, whether the cause is the loop itself overrunning or the thread being
+ * woken up late. Recording is allocation-free and costs one clock read per stage; the data can be
+ * read at any time from another thread without affecting the real-time thread.
+ */
+class LoopTimingRecorder
+{
+public:
+    /**
+     * @param[in] deadline_ns Longest acceptable time between the start of two cycles [ns].
+     */
+    explicit LoopTimingRecorder(int64_t deadline_ns = kLoopPeriodNs + kLoopPeriodNs / 2)
+    : deadline_ns_(deadline_ns)
+    {
+    }
+
+    /** [Real-time] Mark the start of a cycle and of its first stage */
+    void BeginCycle()
+    {
+        const int64_t now = SteadyTimeNs();
+        if (cycle_start_ns_ != 0) {
+            const int64_t period = now - cycle_start_ns_;
+            period_.Record(period);
+            if (period > deadline_ns_) {
+                deadline_miss_count_.store(
+                    deadline_miss_count_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_relaxed);
+            }
+        }
+        cycle_start_ns_ = now;
+        stage_start_ns_ = now;
+    }
+
+    /**
+     * @brief [Real-time] Mark the end of a stage, which is also the start of the next one.
+     * @param[in] stage Stage that just finished.
+     */
+    void EndStage(LoopStage stage)
+    {
+        const int64_t now = SteadyTimeNs();
+        stages_[static_cast<size_t>(stage)].Record(now - stage_start_ns_);
+        stage_start_ns_ = now;
+    }
+
+    /** [Real-time] Mark the end of the cycle, after its last stage */
+    void EndCycle() { execution_.Record(stage_start_ns_ - cycle_start_ns_); }
+
+    /** Durations of one stage */
+    const LatencyHistogram& stage(LoopStage stage) const
+    {
+        return stages_[static_cast<size_t>(stage)];
+    }
+
+    /** Total execution time of each cycle, from BeginCycle() to the end of the last stage */
+    const LatencyHistogram& execution() const { return execution_; }
+
+    /** Time between the start of consecutive cycles */
+    const LatencyHistogram& period() const { return period_; }
+
+    /** Number of cycles that started later than the deadline after the previous one */
+    uint64_t deadline_miss_count() const
+    {
+        return deadline_miss_count_.load(std::memory_order_relaxed);
+    }
+
+    /** Longest acceptable time between the start of two cycles [ns] */
+    int64_t deadline_ns() const { return deadline_ns_; }
+
+private:
+    int64_t deadline_ns_;
+    int64_t cycle_start_ns_ = 0;
+    int64_t stage_start_ns_ = 0;
+    LatencyHistogram stages_[kLoopStageCount];
+    LatencyHistogram execution_;
+    LatencyHistogram period_;
+    std::atomic<uint64_t> deadline_miss_count_ = {0};
+};
+
+/**
+ * @brief Write a human-readable summary of a recorder: count, mean and p50/p99/p99.9/max in [us]
+ * of the period, the execution time and every stage, plus the deadline misses.
+ * @param[in] name Name of the loop, e.g. "leader".
+ * @param[in] recorder Recorder to summarize, may be in use by its real-time thread.
+ * @param[out] out Stream to write to.
+ */
+inline void WriteTimingReport(
+    const std::string& name, const LoopTimingRecorder& recorder, std::ostream& out)
+{
+    auto write_row = [&out](const std::string& row_name, const LatencyHistogram& histogram) {
+        const auto snapshot = histogram.TakeSnapshot();
+        auto us = [](double ns) { return ns * 1e-3; };
+        out << "  " << std::left << std::setw(10) << row_name << std::right << std::setw(10)
+            << snapshot->count << std::fixed << std::setprecision(1) << std::setw(10)
+            << us(snapshot->mean_ns()) << std::setw(10) << us(snapshot->ValueAtPercentile(50))
+            << std::setw(10) << us(snapshot->ValueAtPercentile(99)) << std::setw(10)
+            << us(snapshot->ValueAtPercentile(99.9)) << std::setw(10) << us(snapshot->max_ns)
+            << std::endl;
+    };
+    out << name << " loop: " << recorder.deadline_miss_count() << " deadline misses (> "
+        << recorder.deadline_ns() / 1000 << " us)" << std::endl;
+    out << "  " << std::left << std::setw(10) << "[us]" << std::right << std::setw(10) << "count"
+        << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p99"
+        << std::setw(10) << "p99.9" << std::setw(10) << "max" << std::endl;
+    write_row("period", recorder.period());
+    write_row("execution", recorder.execution());
+    for (size_t i = 0; i < kLoopStageCount; ++i) {
+        write_row(kLoopStageNames[i], recorder.stage(static_cast<LoopStage>(i)));
+    }
+}
+
+/**
+ * @class TimingDumper
+ * @brief Writes the timing reports of one or more running loops to a file, on demand via Dump()
+ * and optionally periodically from its own background thread. Each dump replaces the file
+ * atomically, so readers never see a partial report. The real-time threads are never blocked.
+ */
+class TimingDumper
+{
+public:
+    /**
+     * @param[in] path File to write the reports to.
+     */
+    explicit TimingDumper(const std::string& path)
+    : path_(path)
+    {
+    }
+
+    ~TimingDumper() { Stop(); }
+
+    TimingDumper(const TimingDumper&) = delete;
+    TimingDumper& operator=(const TimingDumper&) = delete;
+
+    /**
+     * @brief Add a loop to the reports. The recorder must stay alive until removed or until the
+     * dumper is destroyed.
+     * @param[in] name Name of the loop in the reports.
+     * @param[in] recorder Timing recorder of the loop.
+     */
+    void Add(const std::string& name, const LoopTimingRecorder& recorder)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loops_.emplace_back(name, &recorder);
+    }
+
+    /**
+     * @brief Remove a loop from the reports, e.g. before its recorder is destroyed. Waits for a
+     * dump in progress to finish.
+     * @param[in] recorder Timing recorder previously added.
+     */
+    void Remove(const LoopTimingRecorder& recorder)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loops_.erase(std::remove_if(loops_.begin(), loops_.end(),
+                         [&](const auto& loop) { return loop.second == &recorder; }),
+            loops_.end());
+    }
+
+    /**
+     * @brief Write the reports now. Safe to call from any non-real-time thread.
+     * @throw std::runtime_error if the file cannot be written.
+     */
+    void Dump()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const std::string tmp_path = path_ + ".tmp";
+        {
+            std::ofstream file(tmp_path, std::ios::trunc);
+            if (!file) {
+                throw std::runtime_error(
+                    "[flexiv::omni::teleop::TimingDumper] Failed to open " + tmp_path);
+            }
+            for (const auto& loop : loops_) {
+                WriteTimingReport(loop.first, *loop.second, file);
+            }
+        }
+        if (std::rename(tmp_path.c_str(), path_.c_str()) != 0) {
+            throw std::runtime_error(
+                "[flexiv::omni::teleop::TimingDumper] Failed to write " + path_);
+        }
+    }
+
+    /**
+     * @brief Start dumping periodically from a background thread, until Stop().
+     * @param[in] interval Time between dumps.
+     */
+    void Start(std::chrono::milliseconds interval)
+    {
+        Stop();
+        stop_ = false;
+        thread_ = std::thread([this, interval]() {
+            std::unique_lock<std::mutex> lock(stop_mutex_);
+            while (!stop_cv_.wait_for(lock, interval, [this]() { return stop_; })) {
+                try {
+                    Dump();
+                } catch (const std::exception& e) {
+                    std::cerr << e.what() << std::endl;
+                }
+            }
+        });
+    }
+
+    /** Stop periodic dumping, if running */
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex_);
+            stop_ = true;
+        }
+        stop_cv_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+private:
+    std::string path_;
+    std::mutex mutex_;
+    std::vector<std::pair<std::string, const LoopTimingRecorder*>> loops_;
+
+    std::thread thread_;
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stop_ = false;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
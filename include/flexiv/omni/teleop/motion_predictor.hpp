@@ -0,0 +1,221 @@
+/**
+ * @file motion_predictor.hpp
+ * @brief Kalman forecast of the leader's joint motion, to compensate network delay.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "data.hpp"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct MotionPredictorParams
+ * @brief Tuning of the motion predictor.
+ */
+struct MotionPredictorParams
+{
+    /**
+     * Spectral density of the operator's joint jerk, modeled as white noise [rad^2/s^5]. Larger
+     * values follow changes of acceleration quicker but forecast more noisily.
+     */
+    double jerk_density = 200.0;
+
+    /** Standard deviation of the received joint positions [rad] */
+    double position_noise = 1e-4;
+
+    /** Standard deviation of the received joint velocities [rad/s] */
+    double velocity_noise = 1e-2;
+
+    /**
+     * Forecast uncertainty at which the forecast is fully discarded in favor of the raw command,
+     * confidence falls linearly from 1 at zero uncertainty [rad]
+     */
+    double max_uncertainty = 0.02;
+
+    /** Longest horizon forecast, longer ones are cut to this [ns] */
+    int64_t max_horizon_ns = 200000000;
+
+    /** Gap between samples after which the filter restarts instead of bridging it [ns] */
+    int64_t reset_gap_ns = 500000000;
+};
+
+/**
+ * @class MotionPredictor
+ * @brief Forecasts where the operator is moving the leader's joints. Each joint is tracked by a
+ * Kalman filter with a constant acceleration model driven by white jerk, updated with the joint
+ * positions and velocities of every leader sample at its send time. The forecast extrapolates
+ * the filtered state to a later time, e.g. the current time on the leader's clock, removing the
+ * network delay from the motion. The confidence of each joint's forecast falls as its predicted
+ * uncertainty grows, which happens over long horizons and, because the uncertainty is scaled by
+ * how much recent samples surprised the filter, when the operator changes motion abruptly.
+ * Forecasts are blended with the raw command by confidence, so an unreliable forecast degrades to
+ * the raw command instead of overshooting. All joints share one model, so the gain is computed
+ * once per update. Fixed-size state, no allocation.
+ */
+class MotionPredictor
+{
+public:
+    explicit MotionPredictor(const MotionPredictorParams& params = MotionPredictorParams())
+    : params_(params)
+    {
+        measurement_noise_.setZero();
+        measurement_noise_(0, 0) = params.position_noise * params.position_noise;
+        measurement_noise_(1, 1) = params.velocity_noise * params.velocity_noise;
+    }
+
+    /**
+     * @brief [Real-time] Add a leader sample. Samples older than the newest one are ignored.
+     * @param[in] time_ns Send time of the sample on the leader's clock [ns].
+     * @param[in] q Joint positions [rad].
+     * @param[in] dq Joint velocities [rad/s].
+     */
+    void Update(int64_t time_ns, const JointArray& q, const JointArray& dq)
+    {
+        if (!initialized_ || time_ns - time_ns_ > params_.reset_gap_ns) {
+            Initialize(time_ns, q, dq);
+            return;
+        }
+        if (time_ns <= time_ns_) {
+            return;
+        }
+
+        // Predict the shared covariance to the sample time and compute the shared gain
+        const Matrix3 F = Transition(time_ns - time_ns_);
+        const Matrix3 P = F * covariance_ * F.transpose() + ProcessNoise(time_ns - time_ns_);
+        const Eigen::Matrix2d S = P.topLeftCorner<2, 2>() + measurement_noise_;
+        const Eigen::Matrix2d S_inv = S.inverse();
+        const Eigen::Matrix<double, 3, 2> K = P.leftCols<2>() * S_inv;
+        covariance_ = P - K * P.topRows<2>();
+        time_ns_ = time_ns;
+
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            const Eigen::Vector3d x = F * states_[i];
+            const Eigen::Vector2d innovation(q[i] - x[0], dq[i] - x[1]);
+            states_[i] = x + K * innovation;
+
+            // Normalized innovation squared per measured dimension, about 1 when the model fits
+            const double nis = innovation.dot(S_inv * innovation) / 2.0;
+            surprise_[i] += kSurpriseGain * (nis - surprise_[i]);
+        }
+    }
+
+    /**
+     * @brief [Real-time] Forecast the joint motion at a later time.
+     * @param[in] time_ns Time to forecast to on the leader's clock, at most max_horizon_ns after
+     * the newest sample [ns].
+     * @param[out] q Forecast joint positions [rad].
+     * @param[out] dq Forecast joint velocities [rad/s].
+     * @param[out] confidence Confidence in each joint's forecast, 0 to 1.
+     * @return False if no sample was added yet, outputs are then untouched.
+     */
+    bool Forecast(int64_t time_ns, JointArray& q, JointArray& dq, JointArray& confidence) const
+    {
+        if (!initialized_) {
+            return false;
+        }
+        const int64_t horizon_ns
+            = std::clamp<int64_t>(time_ns - time_ns_, 0, params_.max_horizon_ns);
+        const Matrix3 F = Transition(horizon_ns);
+        const double variance
+            = (F * covariance_ * F.transpose() + ProcessNoise(horizon_ns))(0, 0);
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            const Eigen::Vector3d x = F * states_[i];
+            q[i] = x[0];
+            dq[i] = x[1];
+            const double uncertainty = std::sqrt(variance * std::max(1.0, surprise_[i]));
+            confidence[i] = std::clamp(1.0 - uncertainty / params_.max_uncertainty, 0.0, 1.0);
+        }
+        return true;
+    }
+
+    /**
+     * @brief [Real-time] Blend a raw command with the forecast at a later time, by confidence.
+     * @param[in] time_ns Time to forecast to on the leader's clock [ns].
+     * @param[in,out] q Raw joint position command, replaced by the blend [rad].
+     * @param[in,out] dq Raw joint velocity command, replaced by the blend [rad/s].
+     * @return Lowest confidence over all joints, 0 if nothing was forecast.
+     */
+    double Predict(int64_t time_ns, JointArray& q, JointArray& dq) const
+    {
+        JointArray forecast_q, forecast_dq, confidence;
+        if (!Forecast(time_ns, forecast_q, forecast_dq, confidence)) {
+            return 0.0;
+        }
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            q[i] += confidence[i] * (forecast_q[i] - q[i]);
+            dq[i] += confidence[i] * (forecast_dq[i] - dq[i]);
+        }
+        return *std::min_element(confidence.begin(), confidence.end());
+    }
+
+    /** Forget all samples */
+    void Reset() { initialized_ = false; }
+
+    /** Send time of the newest sample, 0 before the first one [ns] */
+    int64_t time_ns() const { return initialized_ ? time_ns_ : 0; }
+
+private:
+    using Matrix3 = Eigen::Matrix3d;
+
+    /** Smoothing of the normalized innovation, about the last 20 samples */
+    static constexpr double kSurpriseGain = 0.05;
+
+    void Initialize(int64_t time_ns, const JointArray& q, const JointArray& dq)
+    {
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            states_[i] = Eigen::Vector3d(q[i], dq[i], 0.0);
+            surprise_[i] = 1.0;
+        }
+        // Acceleration is unknown, allow what an operator's hand plausibly reaches
+        covariance_ = Eigen::Vector3d(measurement_noise_(0, 0), measurement_noise_(1, 1),
+            kInitialAcceleration * kInitialAcceleration)
+                          .asDiagonal();
+        time_ns_ = time_ns;
+        initialized_ = true;
+    }
+
+    static Matrix3 Transition(int64_t dt_ns)
+    {
+        const double dt = static_cast<double>(dt_ns) * 1e-9;
+        Matrix3 F;
+        F << 1.0, dt, 0.5 * dt * dt, 0.0, 1.0, dt, 0.0, 0.0, 1.0;
+        return F;
+    }
+
+    /** Covariance added by white jerk over dt */
+    Matrix3 ProcessNoise(int64_t dt_ns) const
+    {
+        const double dt = static_cast<double>(dt_ns) * 1e-9;
+        const double dt2 = dt * dt, dt3 = dt2 * dt;
+        Matrix3 Q;
+        Q << dt3 * dt2 / 20.0, dt2 * dt2 / 8.0, dt3 / 6.0, dt2 * dt2 / 8.0, dt3 / 3.0, dt2 / 2.0,
+            dt3 / 6.0, dt2 / 2.0, dt;
+        return params_.jerk_density * Q;
+    }
+
+    /** Standard deviation of the initial acceleration [rad/s^2] */
+    static constexpr double kInitialAcceleration = 10.0;
+
+    MotionPredictorParams params_;
+    Eigen::Matrix2d measurement_noise_;
+    Matrix3 covariance_ = Matrix3::Zero();
+    std::array<Eigen::Vector3d, kJointDoF> states_;
+    JointArray surprise_ = {};
+    int64_t time_ns_ = 0;
+    bool initialized_ = false;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
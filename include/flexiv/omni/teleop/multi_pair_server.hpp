@@ -0,0 +1,740 @@
+/**
+ * @file multi_pair_server.hpp
+ * @brief Network I/O for many teleop pairs hosted in one process, shared by all their loops, on
+ * epoll or io_uring.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "io_uring.hpp"
+#include "rt_thread.hpp"
+#include "spsc_queue.hpp"
+#include "transport.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @enum IoBackend
+ * @brief Kernel interface the network I/O thread is built on.
+ */
+enum class IoBackend
+{
+    kEpoll,   ///< epoll_wait() with batched recvmmsg() and sendmmsg()
+    kIoUring, ///< io_uring with multishot receive into a provided buffer ring, Linux 6.0 and newer
+};
+
+/**
+ * @struct MultiPairServerParams
+ * @brief Setup of the shared network I/O thread.
+ */
+struct MultiPairServerParams
+{
+    /**
+     * Backend of the I/O thread. io_uring submits all sends and collects all received datagrams
+     * of a wakeup in one system call; it falls back to epoll if the kernel or its headers lack
+     * the features used, or if io_uring is disabled.
+     */
+    IoBackend backend = IoBackend::kEpoll;
+
+    /** Largest number of datagrams moved per recvmmsg() or sendmmsg() call */
+    size_t batch_size = 32;
+
+    /**
+     * Real-time setup of the I/O thread. Give it a lower priority than the control loops, so
+     * that it only runs while they sleep, and its own core if one is spare.
+     */
+    RtThreadConfig io_thread = {70, -1, false, 0, 0, true};
+};
+
+/**
+ * @struct PairMetrics
+ * @brief Traffic counters of one pair's endpoint.
+ */
+struct PairMetrics
+{
+    /** Datagrams received from the peer and handed to the loop */
+    uint64_t received_count = 0;
+
+    /** Datagrams sent to the peer */
+    uint64_t sent_count = 0;
+
+    /** Datagrams dropped because the loop did not consume received ones in time */
+    uint64_t rx_overflow_count = 0;
+
+    /** Datagrams dropped because the I/O thread did not send queued ones in time */
+    uint64_t tx_overflow_count = 0;
+
+    /** Datagrams the kernel refused to send, e.g. with a full socket buffer */
+    uint64_t send_error_count = 0;
+};
+
+/**
+ * @struct MultiPairServerMetrics
+ * @brief Work done by the I/O thread, summed over all pairs.
+ */
+struct MultiPairServerMetrics
+{
+    /** Returns from waiting for events, in epoll_wait() or io_uring_enter() */
+    uint64_t wakeup_count = 0;
+
+    /** Wakeups requested by loops that queued a datagram while the I/O thread slept */
+    uint64_t notify_count = 0;
+
+    /** recvmmsg() calls, including the final one finding a socket drained */
+    uint64_t recv_call_count = 0;
+
+    /** sendmmsg() calls */
+    uint64_t send_call_count = 0;
+
+    /** io_uring_enter() calls that only submitted, without waiting */
+    uint64_t submit_call_count = 0;
+
+    /** Datagrams received and sent over all pairs */
+    uint64_t received_count = 0;
+    uint64_t sent_count = 0;
+};
+
+class MultiPairServer;
+
+namespace detail {
+
+/** One datagram in a queue between a pair's loop and the I/O thread */
+struct PairMessage
+{
+    uint32_t size = 0;
+    std::array<uint8_t, kMaxMessageSize> data;
+};
+
+} /* namespace detail */
+
+/**
+ * @class PairEndpoint
+ * @brief Transport of one pair hosted by a MultiPairServer, used by that pair's control loop like
+ * any other transport. Send() and Receive() only touch wait-free queues shared with the server's
+ * I/O thread, so the loop makes no socket calls: at most one eventfd write per cycle to wake the
+ * I/O thread if it sleeps. Created by MultiPairServer::AddPair(), one loop thread per endpoint.
+ */
+class PairEndpoint : public Transport
+{
+public:
+    PairEndpoint(const PairEndpoint&) = delete;
+    PairEndpoint& operator=(const PairEndpoint&) = delete;
+
+    ~PairEndpoint() override { ::close(fd_); }
+
+    bool Send(const void* data, size_t size) override;
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        while (rx_queue_.TryPop(rx_message_)) {
+            // Messages larger than the buffer are discarded as malformed, like truncated datagrams
+            if (rx_message_.size <= capacity) {
+                std::memcpy(buffer, rx_message_.data.data(), rx_message_.size);
+                return rx_message_.size;
+            }
+        }
+        return 0;
+    }
+
+    /** Traffic counters, safe to read from any thread */
+    PairMetrics metrics() const
+    {
+        PairMetrics metrics;
+        metrics.received_count = received_count_.load(std::memory_order_relaxed);
+        metrics.sent_count = sent_count_.load(std::memory_order_relaxed);
+        metrics.rx_overflow_count = rx_overflow_count_.load(std::memory_order_relaxed);
+        metrics.tx_overflow_count = tx_overflow_count_.load(std::memory_order_relaxed);
+        metrics.send_error_count = send_error_count_.load(std::memory_order_relaxed);
+        return metrics;
+    }
+
+private:
+    friend class MultiPairServer;
+
+    using Message = detail::PairMessage;
+
+    /** Datagrams buffered in each direction, about 64 ms of traffic at the loop rate */
+    static constexpr size_t kQueueCapacity = 64;
+
+    PairEndpoint(MultiPairServer& server, int fd, const sockaddr_in& remote_addr)
+    : server_(server)
+    , fd_(fd)
+    , remote_addr_(remote_addr)
+    {
+    }
+
+    MultiPairServer& server_;
+    int fd_;
+    sockaddr_in remote_addr_;
+    SpscQueue<Message, kQueueCapacity> rx_queue_;
+    SpscQueue<Message, kQueueCapacity> tx_queue_;
+    Message rx_message_;
+    Message tx_message_;
+    std::atomic<uint64_t> received_count_ {0};
+    std::atomic<uint64_t> sent_count_ {0};
+    std::atomic<uint64_t> rx_overflow_count_ {0};
+    std::atomic<uint64_t> tx_overflow_count_ {0};
+    std::atomic<uint64_t> send_error_count_ {0};
+};
+
+/**
+ * @class MultiPairServer
+ * @brief Hosts the network side of many leader/follower pairs in one process, e.g. all arms of a
+ * cell. Each pair gets its own UDP socket and a PairEndpoint its control loop sends and receives
+ * through, while a single I/O thread serves all sockets: it sleeps in epoll_wait() on the sockets
+ * and an eventfd, drains each readable socket with batched recvmmsg() and flushes everything the
+ * loops queued with batched sendmmsg(). With the io_uring backend the thread instead keeps one
+ * multishot receive armed per socket, which the kernel completes into a registered pool of
+ * buffers, and submits the sends and waits for the next completions in a single io_uring_enter().
+ * The loops thus keep their real-time cores free of socket calls, and the process pays one I/O
+ * thread instead of one set of network threads per pair. Datagrams are delivered like
+ * UdpTransport delivers them: unreliable and possibly reordered.
+ */
+class MultiPairServer
+{
+public:
+    /**
+     * @param[in] params Setup of the I/O thread.
+     * @throw std::invalid_argument if the batch size is 0.
+     * @throw std::runtime_error if epoll or the eventfd cannot be set up.
+     */
+    explicit MultiPairServer(const MultiPairServerParams& params = MultiPairServerParams())
+    : params_(params)
+    {
+#if FLEXIV_TELEOP_HAS_IO_URING
+        backend_ = params.backend == IoBackend::kIoUring && detail::ProbeIoUring()
+                       ? IoBackend::kIoUring
+                       : IoBackend::kEpoll;
+#else
+        backend_ = IoBackend::kEpoll;
+#endif
+        if (params.batch_size == 0) {
+            throw std::invalid_argument(
+                "[flexiv::omni::teleop::MultiPairServer] Batch size must be positive");
+        }
+        epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) {
+            ThrowSystemError("Failed to create epoll instance");
+        }
+        wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (wake_fd_ < 0) {
+            ::close(epoll_fd_);
+            ThrowSystemError("Failed to create eventfd");
+        }
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.u64 = kWakeToken;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event) < 0) {
+            ::close(wake_fd_);
+            ::close(epoll_fd_);
+            ThrowSystemError("Failed to watch eventfd");
+        }
+
+        // Scatter/gather descriptors for the batched calls, filled in once
+        batch_.resize(params.batch_size);
+        headers_.resize(params.batch_size);
+        iovecs_.resize(params.batch_size);
+        for (size_t i = 0; i < params.batch_size; ++i) {
+            iovecs_[i].iov_base = batch_[i].data.data();
+            iovecs_[i].iov_len = batch_[i].data.size();
+            headers_[i].msg_hdr.msg_iov = &iovecs_[i];
+            headers_[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    ~MultiPairServer()
+    {
+        Stop();
+        pairs_.clear();
+        ::close(wake_fd_);
+        ::close(epoll_fd_);
+    }
+
+    MultiPairServer(const MultiPairServer&) = delete;
+    MultiPairServer& operator=(const MultiPairServer&) = delete;
+
+    /**
+     * @brief Add a pair: open a socket bound to a local port that exchanges datagrams with one
+     * peer. Call before Start().
+     * @param[in] local_port Local UDP port to receive on.
+     * @param[in] remote_address IPv4 address of the peer.
+     * @param[in] remote_port UDP port the peer receives on.
+     * @return Transport for the pair's control loop, valid as long as the server.
+     * @throw std::invalid_argument if the address is malformed.
+     * @throw std::runtime_error if the server is running or the socket cannot be set up.
+     */
+    PairEndpoint& AddPair(
+        uint16_t local_port, const std::string& remote_address, uint16_t remote_port)
+    {
+        if (thread_.joinable()) {
+            throw std::runtime_error(
+                "[flexiv::omni::teleop::MultiPairServer] Pairs must be added before Start()");
+        }
+        sockaddr_in remote_addr {};
+        remote_addr.sin_family = AF_INET;
+        remote_addr.sin_port = htons(remote_port);
+        if (::inet_pton(AF_INET, remote_address.c_str(), &remote_addr.sin_addr) != 1) {
+            throw std::invalid_argument(
+                "[flexiv::omni::teleop::MultiPairServer] Invalid IPv4 address: " + remote_address);
+        }
+
+        const int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            ThrowSystemError("Failed to create socket");
+        }
+        const int enable = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        sockaddr_in local_addr {};
+        local_addr.sin_family = AF_INET;
+        local_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        local_addr.sin_port = htons(local_port);
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&local_addr), sizeof(local_addr)) < 0) {
+            ::close(fd);
+            ThrowSystemError("Failed to bind to port " + std::to_string(local_port));
+        }
+        epoll_event event {};
+        event.events = EPOLLIN;
+        event.data.u64 = pairs_.size();
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            ThrowSystemError("Failed to watch socket");
+        }
+        pairs_.emplace_back(new PairEndpoint(*this, fd, remote_addr));
+        return *pairs_.back();
+    }
+
+    /** @brief Start the I/O thread, if not running. */
+    void Start()
+    {
+        if (thread_.joinable()) {
+            return;
+        }
+        stop_ = false;
+        thread_ = std::thread([this]() { Run(); });
+    }
+
+    /** @brief Stop the I/O thread, if running. Datagrams still queued are discarded. */
+    void Stop()
+    {
+        if (!thread_.joinable()) {
+            return;
+        }
+        stop_ = true;
+        Notify();
+        thread_.join();
+    }
+
+    /** Backend in use, epoll if io_uring was requested but is not supported */
+    IoBackend backend() const { return backend_; }
+
+    /** Number of pairs added */
+    size_t pair_count() const { return pairs_.size(); }
+
+    /** Endpoint of a pair, in the order added */
+    PairEndpoint& pair(size_t index) { return *pairs_.at(index); }
+
+    /** Work done by the I/O thread, safe to read from any thread */
+    MultiPairServerMetrics metrics() const
+    {
+        MultiPairServerMetrics metrics;
+        metrics.wakeup_count = wakeup_count_.load(std::memory_order_relaxed);
+        metrics.notify_count = notify_count_.load(std::memory_order_relaxed);
+        metrics.recv_call_count = recv_call_count_.load(std::memory_order_relaxed);
+        metrics.send_call_count = send_call_count_.load(std::memory_order_relaxed);
+        metrics.submit_call_count = submit_call_count_.load(std::memory_order_relaxed);
+        for (const auto& pair : pairs_) {
+            const auto pair_metrics = pair->metrics();
+            metrics.received_count += pair_metrics.received_count;
+            metrics.sent_count += pair_metrics.sent_count;
+        }
+        return metrics;
+    }
+
+private:
+    friend class PairEndpoint;
+
+    /** epoll token of the eventfd, pairs use their index */
+    static constexpr uint64_t kWakeToken = UINT64_MAX;
+
+    /** Longest sleep of the I/O thread, bounds the reaction to Stop() if a wakeup were lost */
+    static constexpr int kMaxSleepMs = 100;
+
+    /** [Real-time] Wake the I/O thread if it sleeps, called after queueing a datagram */
+    void Notify()
+    {
+        // Pairs with the fence in Run(): either the I/O thread sees the queued datagram before
+        // sleeping, or this sees it sleeping and wakes it
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.exchange(false)) {
+            const uint64_t one = 1;
+            [[maybe_unused]] const ssize_t ret = ::write(wake_fd_, &one, sizeof(one));
+            notify_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void Run()
+    {
+        ConfigureRtThread(params_.io_thread);
+#if FLEXIV_TELEOP_HAS_IO_URING
+        if (backend_ == IoBackend::kIoUring && RunIoUring()) {
+            return;
+        }
+        backend_ = IoBackend::kEpoll;
+#endif
+        RunEpoll();
+    }
+
+    void RunEpoll()
+    {
+        std::vector<epoll_event> events(pairs_.size() + 1);
+        while (!stop_) {
+            FlushAll();
+
+            // Announce sleeping, then look once more for datagrams queued meanwhile
+            sleeping_ = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (HasPendingSends()) {
+                sleeping_ = false;
+                continue;
+            }
+            const int count = ::epoll_wait(
+                epoll_fd_, events.data(), static_cast<int>(events.size()), kMaxSleepMs);
+            sleeping_ = false;
+            wakeup_count_.fetch_add(1, std::memory_order_relaxed);
+            for (int i = 0; i < count; ++i) {
+                if (events[i].data.u64 == kWakeToken) {
+                    uint64_t value;
+                    [[maybe_unused]] const ssize_t ret = ::read(wake_fd_, &value, sizeof(value));
+                } else {
+                    Drain(*pairs_[events[i].data.u64]);
+                }
+            }
+        }
+    }
+
+    /** Move all datagrams waiting in a pair's socket to its receive queue */
+    void Drain(PairEndpoint& pair)
+    {
+        while (true) {
+            for (size_t i = 0; i < batch_.size(); ++i) {
+                headers_[i].msg_hdr.msg_name = nullptr;
+                headers_[i].msg_hdr.msg_namelen = 0;
+                headers_[i].msg_hdr.msg_flags = 0;
+            }
+            const int count = ::recvmmsg(pair.fd_, headers_.data(),
+                static_cast<unsigned int>(batch_.size()), MSG_DONTWAIT, nullptr);
+            recv_call_count_.fetch_add(1, std::memory_order_relaxed);
+            if (count <= 0) {
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            for (int i = 0; i < count; ++i) {
+                // Datagrams larger than a message are truncated, discard them as malformed
+                if (headers_[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                    continue;
+                }
+                batch_[i].size = headers_[i].msg_len;
+                Deliver(pair, batch_[i]);
+            }
+            if (static_cast<size_t>(count) < batch_.size()) {
+                return;
+            }
+        }
+    }
+
+    /** Send all datagrams the loops queued */
+    void FlushAll()
+    {
+        for (const auto& pair : pairs_) {
+            while (true) {
+                size_t count = 0;
+                while (count < batch_.size() && pair->tx_queue_.TryPop(batch_[count])) {
+                    iovecs_[count].iov_len = batch_[count].size;
+                    headers_[count].msg_hdr.msg_name = &pair->remote_addr_;
+                    headers_[count].msg_hdr.msg_namelen = sizeof(pair->remote_addr_);
+                    ++count;
+                }
+                if (count == 0) {
+                    break;
+                }
+                // A full socket buffer drops the rest rather than blocking, newer ones will follow
+                size_t sent = 0;
+                while (sent < count) {
+                    const int ret = ::sendmmsg(pair->fd_, headers_.data() + sent,
+                        static_cast<unsigned int>(count - sent), MSG_DONTWAIT);
+                    send_call_count_.fetch_add(1, std::memory_order_relaxed);
+                    if (ret < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (ret <= 0) {
+                        break;
+                    }
+                    sent += static_cast<size_t>(ret);
+                }
+                pair->sent_count_.fetch_add(sent, std::memory_order_relaxed);
+                pair->send_error_count_.fetch_add(count - sent, std::memory_order_relaxed);
+            }
+        }
+        for (auto& iovec : iovecs_) {
+            iovec.iov_len = kMaxMessageSize;
+        }
+    }
+
+#if FLEXIV_TELEOP_HAS_IO_URING
+    /** Kind of request a completion belongs to, in the upper half of its user data */
+    enum class RequestKind : uint32_t
+    {
+        kReceive,
+        kSend,
+        kWake,
+    };
+
+    /** A send in flight, its datagram must stay in place until completed */
+    struct SendSlot
+    {
+        msghdr msg;
+        iovec iov;
+        PairEndpoint::Message message;
+        uint32_t pair_index;
+    };
+
+    /** Concurrent sends in flight */
+    static constexpr size_t kSendSlotCount = 128;
+
+    /** Receive buffers, each holds one datagram after its io_uring_recvmsg_out header */
+    static constexpr unsigned kReceiveBufferCount = 256;
+    static constexpr unsigned kReceiveBufferSize
+        = sizeof(io_uring_recvmsg_out) + static_cast<unsigned>(kMaxMessageSize);
+
+    static uint64_t UserData(RequestKind kind, uint32_t index)
+    {
+        return (static_cast<uint64_t>(kind) << 32) | index;
+    }
+
+    /**
+     * @brief Serve all pairs through io_uring until stopped.
+     * @return False if the ring could not be set up, nothing was done then.
+     */
+    bool RunIoUring()
+    {
+        // Declared first so that the ring is torn down before its buffers
+        detail::ProvidedBuffers buffers;
+        detail::IoUring ring;
+        const auto num_pairs = static_cast<uint32_t>(pairs_.size());
+        unsigned entries = 1;
+        while (entries < kSendSlotCount + num_pairs + 1) {
+            entries *= 2;
+        }
+        if (!ring.Init(entries, 4 * entries)
+            || buffers.Init(ring, 0, kReceiveBufferCount, kReceiveBufferSize) < 0) {
+            return false;
+        }
+        // Sockets and eventfd as fixed files, which saves a file table lookup per request
+        std::vector<int> files;
+        for (const auto& pair : pairs_) {
+            files.push_back(pair->fd_);
+        }
+        files.push_back(wake_fd_);
+        if (ring.Register(IORING_REGISTER_FILES, files.data(), static_cast<unsigned>(files.size()))
+            < 0) {
+            return false;
+        }
+
+        // All storage requests point to is set up before the loop and never moves
+        std::vector<SendSlot> slots(kSendSlotCount);
+        std::vector<uint32_t> free_slots;
+        for (uint32_t i = 0; i < kSendSlotCount; ++i) {
+            slots[i].iov.iov_base = slots[i].message.data.data();
+            slots[i].msg.msg_iov = &slots[i].iov;
+            slots[i].msg.msg_iovlen = 1;
+            free_slots.push_back(kSendSlotCount - 1 - i);
+        }
+        msghdr receive_msg {};
+        uint64_t wake_value = 0;
+        auto arm_receive = [&](uint32_t index) {
+            io_uring_sqe* sqe = ring.GetSqe();
+            sqe->opcode = IORING_OP_RECVMSG;
+            sqe->fd = static_cast<int32_t>(index);
+            sqe->flags = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+            sqe->addr = reinterpret_cast<uint64_t>(&receive_msg);
+            sqe->ioprio = IORING_RECV_MULTISHOT;
+            sqe->buf_group = 0;
+            sqe->user_data = UserData(RequestKind::kReceive, index);
+        };
+        auto arm_wake = [&]() {
+            io_uring_sqe* sqe = ring.GetSqe();
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = static_cast<int32_t>(num_pairs);
+            sqe->flags = IOSQE_FIXED_FILE;
+            sqe->addr = reinterpret_cast<uint64_t>(&wake_value);
+            sqe->len = sizeof(wake_value);
+            sqe->user_data = UserData(RequestKind::kWake, 0);
+        };
+        for (uint32_t i = 0; i < num_pairs; ++i) {
+            arm_receive(i);
+        }
+        arm_wake();
+
+        while (!stop_) {
+            // Queue a send per datagram the loops queued, as far as slots are free
+            for (uint32_t i = 0; i < num_pairs && !free_slots.empty(); ++i) {
+                PairEndpoint& pair = *pairs_[i];
+                while (!free_slots.empty()
+                       && pair.tx_queue_.TryPop(slots[free_slots.back()].message)) {
+                    SendSlot& slot = slots[free_slots.back()];
+                    slot.iov.iov_len = slot.message.size;
+                    slot.msg.msg_name = &pair.remote_addr_;
+                    slot.msg.msg_namelen = sizeof(pair.remote_addr_);
+                    slot.pair_index = i;
+                    io_uring_sqe* sqe = ring.GetSqe();
+                    sqe->opcode = IORING_OP_SENDMSG;
+                    sqe->fd = static_cast<int32_t>(i);
+                    sqe->flags = IOSQE_FIXED_FILE;
+                    sqe->addr = reinterpret_cast<uint64_t>(&slot.msg);
+                    sqe->msg_flags = MSG_DONTWAIT;
+                    sqe->user_data = UserData(RequestKind::kSend, free_slots.back());
+                    free_slots.pop_back();
+                }
+            }
+
+            // Announce sleeping, then look once more for datagrams queued meanwhile
+            sleeping_ = true;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (HasPendingSends() && !free_slots.empty()) {
+                sleeping_ = false;
+                ring.Enter(0);
+                submit_call_count_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            ring.Enter(1);
+            sleeping_ = false;
+            wakeup_count_.fetch_add(1, std::memory_order_relaxed);
+
+            ring.ForEachCompletion([&](const io_uring_cqe& cqe) {
+                const auto kind = static_cast<RequestKind>(cqe.user_data >> 32);
+                const auto index = static_cast<uint32_t>(cqe.user_data);
+                if (kind == RequestKind::kReceive) {
+                    if (cqe.flags & IORING_CQE_F_BUFFER) {
+                        const auto id
+                            = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                        const uint8_t* data = buffers.data(id);
+                        const auto* out = reinterpret_cast<const io_uring_recvmsg_out*>(data);
+                        // Datagrams larger than a message are truncated, discard them as malformed
+                        if (cqe.res >= static_cast<int>(sizeof(*out))
+                            && !(out->flags & MSG_TRUNC)) {
+                            auto& message = batch_.front();
+                            message.size = out->payloadlen;
+                            std::memcpy(message.data.data(),
+                                data + sizeof(*out) + out->namelen + out->controllen,
+                                out->payloadlen);
+                            Deliver(*pairs_[index], message);
+                        }
+                        buffers.Recycle(id);
+                    }
+                    // The kernel ends a multishot receive e.g. when it ran out of buffers
+                    if (!(cqe.flags & IORING_CQE_F_MORE)) {
+                        arm_receive(index);
+                    }
+                } else if (kind == RequestKind::kSend) {
+                    PairEndpoint& pair = *pairs_[slots[index].pair_index];
+                    if (cqe.res >= 0) {
+                        pair.sent_count_.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        pair.send_error_count_.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    free_slots.push_back(index);
+                } else {
+                    arm_wake();
+                }
+            });
+            buffers.Commit();
+        }
+        return true;
+    }
+#endif
+
+    /** Hand a received datagram to a pair's loop */
+    static void Deliver(PairEndpoint& pair, const PairEndpoint::Message& message)
+    {
+        if (pair.rx_queue_.TryPush(message)) {
+            pair.received_count_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            pair.rx_overflow_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool HasPendingSends() const
+    {
+        for (const auto& pair : pairs_) {
+            if (!pair->tx_queue_.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    [[noreturn]] static void ThrowSystemError(const std::string& what)
+    {
+        throw std::runtime_error(
+            "[flexiv::omni::teleop::MultiPairServer] " + what + ": " + std::strerror(errno));
+    }
+
+    MultiPairServerParams params_;
+    std::atomic<IoBackend> backend_ {IoBackend::kEpoll};
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::vector<std::unique_ptr<PairEndpoint>> pairs_;
+    std::vector<PairEndpoint::Message> batch_;
+    std::vector<mmsghdr> headers_;
+    std::vector<iovec> iovecs_;
+    std::thread thread_;
+    std::atomic<bool> stop_ {false};
+    std::atomic<bool> sleeping_ {false};
+    std::atomic<uint64_t> wakeup_count_ {0};
+    std::atomic<uint64_t> notify_count_ {0};
+    std::atomic<uint64_t> recv_call_count_ {0};
+    std::atomic<uint64_t> send_call_count_ {0};
+    std::atomic<uint64_t> submit_call_count_ {0};
+};
+
+inline bool PairEndpoint::Send(const void* data, size_t size)
+{
+    if (size > kMaxMessageSize) {
+        return false;
+    }
+    tx_message_.size = static_cast<uint32_t>(size);
+    std::memcpy(tx_message_.data.data(), data, size);
+    if (!tx_queue_.TryPush(tx_message_)) {
+        tx_overflow_count_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    server_.Notify();
+    return true;
+}
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,274 @@
+/**
+ * @file multipath.hpp
+ * @brief Redundant transmission of every message over several network paths, keeping the first
+ * copy to arrive.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "epoch_tracker.hpp"
+#include "transport.hpp"
+#include "wire_format.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/** Magic number at the start of every multipath datagram, "FOTM" in little-endian byte order */
+constexpr uint32_t kMultipathMagic = 0x4D544F46;
+
+/** Largest number of paths a MultipathTransport sends over */
+constexpr size_t kMaxMultipathPaths = 4;
+
+/**
+ * @struct MultipathHeader
+ * @brief Header in front of every copy sent over a path.
+ */
+struct MultipathHeader
+{
+    uint32_t magic = kMultipathMagic;
+
+    /** Path the copy was sent over */
+    uint8_t path = 0;
+
+    uint8_t reserved[3] = {};
+
+    /**
+     * Random number drawn by the sender when it starts, see NewEpoch(). A new epoch tells the
+     * receiver that the sender restarted and its sequence starts over.
+     */
+    uint32_t epoch = 0;
+
+    uint32_t reserved_2 = 0;
+
+    /** Sequence number of the message, the same on every path, starting from 1 in every epoch */
+    uint64_t sequence = 0;
+};
+static_assert(sizeof(MultipathHeader) == 24, "MultipathHeader must have no padding");
+
+/**
+ * @struct MultipathPathStats
+ * @brief Traffic over one path.
+ */
+struct MultipathPathStats
+{
+    /** Copies handed to the path, and copies it refused, e.g. with its link down */
+    uint64_t sent_count = 0;
+    uint64_t send_failure_count = 0;
+
+    /** Copies received over the path */
+    uint64_t received_count = 0;
+
+    /** Copies that were the first of their message to arrive, and thus delivered */
+    uint64_t first_count = 0;
+};
+
+/**
+ * @struct MultipathStats
+ * @brief Traffic of a MultipathTransport so far.
+ */
+struct MultipathStats
+{
+    /** Messages delivered, each once */
+    uint64_t delivered_count = 0;
+
+    /** Copies dropped for their message having arrived over another path before */
+    uint64_t duplicate_count = 0;
+
+    /**
+     * Copies dropped for being too old to tell whether their message arrived before, or for not
+     * being of the sender's current epoch
+     */
+    uint64_t stale_count = 0;
+
+    /** Datagrams dropped for not carrying a multipath header */
+    uint64_t malformed_count = 0;
+
+    /** Times the peer was detected restarting, i.e. starting a new epoch */
+    uint64_t restart_count = 0;
+
+    /** Traffic of each path, in the order given */
+    std::array<MultipathPathStats, kMaxMultipathPaths> paths = {};
+};
+
+/**
+ * @class MultipathTransport
+ * @brief Sends every message over each of several transports, e.g. one UDP socket per network
+ * interface for a wired link and an LTE link, and delivers the first copy to arrive. A latency
+ * spike or outage on one path then costs nothing as long as another path is on time, so the
+ * tail latency is that of the best path at each moment rather than of a fixed one, at the price
+ * of sending everything once per path. Copies carry a sequence number of their own, so that any
+ * message can be deduplicated, compressed and encrypted ones too; a window of the last
+ * kDedupWindow sequence numbers remembers which have arrived. Once an EpochTracker confirms a
+ * new epoch, the sender restarted: the window starts over with it, and late copies of the epochs
+ * before are dropped as stale, as are the few copies before the confirmation. The header is not
+ * authenticated: over untrusted paths, put an EncryptedTransport above this one, never one per
+ * path, which would encrypt the copies with the same nonces.
+ */
+class MultipathTransport : public Transport
+{
+public:
+    /** Sequence numbers the receiver remembers, later copies of older ones are dropped as stale */
+    static constexpr uint64_t kDedupWindow = 1024;
+
+    /**
+     * @param[in] paths Transports to send over, must outlive this one.
+     * @throw std::invalid_argument if there are no paths or more than kMaxMultipathPaths.
+     */
+    explicit MultipathTransport(const std::vector<Transport*>& paths)
+    : paths_(paths)
+    , tx_epoch_(NewEpoch())
+    {
+        if (paths.empty() || paths.size() > kMaxMultipathPaths) {
+            throw std::invalid_argument(
+                "[flexiv::omni::teleop::MultipathTransport] Number of paths must be within [1, "
+                + std::to_string(kMaxMultipathPaths) + "]");
+        }
+        for (const auto* path : paths) {
+            if (path == nullptr) {
+                throw std::invalid_argument(
+                    "[flexiv::omni::teleop::MultipathTransport] Path must not be null");
+            }
+        }
+    }
+
+    bool Send(const void* data, size_t size) override
+    {
+        if (size + sizeof(MultipathHeader) > kMaxMessageSize) {
+            return false;
+        }
+        MultipathHeader header;
+        header.epoch = tx_epoch_;
+        header.sequence = ++sequence_;
+        std::memcpy(tx_buffer_.data() + sizeof(header), data, size);
+        bool sent = false;
+        for (size_t i = 0; i < paths_.size(); ++i) {
+            header.path = static_cast<uint8_t>(i);
+            std::memcpy(tx_buffer_.data(), &header, sizeof(header));
+            auto& path_stats = stats_.paths[i];
+            if (paths_[i]->Send(tx_buffer_.data(), size + sizeof(header))) {
+                ++path_stats.sent_count;
+                sent = true;
+            } else {
+                ++path_stats.send_failure_count;
+            }
+        }
+        return sent;
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        // Start from a different path each call so that none is starved
+        const size_t first = next_path_;
+        next_path_ = (next_path_ + 1) % paths_.size();
+        for (size_t n = 0; n < paths_.size(); ++n) {
+            const size_t i = (first + n) % paths_.size();
+            size_t size;
+            while ((size = paths_[i]->Receive(rx_buffer_.data(), rx_buffer_.size())) > 0) {
+                MultipathHeader header;
+                if (size < sizeof(header)) {
+                    ++stats_.malformed_count;
+                    continue;
+                }
+                std::memcpy(&header, rx_buffer_.data(), sizeof(header));
+                if (header.magic != kMultipathMagic || header.sequence == 0) {
+                    ++stats_.malformed_count;
+                    continue;
+                }
+                ++stats_.paths[i].received_count;
+                // A copy that does not fit must not mark its message as arrived
+                const size_t payload_size = size - sizeof(header);
+                if (payload_size > capacity || !Admit(header.sequence, header.epoch)) {
+                    continue;
+                }
+                ++stats_.paths[i].first_count;
+                ++stats_.delivered_count;
+                std::memcpy(buffer, rx_buffer_.data() + sizeof(header), payload_size);
+                return payload_size;
+            }
+        }
+        return 0;
+    }
+
+    /** Number of paths */
+    size_t path_count() const { return paths_.size(); }
+
+    /** Traffic so far */
+    const MultipathStats& stats() const { return stats_; }
+
+private:
+    static constexpr size_t kWindowWords = kDedupWindow / 64;
+
+    /** Whether a copy is the first of its message, marking it as arrived if so */
+    bool Admit(uint64_t sequence, uint32_t epoch)
+    {
+        using Verdict = EpochTracker<uint32_t>::Verdict;
+        switch (epochs_.Observe(epoch, sequence)) {
+            case Verdict::kRetired:
+            case Verdict::kPending:
+                ++stats_.stale_count;
+                return false;
+            case Verdict::kRestarted:
+                arrived_ = {};
+                newest_ = 0;
+                ++stats_.restart_count;
+                break;
+            case Verdict::kCurrent:
+                break;
+        }
+
+        if (sequence > newest_) {
+            // Forget the sequence numbers the window slides past
+            const uint64_t oldest_kept = sequence > kDedupWindow ? sequence - kDedupWindow + 1 : 1;
+            const uint64_t begin = std::max(newest_ + 1, oldest_kept);
+            for (uint64_t s = begin; s < sequence; ++s) {
+                ClearArrived(s);
+            }
+            newest_ = sequence;
+            SetArrived(sequence);
+            return true;
+        }
+        const uint64_t age = newest_ - sequence;
+        if (age >= kDedupWindow) {
+            ++stats_.stale_count;
+            return false;
+        }
+        if (IsArrived(sequence)) {
+            ++stats_.duplicate_count;
+            return false;
+        }
+        SetArrived(sequence);
+        return true;
+    }
+
+    bool IsArrived(uint64_t s) const
+    {
+        return arrived_[(s / 64) % kWindowWords] & (1ull << (s % 64));
+    }
+    void SetArrived(uint64_t s) { arrived_[(s / 64) % kWindowWords] |= 1ull << (s % 64); }
+    void ClearArrived(uint64_t s) { arrived_[(s / 64) % kWindowWords] &= ~(1ull << (s % 64)); }
+
+    std::vector<Transport*> paths_;
+    uint32_t tx_epoch_;
+    uint64_t sequence_ = 0;
+    uint64_t newest_ = 0;
+    EpochTracker<uint32_t> epochs_;
+    size_t next_path_ = 0;
+    std::array<uint64_t, kWindowWords> arrived_ = {};
+    MultipathStats stats_;
+    std::array<uint8_t, kMaxMessageSize> tx_buffer_ = {};
+    std::array<uint8_t, kMaxMessageSize> rx_buffer_ = {};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,158 @@
+/**
+ * @file passivity.hpp
+ * @brief Time-domain passivity observer and controller keeping delayed force feedback stable.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "data.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct PassivityParams
+ * @brief Tuning of the passivity controller.
+ */
+struct PassivityParams
+{
+    /**
+     * Largest energy the observer credits to each joint of the teleop channel [J]. Energy the
+     * channel absorbed earlier, e.g. while the operator pushed into a contact, may be returned
+     * later without damping; capping it bounds how much stored energy can come back at once.
+     */
+    double max_stored_energy = 0.5;
+
+    /**
+     * Largest damping the controller adds to each joint [Nm s/rad]. Damping the leader cannot
+     * render within one cycle makes the joint chatter, keep it below the joint's inertia divided
+     * by twice the sample period. Defaults suit a Rizon 4 used as leader.
+     */
+    JointArray max_damping = {400.0, 400.0, 200.0, 200.0, 50.0, 50.0, 25.0};
+
+    /** Joint speed below which no damping is added, avoids dividing by ~0 [rad/s] */
+    double min_speed = 1e-3;
+};
+
+/**
+ * @struct PassivityMetrics
+ * @brief Energy balance of the force feedback port, accumulated since the controller was created.
+ */
+struct PassivityMetrics
+{
+    /** Energy credited to the channel summed over joints, negative while a deficit remains [J] */
+    double observed_energy = 0.0;
+
+    /** Energy that flowed from the channel back to the operator [J] */
+    double returned_energy = 0.0;
+
+    /** Energy removed by the added damping [J] */
+    double dissipated_energy = 0.0;
+
+    /** Number of cycles in which damping was added to any joint */
+    uint64_t active_count = 0;
+};
+
+/**
+ * @class PassivityController
+ * @brief Time-domain passivity observer/controller (Hannaford and Ryu) on the leader's force
+ * feedback port. Seen from the leader arm, the link, the follower and its environment form a
+ * one-port per joint that exchanges power -tau * dq with the operator. Without delay these
+ * ports are passive, with delay the feedback lags the motion and a port can return more energy
+ * than it received, which is what destabilizes stiff contacts over long links. The observer
+ * integrates the energy of each port every cycle; whenever it would turn negative the controller
+ * adds just enough damping on that joint to dissipate the deficit. On passive cycles the feedback
+ * passes through unchanged, so transparency is kept everywhere else and no global gain has to be
+ * detuned. Fixed-size state, no allocation.
+ */
+class PassivityController
+{
+public:
+    /**
+     * @param[in] params Tuning.
+     * @param[in] sample_period Period at which Apply() is called [s].
+     * @throw std::invalid_argument if sample_period is not positive.
+     */
+    explicit PassivityController(
+        const PassivityParams& params = PassivityParams(), double sample_period = kLoopPeriod)
+    : params_(params)
+    , dt_(sample_period)
+    {
+        if (sample_period <= 0.0) {
+            throw std::invalid_argument(
+                "[flexiv::omni::teleop::PassivityController] Sample period must be positive");
+        }
+    }
+
+    /**
+     * @brief [Real-time] Observe one cycle and make the feedback passive. Call every cycle, also
+     * when the feedback did not change, since the energy flows with the leader's motion.
+     * @param[in] feedback Feedback torques about to be rendered on the leader [Nm].
+     * @param[in] dq Current joint velocities of the leader [rad/s].
+     * @return Torques to render instead, with the damping added [Nm].
+     */
+    const JointArray& Apply(const JointArray& feedback, const JointArray& dq)
+    {
+        output_ = feedback;
+        bool active = false;
+        double total_energy = 0.0;
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            // Observe the energy that flowed from the operator into the channel during the last
+            // cycle, from the torque rendered then and the motion it produced
+            const double observed = -last_output_[i] * dq[i] * dt_;
+            if (observed < 0.0) {
+                metrics_.returned_energy -= observed;
+            }
+            energy_[i] = std::min(energy_[i] + observed, params_.max_stored_energy);
+
+            // Add the damping that keeps the energy non-negative through this cycle, limited to
+            // what the leader can render; a deficit left over is dissipated in the next cycles
+            const double deficit = -(energy_[i] - feedback[i] * dq[i] * dt_);
+            if (deficit > 0.0 && std::abs(dq[i]) > params_.min_speed) {
+                const double damping = std::min(
+                    deficit / (dt_ * dq[i] * dq[i]), std::max(params_.max_damping[i], 0.0));
+                output_[i] -= damping * dq[i];
+                metrics_.dissipated_energy += damping * dq[i] * dq[i] * dt_;
+                active = true;
+            }
+            total_energy += energy_[i];
+        }
+        metrics_.observed_energy = total_energy;
+        metrics_.active_count += active;
+        last_output_ = output_;
+        return output_;
+    }
+
+    /** Forget the energy balance, e.g. when feedback is re-engaged */
+    void Reset()
+    {
+        metrics_ = PassivityMetrics();
+        energy_ = {};
+        output_ = {};
+        last_output_ = {};
+    }
+
+    /** Latest torques returned by Apply() [Nm] */
+    const JointArray& output() const { return output_; }
+
+    /** Energy balance */
+    const PassivityMetrics& metrics() const { return metrics_; }
+
+private:
+    PassivityParams params_;
+    double dt_;
+    PassivityMetrics metrics_;
+    JointArray energy_ = {};
+    JointArray output_ = {};
+    JointArray last_output_ = {};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
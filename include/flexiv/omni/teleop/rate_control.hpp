@@ -0,0 +1,206 @@
+/**
+ * @file rate_control.hpp
+ * @brief Congestion-aware control of the rate a node streams its states at.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct RateControlParams
+ * @brief Tuning of the rate controller.
+ */
+struct RateControlParams
+{
+    /** Largest divider of the loop rate, a power of 2, e.g. 4 streams at 250 Hz at the lowest */
+    unsigned max_rate_divider = 4;
+
+    /** Round-trip time above the baseline that is taken as queues building up [ns] */
+    int64_t queuing_delay_threshold_ns = 20000000;
+
+    /** Share of the peer's packets lost within a window that is taken as congestion [0-1] */
+    double loss_threshold = 0.05;
+
+    /** Length of the windows congestion is evaluated over [ns] */
+    int64_t window_ns = 100000000;
+
+    /** Time without congestion before the rate is doubled again [ns] */
+    int64_t ramp_up_delay_ns = 2000000000;
+
+    /** Time the baseline round-trip time is the minimum over [ns] */
+    int64_t baseline_window_ns = 10000000000;
+};
+
+/**
+ * @struct RateControlMetrics
+ * @brief Current state and counters of the rate controller.
+ */
+struct RateControlMetrics
+{
+    /** Current divider of the loop rate, 1 at full rate */
+    unsigned rate_divider = 1;
+
+    /** Smallest round-trip time in the latest window, 0 if none was measured [ns] */
+    int64_t round_trip_ns = 0;
+
+    /** Smallest round-trip time over the baseline window [ns] */
+    int64_t baseline_round_trip_ns = 0;
+
+    /** Share of the peer's packets lost in the latest window [0-1] */
+    double loss_ratio = 0.0;
+
+    /** Number of times the rate was lowered */
+    uint64_t decrease_count = 0;
+
+    /** Number of times the rate was raised */
+    uint64_t increase_count = 0;
+
+    /** Number of cycles a state was not sent to keep the rate down */
+    uint64_t skipped_count = 0;
+};
+
+/**
+ * @class RateController
+ * @brief Lowers the rate a node streams its states at when the link congests, and ramps it back
+ * up once the link recovered, so that a link that can no longer carry the full rate does not
+ * build up queues in routers that delay every packet by up to seconds.
+ * @details Congestion is read from two signals, evaluated over fixed windows: round-trip time
+ * rising above its baseline, the minimum over a long window, which shows queues building up
+ * before any packet is dropped; and loss of the peer's packets, which share the congested link,
+ * or no peer packet arriving at all. On congestion the rate is halved, at most once per round
+ * trip so that the effect of the previous step is seen first, down to the loop rate divided by
+ * max_rate_divider. After ramp_up_delay_ns without congestion it is doubled again, step by step.
+ * Receivers interpolate between the sparser states, see FollowerParams::use_target_interpolation.
+ * Fixed-size state, no allocation.
+ */
+class RateController
+{
+public:
+    explicit RateController(const RateControlParams& params = RateControlParams())
+    : params_(params)
+    {
+        max_divider_ = 1;
+        while (max_divider_ * 2 <= std::max(params.max_rate_divider, 1u)) {
+            max_divider_ *= 2;
+        }
+    }
+
+    /**
+     * @brief [Real-time] Add a round-trip time sample.
+     * @param[in] round_trip_ns Network round-trip time, excluding the peer's hold time [ns].
+     */
+    void AddRoundTrip(int64_t round_trip_ns)
+    {
+        if (round_trip_ns >= 0) {
+            window_min_rtt_ = std::min(window_min_rtt_, round_trip_ns);
+            baseline_block_min_ = std::min(baseline_block_min_, round_trip_ns);
+        }
+    }
+
+    /**
+     * @brief [Real-time] Advance by one cycle and decide whether to send this cycle's state.
+     * @param[in] now_ns Current local time [ns].
+     * @param[in] received_count Total number of valid packets received from the peer.
+     * @param[in] lost_count Total number of the peer's packets lost so far.
+     * @return True if the state should be sent this cycle.
+     */
+    bool Update(int64_t now_ns, uint64_t received_count, uint64_t lost_count)
+    {
+        if (!started_) {
+            started_ = true;
+            window_start_ns_ = baseline_block_start_ns_ = last_change_ns_ = now_ns;
+            last_congestion_ns_ = now_ns;
+            last_received_count_ = received_count;
+            last_lost_count_ = lost_count;
+        }
+        if (now_ns - window_start_ns_ >= params_.window_ns) {
+            EvaluateWindow(now_ns, received_count, lost_count);
+        }
+
+        const bool send = cycle_++ % metrics_.rate_divider == 0;
+        metrics_.skipped_count += !send;
+        return send;
+    }
+
+    /** Current state and counters */
+    const RateControlMetrics& metrics() const { return metrics_; }
+
+private:
+    void EvaluateWindow(int64_t now_ns, uint64_t received_count, uint64_t lost_count)
+    {
+        // Windowed minimum over two alternating blocks, so that the baseline can also rise when
+        // the path gets longer
+        if (now_ns - baseline_block_start_ns_ >= params_.baseline_window_ns / 2) {
+            baseline_previous_min_ = baseline_block_min_;
+            baseline_block_min_ = std::numeric_limits<int64_t>::max();
+            baseline_block_start_ns_ = now_ns;
+        }
+        const int64_t baseline = std::min(baseline_previous_min_, baseline_block_min_);
+
+        // Late arrivals lower the lost count again
+        const uint64_t received = received_count - last_received_count_;
+        const uint64_t lost = lost_count > last_lost_count_ ? lost_count - last_lost_count_ : 0;
+        metrics_.loss_ratio
+            = received + lost > 0 ? static_cast<double>(lost) / (received + lost) : 0.0;
+        const bool has_rtt = window_min_rtt_ != std::numeric_limits<int64_t>::max();
+        metrics_.round_trip_ns = has_rtt ? window_min_rtt_ : 0;
+        metrics_.baseline_round_trip_ns
+            = baseline != std::numeric_limits<int64_t>::max() ? baseline : 0;
+
+        // Silence counts once the peer was heard from, not while it is still starting up
+        const bool congested
+            = (received == 0 && received_count > 0)
+              || metrics_.loss_ratio > params_.loss_threshold
+              || (has_rtt && window_min_rtt_ - baseline > params_.queuing_delay_threshold_ns);
+        if (congested) {
+            last_congestion_ns_ = now_ns;
+            const int64_t settle_ns = std::max(params_.window_ns, metrics_.round_trip_ns);
+            if (metrics_.rate_divider < max_divider_ && now_ns - last_change_ns_ >= settle_ns) {
+                metrics_.rate_divider *= 2;
+                ++metrics_.decrease_count;
+                last_change_ns_ = now_ns;
+            }
+        } else if (metrics_.rate_divider > 1
+                   && now_ns - std::max(last_congestion_ns_, last_change_ns_)
+                          >= params_.ramp_up_delay_ns) {
+            metrics_.rate_divider /= 2;
+            ++metrics_.increase_count;
+            last_change_ns_ = now_ns;
+        }
+
+        window_start_ns_ = now_ns;
+        window_min_rtt_ = std::numeric_limits<int64_t>::max();
+        last_received_count_ = received_count;
+        last_lost_count_ = lost_count;
+    }
+
+    RateControlParams params_;
+    unsigned max_divider_ = 1;
+    RateControlMetrics metrics_;
+    uint64_t cycle_ = 0;
+
+    bool started_ = false;
+    int64_t window_start_ns_ = 0;
+    int64_t window_min_rtt_ = std::numeric_limits<int64_t>::max();
+    uint64_t last_received_count_ = 0;
+    uint64_t last_lost_count_ = 0;
+
+    int64_t baseline_block_start_ns_ = 0;
+    int64_t baseline_block_min_ = std::numeric_limits<int64_t>::max();
+    int64_t baseline_previous_min_ = std::numeric_limits<int64_t>::max();
+
+    int64_t last_change_ns_ = 0;
+    int64_t last_congestion_ns_ = 0;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,701 @@
+/**
+ * @file relay.hpp
+ * @brief Relay server forwarding teleop datagrams between sites that cannot reach each other
+ * directly, e.g. both behind carrier-grade NAT, and the endpoint transport that talks through it.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "clock.hpp"
+#include "transport.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/** Magic number at the start of every relayed datagram, "FOTR" in little-endian byte order */
+constexpr uint32_t kRelayMagic = 0x52544F46;
+
+/**
+ * @enum RelayRole
+ * @brief Which end of a session an endpoint is, the relay forwards each to the other.
+ */
+enum class RelayRole : uint8_t
+{
+    kLeader = 0,
+    kFollower = 1,
+};
+
+/**
+ * @enum RelayDatagramType
+ * @brief What a datagram to the relay is for.
+ */
+enum class RelayDatagramType : uint8_t
+{
+    /** Message for the other end */
+    kData = 0,
+
+    /** Registration of the sender's address, the session token follows the header */
+    kRegister = 1,
+};
+
+/** Size of a session token [bytes] */
+constexpr size_t kRelayTokenSize = 16;
+
+/**
+ * Secret of a session shared by both ends, proving to the relay that a datagram comes from one
+ * of them. Keep it as secret as an encryption key, and use a fresh one per session.
+ */
+using RelayToken = std::array<uint8_t, kRelayTokenSize>;
+
+/**
+ * @brief Draw a session token from the kernel's random number generator.
+ * @throw std::runtime_error if the kernel has no randomness to give.
+ */
+inline RelayToken GenerateRelayToken()
+{
+    RelayToken token;
+    size_t filled = 0;
+    while (filled < token.size()) {
+        const ssize_t ret = ::getrandom(token.data() + filled, token.size() - filled, 0);
+        if (ret < 0 && errno != EINTR) {
+            throw std::runtime_error(
+                std::string("[flexiv::omni::teleop::GenerateRelayToken] getrandom failed: ")
+                + std::strerror(errno));
+        }
+        filled += ret > 0 ? static_cast<size_t>(ret) : 0;
+    }
+    return token;
+}
+
+/**
+ * @struct RelayHeader
+ * @brief Header in front of every datagram to and from the relay. The relay forwards datagrams
+ * unchanged, header included, so the receiving end can check whose they are.
+ */
+struct RelayHeader
+{
+    uint32_t magic = kRelayMagic;
+
+    /** Role of the sender, see RelayRole */
+    uint8_t role = 0;
+
+    /** Kind of datagram, see RelayDatagramType */
+    uint8_t type = 0;
+
+    uint8_t reserved[2] = {};
+
+    /** Session both ends registered for, random so that it cannot be guessed */
+    uint64_t session_id = 0;
+
+    /**
+     * Time stamp of the sender, increasing over its datagrams and across its restarts [ns]. The
+     * relay only takes a datagram newer than any before from its end, so one reordered on the
+     * way to the relay is dropped, as a late state packet would be by its receiver anyway.
+     */
+    uint64_t stamp = 0;
+
+    /** SipHash-2-4 of the fields above under the session token */
+    uint64_t tag = 0;
+};
+static_assert(sizeof(RelayHeader) == 32, "RelayHeader must have no padding");
+
+namespace detail {
+
+/** SipHash-2-4 (Aumasson and Bernstein, 2012): a keyed hash for authenticating short inputs */
+inline uint64_t SipHash24(const RelayToken& key, const uint8_t* data, size_t size)
+{
+    auto load = [](const uint8_t* p, size_t n) {
+        uint64_t v = 0;
+        for (size_t i = 0; i < n; ++i) {
+            v |= static_cast<uint64_t>(p[i]) << (8 * i);
+        }
+        return v;
+    };
+    auto rotl = [](uint64_t v, int n) { return (v << n) | (v >> (64 - n)); };
+    const uint64_t k0 = load(key.data(), 8), k1 = load(key.data() + 8, 8);
+    uint64_t v0 = k0 ^ 0x736f6d6570736575, v1 = k1 ^ 0x646f72616e646f6d;
+    uint64_t v2 = k0 ^ 0x6c7967656e657261, v3 = k1 ^ 0x7465646279746573;
+    auto round = [&]() {
+        v0 += v1;
+        v1 = rotl(v1, 13) ^ v0;
+        v0 = rotl(v0, 32);
+        v2 += v3;
+        v3 = rotl(v3, 16) ^ v2;
+        v0 += v3;
+        v3 = rotl(v3, 21) ^ v0;
+        v2 += v1;
+        v1 = rotl(v1, 17) ^ v2;
+        v2 = rotl(v2, 32);
+    };
+    auto compress = [&](uint64_t m) {
+        v3 ^= m;
+        round();
+        round();
+        v0 ^= m;
+    };
+    size_t offset = 0;
+    for (; offset + 8 <= size; offset += 8) {
+        compress(load(data + offset, 8));
+    }
+    compress(load(data + offset, size - offset) | (static_cast<uint64_t>(size) << 56));
+    v2 ^= 0xff;
+    for (int i = 0; i < 4; ++i) {
+        round();
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/** Tag of a relay header under a session token */
+inline uint64_t RelayTag(const RelayToken& token, const RelayHeader& header)
+{
+    return SipHash24(
+        token, reinterpret_cast<const uint8_t*>(&header), offsetof(RelayHeader, tag));
+}
+
+} /* namespace detail */
+
+/**
+ * @struct RelayParams
+ * @brief Setup of a RelayServer.
+ */
+struct RelayParams
+{
+    /** UDP port the relay receives on, both ends send to it */
+    uint16_t port = 25400;
+
+    /** Largest number of datagrams moved per recvmmsg() or sendmmsg() call */
+    size_t batch_size = 32;
+
+    /** Sessions not heard from for this long are removed [ns] */
+    int64_t session_timeout_ns = 10000000000;
+
+    /** Largest number of sessions relayed at once, registrations beyond it are dropped */
+    size_t max_sessions = 1024;
+};
+
+/**
+ * @struct RelaySessionStats
+ * @brief Traffic of one session through the relay.
+ */
+struct RelaySessionStats
+{
+    uint64_t session_id = 0;
+
+    /** Whether the relay knows the public address of each end, indexed by RelayRole */
+    std::array<bool, 2> registered = {};
+
+    /** Datagrams and bytes forwarded from each end to the other, indexed by the sender's role */
+    std::array<uint64_t, 2> forwarded_count = {};
+    std::array<uint64_t, 2> forwarded_bytes = {};
+
+    /** Datagrams dropped because the other end had not registered yet */
+    uint64_t unpaired_count = 0;
+
+    /**
+     * Datagrams dropped for failing the tag under the session token, or for a stamp not newer
+     * than the newest of their end, e.g. replayed from elsewhere or reordered on the way
+     */
+    uint64_t unauthentic_count = 0;
+
+    /** Times an end showed up from a new address, e.g. after its NAT rebound */
+    uint64_t address_change_count = 0;
+
+    /** Steady time of the last datagram of the session [ns] */
+    int64_t last_seen_ns = 0;
+};
+
+/**
+ * @struct RelayMetrics
+ * @brief Work done by the relay, over all sessions.
+ */
+struct RelayMetrics
+{
+    /** Datagrams received */
+    uint64_t received_count = 0;
+
+    /** Datagrams forwarded */
+    uint64_t forwarded_count = 0;
+
+    /** Datagrams dropped for not carrying a relay header */
+    uint64_t malformed_count = 0;
+
+    /** Registrations dropped because max_sessions were relayed already */
+    uint64_t rejected_count = 0;
+
+    /** Datagrams dropped for proving no possession of their session's token, or being stale */
+    uint64_t unauthentic_count = 0;
+
+    /** Datagrams the kernel refused to send, e.g. with a full socket buffer */
+    uint64_t send_error_count = 0;
+
+    /** recvmmsg() and sendmmsg() calls */
+    uint64_t recv_call_count = 0;
+    uint64_t send_call_count = 0;
+
+    /** Sessions removed after session_timeout_ns without traffic */
+    uint64_t expired_count = 0;
+};
+
+/**
+ * @class RelayServer
+ * @brief Forwards datagrams between the two ends of each teleop session, for sites that cannot
+ * reach each other directly but can both reach the relay, like a TURN server does for WebRTC.
+ * Both ends send to the relay's port, which opens their NATs for the way back; the relay learns
+ * each end's public address from its datagrams, following it if the NAT rebinds, and sends every
+ * datagram of one end to the other. The first registration of a session tells the relay the
+ * session token, and from then on a datagram only counts, as traffic or as a new address of its
+ * end, if its header carries the token's tag and a stamp newer than any before from that end.
+ * Knowing the session ID, or having captured a datagram, is thus not enough to divert a session.
+ * Unlike a VPN there is no tunnel and no reliable transport in
+ * between: one datagram in, one datagram out, at the cost of one extra hop. A single thread
+ * drains the socket with batched recvmmsg() and sends each batch back out with sendmmsg()
+ * straight from the buffers it was received into. Datagrams are forwarded as they are, so
+ * end-to-end encryption (EncryptedTransport under the RelayTransport) keeps the relay blind.
+ * Datagrams reordered between an end and the relay are dropped for their stale stamp, which
+ * teleop tolerates as it only acts on the newest state anyway.
+ */
+class RelayServer
+{
+public:
+    /**
+     * @param[in] params Setup of the relay.
+     * @throw std::invalid_argument if the batch size is 0.
+     * @throw std::runtime_error if the socket cannot be set up.
+     */
+    explicit RelayServer(const RelayParams& params = RelayParams())
+    : params_(params)
+    {
+        if (params.batch_size == 0) {
+            throw std::invalid_argument(
+                "[flexiv::omni::teleop::RelayServer] Batch size must be positive");
+        }
+        fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) {
+            ThrowSystemError("Failed to create socket");
+        }
+        const int enable = 1;
+        ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        sockaddr_in local_addr {};
+        local_addr.sin_family = AF_INET;
+        local_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        local_addr.sin_port = htons(params.port);
+        if (::bind(fd_, reinterpret_cast<sockaddr*>(&local_addr), sizeof(local_addr)) < 0) {
+            ::close(fd_);
+            ThrowSystemError("Failed to bind to port " + std::to_string(params.port));
+        }
+
+        // Scatter/gather descriptors for the batched calls, filled in once
+        buffers_.resize(params.batch_size);
+        sources_.resize(params.batch_size);
+        destinations_.resize(params.batch_size);
+        recv_iovecs_.resize(params.batch_size);
+        recv_headers_.resize(params.batch_size);
+        send_iovecs_.resize(params.batch_size);
+        send_headers_.resize(params.batch_size);
+        for (size_t i = 0; i < params.batch_size; ++i) {
+            recv_iovecs_[i].iov_base = buffers_[i].data();
+            recv_iovecs_[i].iov_len = buffers_[i].size();
+            recv_headers_[i].msg_hdr.msg_iov = &recv_iovecs_[i];
+            recv_headers_[i].msg_hdr.msg_iovlen = 1;
+            send_headers_[i].msg_hdr.msg_iov = &send_iovecs_[i];
+            send_headers_[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    ~RelayServer()
+    {
+        Stop();
+        ::close(fd_);
+    }
+
+    RelayServer(const RelayServer&) = delete;
+    RelayServer& operator=(const RelayServer&) = delete;
+
+    /** @brief Start the relay thread, if not running. */
+    void Start()
+    {
+        if (thread_.joinable()) {
+            return;
+        }
+        stop_ = false;
+        thread_ = std::thread([this]() { Run(); });
+    }
+
+    /** @brief Stop the relay thread, if running. Sessions are kept. */
+    void Stop()
+    {
+        if (!thread_.joinable()) {
+            return;
+        }
+        stop_ = true;
+        thread_.join();
+    }
+
+    /** Work done so far, safe to read from any thread */
+    RelayMetrics metrics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return metrics_;
+    }
+
+    /** Traffic of every current session, safe to read from any thread */
+    std::vector<RelaySessionStats> sessions() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<RelaySessionStats> sessions;
+        sessions.reserve(sessions_.size());
+        for (const auto& entry : sessions_) {
+            sessions.push_back(entry.second.stats);
+        }
+        return sessions;
+    }
+
+private:
+    /** Longest sleep of the relay thread, bounds the reaction to Stop() */
+    static constexpr int kMaxSleepMs = 100;
+
+    struct Session
+    {
+        RelaySessionStats stats;
+        std::array<sockaddr_in, 2> addresses {};
+        RelayToken token {};
+
+        /** Newest stamp of each end, indexed by RelayRole */
+        std::array<uint64_t, 2> newest_stamps {};
+    };
+
+    void Run()
+    {
+        int64_t last_sweep_ns = SteadyTimeNs();
+        while (!stop_) {
+            pollfd fd {fd_, POLLIN, 0};
+            if (::poll(&fd, 1, kMaxSleepMs) > 0) {
+                Drain();
+            }
+            const int64_t now = SteadyTimeNs();
+            if (now - last_sweep_ns > params_.session_timeout_ns / 10) {
+                ExpireSessions(now);
+                last_sweep_ns = now;
+            }
+        }
+    }
+
+    /** Forward batches until the socket is empty */
+    void Drain()
+    {
+        while (true) {
+            for (size_t i = 0; i < recv_headers_.size(); ++i) {
+                recv_headers_[i].msg_hdr.msg_name = &sources_[i];
+                recv_headers_[i].msg_hdr.msg_namelen = sizeof(sources_[i]);
+                recv_headers_[i].msg_hdr.msg_flags = 0;
+            }
+            const int count = ::recvmmsg(fd_, recv_headers_.data(),
+                static_cast<unsigned int>(recv_headers_.size()), MSG_DONTWAIT, nullptr);
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++metrics_.recv_call_count;
+            if (count <= 0) {
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            metrics_.received_count += static_cast<uint64_t>(count);
+            const size_t num_forward = Route(static_cast<size_t>(count));
+            Forward(num_forward);
+            if (static_cast<size_t>(count) < recv_headers_.size()) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Register the senders of a received batch and point a send descriptor at each
+     * datagram that has somewhere to go, in its receive buffer.
+     * @return Number of datagrams to forward.
+     */
+    size_t Route(size_t count)
+    {
+        const int64_t now = SteadyTimeNs();
+        size_t num_forward = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const size_t size = recv_headers_[i].msg_len;
+            RelayHeader header;
+            if ((recv_headers_[i].msg_hdr.msg_flags & MSG_TRUNC) || size < sizeof(header)) {
+                ++metrics_.malformed_count;
+                continue;
+            }
+            std::memcpy(&header, buffers_[i].data(), sizeof(header));
+            const bool registration
+                = header.type == static_cast<uint8_t>(RelayDatagramType::kRegister);
+            if (header.magic != kRelayMagic || header.role > 1
+                || (registration && size != sizeof(header) + kRelayTokenSize)) {
+                ++metrics_.malformed_count;
+                continue;
+            }
+            auto it = sessions_.find(header.session_id);
+            if (it == sessions_.end()) {
+                // Only a registration, which carries the token, sets up a session
+                if (!registration) {
+                    ++metrics_.unauthentic_count;
+                    continue;
+                }
+                if (sessions_.size() >= params_.max_sessions) {
+                    ++metrics_.rejected_count;
+                    continue;
+                }
+                it = sessions_.emplace(header.session_id, Session()).first;
+                it->second.stats.session_id = header.session_id;
+                std::memcpy(it->second.token.data(), buffers_[i].data() + sizeof(header),
+                    kRelayTokenSize);
+            }
+            Session& session = it->second;
+            RelaySessionStats& stats = session.stats;
+            if (header.tag != detail::RelayTag(session.token, header)
+                || header.stamp <= session.newest_stamps[header.role]) {
+                ++stats.unauthentic_count;
+                ++metrics_.unauthentic_count;
+                continue;
+            }
+            session.newest_stamps[header.role] = header.stamp;
+            stats.last_seen_ns = now;
+
+            // Follow the sender's public address, its NAT may have rebound
+            const sockaddr_in& source = sources_[i];
+            sockaddr_in& address = session.addresses[header.role];
+            if (stats.registered[header.role]
+                && (address.sin_addr.s_addr != source.sin_addr.s_addr
+                    || address.sin_port != source.sin_port)) {
+                ++stats.address_change_count;
+            }
+            address = source;
+            stats.registered[header.role] = true;
+
+            if (registration) {
+                continue;
+            }
+            const int peer = 1 - header.role;
+            if (!stats.registered[peer]) {
+                ++stats.unpaired_count;
+                continue;
+            }
+            destinations_[num_forward] = session.addresses[peer];
+            send_iovecs_[num_forward].iov_base = buffers_[i].data();
+            send_iovecs_[num_forward].iov_len = size;
+            send_headers_[num_forward].msg_hdr.msg_name = &destinations_[num_forward];
+            send_headers_[num_forward].msg_hdr.msg_namelen = sizeof(destinations_[num_forward]);
+            ++stats.forwarded_count[header.role];
+            stats.forwarded_bytes[header.role] += size;
+            ++num_forward;
+        }
+        return num_forward;
+    }
+
+    /** Send the routed datagrams, a full socket buffer drops the rest rather than blocking */
+    void Forward(size_t count)
+    {
+        size_t sent = 0;
+        while (sent < count) {
+            const int ret = ::sendmmsg(fd_, send_headers_.data() + sent,
+                static_cast<unsigned int>(count - sent), MSG_DONTWAIT);
+            ++metrics_.send_call_count;
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ret <= 0) {
+                break;
+            }
+            sent += static_cast<size_t>(ret);
+        }
+        metrics_.forwarded_count += sent;
+        metrics_.send_error_count += count - sent;
+    }
+
+    void ExpireSessions(int64_t now)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = sessions_.begin(); it != sessions_.end();) {
+            if (now - it->second.stats.last_seen_ns > params_.session_timeout_ns) {
+                it = sessions_.erase(it);
+                ++metrics_.expired_count;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    [[noreturn]] static void ThrowSystemError(const std::string& what)
+    {
+        throw std::runtime_error(
+            "[flexiv::omni::teleop::RelayServer] " + what + ": " + std::strerror(errno));
+    }
+
+    RelayParams params_;
+    int fd_ = -1;
+    std::thread thread_;
+    std::atomic<bool> stop_ {false};
+
+    /** Guards the sessions and metrics, held by the relay thread while it handles a batch */
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, Session> sessions_;
+    RelayMetrics metrics_;
+
+    std::vector<std::array<uint8_t, kMaxMessageSize>> buffers_;
+    std::vector<sockaddr_in> sources_;
+    std::vector<sockaddr_in> destinations_;
+    std::vector<iovec> recv_iovecs_;
+    std::vector<mmsghdr> recv_headers_;
+    std::vector<iovec> send_iovecs_;
+    std::vector<mmsghdr> send_headers_;
+};
+
+/**
+ * @class RelayTransport
+ * @brief Wraps a transport to a RelayServer, e.g. a UdpTransport whose remote is the relay, and
+ * exchanges messages with the other end of a session through it. Each message is sent behind a
+ * RelayHeader tagged with the session token, which also refreshes this end's registration and
+ * the NAT mapping on the way, as the teleop nodes do every cycle; received datagrams are only
+ * delivered if they carry the token's tag, belong to the session and come from the other end.
+ * Both ends register on construction, telling the relay the token unless it learned it already,
+ * and again from Send() and Receive() every kUnpairedRegisterIntervalNs until the other end is
+ * heard from, then every kPairedRegisterIntervalNs. A registration lost on the way, or a relay
+ * that restarted or let the session expire, thus only costs the session until the next one.
+ * The token travels in the clear in registrations, so it only keeps out those who cannot watch
+ * this end's link to the relay.
+ */
+class RelayTransport : public Transport
+{
+public:
+    /** Time between registrations while the other end is not heard from [ns] */
+    static constexpr int64_t kUnpairedRegisterIntervalNs = 100000000;
+
+    /** Time between registrations while the other end is heard from [ns] */
+    static constexpr int64_t kPairedRegisterIntervalNs = 1000000000;
+
+    /**
+     * @param[in] transport Transport to the relay, must outlive this one.
+     * @param[in] session_id Session shared by both ends, random so that it cannot be guessed.
+     * @param[in] token Secret of the session shared by both ends, see GenerateRelayToken().
+     * @param[in] role End of the session this is, the other end must take the other role.
+     */
+    RelayTransport(
+        Transport& transport, uint64_t session_id, const RelayToken& token, RelayRole role)
+    : transport_(transport)
+    , token_(token)
+    {
+        header_.role = static_cast<uint8_t>(role);
+        header_.session_id = session_id;
+        Register();
+    }
+
+    /** @brief Tell the relay this end's current address and the session token. */
+    bool Register()
+    {
+        uint8_t datagram[sizeof(RelayHeader) + kRelayTokenSize];
+        Seal(RelayDatagramType::kRegister, datagram);
+        std::memcpy(datagram + sizeof(RelayHeader), token_.data(), token_.size());
+        last_register_ns_ = SteadyTimeNs();
+        return transport_.Send(datagram, sizeof(datagram));
+    }
+
+    bool Send(const void* data, size_t size) override
+    {
+        if (size == 0 || size + sizeof(RelayHeader) > kMaxMessageSize) {
+            return false;
+        }
+        KeepRegistered();
+        Seal(RelayDatagramType::kData, tx_buffer_.data());
+        std::memcpy(tx_buffer_.data() + sizeof(RelayHeader), data, size);
+        return transport_.Send(tx_buffer_.data(), size + sizeof(RelayHeader));
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        KeepRegistered();
+        size_t size;
+        while ((size = transport_.Receive(rx_buffer_.data(), rx_buffer_.size())) > 0) {
+            RelayHeader header;
+            if (size <= sizeof(header)) {
+                continue;
+            }
+            std::memcpy(&header, rx_buffer_.data(), sizeof(header));
+            if (header.magic != kRelayMagic || header.session_id != header_.session_id
+                || header.role != 1 - header_.role
+                || header.type != static_cast<uint8_t>(RelayDatagramType::kData)
+                || header.tag != detail::RelayTag(token_, header)) {
+                continue;
+            }
+            last_peer_ns_ = SteadyTimeNs();
+            const size_t payload_size = size - sizeof(header);
+            if (payload_size > capacity) {
+                continue;
+            }
+            std::memcpy(buffer, rx_buffer_.data() + sizeof(header), payload_size);
+            return payload_size;
+        }
+        return 0;
+    }
+
+private:
+    /** Register again once due, more often while the other end is not heard from */
+    void KeepRegistered()
+    {
+        const int64_t now = SteadyTimeNs();
+        const bool paired = last_peer_ns_ != 0 && now - last_peer_ns_ < kPairedRegisterIntervalNs;
+        if (now - last_register_ns_
+            >= (paired ? kPairedRegisterIntervalNs : kUnpairedRegisterIntervalNs)) {
+            Register();
+        }
+    }
+
+    /** Write the header of the next datagram, stamped and tagged */
+    void Seal(RelayDatagramType type, uint8_t* datagram)
+    {
+        // System time keeps the stamps increasing across restarts of this end
+        const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch())
+                             .count();
+        header_.type = static_cast<uint8_t>(type);
+        header_.stamp = std::max(header_.stamp + 1, static_cast<uint64_t>(now));
+        header_.tag = detail::RelayTag(token_, header_);
+        std::memcpy(datagram, &header_, sizeof(header_));
+    }
+
+    Transport& transport_;
+    RelayToken token_;
+    RelayHeader header_;
+
+    /** Steady time of the latest registration, and of the latest datagram from the other end */
+    int64_t last_register_ns_ = 0;
+    int64_t last_peer_ns_ = 0;
+
+    std::array<uint8_t, kMaxMessageSize> tx_buffer_ = {};
+    std::array<uint8_t, kMaxMessageSize> rx_buffer_ = {};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,47 @@
+/**
+ * @file robot_interface.hpp
+ * @brief Abstract arm interface driven by the teleop nodes.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "data.hpp"
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @class RobotInterface
+ * @brief The subset of arm functionality teleop needs. Real arms are adapted to this interface
+ * by the application, simulated arms implement it directly (see SimRobot). All methods are
+ * called from the real-time control thread once per cycle and must not block or allocate.
+ */
+class RobotInterface
+{
+public:
+    virtual ~RobotInterface() = default;
+
+    /** Latest measured states of the arm */
+    virtual RobotStates states() const = 0;
+
+    /**
+     * @brief Stream a joint-space impedance target. Used to drive the follower.
+     * @param[in] positions Target joint positions [rad].
+     * @param[in] velocities Target joint velocities [rad/s].
+     */
+    virtual void StreamJointPosition(const JointArray& positions, const JointArray& velocities)
+        = 0;
+
+    /**
+     * @brief Stream joint torques on top of the arm's own gravity compensation. Used to render
+     * force feedback on the leader.
+     * @param[in] torques Joint torques [Nm].
+     */
+    virtual void StreamJointTorque(const JointArray& torques) = 0;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,328 @@
+/**
+ * @file rt_thread.hpp
+ * @brief Setup of the calling thread for hard real-time control, and per-cycle monitoring of
+ * page faults and context switches.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include <alloca.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct RtThreadConfig
+ * @brief Real-time setup applied by ConfigureRtThread().
+ */
+struct RtThreadConfig
+{
+    /** SCHED_FIFO priority [1-99], 0 to keep the current scheduling policy */
+    int priority = 80;
+
+    /** CPU core to pin the thread to, -1 to keep the current affinity */
+    int cpu_core = -1;
+
+    /** Lock all current and future pages of the process into RAM with mlockall() */
+    bool lock_memory = true;
+
+    /**
+     * Bytes of stack to touch so that its pages are mapped before the loop starts, at most what
+     * the thread's stack has left below the caller
+     */
+    size_t stack_prefault_size = 512 * 1024;
+
+    /**
+     * Bytes of heap to touch and keep in the process so that later allocations do not fault.
+     * Also disables returning heap memory to the OS and serving allocations with mmap(), for the
+     * whole process and once, however many threads are configured.
+     */
+    size_t heap_prefault_size = 16 * 1024 * 1024;
+
+    /** Print a warning to stderr for every step that could not be applied */
+    bool print_warnings = true;
+};
+
+/**
+ * @struct RtThreadReport
+ * @brief Outcome of ConfigureRtThread(). Steps that were not requested count as applied.
+ */
+struct RtThreadReport
+{
+    /** SCHED_FIFO with the requested priority is in effect */
+    bool scheduling_applied = false;
+
+    /** The thread is pinned to the requested core */
+    bool affinity_applied = false;
+
+    /** Process memory is locked */
+    bool memory_locked = false;
+
+    /** Stack and heap were prefaulted */
+    bool prefaulted = false;
+
+    /** One message per step that could not be applied */
+    std::vector<std::string> warnings;
+
+    /** Whether every requested step was applied */
+    bool fully_applied() const
+    {
+        return scheduling_applied && affinity_applied && memory_locked && prefaulted;
+    }
+};
+
+namespace detail {
+
+/** Stack kept untouched below the prefaulted region, for the frames of the calls made then */
+constexpr size_t kStackPrefaultReserve = 64 * 1024;
+
+/** Bytes of the calling thread's stack below the current frame, 0 if unknown */
+inline size_t StackRoom()
+{
+    pthread_attr_t attr;
+    if (::pthread_getattr_np(::pthread_self(), &attr) != 0) {
+        return 0;
+    }
+    void* lowest = nullptr;
+    size_t size = 0;
+    const int ret = ::pthread_attr_getstack(&attr, &lowest, &size);
+    ::pthread_attr_destroy(&attr);
+    if (ret != 0) {
+        return 0;
+    }
+    // The stack grows down, from lowest + size towards lowest
+    const unsigned char marker = 0;
+    const auto here = reinterpret_cast<uintptr_t>(&marker);
+    const auto bottom = reinterpret_cast<uintptr_t>(lowest);
+    return here > bottom ? here - bottom : 0;
+}
+
+/** Touch every page of a stack region below the current frame, as much of it as there is */
+__attribute__((noinline)) inline void PrefaultStack(size_t size)
+{
+    const size_t room = StackRoom();
+    size = std::min(size, room > kStackPrefaultReserve ? room - kStackPrefaultReserve : 0);
+    if (size == 0) {
+        return;
+    }
+    volatile unsigned char* stack = static_cast<unsigned char*>(alloca(size));
+    const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    for (size_t i = 0; i < size; i += page_size) {
+        stack[i] = 0;
+    }
+}
+
+/**
+ * Keep freed memory in the heap and never use mmap(), which would be unmapped on free. Both are
+ * settings of the whole process, applied by the first call only.
+ * @return 0 on success, else the error.
+ */
+inline int KeepHeapResident()
+{
+    static const int error = []() {
+        // mallopt() only fails on a parameter it does not take, and does not set errno
+        return ::mallopt(M_TRIM_THRESHOLD, -1) == 0 || ::mallopt(M_MMAP_MAX, 0) == 0 ? EINVAL
+                                                                                     : 0;
+    }();
+    return error;
+}
+
+/**
+ * Grow the heap, touch every page, then release it to the allocator but not to the OS.
+ * @return 0 on success, else the error.
+ */
+inline int PrefaultHeap(size_t size)
+{
+    auto* heap = static_cast<volatile unsigned char*>(std::malloc(size));
+    if (!heap) {
+        return errno;
+    }
+    const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    for (size_t i = 0; i < size; i += page_size) {
+        heap[i] = 0;
+    }
+    std::free(const_cast<unsigned char*>(heap));
+    return 0;
+}
+
+} /* namespace detail */
+
+/**
+ * @brief Prepare the calling thread for hard real-time control: SCHED_FIFO priority, CPU pinning,
+ * mlockall() and stack/heap prefaulting. Call once at the start of the control thread, before
+ * entering the loop. Steps that fail, typically for lack of privileges (CAP_SYS_NICE and
+ * CAP_IPC_LOCK or a suitable rtprio/memlock in limits.conf), are skipped with a warning rather
+ * than treated as errors, so the same program still runs on development machines and CI.
+ * @param[in] config Setup to apply.
+ * @return Which steps were applied.
+ */
+inline RtThreadReport ConfigureRtThread(const RtThreadConfig& config = RtThreadConfig())
+{
+    RtThreadReport report;
+    auto warn = [&](const std::string& step, int error) {
+        report.warnings.push_back(step + ": " + std::strerror(error));
+        if (config.print_warnings) {
+            std::cerr << "[flexiv::omni::teleop] WARNING: " << report.warnings.back()
+                      << ", real-time performance will be degraded" << std::endl;
+        }
+    };
+
+    // Lock memory first so that the prefaulted pages stay resident
+    report.memory_locked = true;
+    if (config.lock_memory && ::mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        report.memory_locked = false;
+        warn("Failed to lock memory with mlockall()", errno);
+    }
+
+    report.scheduling_applied = true;
+    if (config.priority > 0) {
+        sched_param param {};
+        param.sched_priority = config.priority;
+        const int ret = ::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param);
+        if (ret != 0) {
+            report.scheduling_applied = false;
+            warn("Failed to set SCHED_FIFO priority " + std::to_string(config.priority), ret);
+        }
+    }
+
+    report.affinity_applied = true;
+    if (config.cpu_core >= 0) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(config.cpu_core, &cpu_set);
+        const int ret = ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set);
+        if (ret != 0) {
+            report.affinity_applied = false;
+            warn("Failed to pin thread to CPU core " + std::to_string(config.cpu_core), ret);
+        }
+    }
+
+    detail::PrefaultStack(config.stack_prefault_size);
+    report.prefaulted = true;
+    if (config.heap_prefault_size > 0) {
+        int ret = detail::KeepHeapResident();
+        if (ret != 0) {
+            report.prefaulted = false;
+            warn("Failed to keep freed heap memory in the process with mallopt()", ret);
+        } else if ((ret = detail::PrefaultHeap(config.heap_prefault_size)) != 0) {
+            report.prefaulted = false;
+            warn("Failed to prefault " + std::to_string(config.heap_prefault_size)
+                     + " bytes of heap",
+                ret);
+        }
+    }
+    return report;
+}
+
+/**
+ * @struct RtUsage
+ * @brief Resource usage of a thread, either cumulative or over an interval.
+ */
+struct RtUsage
+{
+    /** Page faults served without I/O */
+    uint64_t minor_faults = 0;
+
+    /** Page faults that required I/O */
+    uint64_t major_faults = 0;
+
+    /** Context switches because the thread blocked or slept */
+    uint64_t voluntary_switches = 0;
+
+    /** Context switches because the thread was preempted */
+    uint64_t involuntary_switches = 0;
+};
+
+/**
+ * @class RtUsageMonitor
+ * @brief Measures page faults and context switches of the calling thread per control cycle via
+ * getrusage(RUSAGE_THREAD). A well configured real-time thread incurs no page faults and no
+ * involuntary context switches in steady state, and exactly one voluntary switch per cycle
+ * (the sleep until the next period).
+ * @note Construct and use from the thread being monitored.
+ */
+class RtUsageMonitor
+{
+public:
+    RtUsageMonitor() { previous_ = Read(); }
+
+    /**
+     * @brief Call once per cycle.
+     * @return Usage incurred since the previous call.
+     */
+    RtUsage Update()
+    {
+        const RtUsage current = Read();
+        RtUsage delta;
+        delta.minor_faults = current.minor_faults - previous_.minor_faults;
+        delta.major_faults = current.major_faults - previous_.major_faults;
+        delta.voluntary_switches = current.voluntary_switches - previous_.voluntary_switches;
+        delta.involuntary_switches = current.involuntary_switches - previous_.involuntary_switches;
+        previous_ = current;
+
+        totals_.minor_faults += delta.minor_faults;
+        totals_.major_faults += delta.major_faults;
+        totals_.voluntary_switches += delta.voluntary_switches;
+        totals_.involuntary_switches += delta.involuntary_switches;
+        ++cycle_count_;
+        if (delta.minor_faults + delta.major_faults > 0) {
+            ++faulted_cycle_count_;
+        }
+        if (delta.involuntary_switches > 0) {
+            ++preempted_cycle_count_;
+        }
+        return delta;
+    }
+
+    /** Usage accumulated over all Update() calls */
+    const RtUsage& totals() const { return totals_; }
+
+    /** Number of Update() calls */
+    uint64_t cycle_count() const { return cycle_count_; }
+
+    /** Number of cycles that incurred at least one page fault */
+    uint64_t faulted_cycle_count() const { return faulted_cycle_count_; }
+
+    /** Number of cycles that incurred at least one involuntary context switch */
+    uint64_t preempted_cycle_count() const { return preempted_cycle_count_; }
+
+private:
+    static RtUsage Read()
+    {
+        rusage usage {};
+        ::getrusage(RUSAGE_THREAD, &usage);
+        RtUsage result;
+        result.minor_faults = static_cast<uint64_t>(usage.ru_minflt);
+        result.major_faults = static_cast<uint64_t>(usage.ru_majflt);
+        result.voluntary_switches = static_cast<uint64_t>(usage.ru_nvcsw);
+        result.involuntary_switches = static_cast<uint64_t>(usage.ru_nivcsw);
+        return result;
+    }
+
+    RtUsage previous_;
+    RtUsage totals_;
+    uint64_t cycle_count_ = 0;
+    uint64_t faulted_cycle_count_ = 0;
+    uint64_t preempted_cycle_count_ = 0;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,121 @@
+/**
+ * @file sequence_filter.hpp
+ * @brief Newest-wins admission of received packets based on sequence numbers.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "epoch_tracker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @class SequenceFilter
+ * @brief Admits a packet only if its sequence number is newer than every packet admitted before,
+ * so late, reordered and duplicated packets are discarded instead of being acted upon. Gaps in
+ * the sequence are counted as lost packets, and taken back when a late packet fills them; which
+ * of the last kWindow sequence numbers arrived is remembered, so that a duplicate never does.
+ * Once an EpochTracker confirms a new epoch, the peer restarted: its sequence starts over, while
+ * late packets of the epochs before are discarded, and so are the few unconfirmed ones.
+ */
+class SequenceFilter
+{
+public:
+    /** Sequence numbers whose arrival is remembered, older late packets stay counted as lost */
+    static constexpr uint64_t kWindow = 1024;
+
+    /**
+     * @brief [Real-time] Decide whether to act on a received packet.
+     * @param[in] sequence Sequence number of the packet, starting from 1 in every epoch.
+     * @param[in] epoch Epoch of the packet's sender, see PacketHeader::epoch.
+     * @return True if the packet is the newest so far.
+     */
+    bool Accept(uint64_t sequence, uint32_t epoch)
+    {
+        using Verdict = EpochTracker<uint32_t>::Verdict;
+        switch (epochs_.Observe(epoch, sequence)) {
+            case Verdict::kRetired:
+            case Verdict::kPending:
+                ++stale_count_;
+                return false;
+            case Verdict::kRestarted:
+                newest_ = 0;
+                break;
+            case Verdict::kCurrent:
+                break;
+        }
+
+        if (newest_ == 0) {
+            // Nothing before the first packet of an epoch counts as lost
+            arrived_.fill(~uint64_t {0});
+            newest_ = sequence;
+            return true;
+        }
+        if (sequence > newest_) {
+            lost_count_ += sequence - newest_ - 1;
+            // Forget the sequence numbers the window slides past
+            const uint64_t oldest_kept = sequence >= kWindow ? sequence - kWindow + 1 : 0;
+            for (uint64_t s = std::max(newest_ + 1, oldest_kept); s < sequence; ++s) {
+                ClearArrived(s);
+            }
+            newest_ = sequence;
+            SetArrived(sequence);
+            return true;
+        }
+        // Late arrivals were counted as lost when the gap was first seen, duplicates were not
+        if (newest_ - sequence < kWindow && !IsArrived(sequence)) {
+            SetArrived(sequence);
+            --lost_count_;
+        }
+        ++stale_count_;
+        return false;
+    }
+
+    /** Newest sequence number accepted so far in the current epoch, 0 if none */
+    uint64_t newest() const { return newest_; }
+
+    /** Epoch of the newest packet accepted */
+    uint32_t epoch() const { return epochs_.current(); }
+
+    /**
+     * Number of packets discarded for being older than or equal to the newest one, or for not
+     * being of the current epoch
+     */
+    uint64_t stale_count() const { return stale_count_; }
+
+    /** Number of packets never received, i.e. missing from the sequence and not arrived late */
+    uint64_t lost_count() const { return lost_count_; }
+
+    /** Number of times the peer was detected restarting, i.e. starting a new epoch */
+    uint64_t restart_count() const { return epochs_.restart_count(); }
+
+private:
+    static constexpr size_t kWindowWords = kWindow / 64;
+
+    bool IsArrived(uint64_t s) const
+    {
+        return arrived_[(s / 64) % kWindowWords] & (uint64_t {1} << (s % 64));
+    }
+    void SetArrived(uint64_t s) { arrived_[(s / 64) % kWindowWords] |= uint64_t {1} << (s % 64); }
+    void ClearArrived(uint64_t s)
+    {
+        arrived_[(s / 64) % kWindowWords] &= ~(uint64_t {1} << (s % 64));
+    }
+
+    uint64_t newest_ = 0;
+    EpochTracker<uint32_t> epochs_;
+    std::array<uint64_t, kWindowWords> arrived_ = {};
+    uint64_t stale_count_ = 0;
+    uint64_t lost_count_ = 0;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,283 @@
+/**
+ * @file session_log.hpp
+ * @brief Binary format of recorded teleop sessions, and a reader for it.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "wire_format.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/** Magic number at the start of a session log, "FOTS" in little-endian byte order */
+constexpr uint32_t kSessionMagic = 0x53544F46;
+
+/** Magic number at the start of every chunk of a session log, "FOTC" in little-endian order */
+constexpr uint32_t kSessionChunkMagic = 0x43544F46;
+
+/** Session log format version, bumped on every layout change */
+constexpr uint16_t kSessionLogVersion = 3;
+
+/** Space reserved for the file header, chunks start right after it [bytes] */
+constexpr size_t kSessionHeaderSize = 4096;
+
+/** What a SessionRecord holds */
+enum class RecordKind : uint8_t
+{
+    /** One control cycle of the recording node: the state packet it sent and its command */
+    kCycle = 1,
+
+    /** A valid packet received from the peer, timestamped with its arrival time */
+    kReceived = 2,
+};
+
+/**
+ * @struct JointCommand
+ * @brief Command streamed to an arm in one cycle. The follower commands position and velocity
+ * targets, the leader commands force feedback torques; unused fields are 0.
+ */
+struct JointCommand
+{
+    /** Joint position targets [rad] */
+    JointArray q = {};
+
+    /** Joint velocity targets [rad/s] */
+    JointArray dq = {};
+
+    /** Joint torques [Nm] */
+    JointArray tau = {};
+};
+
+/**
+ * @struct SessionRecord
+ * @brief One entry of a session log. Fixed size so that records never straddle chunks and can
+ * be copied around the real-time thread without allocation. 504 bytes.
+ */
+struct SessionRecord
+{
+    /** Local steady clock of the recording node: cycle time or packet arrival time [ns] */
+    int64_t time_ns = 0;
+
+    /** Content of the record */
+    RecordKind kind = RecordKind::kCycle;
+
+    /** Reserved for future use, must be 0 */
+    uint8_t reserved[7] = {};
+
+    /** kCycle: packet sent to the peer, i.e. own states. kReceived: packet from the peer */
+    StatePacket packet;
+
+    /** kCycle: command streamed to the own arm. kReceived: unused */
+    JointCommand command;
+};
+
+static_assert(std::is_trivially_copyable<SessionRecord>::value
+                  && std::is_standard_layout<SessionRecord>::value,
+    "SessionRecord must be a POD type");
+static_assert(sizeof(SessionRecord) == 504, "SessionRecord layout changed, bump version");
+
+/**
+ * @struct SessionFileHeader
+ * @brief Header at the start of a session log, padded to kSessionHeaderSize.
+ */
+struct SessionFileHeader
+{
+    /** Always kSessionMagic */
+    uint32_t magic = kSessionMagic;
+
+    /** Always kSessionLogVersion */
+    uint16_t version = kSessionLogVersion;
+
+    /** Always sizeof(SessionRecord) [bytes] */
+    uint16_t record_size = sizeof(SessionRecord);
+
+    /** Size of each chunk including its header, a multiple of the page size [bytes] */
+    uint32_t chunk_size = 0;
+
+    /** Role of the recording node */
+    MessageType node = MessageType::kLeaderState;
+
+    /** Reserved for future use, must be 0 */
+    uint8_t reserved[3] = {};
+
+    /** Steady clock of the recording node when recording started [ns] */
+    int64_t start_steady_ns = 0;
+
+    /** System (wall) clock when recording started, to correlate with other logs [ns] */
+    int64_t start_system_ns = 0;
+
+    /** Number of records dropped because the writer could not keep up, set when closed */
+    uint64_t dropped_count = 0;
+};
+
+static_assert(sizeof(SessionFileHeader) <= kSessionHeaderSize, "SessionFileHeader too large");
+
+/**
+ * @struct SessionChunkHeader
+ * @brief Header at the start of each chunk, followed by record_count records. 64 bytes.
+ */
+struct SessionChunkHeader
+{
+    /** Always kSessionChunkMagic */
+    uint32_t magic = kSessionChunkMagic;
+
+    /** Number of complete records in this chunk, published after each record is written */
+    uint32_t record_count = 0;
+
+    /** Index of this chunk in the file, starting from 0 */
+    uint64_t index = 0;
+
+    /** Reserved for future use, must be 0 */
+    uint64_t reserved[6] = {};
+};
+
+static_assert(sizeof(SessionChunkHeader) == 64, "SessionChunkHeader layout changed, bump version");
+
+/**
+ * @class SessionReader
+ * @brief Reads the records of a session log in the order they were written. The file is mapped
+ * read-only, records are copied out one at a time. Logs of sessions that were cut short, e.g. by
+ * a crash, are read up to the last complete record.
+ */
+class SessionReader
+{
+public:
+    /**
+     * @brief Open a session log.
+     * @param[in] path Path of the log.
+     * @throw std::runtime_error if the file cannot be opened or is not a compatible session log.
+     */
+    explicit SessionReader(const std::string& path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            ThrowError("Failed to open " + path + ": " + std::strerror(errno));
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kSessionHeaderSize) {
+            ::close(fd);
+            ThrowError(path + " is not a session log");
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            ThrowError("Failed to map " + path + ": " + std::strerror(errno));
+        }
+        data_ = static_cast<const uint8_t*>(data);
+
+        std::memcpy(&header_, data_, sizeof(header_));
+        if (header_.magic != kSessionMagic) {
+            Unmap();
+            ThrowError(path + " is not a session log");
+        }
+        if (header_.version != kSessionLogVersion || header_.record_size != sizeof(SessionRecord)
+            || header_.chunk_size <= sizeof(SessionChunkHeader)) {
+            Unmap();
+            ThrowError(path + " has unsupported session log version "
+                       + std::to_string(header_.version));
+        }
+        Rewind();
+    }
+
+    ~SessionReader() { Unmap(); }
+
+    SessionReader(const SessionReader&) = delete;
+    SessionReader& operator=(const SessionReader&) = delete;
+
+    /**
+     * @brief Read the next record.
+     * @param[out] record Next record.
+     * @return False at the end of the log.
+     */
+    bool Next(SessionRecord& record)
+    {
+        while (record_index_ >= chunk_record_count_) {
+            if (!OpenChunk(chunk_index_ + 1)) {
+                return false;
+            }
+        }
+        std::memcpy(&record,
+            data_ + chunk_offset_ + sizeof(SessionChunkHeader)
+                + record_index_ * sizeof(SessionRecord),
+            sizeof(record));
+        ++record_index_;
+        return true;
+    }
+
+    /** Go back to the first record */
+    void Rewind()
+    {
+        chunk_index_ = 0;
+        chunk_record_count_ = 0;
+        record_index_ = 0;
+        OpenChunk(0);
+    }
+
+    /** File header */
+    const SessionFileHeader& header() const { return header_; }
+
+private:
+    [[noreturn]] static void ThrowError(const std::string& what)
+    {
+        throw std::runtime_error("[flexiv::omni::teleop::SessionReader] " + what);
+    }
+
+    /** Move to a chunk, false if it does not exist or is damaged */
+    bool OpenChunk(size_t index)
+    {
+        const size_t offset = kSessionHeaderSize + index * header_.chunk_size;
+        if (offset + sizeof(SessionChunkHeader) > size_) {
+            return false;
+        }
+        SessionChunkHeader chunk;
+        std::memcpy(&chunk, data_ + offset, sizeof(chunk));
+        if (chunk.magic != kSessionChunkMagic || chunk.index != index) {
+            return false;
+        }
+        // Never read past the end of the chunk or of a truncated file
+        const size_t chunk_end = std::min(size_, offset + header_.chunk_size);
+        const size_t capacity
+            = (chunk_end - offset - sizeof(SessionChunkHeader)) / sizeof(SessionRecord);
+        chunk_index_ = index;
+        chunk_offset_ = offset;
+        chunk_record_count_ = std::min<size_t>(chunk.record_count, capacity);
+        record_index_ = 0;
+        return true;
+    }
+
+    void Unmap()
+    {
+        if (data_) {
+            ::munmap(const_cast<uint8_t*>(data_), size_);
+            data_ = nullptr;
+        }
+    }
+
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    SessionFileHeader header_;
+    size_t chunk_index_ = 0;
+    size_t chunk_offset_ = 0;
+    size_t chunk_record_count_ = 0;
+    size_t record_index_ = 0;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,273 @@
+/**
+ * @file session_recorder.hpp
+ * @brief Full-rate recording of a teleop session to a memory-mapped, append-only binary log.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "clock.hpp"
+#include "session_log.hpp"
+#include "spsc_queue.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct SessionRecorderParams
+ * @brief Tuning of the session recorder.
+ */
+struct SessionRecorderParams
+{
+    /** Size of each chunk the file grows by, a multiple of the page size [bytes] */
+    size_t chunk_size = 4 * 1024 * 1024;
+
+    /** Time the writer thread sleeps when there is nothing to write [ms] */
+    int idle_sleep_ms = 2;
+};
+
+/**
+ * @class SessionRecorder
+ * @brief Logs the records of one teleop node to a session log file, see session_log.hpp for the
+ * format. The real-time thread only copies each record into a lock-free queue; a background
+ * thread drains the queue into the file, which grows by one chunk at a time and has only the
+ * current chunk mapped. Each chunk's blocks are reserved before it is mapped, so a full disk
+ * stops the recording rather than the process. A record is complete on disk as soon as its
+ * chunk's record count is published, so the log stays readable if the process dies. Records that
+ * do not fit into the queue because the writer fell behind are dropped and counted, the
+ * real-time thread never waits.
+ * @note Record() must only be called from one thread. Attach one recorder per node.
+ */
+class SessionRecorder
+{
+public:
+    /**
+     * @brief Create the log file and start the writer thread.
+     * @param[in] path Path of the log, overwritten if it exists.
+     * @param[in] node Role of the recording node.
+     * @param[in] params Recorder tuning.
+     * @throw std::invalid_argument if the chunk size is not a multiple of the page size.
+     * @throw std::runtime_error if the file cannot be created.
+     */
+    SessionRecorder(const std::string& path, MessageType node,
+        const SessionRecorderParams& params = SessionRecorderParams())
+    : params_(params)
+    , queue_(std::make_unique<Queue>())
+    {
+        const auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        if (params_.chunk_size % page_size != 0
+            || params_.chunk_size < sizeof(SessionChunkHeader) + sizeof(SessionRecord)) {
+            throw std::invalid_argument("[flexiv::omni::teleop::SessionRecorder] Chunk size must "
+                                        "be a multiple of the page size");
+        }
+        records_per_chunk_
+            = (params_.chunk_size - sizeof(SessionChunkHeader)) / sizeof(SessionRecord);
+
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            ThrowSystemError("Failed to create " + path);
+        }
+        header_.chunk_size = static_cast<uint32_t>(params_.chunk_size);
+        header_.node = node;
+        header_.start_steady_ns = SteadyTimeNs();
+        const auto system_time = std::chrono::system_clock::now().time_since_epoch();
+        header_.start_system_ns
+            = std::chrono::duration_cast<std::chrono::nanoseconds>(system_time).count();
+        if (!WriteHeader() || ::ftruncate(fd_, kSessionHeaderSize) != 0) {
+            ::close(fd_);
+            ThrowSystemError("Failed to write " + path);
+        }
+        thread_ = std::thread([this]() { WriterLoop(); });
+    }
+
+    /** Write all queued records and close the file */
+    ~SessionRecorder() { Close(); }
+
+    SessionRecorder(const SessionRecorder&) = delete;
+    SessionRecorder& operator=(const SessionRecorder&) = delete;
+
+    /**
+     * @brief [Real-time] Queue a record for writing.
+     * @param[in] record Record to copy.
+     * @return False if it was dropped because the queue is full.
+     */
+    bool Record(const SessionRecord& record)
+    {
+        if (!queue_->TryPush(record)) {
+            dropped_count_.store(
+                dropped_count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /** Stop recording: write all queued records, trim the last chunk and close the file */
+    void Close()
+    {
+        if (!thread_.joinable()) {
+            return;
+        }
+        running_ = false;
+        thread_.join();
+        UnmapChunk();
+
+        // Trim the unused tail of the last chunk, readers rely on record counts anyway
+        size_t size = kSessionHeaderSize;
+        if (chunk_count_ > 0) {
+            size += (chunk_count_ - 1) * params_.chunk_size + sizeof(SessionChunkHeader)
+                    + chunk_record_count_ * sizeof(SessionRecord);
+        }
+        header_.dropped_count = dropped_count();
+        if (::ftruncate(fd_, static_cast<off_t>(size)) != 0 || !WriteHeader()
+            || ::fdatasync(fd_) != 0) {
+            std::cerr << "[flexiv::omni::teleop::SessionRecorder] Failed to finalize log: "
+                      << std::strerror(errno) << std::endl;
+        }
+        ::close(fd_);
+    }
+
+    /** Number of records written to the file so far */
+    uint64_t written_count() const { return written_count_.load(std::memory_order_relaxed); }
+
+    /** Number of records dropped because the queue was full or the file could not grow */
+    uint64_t dropped_count() const
+    {
+        return dropped_count_.load(std::memory_order_relaxed)
+               + write_failed_count_.load(std::memory_order_relaxed);
+    }
+
+private:
+    /** About 2.7 s of one node's records at 1 kHz */
+    static constexpr size_t kQueueCapacity = 8192;
+    using Queue = SpscQueue<SessionRecord, kQueueCapacity>;
+
+    [[noreturn]] static void ThrowSystemError(const std::string& what)
+    {
+        throw std::runtime_error(
+            "[flexiv::omni::teleop::SessionRecorder] " + what + ": " + std::strerror(errno));
+    }
+
+    bool WriteHeader()
+    {
+        return ::pwrite(fd_, &header_, sizeof(header_), 0)
+               == static_cast<ssize_t>(sizeof(header_));
+    }
+
+    void WriterLoop()
+    {
+        SessionRecord record;
+        while (true) {
+            // Read the flag before draining so that nothing queued before Close() is missed
+            const bool running = running_;
+            bool wrote = false;
+            while (queue_->TryPop(record)) {
+                Append(record);
+                wrote = true;
+            }
+            if (!running) {
+                break;
+            }
+            if (!wrote) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(params_.idle_sleep_ms));
+            }
+        }
+    }
+
+    void Append(const SessionRecord& record)
+    {
+        if (failed_) {
+            write_failed_count_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (!chunk_ || chunk_record_count_ == records_per_chunk_) {
+            if (!MapNextChunk()) {
+                std::cerr << "[flexiv::omni::teleop::SessionRecorder] Failed to grow log, "
+                             "dropping all further records: "
+                          << std::strerror(errno) << std::endl;
+                failed_ = true;
+                write_failed_count_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        std::memcpy(chunk_ + sizeof(SessionChunkHeader) + chunk_record_count_ * sizeof(record),
+            &record, sizeof(record));
+        ++chunk_record_count_;
+        // Publish the record only after its bytes, for readers of a log still being written
+        __atomic_store_n(&reinterpret_cast<SessionChunkHeader*>(chunk_)->record_count,
+            static_cast<uint32_t>(chunk_record_count_), __ATOMIC_RELEASE);
+        written_count_.store(
+            written_count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    bool MapNextChunk()
+    {
+        UnmapChunk();
+        const size_t offset = kSessionHeaderSize + chunk_count_ * params_.chunk_size;
+        // Reserve the chunk's blocks: a sparse chunk would raise SIGBUS on a write to the
+        // mapping once the disk or tmpfs is full, instead of failing here
+        const int ret = ::posix_fallocate(
+            fd_, static_cast<off_t>(offset), static_cast<off_t>(params_.chunk_size));
+        if (ret != 0) {
+            errno = ret;
+            return false;
+        }
+        void* chunk = ::mmap(nullptr, params_.chunk_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
+            static_cast<off_t>(offset));
+        if (chunk == MAP_FAILED) {
+            return false;
+        }
+        chunk_ = static_cast<uint8_t*>(chunk);
+        SessionChunkHeader chunk_header;
+        chunk_header.index = chunk_count_;
+        std::memcpy(chunk_, &chunk_header, sizeof(chunk_header));
+        chunk_record_count_ = 0;
+        ++chunk_count_;
+        return true;
+    }
+
+    void UnmapChunk()
+    {
+        if (chunk_) {
+            // Start writeback now rather than all at once when the file is closed
+            ::msync(chunk_, params_.chunk_size, MS_ASYNC);
+            ::munmap(chunk_, params_.chunk_size);
+            chunk_ = nullptr;
+        }
+    }
+
+    SessionRecorderParams params_;
+    std::unique_ptr<Queue> queue_;
+    std::atomic<uint64_t> dropped_count_ = {0};
+    std::atomic<uint64_t> write_failed_count_ = {0};
+    std::atomic<uint64_t> written_count_ = {0};
+    std::atomic<bool> running_ = {true};
+    std::thread thread_;
+
+    // Owned by the writer thread until it is joined
+    int fd_ = -1;
+    SessionFileHeader header_;
+    size_t records_per_chunk_ = 0;
+    uint8_t* chunk_ = nullptr;
+    size_t chunk_count_ = 0;
+    size_t chunk_record_count_ = 0;
+    bool failed_ = false;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
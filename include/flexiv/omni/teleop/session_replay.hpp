@@ -0,0 +1,377 @@
+/**
+ * @file session_replay.hpp
+ * @brief Deterministic, faster than real-time replay of recorded sessions through the follower
+ * pipeline against a simulated arm.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "clock.hpp"
+#include "follower_node.hpp"
+#include "session_log.hpp"
+#include "sim_robot.hpp"
+#include "transport.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @class ReplayTransport
+ * @brief Transport that delivers packets queued by the replay driver instead of the network, and
+ * swallows everything sent. Not real-time safe, for replay and simulation only.
+ */
+class ReplayTransport : public Transport
+{
+public:
+    /**
+     * @brief Queue a packet for the next Receive() calls.
+     * @param[in] packet Packet to deliver.
+     */
+    void Push(const StatePacket& packet) { pending_.push_back(packet); }
+
+    bool Send(const void*, size_t) override
+    {
+        ++sent_count_;
+        return true;
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        if (pending_.empty() || capacity < sizeof(StatePacket)) {
+            return 0;
+        }
+        std::memcpy(buffer, &pending_.front(), sizeof(StatePacket));
+        pending_.pop_front();
+        return sizeof(StatePacket);
+    }
+
+    /** Number of messages sent */
+    uint64_t sent_count() const { return sent_count_; }
+
+private:
+    std::deque<StatePacket> pending_;
+    uint64_t sent_count_ = 0;
+};
+
+/**
+ * @struct SessionReplayParams
+ * @brief Setup of a replay: the follower pipeline under test and the simulated arm it drives.
+ */
+struct SessionReplayParams
+{
+    /** Follower pipeline to replay the session through */
+    FollowerParams follower;
+
+    /** Simulated follower arm, initial_q is overridden by the first recorded state */
+    SimRobotParams robot;
+
+    /** Contact rendered by the simulated arm */
+    VirtualWall wall;
+};
+
+/**
+ * @struct SessionReplayResult
+ * @brief Outcome of a replay.
+ */
+struct SessionReplayResult
+{
+    /** Number of control cycles replayed */
+    uint64_t cycle_count = 0;
+
+    /** Time span of the replayed cycles on the recording node's clock [s] */
+    double recorded_duration = 0.0;
+
+    /**
+     * Largest and RMS difference between the joint position targets commanded in the replay and
+     * those commanded in the recording [rad]. Zero if the replayed pipeline behaves exactly like
+     * the recorded one.
+     */
+    double divergence_max = 0.0;
+    double divergence_rms = 0.0;
+
+    /**
+     * Largest and RMS difference between the simulated arm's positions and its targets, from the
+     * first commanded cycle on [rad]
+     */
+    double tracking_error_max = 0.0;
+    double tracking_error_rms = 0.0;
+
+    /** FNV-1a hash of all commanded targets, identical for identical replays */
+    uint64_t command_hash = 0;
+
+    /** Counters of the replayed follower node */
+    FollowerStatus status;
+};
+
+/**
+ * @struct PredictionError
+ * @brief Accuracy of the motion predictor at one horizon, evaluated on a recorded session. Errors
+ * are the largest over joints of the difference to the leader's actual positions at the forecast
+ * time [rad].
+ */
+struct PredictionError
+{
+    /** Time forecast ahead of each leader sample [ns] */
+    int64_t horizon_ns = 0;
+
+    /** Number of leader samples evaluated */
+    uint64_t sample_count = 0;
+
+    /** Error of commanding the sample as is, i.e. lagging the leader by the horizon */
+    double hold_rms = 0.0;
+    double hold_max = 0.0;
+
+    /** Error of commanding the forecast */
+    double forecast_rms = 0.0;
+    double forecast_max = 0.0;
+
+    /** Error of commanding the forecast blended with the sample by confidence */
+    double blended_rms = 0.0;
+    double blended_max = 0.0;
+
+    /** Mean of the lowest per-joint confidence */
+    double mean_confidence = 0.0;
+};
+
+/**
+ * @class SessionReplay
+ * @brief Feeds a session recorded by a follower node (see SessionRecorder) back through a fresh
+ * FollowerNode driving a SimRobot. The node's clock is stepped to each recorded cycle time and
+ * the packets received in that cycle are delivered to it, in their recorded order, so that the
+ * replayed node sees exactly the inputs the production node saw, including network delay,
+ * jitter, loss and reordering. Replays are deterministic and run as fast as the CPU allows.
+ */
+class SessionReplay
+{
+public:
+    /**
+     * @brief Open a follower session log.
+     * @param[in] log_path Session log written by a follower node.
+     * @param[in] params Replay setup.
+     * @throw std::runtime_error if the log cannot be read.
+     * @throw std::invalid_argument if the log was not recorded by a follower node.
+     */
+    explicit SessionReplay(
+        const std::string& log_path, const SessionReplayParams& params = SessionReplayParams())
+    : reader_(log_path)
+    , params_(params)
+    {
+        if (reader_.header().node != MessageType::kFollowerState) {
+            throw std::invalid_argument("[flexiv::omni::teleop::SessionReplay] " + log_path
+                                        + " was not recorded by a follower node");
+        }
+    }
+
+    /**
+     * @brief Replay the whole session from the start.
+     * @return Replay metrics.
+     */
+    SessionReplayResult Run()
+    {
+        SessionReplayResult result;
+        SessionRecord record;
+
+        // Start the simulated arm where the real one was
+        SimRobotParams robot_params = params_.robot;
+        reader_.Rewind();
+        while (reader_.Next(record)) {
+            if (record.kind == RecordKind::kCycle) {
+                robot_params.initial_q = record.packet.q;
+                break;
+            }
+        }
+
+        ManualClock clock;
+        ReplayTransport transport;
+        SimRobot robot(robot_params);
+        robot.SetVirtualWall(params_.wall);
+        FollowerNode node(robot, transport, params_.follower, clock);
+
+        uint64_t hash = kFnvOffset;
+        double divergence_sq_sum = 0.0, tracking_sq_sum = 0.0;
+        uint64_t tracking_count = 0;
+        int64_t first_time = 0, last_time = 0;
+        reader_.Rewind();
+        while (reader_.Next(record)) {
+            if (record.kind == RecordKind::kReceived) {
+                transport.Push(record.packet);
+                continue;
+            }
+            if (record.kind != RecordKind::kCycle) {
+                continue;
+            }
+            if (result.cycle_count++ == 0) {
+                first_time = record.time_ns;
+            }
+            last_time = record.time_ns;
+
+            clock.Set(record.time_ns);
+            node.Step();
+            robot.Step();
+
+            const auto& target = robot.target_q();
+            const auto q = robot.states().q;
+            double divergence = 0.0, tracking = 0.0;
+            for (size_t i = 0; i < kJointDoF; ++i) {
+                divergence = std::max(divergence, std::abs(target[i] - record.command.q[i]));
+                tracking = std::max(tracking, std::abs(target[i] - q[i]));
+                uint64_t bits;
+                std::memcpy(&bits, &target[i], sizeof(bits));
+                hash = (hash ^ bits) * kFnvPrime;
+            }
+            result.divergence_max = std::max(result.divergence_max, divergence);
+            divergence_sq_sum += divergence * divergence;
+            // The arm only tracks once it has been given a target
+            if (node.status().commanded_count > 0) {
+                result.tracking_error_max = std::max(result.tracking_error_max, tracking);
+                tracking_sq_sum += tracking * tracking;
+                ++tracking_count;
+            }
+        }
+
+        if (result.cycle_count > 0) {
+            result.recorded_duration = (last_time - first_time) * 1e-9;
+            result.divergence_rms = std::sqrt(divergence_sq_sum / result.cycle_count);
+        }
+        if (tracking_count > 0) {
+            result.tracking_error_rms = std::sqrt(tracking_sq_sum / tracking_count);
+        }
+        result.command_hash = hash;
+        result.status = node.status();
+        return result;
+    }
+
+    /**
+     * @brief Evaluate the motion predictor configured in FollowerParams::prediction on the leader
+     * samples received in the session. For each horizon, every received sample is fed to a fresh
+     * predictor in send order, the motion is forecast the horizon past the sample's send time and
+     * compared to the leader's actual positions then, interpolated from the later samples.
+     * Network delay does not enter the evaluation, only what the operator did. Each run of the
+     * leader, told apart by the epoch of its packets, is evaluated on its own, in the order the
+     * runs were recorded.
+     * @param[in] horizons_ns Horizons to evaluate, e.g. typical one-way delays [ns].
+     * @return Accuracy per horizon, in the order given.
+     */
+    std::vector<PredictionError> EvaluatePrediction(const std::vector<int64_t>& horizons_ns)
+    {
+        // Every leader sample once, in the order the leader sent them: run by run, as the runs
+        // were first received, the sequence restarting with each
+        std::vector<uint32_t> epochs;
+        std::vector<std::pair<size_t, StatePacket>> received;
+        SessionRecord record;
+        reader_.Rewind();
+        while (reader_.Next(record)) {
+            if (record.kind == RecordKind::kReceived) {
+                const uint32_t epoch = record.packet.header.epoch;
+                const auto run = std::find(epochs.begin(), epochs.end(), epoch) - epochs.begin();
+                received.emplace_back(run, record.packet);
+                if (run == static_cast<ptrdiff_t>(epochs.size())) {
+                    epochs.push_back(epoch);
+                }
+            }
+        }
+        std::sort(received.begin(), received.end(), [](const auto& a, const auto& b) {
+            return a.first != b.first ? a.first < b.first
+                                      : a.second.header.sequence < b.second.header.sequence;
+        });
+        received.erase(std::unique(received.begin(), received.end(),
+                           [](const auto& a, const auto& b) {
+                               return a.first == b.first
+                                      && a.second.header.sequence == b.second.header.sequence;
+                           }),
+            received.end());
+        std::vector<size_t> runs(received.size());
+        std::vector<StatePacket> samples(received.size());
+        for (size_t k = 0; k < received.size(); ++k) {
+            runs[k] = received[k].first;
+            samples[k] = received[k].second;
+        }
+
+        std::vector<PredictionError> errors;
+        for (int64_t horizon_ns : horizons_ns) {
+            PredictionError error;
+            error.horizon_ns = horizon_ns;
+            MotionPredictor predictor(params_.follower.prediction);
+            double hold_sq_sum = 0.0, forecast_sq_sum = 0.0, blended_sq_sum = 0.0;
+            double confidence_sum = 0.0;
+            size_t next = 0;
+            for (size_t k = 0; k < samples.size(); ++k) {
+                const auto& sample = samples[k];
+                if (k > 0 && runs[k] != runs[k - 1]) {
+                    predictor.Reset();
+                }
+                predictor.Update(sample.header.send_time_ns, sample.q, sample.dq);
+
+                // Actual positions at the forecast time, skip when the run ends before it
+                const int64_t time_ns = sample.header.send_time_ns + horizon_ns;
+                next = std::max(next, k);
+                while (next < samples.size() && runs[next] == runs[k]
+                       && samples[next].header.send_time_ns < time_ns) {
+                    ++next;
+                }
+                if (next == samples.size() || runs[next] != runs[k]) {
+                    continue;
+                }
+                JointArray actual = samples[next].q;
+                if (next > 0 && samples[next].header.send_time_ns > time_ns) {
+                    const auto& before = samples[next - 1];
+                    const double ratio
+                        = static_cast<double>(time_ns - before.header.send_time_ns)
+                          / (samples[next].header.send_time_ns - before.header.send_time_ns);
+                    for (size_t i = 0; i < kJointDoF; ++i) {
+                        actual[i] = before.q[i] + ratio * (samples[next].q[i] - before.q[i]);
+                    }
+                }
+
+                JointArray forecast_q, forecast_dq, confidence;
+                predictor.Forecast(time_ns, forecast_q, forecast_dq, confidence);
+                JointArray blended_q = sample.q, blended_dq = sample.dq;
+                confidence_sum += predictor.Predict(time_ns, blended_q, blended_dq);
+                double hold = 0.0, forecast = 0.0, blended = 0.0;
+                for (size_t i = 0; i < kJointDoF; ++i) {
+                    hold = std::max(hold, std::abs(sample.q[i] - actual[i]));
+                    forecast = std::max(forecast, std::abs(forecast_q[i] - actual[i]));
+                    blended = std::max(blended, std::abs(blended_q[i] - actual[i]));
+                }
+                error.hold_max = std::max(error.hold_max, hold);
+                error.forecast_max = std::max(error.forecast_max, forecast);
+                error.blended_max = std::max(error.blended_max, blended);
+                hold_sq_sum += hold * hold;
+                forecast_sq_sum += forecast * forecast;
+                blended_sq_sum += blended * blended;
+                ++error.sample_count;
+            }
+            if (error.sample_count > 0) {
+                const auto count = static_cast<double>(error.sample_count);
+                error.hold_rms = std::sqrt(hold_sq_sum / count);
+                error.forecast_rms = std::sqrt(forecast_sq_sum / count);
+                error.blended_rms = std::sqrt(blended_sq_sum / count);
+                error.mean_confidence = confidence_sum / count;
+            }
+            errors.push_back(error);
+        }
+        return errors;
+    }
+
+private:
+    static constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+    static constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+    SessionReader reader_;
+    SessionReplayParams params_;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,368 @@
+/**
+ * @file shm_transport.hpp
+ * @brief Transport over POSIX shared memory, for leader and follower on the same host.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "spsc_queue.hpp"
+#include "transport.hpp"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/** Messages each direction of a shared-memory transport holds before new ones are dropped */
+constexpr size_t kShmRingCapacity = 64;
+
+/**
+ * @class ShmTransport
+ * @brief Transport between two processes, or threads, on the same host through a shared-memory
+ * segment created with shm_open(). The segment holds one single-producer/single-consumer ring of
+ * message slots per direction, so a message costs two copies and no system call, where loopback
+ * UDP costs a system call on each side and a pass through the network stack. Like UDP it never
+ * blocks: a full ring drops the message, and each message is delivered once, in order. Receivers
+ * normally poll in their control loop; WaitReadable() sleeps on a futex in the segment instead,
+ * and senders only make the system call that wakes it while a receiver is actually asleep.
+ * One opening side is attached at a time. When the opening side restarts, e.g. after a crash, the
+ * new one takes over the segment, and messages either side left unread for the old one are
+ * discarded on both sides, so that neither acts on messages meant for or sent by a dead peer.
+ */
+class ShmTransport : public Transport
+{
+public:
+    /**
+     * @brief Create a segment for the peer to open, replacing a stale one of the same name left
+     * behind by a crashed process. The segment is removed when this transport is destroyed.
+     * @param[in] name Name of the segment, e.g. "/flexiv_teleop", see shm_open().
+     * @return Transport of the creating side.
+     * @throw std::runtime_error if the segment cannot be created.
+     */
+    static std::unique_ptr<ShmTransport> Create(const std::string& name)
+    {
+        ::shm_unlink(name.c_str());
+        const int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            ThrowSystemError("Failed to create segment " + name);
+        }
+        if (::ftruncate(fd, sizeof(Segment)) < 0) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            ThrowSystemError("Failed to size segment " + name);
+        }
+        void* memory = Map(fd, name, true);
+        auto* segment = new (memory) Segment();
+        segment->ready.store(kSegmentMagic, std::memory_order_release);
+        return std::unique_ptr<ShmTransport>(new ShmTransport(segment, name, 0));
+    }
+
+    /**
+     * @brief [Blocking] Open the segment the peer created, retrying until it exists and no other
+     * opening side is attached to it. An opening side whose process is gone without closing its
+     * transport is taken over from.
+     * @param[in] name Name of the segment, as passed to Create() by the peer.
+     * @param[in] timeout How long to keep retrying.
+     * @return Transport of the opening side.
+     * @throw std::runtime_error if the segment does not exist, or is still in use by another
+     * opening side, before timeout.
+     */
+    static std::unique_ptr<ShmTransport> Open(
+        const std::string& name, std::chrono::milliseconds timeout = std::chrono::seconds(5))
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        bool in_use = false;
+        while (true) {
+            const int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+            struct stat info {};
+            if (fd >= 0 && ::fstat(fd, &info) == 0
+                && static_cast<size_t>(info.st_size) == sizeof(Segment)) {
+                auto* segment = static_cast<Segment*>(Map(fd, name, false));
+                if (segment->ready.load(std::memory_order_acquire) == kSegmentMagic) {
+                    in_use = !Attach(*segment);
+                    if (!in_use) {
+                        return std::unique_ptr<ShmTransport>(new ShmTransport(segment, "", 1));
+                    }
+                }
+                ::munmap(segment, sizeof(Segment));
+            } else if (fd >= 0) {
+                ::close(fd);
+            }
+            if (std::chrono::steady_clock::now() > deadline) {
+                throw std::runtime_error("[flexiv::omni::teleop::ShmTransport] Segment " + name
+                                         + (in_use ? " is in use by another opening side"
+                                                   : " was not created"));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    ~ShmTransport() override
+    {
+        if (side_ == 1) {
+            segment_->opener.store(0, std::memory_order_release);
+        }
+        ::munmap(segment_, sizeof(Segment));
+        if (!owned_name_.empty()) {
+            ::shm_unlink(owned_name_.c_str());
+        }
+    }
+
+    ShmTransport(const ShmTransport&) = delete;
+    ShmTransport& operator=(const ShmTransport&) = delete;
+
+    bool Send(const void* data, size_t size) override
+    {
+        if (size > kMaxMessageSize) {
+            return false;
+        }
+        Ring& ring = *tx_;
+        const uint64_t head = ring.head.load(std::memory_order_relaxed);
+        if (head - tx_cached_tail_ >= kShmRingCapacity) {
+            tx_cached_tail_ = ring.tail.load(std::memory_order_acquire);
+            if (head - tx_cached_tail_ >= kShmRingCapacity) {
+                return false;
+            }
+        }
+        Slot& slot = ring.slots[head % kShmRingCapacity];
+        slot.size = static_cast<uint32_t>(size);
+        std::memcpy(slot.data, data, size);
+        ring.head.store(head + 1, std::memory_order_release);
+
+        // Bump the futex word after publishing, a receiver about to sleep then sees it changed
+        ring.signal.fetch_add(1, std::memory_order_seq_cst);
+        if (ring.sleeping.load(std::memory_order_seq_cst)) {
+            Futex(&ring.signal, FUTEX_WAKE, 1, nullptr);
+        }
+        return true;
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        Resynchronize();
+        Ring& ring = *rx_;
+        while (true) {
+            const uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+            if (tail == rx_cached_head_) {
+                rx_cached_head_ = ring.head.load(std::memory_order_acquire);
+                if (tail == rx_cached_head_) {
+                    return 0;
+                }
+            }
+            const Slot& slot = ring.slots[tail % kShmRingCapacity];
+            const size_t size = slot.size;
+            const bool fits = size <= capacity && size <= kMaxMessageSize;
+            if (fits) {
+                std::memcpy(buffer, slot.data, size);
+            }
+            ring.tail.store(tail + 1, std::memory_order_release);
+            // Messages larger than the buffer are discarded as malformed, like truncated datagrams
+            if (fits) {
+                return size;
+            }
+        }
+    }
+
+    /**
+     * @brief [Blocking] Wait until a message can be received, sleeping on a futex rather than
+     * polling.
+     * @param[in] timeout_ns Longest time to wait [ns].
+     * @return True if a message can be received, false on timeout.
+     */
+    bool WaitReadable(int64_t timeout_ns)
+    {
+        Ring& ring = *rx_;
+        const auto deadline
+            = std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeout_ns);
+        while (true) {
+            const uint32_t signal = ring.signal.load(std::memory_order_seq_cst);
+            if (Readable()) {
+                return true;
+            }
+            const auto remaining = deadline - std::chrono::steady_clock::now();
+            if (remaining <= std::chrono::nanoseconds::zero()) {
+                return false;
+            }
+            const auto remaining_ns
+                = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+            timespec ts {};
+            ts.tv_sec = static_cast<time_t>(remaining_ns / 1000000000);
+            ts.tv_nsec = static_cast<long>(remaining_ns % 1000000000);
+            ring.sleeping.store(1, std::memory_order_seq_cst);
+            // Returns right away if a message was published since the signal was read
+            if (!Readable()) {
+                Futex(&ring.signal, FUTEX_WAIT, signal, &ts);
+            }
+            ring.sleeping.store(0, std::memory_order_seq_cst);
+        }
+    }
+
+private:
+    /** Set once a segment is initialized, "FOTS" in little-endian byte order */
+    static constexpr uint32_t kSegmentMagic = 0x53544F46;
+
+    struct Slot
+    {
+        uint32_t size;
+        uint8_t data[kMaxMessageSize];
+    };
+
+    /** One direction: producer and consumer indices on their own cache lines, then the slots */
+    struct Ring
+    {
+        alignas(kCacheLineSize) std::atomic<uint64_t> head {0};
+        alignas(kCacheLineSize) std::atomic<uint64_t> tail {0};
+        alignas(kCacheLineSize) std::atomic<uint32_t> signal {0};
+        std::atomic<uint32_t> sleeping {0};
+        alignas(kCacheLineSize) Slot slots[kShmRingCapacity];
+    };
+    static_assert(std::atomic<uint64_t>::is_always_lock_free
+                      && std::atomic<uint32_t>::is_always_lock_free,
+        "Atomics shared between processes must be lock-free");
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+        "The futex word must be a plain 32-bit integer");
+
+    struct Segment
+    {
+        std::atomic<uint32_t> ready {0};
+
+        /** Process ID of the attached opening side, 0 if none */
+        std::atomic<int32_t> opener {0};
+
+        /** Incremented each time an opening side attaches */
+        std::atomic<uint32_t> generation {0};
+
+        /** Head of the opening side's ring when it last attached, older messages are stale */
+        std::atomic<uint64_t> attach_head {0};
+
+        Ring rings[2];
+    };
+    static_assert(sizeof(pid_t) == sizeof(int32_t), "Process IDs must fit the opener field");
+
+    /** @param[in] side 0 for the creating side, 1 for the opening side */
+    ShmTransport(Segment* segment, const std::string& owned_name, int side)
+    : segment_(segment)
+    , owned_name_(owned_name)
+    , side_(side)
+    , tx_(&segment->rings[side])
+    , rx_(&segment->rings[1 - side])
+    , tx_cached_tail_(tx_->tail.load(std::memory_order_acquire))
+    , rx_cached_head_(rx_->head.load(std::memory_order_acquire))
+    , generation_(segment->generation.load(std::memory_order_acquire))
+    {
+    }
+
+    /**
+     * @brief Attach as the opening side of a segment, taking over from an opening side whose
+     * process is gone, and discard what was left unread in the rings for or by it.
+     * @return False if another opening side is attached.
+     */
+    static bool Attach(Segment& segment)
+    {
+        const int32_t self = static_cast<int32_t>(::getpid());
+        int32_t holder = 0;
+        if (!segment.opener.compare_exchange_strong(holder, self, std::memory_order_acq_rel)) {
+            // Signal 0 only checks whether the process exists
+            const bool gone = holder != self && ::kill(holder, 0) < 0 && errno == ESRCH;
+            if (!gone
+                || !segment.opener.compare_exchange_strong(
+                    holder, self, std::memory_order_acq_rel)) {
+                return false;
+            }
+        }
+        // The opening side consumes ring 0 and produces ring 1, the creating side skips what it
+        // has not received of ring 1 yet when it sees the generation change
+        Ring& rx = segment.rings[0];
+        rx.tail.store(rx.head.load(std::memory_order_acquire), std::memory_order_release);
+        segment.attach_head.store(
+            segment.rings[1].head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        segment.generation.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief Creating side only: discard messages of an opening side that was replaced */
+    void Resynchronize()
+    {
+        if (side_ != 0) {
+            return;
+        }
+        const uint32_t generation = segment_->generation.load(std::memory_order_acquire);
+        if (generation == generation_) {
+            return;
+        }
+        generation_ = generation;
+        Ring& ring = *rx_;
+        const uint64_t attach_head = segment_->attach_head.load(std::memory_order_relaxed);
+        rx_cached_head_ = ring.head.load(std::memory_order_acquire);
+        ring.tail.store(std::max(ring.tail.load(std::memory_order_relaxed), attach_head),
+            std::memory_order_release);
+    }
+
+    static void* Map(int fd, const std::string& name, bool unlink_on_error)
+    {
+        void* memory
+            = ::mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (memory == MAP_FAILED) {
+            if (unlink_on_error) {
+                ::shm_unlink(name.c_str());
+            }
+            ThrowSystemError("Failed to map segment " + name);
+        }
+        return memory;
+    }
+
+    bool Readable()
+    {
+        Resynchronize();
+        return rx_->tail.load(std::memory_order_relaxed)
+               != rx_->head.load(std::memory_order_acquire);
+    }
+
+    static long Futex(std::atomic<uint32_t>* word, int op, uint32_t value, const timespec* timeout)
+    {
+        // Shared futex, not FUTEX_PRIVATE_FLAG: waiter and waker may be different processes
+        return ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value, timeout,
+            nullptr, 0);
+    }
+
+    [[noreturn]] static void ThrowSystemError(const std::string& what)
+    {
+        throw std::runtime_error(
+            "[flexiv::omni::teleop::ShmTransport] " + what + ": " + std::strerror(errno));
+    }
+
+    Segment* segment_;
+    std::string owned_name_;
+    int side_;
+    Ring* tx_;
+    Ring* rx_;
+    uint64_t tx_cached_tail_;
+    uint64_t rx_cached_head_;
+    uint32_t generation_;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,203 @@
+/**
+ * @file sim_robot.hpp
+ * @brief Simulated arm with kinematics and simple joint impedance dynamics, for running the
+ * teleop pipeline without hardware.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "kinematics.hpp"
+#include "robot_interface.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @struct SimRobotParams
+ * @brief Dynamics and controller parameters of a simulated arm.
+ */
+struct SimRobotParams
+{
+    /** Effective inertia of each joint [kg m^2] */
+    JointArray inertia = {0.8, 0.8, 0.4, 0.4, 0.1, 0.1, 0.05};
+
+    /** Viscous friction of each joint [Nm s/rad] */
+    JointArray viscous_friction = {2.0, 2.0, 1.0, 1.0, 0.3, 0.3, 0.1};
+
+    /** Joint impedance stiffness [Nm/rad] */
+    JointArray stiffness = {1500.0, 1500.0, 800.0, 800.0, 200.0, 200.0, 100.0};
+
+    /** Joint impedance damping ratio [] */
+    double damping_ratio = 0.7;
+
+    /** Actuator torque limits [Nm] */
+    JointArray max_torque = {123.0, 123.0, 64.0, 64.0, 39.0, 39.0, 39.0};
+
+    /** Initial joint positions [rad] */
+    JointArray initial_q = {0.0, -0.698, 0.0, 1.571, 0.0, 0.698, 0.0};
+};
+
+/**
+ * @struct VirtualWall
+ * @brief Half-space contact rendered by SimRobot on the TCP position. The TCP is in contact when
+ * it is on the negative side of the plane n . p = offset.
+ */
+struct VirtualWall
+{
+    /** Whether the wall exists */
+    bool enabled = false;
+
+    /** Unit normal of the wall pointing into free space, in the world frame */
+    Eigen::Vector3d normal = Eigen::Vector3d::UnitZ();
+
+    /** Plane offset along the normal [m] */
+    double offset = 0.0;
+
+    /** Contact stiffness [N/m] */
+    double stiffness = 5000.0;
+
+    /** Contact damping [N s/m] */
+    double damping = 50.0;
+};
+
+/**
+ * @class SimRobot
+ * @brief Each joint is modeled as a decoupled rigid inertia with viscous friction, driven by
+ * either a joint impedance controller (after StreamJointPosition() is called) or streamed
+ * torques alone, plus external torques from the environment. Gravity is assumed to be perfectly
+ * compensated. Contacts are rendered by an optional virtual wall acting on the TCP. The model is
+ * integrated with semi-implicit Euler each time Step() is called.
+ * @note Not thread-safe. Call Step() from the same thread that drives the robot interface, once
+ * per control cycle, to emulate a real arm advancing in time.
+ */
+class SimRobot : public RobotInterface
+{
+public:
+    explicit SimRobot(const SimRobotParams& params = SimRobotParams(),
+        const DhParams& dh_params = DhParams::Rizon4())
+    : params_(params)
+    , kinematics_(dh_params)
+    {
+        states_.q = params_.initial_q;
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            damping_[i] = 2.0 * params_.damping_ratio
+                          * std::sqrt(params_.stiffness[i] * params_.inertia[i]);
+        }
+        UpdateCartesianStates(CartArray {});
+    }
+
+    RobotStates states() const override { return states_; }
+
+    void StreamJointPosition(const JointArray& positions, const JointArray& velocities) override
+    {
+        impedance_active_ = true;
+        target_q_ = positions;
+        target_dq_ = velocities;
+    }
+
+    void StreamJointTorque(const JointArray& torques) override { feedforward_tau_ = torques; }
+
+    /**
+     * @brief Set external joint torques applied by something other than the virtual wall, e.g.
+     * an emulated operator pushing the leader arm. Persists until changed.
+     * @param[in] torques External joint torques [Nm].
+     */
+    void SetExternalJointTorque(const JointArray& torques) { external_tau_ = torques; }
+
+    /**
+     * @brief Set the virtual wall the TCP can collide with.
+     * @param[in] wall Wall definition, disabled by default.
+     */
+    void SetVirtualWall(const VirtualWall& wall) { wall_ = wall; }
+
+    /**
+     * @brief Advance the simulation by one time step.
+     * @param[in] dt Time step [s].
+     */
+    void Step(double dt = kLoopPeriod)
+    {
+        // Contact wrench from the TCP pose and velocity at the start of the step
+        CartArray wall_wrench = ComputeWallWrench();
+        Eigen::Map<const Eigen::Matrix<double, kCartDoF, 1>> wrench(wall_wrench.data());
+        const Eigen::Matrix<double, kJointDoF, 1> wall_tau = jacobian_.transpose() * wrench;
+
+        for (size_t i = 0; i < kJointDoF; ++i) {
+            double tau_cmd = feedforward_tau_[i];
+            if (impedance_active_) {
+                tau_cmd += params_.stiffness[i] * (target_q_[i] - states_.q[i])
+                           + damping_[i] * (target_dq_[i] - states_.dq[i]);
+            }
+            tau_cmd = std::clamp(tau_cmd, -params_.max_torque[i], params_.max_torque[i]);
+
+            const double tau_ext = wall_tau[i] + external_tau_[i];
+            const double ddq = (tau_cmd + tau_ext - params_.viscous_friction[i] * states_.dq[i])
+                               / params_.inertia[i];
+            states_.dq[i] += ddq * dt;
+            states_.q[i] += states_.dq[i] * dt;
+            states_.tau[i] = tau_cmd;
+            states_.tau_ext[i] = tau_ext;
+        }
+        UpdateCartesianStates(wall_wrench);
+    }
+
+    /** Parameters of the simulated arm */
+    const SimRobotParams& params() const { return params_; }
+
+    /** Joint position target last streamed, zeros before the first one [rad] */
+    const JointArray& target_q() const { return target_q_; }
+
+private:
+    CartArray ComputeWallWrench() const
+    {
+        CartArray wrench = {};
+        if (!wall_.enabled) {
+            return wrench;
+        }
+        const Eigen::Vector3d p(states_.tcp_pose[0], states_.tcp_pose[1], states_.tcp_pose[2]);
+        const Eigen::Vector3d v(states_.tcp_vel[0], states_.tcp_vel[1], states_.tcp_vel[2]);
+        const double penetration = wall_.offset - wall_.normal.dot(p);
+        if (penetration <= 0.0) {
+            return wrench;
+        }
+        // Unilateral contact, the wall can only push
+        const double magnitude = std::max(
+            0.0, wall_.stiffness * penetration - wall_.damping * wall_.normal.dot(v));
+        for (size_t i = 0; i < 3; ++i) {
+            wrench[i] = magnitude * wall_.normal[i];
+        }
+        return wrench;
+    }
+
+    void UpdateCartesianStates(const CartArray& ext_wrench)
+    {
+        Eigen::Isometry3d tcp_pose;
+        kinematics_.Compute(states_.q, tcp_pose, jacobian_);
+        states_.tcp_pose = Kinematics::ToPoseArray(tcp_pose);
+
+        Eigen::Map<const Eigen::Matrix<double, kJointDoF, 1>> dq(states_.dq.data());
+        Eigen::Map<Eigen::Matrix<double, kCartDoF, 1>>(states_.tcp_vel.data()) = jacobian_ * dq;
+        states_.ext_wrench_in_world = ext_wrench;
+    }
+
+    SimRobotParams params_;
+    Kinematics kinematics_;
+    RobotStates states_;
+    Jacobian jacobian_ = Jacobian::Zero();
+    JointArray damping_ = {};
+
+    bool impedance_active_ = false;
+    JointArray target_q_ = {};
+    JointArray target_dq_ = {};
+    JointArray feedforward_tau_ = {};
+    JointArray external_tau_ = {};
+    VirtualWall wall_;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
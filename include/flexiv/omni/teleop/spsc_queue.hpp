@@ -0,0 +1,140 @@
+/**
+ * @file spsc_queue.hpp
+ * @brief Wait-free single-producer/single-consumer ring buffer for handing samples between the
+ * real-time control thread and non-real-time threads.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/** Size of a cache line, used to keep producer and consumer indices from false sharing */
+constexpr size_t kCacheLineSize = 64;
+
+/**
+ * @class SpscQueue
+ * @brief Bounded FIFO queue with exactly one producer thread and one consumer thread. Both
+ * TryPush() and TryPop() are wait-free: they complete in a bounded number of steps regardless of
+ * what the other thread is doing, never block and never allocate. All storage is embedded in the
+ * object, so the memory footprint is fixed at compile time.
+ * @tparam T Element type. Should be trivially copyable for real-time use so that copying an
+ * element cannot allocate or throw.
+ * @tparam Capacity Maximum number of elements the queue can hold, must be a power of 2.
+ * @note The object itself may be large, allocate it once before entering the real-time loop
+ * rather than on the real-time thread's stack.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+        "SpscQueue capacity must be a power of 2 and at least 2");
+    static_assert(std::is_default_constructible<T>::value && std::is_copy_assignable<T>::value,
+        "SpscQueue element type must be default constructible and copy assignable");
+
+public:
+    SpscQueue() = default;
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    /**
+     * @brief [Producer only] Append an element to the back of the queue.
+     * @param[in] value Element to copy into the queue.
+     * @return True if the element was enqueued, false if the queue is full.
+     */
+    bool TryPush(const T& value) noexcept(std::is_nothrow_copy_assignable<T>::value)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ == Capacity) {
+            // Refresh the consumer position only when the cached one says we are full
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ == Capacity) {
+                return false;
+            }
+        }
+        buffer_[head & kMask] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief [Consumer only] Remove the element at the front of the queue.
+     * @param[out] value Receives the dequeued element.
+     * @return True if an element was dequeued, false if the queue is empty.
+     */
+    bool TryPop(T& value) noexcept(std::is_nothrow_copy_assignable<T>::value)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            // Refresh the producer position only when the cached one says we are empty
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_) {
+                return false;
+            }
+        }
+        value = buffer_[tail & kMask];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief [Consumer only] Drop all elements but the newest one and return it. Useful when the
+     * consumer only cares about the latest sample but the producer must not lose any (e.g. it is
+     * also being recorded).
+     * @param[out] value Receives the newest element.
+     * @return Number of elements removed from the queue, 0 if the queue was empty.
+     */
+    size_t PopLatest(T& value) noexcept(std::is_nothrow_copy_assignable<T>::value)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        cached_head_ = head;
+        if (tail == head) {
+            return 0;
+        }
+        value = buffer_[(head - 1) & kMask];
+        tail_.store(head, std::memory_order_release);
+        return head - tail;
+    }
+
+    /**
+     * @brief [Any thread] Approximate number of elements in the queue. Exact when called from
+     * either the producer or the consumer while the other side is idle.
+     */
+    size_t size() const noexcept
+    {
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        const size_t head = head_.load(std::memory_order_acquire);
+        return head - tail;
+    }
+
+    /** [Any thread] Whether the queue is (approximately) empty */
+    bool empty() const noexcept { return size() == 0; }
+
+    /** Maximum number of elements the queue can hold */
+    static constexpr size_t capacity() noexcept { return Capacity; }
+
+private:
+    static constexpr size_t kMask = Capacity - 1;
+
+    /** Producer-owned: next slot to write and last observed consumer position */
+    alignas(kCacheLineSize) std::atomic<size_t> head_ {0};
+    size_t cached_tail_ = 0;
+
+    /** Consumer-owned: next slot to read and last observed producer position */
+    alignas(kCacheLineSize) std::atomic<size_t> tail_ {0};
+    size_t cached_head_ = 0;
+
+    alignas(kCacheLineSize) std::array<T, Capacity> buffer_ {};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,631 @@
+/**
+ * @file state_compression.hpp
+ * @brief Quantized, keyframe delta-coded encoding of state packets for bandwidth-limited links.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "epoch_tracker.hpp"
+#include "transport.hpp"
+#include "wire_format.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/** Magic number at the start of every compressed packet, "FOTQ" in little-endian byte order */
+constexpr uint32_t kCompressedPacketMagic = 0x51544F46;
+
+/**
+ * @struct CompressionParams
+ * @brief Resolution each quantity is quantized to, and how often a keyframe is sent. A value is
+ * reconstructed to within half its resolution.
+ */
+struct CompressionParams
+{
+    /** Joint positions [rad] */
+    double joint_position_resolution = 1e-5;
+
+    /** Joint velocities [rad/s] */
+    double joint_velocity_resolution = 1e-4;
+
+    /** External joint torques [Nm] */
+    double joint_torque_resolution = 1e-2;
+
+    /** TCP position [m] */
+    double position_resolution = 1e-5;
+
+    /** TCP orientation quaternion components [] */
+    double orientation_resolution = 1e-5;
+
+    /** External forces [N] */
+    double force_resolution = 1e-2;
+
+    /** External moments [Nm] */
+    double moment_resolution = 1e-3;
+
+    /**
+     * Packets between two keyframes. A keyframe carries absolute values, other packets carry the
+     * difference to the newest keyframe the peer acknowledged, so a shorter interval recovers from
+     * loss and keeps deltas small sooner, at the cost of more full-size packets.
+     */
+    unsigned keyframe_interval = 100;
+};
+
+/** Header flag of a compressed packet that is a keyframe, which the peer keeps and acknowledges */
+constexpr uint8_t kKeyframeFlag = 0x01;
+
+/**
+ * @struct CompressedPacketHeader
+ * @brief Header of a compressed packet. On the wire, the first 12 bytes are laid out as in
+ * PacketHeader with magic set to kCompressedPacketMagic, followed by zigzag varints of sequence,
+ * base_offset, ack, send_time_ns, echo_time_ns and the time from echo_receive_time_ns to
+ * send_time_ns, then by one varint per quantized value. The state packet's header is restored
+ * exactly on decoding.
+ */
+struct CompressedPacketHeader
+{
+    /**
+     * Header of the original packet, with magic set to kCompressedPacketMagic and flags to
+     * kKeyframeFlag for a keyframe
+     */
+    PacketHeader header;
+
+    /** Sequence distance to the keyframe the values are relative to, 0 for absolute values */
+    uint32_t base_offset = 0;
+
+    /** Lower 32 bits of the sequence of the newest keyframe received from the peer, 0 if none */
+    uint32_t ack = 0;
+};
+
+/** Size of the fixed-layout start of a compressed packet: magic, version, type, flags and epoch */
+constexpr size_t kCompressedFixedSize = offsetof(PacketHeader, reserved);
+
+/** Number of quantized values in a state packet's payload */
+constexpr size_t kQuantizedSize = 3 * kJointDoF + kPoseSize + kCartDoF;
+
+/** Largest size of a compressed packet, every varint taking its 10 bytes [bytes] */
+constexpr size_t kMaxCompressedSize = kCompressedFixedSize + 10 * (6 + kQuantizedSize);
+static_assert(kMaxCompressedSize <= kMaxMessageSize, "Compressed packet exceeds a message");
+
+/** Payload of a state packet in units of the configured resolutions */
+using QuantizedState = std::array<int64_t, kQuantizedSize>;
+
+namespace detail {
+
+/** Payload of a state packet as one array, in the order it is laid out in the packet */
+using Payload = std::array<double, kQuantizedSize>;
+static_assert(offsetof(StatePacket, ext_wrench) + sizeof(CartArray) - offsetof(StatePacket, q)
+                  == kQuantizedSize * sizeof(double),
+    "State packet payload must be contiguous");
+
+/** Append a signed value as zigzag LEB128 varint, small magnitudes take one byte */
+inline uint8_t* WriteVarint(int64_t value, uint8_t* out)
+{
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (zigzag >= 0x80) {
+        *out++ = static_cast<uint8_t>(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(zigzag);
+    return out;
+}
+
+/** Read a zigzag LEB128 varint, nullptr if it runs past end */
+inline const uint8_t* ReadVarint(const uint8_t* in, const uint8_t* end, int64_t& value)
+{
+    uint64_t zigzag = 0;
+    for (unsigned shift = 0; shift < 64 && in < end; shift += 7) {
+        const uint8_t byte = *in++;
+        zigzag |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+            return in;
+        }
+    }
+    return nullptr;
+}
+
+/** Write the header of a compressed packet, return the end of what was written */
+inline uint8_t* WriteHeader(const CompressedPacketHeader& header, uint8_t* out)
+{
+    std::memcpy(out, &header.header, kCompressedFixedSize);
+    out += kCompressedFixedSize;
+    const PacketHeader& h = header.header;
+    out = WriteVarint(static_cast<int64_t>(h.sequence), out);
+    out = WriteVarint(header.base_offset, out);
+    out = WriteVarint(header.ack, out);
+    out = WriteVarint(h.send_time_ns, out);
+    out = WriteVarint(h.echo_time_ns, out);
+    // Both on the sender's clock and about a cycle apart, 0 is kept for "none"
+    return WriteVarint(
+        h.echo_receive_time_ns == 0 ? 0 : h.send_time_ns - h.echo_receive_time_ns + 1, out);
+}
+
+/** Read the header of a compressed packet, nullptr if it is not one of this wire version */
+inline const uint8_t* ReadHeader(
+    const uint8_t* in, const uint8_t* end, CompressedPacketHeader& header)
+{
+    if (end - in < static_cast<ptrdiff_t>(kCompressedFixedSize)) {
+        return nullptr;
+    }
+    PacketHeader& h = header.header;
+    std::memcpy(&h, in, kCompressedFixedSize);
+    if (h.magic != kCompressedPacketMagic || h.version != kWireVersion) {
+        return nullptr;
+    }
+    in += kCompressedFixedSize;
+    std::array<int64_t, 6> fields = {};
+    for (size_t i = 0; i < fields.size() && in; ++i) {
+        in = ReadVarint(in, end, fields[i]);
+    }
+    h.sequence = static_cast<uint64_t>(fields[0]);
+    header.base_offset = static_cast<uint32_t>(fields[1]);
+    header.ack = static_cast<uint32_t>(fields[2]);
+    h.send_time_ns = fields[3];
+    h.echo_time_ns = fields[4];
+    h.echo_receive_time_ns = fields[5] == 0 ? 0 : h.send_time_ns - fields[5] + 1;
+    return in;
+}
+
+} /* namespace detail */
+
+/**
+ * @class StateQuantizer
+ * @brief Converts state packet payloads to and from integers in units of their resolutions.
+ */
+class StateQuantizer
+{
+public:
+    /**
+     * @param[in] params Resolutions, all must be positive.
+     * @throw std::invalid_argument if a resolution is not positive.
+     */
+    explicit StateQuantizer(const CompressionParams& params)
+    {
+        const std::array<std::pair<size_t, double>, 7> groups = {{
+            {kJointDoF, params.joint_position_resolution},
+            {kJointDoF, params.joint_velocity_resolution},
+            {kJointDoF, params.joint_torque_resolution},
+            {3, params.position_resolution},
+            {kPoseSize - 3, params.orientation_resolution},
+            {3, params.force_resolution},
+            {kCartDoF - 3, params.moment_resolution},
+        }};
+        size_t i = 0;
+        for (const auto& group : groups) {
+            if (!(group.second > 0.0)) {
+                throw std::invalid_argument(
+                    "[flexiv::omni::teleop::StateQuantizer] Resolutions must be positive");
+            }
+            for (size_t k = 0; k < group.first; ++k, ++i) {
+                resolution_[i] = group.second;
+                scale_[i] = 1.0 / group.second;
+            }
+        }
+    }
+
+    /** [Real-time] Quantize a packet's payload, saturating values beyond the int64 range */
+    void Quantize(const StatePacket& packet, QuantizedState& values) const
+    {
+        detail::Payload in;
+        std::memcpy(in.data(),
+            reinterpret_cast<const uint8_t*>(&packet) + offsetof(StatePacket, q), sizeof(in));
+        for (size_t i = 0; i < kQuantizedSize; ++i) {
+            constexpr double kLimit = 9.2e18;
+            const double scaled = std::round(in[i] * scale_[i]);
+            values[i] = static_cast<int64_t>(std::isnan(scaled) ? 0.0
+                                             : scaled > kLimit  ? kLimit
+                                             : scaled < -kLimit ? -kLimit
+                                                                : scaled);
+        }
+    }
+
+    /** [Real-time] Reconstruct a packet's payload, renormalizing the TCP orientation */
+    void Dequantize(const QuantizedState& values, StatePacket& packet) const
+    {
+        detail::Payload out;
+        for (size_t i = 0; i < kQuantizedSize; ++i) {
+            out[i] = static_cast<double>(values[i]) * resolution_[i];
+        }
+        std::memcpy(reinterpret_cast<uint8_t*>(&packet) + offsetof(StatePacket, q), out.data(),
+            sizeof(out));
+        double norm = 0.0;
+        for (size_t i = 3; i < kPoseSize; ++i) {
+            norm += packet.tcp_pose[i] * packet.tcp_pose[i];
+        }
+        if (norm > 0.0) {
+            norm = std::sqrt(norm);
+            for (size_t i = 3; i < kPoseSize; ++i) {
+                packet.tcp_pose[i] /= norm;
+            }
+        }
+    }
+
+private:
+    std::array<double, kQuantizedSize> resolution_ = {};
+    std::array<double, kQuantizedSize> scale_ = {};
+};
+
+/**
+ * @class StateEncoder
+ * @brief Compresses the packets a node sends. Every keyframe_interval packets a keyframe with the
+ * absolute quantized values is sent; all other packets carry the difference to the newest keyframe
+ * the peer has acknowledged, or absolute values too until the first acknowledgement. Deltas are
+ * taken against a keyframe rather than the previous packet so that each packet decodes on its
+ * own, and the lossy quantization error never accumulates. Keyframes are remembered for 64
+ * intervals, a round trip longer than that never gets one acknowledged.
+ */
+class StateEncoder
+{
+public:
+    explicit StateEncoder(const CompressionParams& params)
+    : quantizer_(params)
+    , keyframe_interval_(params.keyframe_interval > 0 ? params.keyframe_interval : 1)
+    {
+    }
+
+    /**
+     * @brief [Real-time] Encode a packet.
+     * @param[in] packet Packet to send.
+     * @param[in] ack Acknowledgement of the peer's keyframes to piggyback, see StateDecoder::ack().
+     * @param[out] out Destination of at least kMaxCompressedSize bytes.
+     * @return Size of the compressed packet.
+     */
+    size_t Encode(const StatePacket& packet, uint32_t ack, uint8_t* out)
+    {
+        quantizer_.Quantize(packet, values_);
+        const uint64_t sequence = packet.header.sequence;
+        // A new epoch means this node restarted, its old keyframes are void
+        if (packet.header.epoch != epoch_) {
+            Reset();
+            epoch_ = packet.header.epoch;
+        }
+        keyframe_ = last_keyframe_ == 0 || sequence - last_keyframe_ >= keyframe_interval_;
+        const bool absolute
+            = keyframe_ || !has_base_ || sequence - base_sequence_ > UINT32_MAX;
+
+        CompressedPacketHeader header;
+        header.header = packet.header;
+        header.header.magic = kCompressedPacketMagic;
+        header.header.flags = keyframe_ ? kKeyframeFlag : 0;
+        header.base_offset = absolute ? 0 : static_cast<uint32_t>(sequence - base_sequence_);
+        header.ack = ack;
+        uint8_t* cursor = detail::WriteHeader(header, out);
+        for (size_t i = 0; i < kQuantizedSize; ++i) {
+            cursor = detail::WriteVarint(absolute ? values_[i] : values_[i] - base_[i], cursor);
+        }
+
+        // Remember unacknowledged keyframes so that an acknowledgement can make one the base
+        if (keyframe_) {
+            last_keyframe_ = sequence;
+            auto& slot = history_[history_next_++ % history_.size()];
+            slot.sequence = sequence;
+            slot.values = values_;
+        }
+        return static_cast<size_t>(cursor - out);
+    }
+
+    /**
+     * @brief [Real-time] Take an acknowledgement from the peer and delta-code against the
+     * acknowledged keyframe from now on, if it is newer than the current base.
+     * @param[in] ack Lower 32 bits of a keyframe sequence, 0 for none.
+     */
+    void Acknowledge(uint32_t ack)
+    {
+        if (ack == 0) {
+            return;
+        }
+        for (const auto& slot : history_) {
+            if (slot.sequence != 0 && static_cast<uint32_t>(slot.sequence) == ack
+                && (!has_base_ || slot.sequence > base_sequence_)) {
+                base_sequence_ = slot.sequence;
+                base_ = slot.values;
+                has_base_ = true;
+                return;
+            }
+        }
+    }
+
+    /** Sequence of the keyframe deltas are taken against, 0 while none is acknowledged */
+    uint64_t base_sequence() const { return has_base_ ? base_sequence_ : 0; }
+
+    /** Whether the latest packet encoded is a keyframe */
+    bool keyframe() const { return keyframe_; }
+
+    /** Forget all keyframes, e.g. after the peer restarted */
+    void Reset()
+    {
+        has_base_ = false;
+        base_sequence_ = last_keyframe_ = 0;
+        history_ = {};
+    }
+
+private:
+    /** Keyframes remembered until acknowledged, covers round trips up to this many intervals */
+    static constexpr size_t kHistorySize = 64;
+
+    struct Keyframe
+    {
+        uint64_t sequence = 0;
+        QuantizedState values = {};
+    };
+
+    StateQuantizer quantizer_;
+    uint64_t keyframe_interval_;
+    QuantizedState values_ = {};
+    QuantizedState base_ = {};
+    uint64_t base_sequence_ = 0;
+    bool has_base_ = false;
+    uint64_t last_keyframe_ = 0;
+    uint32_t epoch_ = 0;
+    bool keyframe_ = false;
+    std::array<Keyframe, kHistorySize> history_ = {};
+    size_t history_next_ = 0;
+};
+
+/**
+ * @class StateDecoder
+ * @brief Reconstructs the packets a StateEncoder compressed. Keeps the recent keyframes so that
+ * deltas against any of them decode, and acknowledges the newest one back to the encoder.
+ * Keyframes are kept per epoch, so deltas never resolve across a restart. Once an EpochTracker
+ * confirms a new epoch, the peer restarted: the keyframes of other epochs are dropped, and late
+ * keyframes of the epochs before decode but are no longer kept.
+ */
+class StateDecoder
+{
+public:
+    explicit StateDecoder(const CompressionParams& params)
+    : quantizer_(params)
+    {
+    }
+
+    /** Outcome of decoding one message */
+    enum class Result
+    {
+        kDecoded,     ///< packet reconstructed
+        kMalformed,   ///< not a compressed packet of this wire version, or truncated
+        kMissingBase, ///< delta against a keyframe that was lost or is too old
+    };
+
+    /**
+     * @brief [Real-time] Decode a compressed packet.
+     * @param[in] data Received bytes.
+     * @param[in] size Number of bytes received.
+     * @param[out] header Header of the packet, valid unless the result is kMalformed.
+     * @param[out] packet Reconstructed packet, valid only if the result is kDecoded.
+     * @return Outcome.
+     */
+    Result Decode(
+        const uint8_t* data, size_t size, CompressedPacketHeader& header, StatePacket& packet)
+    {
+        const uint8_t* end = data + size;
+        const uint8_t* cursor = detail::ReadHeader(data, end, header);
+        for (size_t i = 0; i < kQuantizedSize && cursor; ++i) {
+            cursor = detail::ReadVarint(cursor, end, values_[i]);
+        }
+        if (cursor != end) {
+            return Result::kMalformed;
+        }
+
+        const uint64_t sequence = header.header.sequence;
+        const uint32_t epoch = header.header.epoch;
+        using Verdict = EpochTracker<uint32_t>::Verdict;
+        const Verdict verdict = epochs_.Observe(epoch, sequence);
+        if (verdict == Verdict::kRestarted) {
+            // Keyframes the new epoch sent before it was confirmed stay
+            newest_keyframe_ = 0;
+            for (auto& slot : history_) {
+                if (slot.epoch != epoch) {
+                    slot = Keyframe();
+                } else {
+                    newest_keyframe_ = std::max(newest_keyframe_, slot.sequence);
+                }
+            }
+        }
+        if (header.header.flags & kKeyframeFlag) {
+            // Late keyframes of an epoch before the restart decode, but are not kept
+            if (verdict != Verdict::kRetired) {
+                // Duplicates overwrite their own slot
+                Keyframe* slot = Find(sequence, epoch);
+                if (!slot) {
+                    slot = &history_[history_next_++ % history_.size()];
+                }
+                slot->sequence = sequence;
+                slot->epoch = epoch;
+                slot->values = values_;
+                if (verdict != Verdict::kPending && sequence > newest_keyframe_) {
+                    newest_keyframe_ = sequence;
+                }
+            }
+        } else if (header.base_offset != 0) {
+            const Keyframe* base = sequence > header.base_offset
+                                       ? Find(sequence - header.base_offset, epoch)
+                                       : nullptr;
+            if (!base) {
+                return Result::kMissingBase;
+            }
+            for (size_t i = 0; i < kQuantizedSize; ++i) {
+                values_[i] += base->values[i];
+            }
+        }
+        packet.header = header.header;
+        packet.header.magic = kPacketMagic;
+        packet.header.flags = 0;
+        quantizer_.Dequantize(values_, packet);
+        return Result::kDecoded;
+    }
+
+    /**
+     * Acknowledgement to send back to the encoder: newest keyframe of the current epoch received,
+     * 0 if none
+     */
+    uint32_t ack() const { return static_cast<uint32_t>(newest_keyframe_); }
+
+    /** Forget all keyframes, e.g. after the peer restarted */
+    void Reset()
+    {
+        newest_keyframe_ = 0;
+        history_ = {};
+    }
+
+private:
+    /** Keyframes kept, deltas against older ones do not decode */
+    static constexpr size_t kHistorySize = 64;
+
+    struct Keyframe
+    {
+        uint64_t sequence = 0;
+        uint32_t epoch = 0;
+        QuantizedState values = {};
+    };
+
+    Keyframe* Find(uint64_t sequence, uint32_t epoch)
+    {
+        for (auto& slot : history_) {
+            if (slot.sequence == sequence && slot.epoch == epoch && sequence != 0) {
+                return &slot;
+            }
+        }
+        return nullptr;
+    }
+
+    StateQuantizer quantizer_;
+    QuantizedState values_ = {};
+    uint64_t newest_keyframe_ = 0;
+    EpochTracker<uint32_t> epochs_;
+    std::array<Keyframe, kHistorySize> history_ = {};
+    size_t history_next_ = 0;
+};
+
+/**
+ * @struct CompressionStats
+ * @brief Traffic of a CompressedTransport so far.
+ */
+struct CompressionStats
+{
+    /** State packets sent and their size before and after compression [bytes] */
+    uint64_t sent_count = 0;
+    uint64_t raw_bytes = 0;
+    uint64_t compressed_bytes = 0;
+
+    /** State packets sent as keyframes */
+    uint64_t keyframe_count = 0;
+
+    /** Compressed packets received and decoded */
+    uint64_t decoded_count = 0;
+
+    /** Compressed packets dropped for being malformed */
+    uint64_t malformed_count = 0;
+
+    /** Delta packets dropped because their keyframe never arrived or was too old */
+    uint64_t missing_base_count = 0;
+};
+
+/**
+ * @class CompressedTransport
+ * @brief Wraps a transport and compresses the state packets sent through it for bandwidth-limited
+ * WAN links, e.g. cellular or satellite uplinks. Both ends must be wrapped with the same
+ * parameters: each end decodes what the other sends, and acknowledges received keyframes in the
+ * packets it sends back, so that the peer delta-codes against a keyframe known to have arrived.
+ * Lost packets cost nothing beyond themselves; a lost keyframe only delays the switch to the next
+ * one. The node above sees full state packets with values rounded to the configured resolutions.
+ * Messages other than state packets pass through unchanged.
+ */
+class CompressedTransport : public Transport
+{
+public:
+    /**
+     * @param[in] transport Wrapped transport, must outlive this one.
+     * @param[in] params Resolutions and keyframe interval, must match the peer's.
+     * @throw std::invalid_argument if a resolution is not positive.
+     */
+    explicit CompressedTransport(Transport& transport, const CompressionParams& params = {})
+    : transport_(transport)
+    , encoder_(params)
+    , decoder_(params)
+    {
+    }
+
+    bool Send(const void* data, size_t size) override
+    {
+        if (size != sizeof(StatePacket)) {
+            return transport_.Send(data, size);
+        }
+        std::memcpy(&tx_packet_, data, size);
+        if (!IsValidPacket(tx_packet_, size)) {
+            return transport_.Send(data, size);
+        }
+        const size_t compressed_size
+            = encoder_.Encode(tx_packet_, decoder_.ack(), tx_buffer_.data());
+        ++stats_.sent_count;
+        stats_.raw_bytes += size;
+        stats_.compressed_bytes += compressed_size;
+        stats_.keyframe_count += encoder_.keyframe();
+        return transport_.Send(tx_buffer_.data(), compressed_size);
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        // Undecodable packets are dropped, the loop ends once the wrapped transport is drained
+        size_t size;
+        while ((size = transport_.Receive(rx_buffer_.data(), rx_buffer_.size())) > 0) {
+            uint32_t magic = 0;
+            if (size >= sizeof(magic)) {
+                std::memcpy(&magic, rx_buffer_.data(), sizeof(magic));
+            }
+            if (magic != kCompressedPacketMagic) {
+                if (size > capacity) {
+                    continue;
+                }
+                std::memcpy(buffer, rx_buffer_.data(), size);
+                return size;
+            }
+            const auto result = decoder_.Decode(rx_buffer_.data(), size, rx_header_, rx_packet_);
+            if (result == StateDecoder::Result::kMalformed) {
+                ++stats_.malformed_count;
+                continue;
+            }
+            encoder_.Acknowledge(rx_header_.ack);
+            if (result == StateDecoder::Result::kMissingBase) {
+                ++stats_.missing_base_count;
+                continue;
+            }
+            ++stats_.decoded_count;
+            if (capacity < sizeof(rx_packet_)) {
+                continue;
+            }
+            std::memcpy(buffer, &rx_packet_, sizeof(rx_packet_));
+            return sizeof(rx_packet_);
+        }
+        return 0;
+    }
+
+    /** Traffic so far */
+    const CompressionStats& stats() const { return stats_; }
+
+private:
+    Transport& transport_;
+    StateEncoder encoder_;
+    StateDecoder decoder_;
+    CompressionStats stats_;
+    StatePacket tx_packet_;
+    StatePacket rx_packet_;
+    CompressedPacketHeader rx_header_;
+    std::array<uint8_t, kMaxCompressedSize> tx_buffer_ = {};
+    std::array<uint8_t, kMaxMessageSize> rx_buffer_ = {};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
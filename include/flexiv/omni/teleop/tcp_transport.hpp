@@ -0,0 +1,221 @@
+/**
+ * @file tcp_transport.hpp
+ * @brief Transport over a TCP connection with length-prefixed framing.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "transport.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @class TcpTransport
+ * @brief Reliable, ordered transport. Each message is framed with a 4-byte length prefix. Sends
+ * block until the kernel accepts the whole frame, receives never block. Nagle's algorithm is
+ * disabled so small messages leave immediately.
+ */
+class TcpTransport : public Transport
+{
+public:
+    /**
+     * @brief [Blocking] Listen on a port and wait for one peer to connect.
+     * @param[in] port Local TCP port to listen on.
+     * @return Transport connected to the peer.
+     * @throw std::runtime_error if the socket cannot be set up.
+     */
+    static std::unique_ptr<TcpTransport> Listen(uint16_t port)
+    {
+        const int listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd < 0) {
+            ThrowSystemError("Failed to create socket");
+        }
+        const int enable = 1;
+        ::setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+            || ::listen(listen_fd, 1) < 0) {
+            ::close(listen_fd);
+            ThrowSystemError("Failed to listen on port " + std::to_string(port));
+        }
+        const int fd = ::accept(listen_fd, nullptr, nullptr);
+        ::close(listen_fd);
+        if (fd < 0) {
+            ThrowSystemError("Failed to accept connection");
+        }
+        return std::unique_ptr<TcpTransport>(new TcpTransport(fd));
+    }
+
+    /**
+     * @brief [Blocking] Connect to a listening peer, retrying until it is reachable.
+     * @param[in] address IPv4 address of the peer.
+     * @param[in] port TCP port of the peer.
+     * @param[in] timeout How long to keep retrying.
+     * @return Transport connected to the peer.
+     * @throw std::invalid_argument if the address is malformed.
+     * @throw std::runtime_error if the peer cannot be reached before timeout.
+     */
+    static std::unique_ptr<TcpTransport> Connect(const std::string& address, uint16_t port,
+        std::chrono::milliseconds timeout = std::chrono::seconds(5))
+    {
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (::inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+            throw std::invalid_argument(
+                "[flexiv::omni::teleop::TcpTransport] Invalid IPv4 address: " + address);
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (true) {
+            const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            if (fd < 0) {
+                ThrowSystemError("Failed to create socket");
+            }
+            if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+                return std::unique_ptr<TcpTransport>(new TcpTransport(fd));
+            }
+            ::close(fd);
+            if (std::chrono::steady_clock::now() > deadline) {
+                ThrowSystemError("Failed to connect to " + address + ":" + std::to_string(port));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    ~TcpTransport() override { ::close(fd_); }
+
+    TcpTransport(const TcpTransport&) = delete;
+    TcpTransport& operator=(const TcpTransport&) = delete;
+
+    bool Send(const void* data, size_t size) override
+    {
+        if (!connected_ || size > kMaxMessageSize) {
+            return false;
+        }
+        const uint32_t length = htonl(static_cast<uint32_t>(size));
+        std::memcpy(tx_buffer_.data(), &length, kHeaderSize);
+        std::memcpy(tx_buffer_.data() + kHeaderSize, data, size);
+
+        // A partially written frame would corrupt the stream, so write it out completely
+        size_t sent = 0;
+        const size_t frame_size = kHeaderSize + size;
+        while (sent < frame_size) {
+            const ssize_t ret
+                = ::send(fd_, tx_buffer_.data() + sent, frame_size - sent, MSG_NOSIGNAL);
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                connected_ = false;
+                return false;
+            }
+            sent += static_cast<size_t>(ret);
+        }
+        return true;
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        if (!connected_) {
+            return 0;
+        }
+        if (!HasCompleteFrame()) {
+            const ssize_t ret = ::recv(fd_, rx_buffer_.data() + rx_size_,
+                rx_buffer_.size() - rx_size_, MSG_DONTWAIT);
+            if (ret == 0
+                || (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                connected_ = false;
+                return 0;
+            }
+            if (ret > 0) {
+                rx_size_ += static_cast<size_t>(ret);
+            }
+            if (!HasCompleteFrame()) {
+                return 0;
+            }
+        }
+
+        const size_t size = FrameLength();
+        const size_t frame_size = kHeaderSize + size;
+        const bool fits = size <= capacity;
+        if (fits) {
+            std::memcpy(buffer, rx_buffer_.data() + kHeaderSize, size);
+        }
+        std::memmove(rx_buffer_.data(), rx_buffer_.data() + frame_size, rx_size_ - frame_size);
+        rx_size_ -= frame_size;
+        return fits ? size : 0;
+    }
+
+    /** Whether the connection is still up */
+    bool connected() const { return connected_; }
+
+private:
+    static constexpr size_t kHeaderSize = sizeof(uint32_t);
+
+    explicit TcpTransport(int fd)
+    : fd_(fd)
+    {
+        const int enable = 1;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    }
+
+    size_t FrameLength() const
+    {
+        uint32_t length;
+        std::memcpy(&length, rx_buffer_.data(), kHeaderSize);
+        return ntohl(length);
+    }
+
+    bool HasCompleteFrame()
+    {
+        if (rx_size_ < kHeaderSize) {
+            return false;
+        }
+        if (FrameLength() > kMaxMessageSize) {
+            // Corrupted stream, there is no way to resynchronize
+            connected_ = false;
+            return false;
+        }
+        return rx_size_ >= kHeaderSize + FrameLength();
+    }
+
+    [[noreturn]] static void ThrowSystemError(const std::string& what)
+    {
+        throw std::runtime_error(
+            "[flexiv::omni::teleop::TcpTransport] " + what + ": " + std::strerror(errno));
+    }
+
+    int fd_ = -1;
+    bool connected_ = true;
+    std::array<uint8_t, kHeaderSize + kMaxMessageSize> tx_buffer_ = {};
+    std::array<uint8_t, 16 * (kHeaderSize + kMaxMessageSize)> rx_buffer_ = {};
+    size_t rx_size_ = 0;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,48 @@
+/**
+ * @file transport.hpp
+ * @brief Abstract message transport between leader and follower.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/** Maximum size of one transport message [bytes], small enough to fit one Ethernet frame */
+constexpr size_t kMaxMessageSize = 1400;
+
+/**
+ * @class Transport
+ * @brief Message-oriented, bidirectional link to the peer node. Implementations preserve message
+ * boundaries: one Send() on one side is delivered as one Receive() on the other, or not at all.
+ * Both methods are called from the real-time control thread and must not block indefinitely.
+ */
+class Transport
+{
+public:
+    virtual ~Transport() = default;
+
+    /**
+     * @brief Send one message to the peer.
+     * @param[in] data Pointer to message bytes.
+     * @param[in] size Number of bytes to send.
+     * @return True if the message was handed to the network, false if it was dropped.
+     */
+    virtual bool Send(const void* data, size_t size) = 0;
+
+    /**
+     * @brief Receive one message from the peer without waiting.
+     * @param[out] buffer Destination buffer.
+     * @param[in] capacity Size of the destination buffer.
+     * @return Size of the received message, or 0 if no message is available.
+     */
+    virtual size_t Receive(void* buffer, size_t capacity) = 0;
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
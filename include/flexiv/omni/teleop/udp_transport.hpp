@@ -0,0 +1,120 @@
+/**
+ * @file udp_transport.hpp
+ * @brief Transport over UDP datagrams, for low-latency teleop on a LAN.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "transport.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * @class UdpTransport
+ * @brief Unreliable, unordered transport: one message per datagram, no retransmission and thus
+ * no head-of-line blocking. A lost packet costs exactly that one sample. Pair it with sequence
+ * numbers on the receiving side (the teleop nodes do this) so that only the newest sample is
+ * acted upon. Neither Send() nor Receive() ever blocks.
+ */
+class UdpTransport : public Transport
+{
+public:
+    /**
+     * @brief Open a socket bound to a local port that exchanges datagrams with one peer.
+     * @param[in] local_port Local UDP port to receive on.
+     * @param[in] remote_address IPv4 address of the peer.
+     * @param[in] remote_port UDP port the peer receives on.
+     * @throw std::invalid_argument if the address is malformed.
+     * @throw std::runtime_error if the socket cannot be set up.
+     */
+    UdpTransport(uint16_t local_port, const std::string& remote_address, uint16_t remote_port)
+    {
+        remote_addr_.sin_family = AF_INET;
+        remote_addr_.sin_port = htons(remote_port);
+        if (::inet_pton(AF_INET, remote_address.c_str(), &remote_addr_.sin_addr) != 1) {
+            throw std::invalid_argument(
+                "[flexiv::omni::teleop::UdpTransport] Invalid IPv4 address: " + remote_address);
+        }
+
+        fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+        if (fd_ < 0) {
+            ThrowSystemError("Failed to create socket");
+        }
+        const int enable = 1;
+        ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+        sockaddr_in local_addr {};
+        local_addr.sin_family = AF_INET;
+        local_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        local_addr.sin_port = htons(local_port);
+        if (::bind(fd_, reinterpret_cast<sockaddr*>(&local_addr), sizeof(local_addr)) < 0) {
+            ::close(fd_);
+            ThrowSystemError("Failed to bind to port " + std::to_string(local_port));
+        }
+    }
+
+    ~UdpTransport() override { ::close(fd_); }
+
+    UdpTransport(const UdpTransport&) = delete;
+    UdpTransport& operator=(const UdpTransport&) = delete;
+
+    bool Send(const void* data, size_t size) override
+    {
+        if (size > kMaxMessageSize) {
+            return false;
+        }
+        // A full socket buffer drops the packet rather than blocking, newer ones will follow
+        const ssize_t ret = ::sendto(fd_, data, size, MSG_DONTWAIT,
+            reinterpret_cast<const sockaddr*>(&remote_addr_), sizeof(remote_addr_));
+        return ret == static_cast<ssize_t>(size);
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        while (true) {
+            const ssize_t ret = ::recv(fd_, buffer, capacity, MSG_DONTWAIT | MSG_TRUNC);
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return 0;
+            }
+            // Datagrams larger than the buffer are truncated, discard them as malformed
+            if (static_cast<size_t>(ret) > capacity) {
+                continue;
+            }
+            return static_cast<size_t>(ret);
+        }
+    }
+
+    /** Underlying socket file descriptor */
+    int fd() const { return fd_; }
+
+private:
+    [[noreturn]] static void ThrowSystemError(const std::string& what)
+    {
+        throw std::runtime_error(
+            "[flexiv::omni::teleop::UdpTransport] " + what + ": " + std::strerror(errno));
+    }
+
+    int fd_ = -1;
+    sockaddr_in remote_addr_ {};
+};
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
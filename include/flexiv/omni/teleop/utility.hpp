@@ -0,0 +1,58 @@
+/**
+ * @file utility.hpp
+ * @brief Helpers shared by teleop programs.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+namespace utility {
+
+/**
+ * @brief Check if any of the specified arguments was passed to the program.
+ * @param[in] argc Argument count passed to main().
+ * @param[in] argv Argument vector passed to main().
+ * @param[in] ref_strings Arguments to look for, e.g. {"-h", "--help"}.
+ * @return True if at least one of them exists.
+ */
+inline bool ProgramArgsExist(int argc, char** argv, const std::vector<std::string>& ref_strings)
+{
+    for (int i = 0; i < argc; i++) {
+        for (const auto& v : ref_strings) {
+            if (v == std::string(argv[i])) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Get the value following an option, e.g. "5" for "--duration 5".
+ * @param[in] argc Argument count passed to main().
+ * @param[in] argv Argument vector passed to main().
+ * @param[in] option Option to look for.
+ * @param[in] default_value Value returned if the option is absent or has no value.
+ * @return Option value.
+ */
+inline std::string ProgramArgValue(
+    int argc, char** argv, const std::string& option, const std::string& default_value = "")
+{
+    for (int i = 0; i < argc - 1; i++) {
+        if (option == std::string(argv[i])) {
+            return argv[i + 1];
+        }
+    }
+    return default_value;
+}
+
+} /* namespace utility */
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
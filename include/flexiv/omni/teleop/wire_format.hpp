@@ -0,0 +1,227 @@
+/**
+ * @file wire_format.hpp
+ * @brief Fixed-layout packets exchanged between leader and follower. Packets are plain structs
+ * that are sent and received directly from pre-allocated memory, there is no serialization step.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include "data.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <type_traits>
+
+namespace flexiv {
+namespace omni {
+namespace teleop {
+
+/**
+ * The wire format is little-endian with IEEE 754 doubles, which is the native representation of
+ * every platform we support. Rather than byte-swapping at runtime, building on anything else is
+ * rejected at compile time.
+ */
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+    "flexiv_omni_teleop wire format requires a little-endian host");
+static_assert(std::numeric_limits<double>::is_iec559 && sizeof(double) == 8,
+    "flexiv_omni_teleop wire format requires IEEE 754 double precision floats");
+
+/** Magic number at the start of every packet, "FOTP" in little-endian byte order */
+constexpr uint32_t kPacketMagic = 0x50544F46;
+
+/** Wire format version, bumped on every layout change */
+constexpr uint16_t kWireVersion = 3;
+
+/** Role of the node that sent a packet */
+enum class MessageType : uint8_t
+{
+    kLeaderState = 1,
+    kFollowerState = 2,
+};
+
+/**
+ * @struct PacketHeader
+ * @brief Common header of all packets. 48 bytes, all fields naturally aligned. The echo fields
+ * give the peer the four timestamps of an NTP-style exchange, see ClockSync.
+ */
+struct PacketHeader
+{
+    /** Always kPacketMagic */
+    uint32_t magic = kPacketMagic;
+
+    /** Always kWireVersion */
+    uint16_t version = kWireVersion;
+
+    /** Role of the sender */
+    MessageType type = MessageType::kLeaderState;
+
+    /** Reserved for future use, must be 0 */
+    uint8_t flags = 0;
+
+    /**
+     * Random number drawn by the sender when it starts, see NewEpoch(). A new epoch tells the
+     * receiver that the sender restarted and its sequence starts over.
+     */
+    uint32_t epoch = 0;
+
+    /** Reserved for future use, must be 0 */
+    uint32_t reserved = 0;
+
+    /** Per-sender packet counter, starts from 1 in every epoch */
+    uint64_t sequence = 0;
+
+    /** Sender's steady clock when the packet was sent [ns] */
+    int64_t send_time_ns = 0;
+
+    /** send_time_ns of the newest packet received from the peer, 0 if none [ns] */
+    int64_t echo_time_ns = 0;
+
+    /** Sender's steady clock when the packet of echo_time_ns arrived, 0 if none [ns] */
+    int64_t echo_receive_time_ns = 0;
+};
+
+/**
+ * @struct StatePacket
+ * @brief State of one arm sent to the peer every cycle. The leader's packet drives the follower,
+ * the follower's packet carries force feedback back to the leader. 320 bytes.
+ */
+struct StatePacket
+{
+    PacketHeader header;
+
+    /** Joint positions [rad] */
+    JointArray q = {};
+
+    /** Joint velocities [rad/s] */
+    JointArray dq = {};
+
+    /** External joint torques [Nm] */
+    JointArray tau_ext = {};
+
+    /** TCP pose [m][] */
+    PoseArray tcp_pose = {};
+
+    /** External wrench on TCP in world frame [N][Nm] */
+    CartArray ext_wrench = {};
+};
+
+// Pin down the layout so that any change to it is a deliberate, versioned one
+static_assert(std::is_trivially_copyable<PacketHeader>::value
+                  && std::is_standard_layout<PacketHeader>::value,
+    "PacketHeader must be a POD type");
+static_assert(sizeof(PacketHeader) == 48, "PacketHeader layout changed, bump kWireVersion");
+static_assert(offsetof(PacketHeader, magic) == 0 && offsetof(PacketHeader, version) == 4
+                  && offsetof(PacketHeader, type) == 6 && offsetof(PacketHeader, flags) == 7
+                  && offsetof(PacketHeader, epoch) == 8 && offsetof(PacketHeader, reserved) == 12
+                  && offsetof(PacketHeader, sequence) == 16
+                  && offsetof(PacketHeader, send_time_ns) == 24
+                  && offsetof(PacketHeader, echo_time_ns) == 32
+                  && offsetof(PacketHeader, echo_receive_time_ns) == 40,
+    "PacketHeader layout changed, bump kWireVersion");
+
+static_assert(std::is_trivially_copyable<StatePacket>::value
+                  && std::is_standard_layout<StatePacket>::value,
+    "StatePacket must be a POD type");
+static_assert(sizeof(JointArray) == kJointDoF * sizeof(double)
+                  && sizeof(PoseArray) == kPoseSize * sizeof(double)
+                  && sizeof(CartArray) == kCartDoF * sizeof(double),
+    "std::array must not add padding");
+static_assert(sizeof(StatePacket) == 320, "StatePacket layout changed, bump kWireVersion");
+static_assert(offsetof(StatePacket, q) == 48 && offsetof(StatePacket, dq) == 104
+                  && offsetof(StatePacket, tau_ext) == 160 && offsetof(StatePacket, tcp_pose) == 216
+                  && offsetof(StatePacket, ext_wrench) == 272,
+    "StatePacket layout changed, bump kWireVersion");
+
+/**
+ * @brief Draw the epoch of a sender that starts, see PacketHeader::epoch. Not real-time safe,
+ * call once at construction.
+ * @return Random number, never 0.
+ */
+inline uint32_t NewEpoch()
+{
+    std::random_device device;
+    uint32_t epoch = 0;
+    while (epoch == 0) {
+        epoch = device();
+    }
+    return epoch;
+}
+
+/**
+ * @brief [Real-time] Copy the states of an arm into the payload of a packet.
+ * @param[in] states Arm states.
+ * @param[out] packet Packet to fill, header is left untouched.
+ */
+inline void WriteStates(const RobotStates& states, StatePacket& packet)
+{
+    packet.q = states.q;
+    packet.dq = states.dq;
+    packet.tau_ext = states.tau_ext;
+    packet.tcp_pose = states.tcp_pose;
+    packet.ext_wrench = states.ext_wrench_in_world;
+}
+
+/**
+ * @brief [Real-time] Blend the payloads of two packets, e.g. to reconstruct the sender's states
+ * between two received ones. Joint states, torques, TCP position and wrench are linearly
+ * interpolated, the TCP orientation is normalized-lerped along the shorter arc.
+ * @param[in] a Packet at ratio 0.
+ * @param[in] b Packet at ratio 1, its header is copied to the output.
+ * @param[in] ratio Blend ratio [0-1].
+ * @param[out] out Blended packet.
+ */
+inline void InterpolatePackets(
+    const StatePacket& a, const StatePacket& b, double ratio, StatePacket& out)
+{
+    out.header = b.header;
+    auto lerp = [ratio](const auto& x, const auto& y, auto& z) {
+        for (size_t i = 0; i < z.size(); ++i) {
+            z[i] = x[i] + ratio * (y[i] - x[i]);
+        }
+    };
+    lerp(a.q, b.q, out.q);
+    lerp(a.dq, b.dq, out.dq);
+    lerp(a.tau_ext, b.tau_ext, out.tau_ext);
+    lerp(a.ext_wrench, b.ext_wrench, out.ext_wrench);
+
+    // Position is linear, orientation is nlerp along the shorter arc
+    const double sign = (a.tcp_pose[3] * b.tcp_pose[3] + a.tcp_pose[4] * b.tcp_pose[4]
+                            + a.tcp_pose[5] * b.tcp_pose[5] + a.tcp_pose[6] * b.tcp_pose[6])
+                                < 0.0
+                            ? -1.0
+                            : 1.0;
+    double norm = 0.0;
+    for (size_t i = 0; i < kPoseSize; ++i) {
+        const double target = i < 3 ? b.tcp_pose[i] : sign * b.tcp_pose[i];
+        out.tcp_pose[i] = a.tcp_pose[i] + ratio * (target - a.tcp_pose[i]);
+        if (i >= 3) {
+            norm += out.tcp_pose[i] * out.tcp_pose[i];
+        }
+    }
+    norm = std::sqrt(norm);
+    if (norm > 0.0) {
+        for (size_t i = 3; i < kPoseSize; ++i) {
+            out.tcp_pose[i] /= norm;
+        }
+    }
+}
+
+/**
+ * @brief [Real-time] Check that a received buffer holds a packet this build understands.
+ * @param[in] packet Received packet.
+ * @param[in] size Number of bytes received.
+ * @return True if size, magic and version all match.
+ */
+inline bool IsValidPacket(const StatePacket& packet, size_t size)
+{
+    return size == sizeof(StatePacket) && packet.header.magic == kPacketMagic
+           && packet.header.version == kWireVersion;
+}
+
+} /* namespace teleop */
+} /* namespace omni */
+} /* namespace flexiv */
@@ -0,0 +1,87 @@
+/**
+ * @file batch_kinematics_test.cpp
+ * @brief Compares BatchKinematics against the scalar Kinematics reference on random joint
+ * configurations, with both the portable kernel and, where this CPU has it, the AVX2 kernel.
+ * Fails unless every pose and Jacobian entry matches to within 1e-12.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/batch_kinematics.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+
+using namespace flexiv::omni;
+
+namespace {
+/** Largest difference to the scalar reference accepted */
+constexpr double kTolerance = 1e-12;
+
+/** Number of configurations per batch */
+constexpr size_t kBatchSize = 64;
+
+/**
+ * @brief Run one kernel over a batch and return its largest difference to the reference.
+ * @param[in] allow_simd Whether the AVX2 kernel may be used.
+ * @param[in] range Joint positions are drawn from [-range, range] [rad].
+ */
+double MaxError(bool allow_simd, double range)
+{
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> dist(-range, range);
+    auto q = std::make_unique<teleop::JointBatch<kBatchSize>>();
+    for (size_t k = 0; k < kBatchSize; ++k) {
+        teleop::JointArray config;
+        for (auto& v : config) {
+            v = dist(rng);
+        }
+        q->Set(k, config);
+    }
+
+    const teleop::BatchKinematics batch_kinematics(teleop::DhParams::Rizon4(), allow_simd);
+    auto poses = std::make_unique<teleop::PoseBatch<kBatchSize>>();
+    auto fk_poses = std::make_unique<teleop::PoseBatch<kBatchSize>>();
+    auto jacobians = std::make_unique<teleop::JacobianBatch<kBatchSize>>();
+    batch_kinematics.Compute(*q, *poses, *jacobians);
+    batch_kinematics.ForwardKinematics(*q, *fk_poses);
+
+    const teleop::Kinematics kinematics;
+    double max_error = 0.0;
+    for (size_t k = 0; k < kBatchSize; ++k) {
+        Eigen::Isometry3d pose;
+        teleop::Jacobian jacobian;
+        kinematics.Compute(q->Get(k), pose, jacobian);
+        max_error = std::max({max_error,
+            (pose.matrix() - poses->Get(k).matrix()).cwiseAbs().maxCoeff(),
+            (pose.matrix() - fk_poses->Get(k).matrix()).cwiseAbs().maxCoeff(),
+            (jacobian - jacobians->Get(k)).cwiseAbs().maxCoeff()});
+    }
+    std::cout << (allow_simd ? "SIMD" : "portable") << " kernel, SIMD width "
+              << batch_kinematics.simd_width() << ", joints within +-" << range
+              << " rad: max error " << max_error << std::endl;
+    return max_error;
+}
+}
+
+int main()
+{
+    std::cout << "CPU " << (teleop::HasAvx2() ? "has" : "lacks") << " AVX2 and FMA" << std::endl;
+    test::Check(teleop::BatchKinematics(teleop::DhParams::Rizon4(), false).simd_width() == 1,
+        "the portable kernel can be forced");
+    test::Check(teleop::BatchKinematics().simd_width() == (teleop::HasAvx2() ? 4 : 1),
+        "the AVX2 kernel is used exactly where the CPU has it");
+
+    for (bool allow_simd : {false, true}) {
+        for (double range : {2.0, 50.0}) {
+            test::Check(MaxError(allow_simd, range) <= kTolerance,
+                std::string(allow_simd ? "SIMD" : "portable") + " kernel matches the reference "
+                    + "for joints within +-" + std::to_string(range) + " rad");
+        }
+    }
+    return test::Finish("batch_kinematics_test");
+}
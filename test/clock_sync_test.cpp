@@ -0,0 +1,81 @@
+/**
+ * @file clock_sync_test.cpp
+ * @brief Runs ClockSync against a peer clock a day ahead of the local one and drifting at 50 ppm,
+ * over a symmetric link of 1 ms each way. Fails unless the one-way delay read through
+ * PeerToLocal() is 1 ms, and converting a time to the other timebase and back returns it, both
+ * right after the exchanges and while extrapolating a minute later.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/clock.hpp>
+#include <flexiv/omni/teleop/clock_sync.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+using namespace flexiv::omni;
+
+namespace {
+/** Peer clock minus local clock at the start [ns] */
+constexpr int64_t kOffsetNs = 86400LL * 1000000000;
+
+/** Rate at which the peer clock runs faster [ppm] */
+constexpr double kDriftPpm = 50.0;
+
+/** Network delay each way [ns] */
+constexpr int64_t kDelayNs = 1000000;
+
+/** Largest error of a converted time [ns] */
+constexpr int64_t kToleranceNs = 10000;
+
+/** Check the conversions at the current time of both clocks */
+void CheckConversions(const teleop::ClockSync& sync, teleop::ManualClock& local,
+    const teleop::SkewedClock& peer, const std::string& when)
+{
+    // A packet the peer sends now arrives one delay later
+    const int64_t send_time_ns = peer.NowNs();
+    local.Advance(kDelayNs);
+    const int64_t one_way_ns = local.NowNs() - sync.PeerToLocal(send_time_ns);
+    test::Check(std::llabs(one_way_ns - kDelayNs) < kToleranceNs,
+        "the one-way delay is read correctly " + when + ", got " + std::to_string(one_way_ns)
+            + " ns");
+
+    const int64_t local_ns = local.NowNs();
+    const int64_t peer_ns = peer.NowNs();
+    test::Check(std::llabs(sync.LocalToPeer(local_ns) - peer_ns) < kToleranceNs
+                    && std::llabs(sync.PeerToLocal(peer_ns) - local_ns) < kToleranceNs,
+        "both conversions match the clocks " + when);
+    test::Check(std::llabs(sync.PeerToLocal(sync.LocalToPeer(local_ns)) - local_ns) < kToleranceNs
+                    && std::llabs(sync.LocalToPeer(sync.PeerToLocal(peer_ns)) - peer_ns)
+                           < kToleranceNs,
+        "both conversions round-trip " + when);
+}
+}
+
+int main()
+{
+    teleop::ManualClock local(1000000000);
+    const teleop::SkewedClock peer(local, kOffsetNs, kDriftPpm);
+    teleop::ClockSync sync;
+
+    // Exchanges back to back for 40 s, the peer echoing at once
+    for (int i = 0; i < 20000; ++i) {
+        const int64_t t1 = local.NowNs();
+        local.Advance(kDelayNs);
+        const int64_t t2 = peer.NowNs();
+        local.Advance(kDelayNs);
+        sync.AddExchange(t1, t2, t2, local.NowNs());
+    }
+    const auto estimate = sync.estimate();
+    test::Check(estimate.valid && std::abs(estimate.drift_ppm - kDriftPpm) < 1.0,
+        "the drift is estimated, got " + std::to_string(estimate.drift_ppm) + " ppm");
+
+    CheckConversions(sync, local, peer, "after the exchanges");
+    local.Advance(60LL * 1000000000);
+    CheckConversions(sync, local, peer, "a minute later");
+
+    return test::Finish("clock_sync_test");
+}
@@ -0,0 +1,253 @@
+/**
+ * @file encryption_test.cpp
+ * @brief Checks each cipher against its published test vectors: RFC 8439 section 2.8.2 for
+ * ChaCha20-Poly1305, test case 16 of the GCM specification for AES-256-GCM where this CPU has
+ * AES-NI, and section 2.2.1 of the XChaCha20 draft for the HChaCha20 subkey derivation. Then runs
+ * EncryptedTransport across two restarts of the sender under the same key. Fails unless the
+ * restarted sender's datagrams differ from the first one's, the receiver takes them once their
+ * salt is confirmed, late or replayed datagrams of either are dropped, and replaying everything
+ * the first sender sent never costs a datagram of the third.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/encryption.hpp>
+#include <flexiv/omni/teleop/wire_format.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+
+std::vector<uint8_t> FromHex(const std::string& hex)
+{
+    std::vector<uint8_t> bytes;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        bytes.push_back(static_cast<uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    }
+    return bytes;
+}
+
+teleop::AeadKey ToKey(const std::vector<uint8_t>& bytes)
+{
+    teleop::AeadKey key;
+    std::memcpy(key.data(), bytes.data(), key.size());
+    return key;
+}
+
+/** Known-answer test of one cipher: seal, compare, open, then open a tampered copy */
+void CheckTestVector(teleop::AeadCipher cipher)
+{
+    std::vector<uint8_t> key, nonce, aad, plaintext, ciphertext, tag;
+    std::string name;
+    if (cipher == teleop::AeadCipher::kChaCha20Poly1305) {
+        name = "ChaCha20-Poly1305";
+        key = FromHex("808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f");
+        nonce = FromHex("070000004041424344454647");
+        aad = FromHex("50515253c0c1c2c3c4c5c6c7");
+        const std::string text = "Ladies and Gentlemen of the class of '99: If I could offer you "
+                                 "only one tip for the future, sunscreen would be it.";
+        plaintext.assign(text.begin(), text.end());
+        ciphertext = FromHex(
+            "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d63dbea45e8ca967128"
+            "2fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b3692ddbd7f2d778b8c9803aee328091b58fab"
+            "324e4fad675945585808b4831d7bc3ff4def08e4b7a9de576d26586cec64b6116");
+        tag = FromHex("1ae10b594f09e26a7e902ecbd0600691");
+    } else {
+        name = "AES-256-GCM";
+        key = FromHex("feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308");
+        nonce = FromHex("cafebabefacedbaddecaf888");
+        aad = FromHex("feedfacedeadbeeffeedfacedeadbeefabaddad2");
+        plaintext = FromHex(
+            "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532"
+            "fcf0e2449a6b525b16aedf5aa0de657ba637b39");
+        ciphertext = FromHex(
+            "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da"
+            "7b08b1056828838c5f61e6393ba7a0abcc9f662");
+        tag = FromHex("76fc6ece0f4e1768cddf8853bb2d551b");
+    }
+    // Rekeying must land on the same state as constructing with the key
+    teleop::Aead aead(cipher, teleop::GenerateAeadKey());
+    aead.Rekey(ToKey(key));
+
+    std::vector<uint8_t> data = plaintext;
+    uint8_t computed[teleop::kAeadTagSize];
+    aead.Seal(nonce.data(), aad.data(), aad.size(), data.data(), data.size(), computed);
+    test::Check(data == ciphertext && std::memcmp(computed, tag.data(), teleop::kAeadTagSize) == 0,
+        name + " reproduces its test vector");
+    test::Check(
+        aead.Open(nonce.data(), aad.data(), aad.size(), data.data(), data.size(), computed)
+            && data == plaintext,
+        name + " opens its test vector");
+    aead.Seal(nonce.data(), aad.data(), aad.size(), data.data(), data.size(), computed);
+    data[0] ^= 1;
+    test::Check(
+        !aead.Open(nonce.data(), aad.data(), aad.size(), data.data(), data.size(), computed),
+        name + " rejects a tampered ciphertext");
+}
+
+/** Transport queueing every datagram sent, so that they can be delivered, dropped or replayed */
+class QueueTransport : public teleop::Transport
+{
+public:
+    bool Send(const void* data, size_t size) override
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        sent.emplace_back(bytes, bytes + size);
+        return true;
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        while (!inbox.empty()) {
+            const std::vector<uint8_t> datagram = inbox.front();
+            inbox.pop_front();
+            if (datagram.size() <= capacity) {
+                std::memcpy(buffer, datagram.data(), datagram.size());
+                return datagram.size();
+            }
+        }
+        return 0;
+    }
+
+    /** Datagrams sent, oldest first */
+    std::vector<std::vector<uint8_t>> sent;
+
+    /** Datagrams to receive, oldest first */
+    std::deque<std::vector<uint8_t>> inbox;
+};
+
+/** Whether a follower receives exactly the state packet of a sequence number from a datagram */
+bool Delivers(teleop::EncryptedTransport& follower, QueueTransport& wire,
+    const std::vector<uint8_t>& datagram, uint64_t sequence)
+{
+    wire.inbox.push_back(datagram);
+    teleop::StatePacket packet;
+    return follower.Receive(&packet, sizeof(packet)) == sizeof(packet)
+           && packet.header.sequence == sequence;
+}
+
+/** A leader restarting under the same key, e.g. one configured once for good */
+void CheckRestart(teleop::AeadCipher cipher)
+{
+    teleop::EncryptionParams params;
+    params.key = teleop::GenerateAeadKey();
+    params.cipher = cipher;
+    QueueTransport leader_wire, restarted_wire, follower_wire;
+    teleop::EncryptedTransport leader(leader_wire, params);
+    teleop::EncryptedTransport restarted(restarted_wire, params);
+    params.role = teleop::EncryptionRole::kFollower;
+    teleop::EncryptedTransport follower(follower_wire, params);
+
+    teleop::StatePacket packet;
+    for (uint64_t s = 1; s <= 50; ++s) {
+        packet.header.sequence = s;
+        leader.Send(&packet, sizeof(packet));
+        restarted.Send(&packet, sizeof(packet));
+    }
+    const auto& before = leader_wire.sent;
+    const auto& after = restarted_wire.sent;
+    const size_t header_size = sizeof(teleop::EncryptedPacketHeader);
+    test::Check(!std::equal(before[0].begin() + header_size, before[0].end(),
+                    after[0].begin() + header_size),
+        "a restarted sender's first datagram differs from the first sender's");
+
+    bool all_delivered = true;
+    for (uint64_t s = 1; s <= 40; ++s) {
+        all_delivered &= Delivers(follower, follower_wire, before[s - 1], s);
+    }
+    test::Check(all_delivered, "datagrams of the first sender are delivered");
+    test::Check(!Delivers(follower, follower_wire, before[39], 40)
+                    && follower.stats().replay_count == 1,
+        "a replayed datagram is dropped");
+
+    // The restarted sender's datagrams take over once its salt is confirmed
+    const uint64_t confirm = teleop::EpochTracker<uint64_t>::kConfirmCount;
+    bool held_back = true;
+    for (uint64_t s = 1; s < confirm; ++s) {
+        held_back &= !Delivers(follower, follower_wire, after[s - 1], s);
+    }
+    test::Check(held_back && follower.stats().unconfirmed_count == confirm - 1
+                    && follower.stats().peer_restart_count == 0,
+        "datagrams under a new salt are held back until it is confirmed");
+    test::Check(Delivers(follower, follower_wire, after[confirm - 1], confirm)
+                    && follower.stats().peer_restart_count == 1,
+        "once its salt is confirmed, the restarted sender's datagrams are delivered");
+    test::Check(!Delivers(follower, follower_wire, before[44], 45)
+                    && follower.stats().replay_count == 2
+                    && follower.stats().peer_restart_count == 1,
+        "a late datagram from before the restart is dropped and does not restart again");
+    test::Check(Delivers(follower, follower_wire, after[confirm], confirm + 1)
+                    && !Delivers(follower, follower_wire, after[confirm], confirm + 1),
+        "the restarted sender's datagrams are delivered once");
+
+    auto forged = after[confirm + 1];
+    forged[offsetof(teleop::EncryptedPacketHeader, salt)] ^= 1;
+    test::Check(!Delivers(follower, follower_wire, forged, confirm + 2)
+                    && follower.stats().auth_failure_count == 1
+                    && follower.stats().peer_restart_count == 1,
+        "a datagram with a forged salt fails authentication and does not restart the peer");
+    test::Check(Delivers(follower, follower_wire, after[confirm + 1], confirm + 2),
+        "datagrams of the restarted sender keep being delivered after a forged one");
+
+    // A second restart, then an attacker replays everything the first sender sent
+    params.role = teleop::EncryptionRole::kLeader;
+    QueueTransport third_wire;
+    teleop::EncryptedTransport third(third_wire, params);
+    for (uint64_t s = 1; s <= 200; ++s) {
+        packet.header.sequence = s;
+        third.Send(&packet, sizeof(packet));
+    }
+    const auto& live = third_wire.sent;
+    for (uint64_t s = 1; s <= confirm; ++s) {
+        Delivers(follower, follower_wire, live[s - 1], s);
+    }
+    test::Check(follower.stats().peer_restart_count == 2, "the second restart is detected");
+    size_t replayed = 0;
+    for (const auto& datagram : before) {
+        follower_wire.inbox.push_back(datagram);
+        replayed += follower.Receive(&packet, sizeof(packet)) > 0;
+    }
+    test::Check(replayed == 0, "no replayed datagram of the first sender is delivered");
+    size_t delivered = 0;
+    for (uint64_t s = confirm + 1; s <= 200; ++s) {
+        follower_wire.inbox.push_back(before[s % before.size()]);
+        follower_wire.inbox.push_back(after[s % after.size()]);
+        delivered += Delivers(follower, follower_wire, live[s - 1], s);
+    }
+    test::Check(delivered == 200 - confirm && follower.stats().peer_restart_count == 2,
+        "replayed datagrams of earlier senders never lock out the live one");
+}
+
+}
+
+int main()
+{
+    // HChaCha20 test vector of draft-irtf-cfrg-xchacha-03, section 2.2.1
+    const auto subkey = teleop::detail::ChaCha20Poly1305::HChaCha20(
+        ToKey(FromHex("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f")),
+        FromHex("000000090000004a0000000031415927").data());
+    test::Check(subkey
+                    == ToKey(FromHex("82413b4227b27bfed30e42508a877d73a0f9e4d58a74a853c12ec41326d3"
+                                     "ecdc")),
+        "HChaCha20 reproduces its test vector");
+
+    for (const auto cipher :
+        {teleop::AeadCipher::kChaCha20Poly1305, teleop::AeadCipher::kAes256Gcm}) {
+        if (cipher == teleop::AeadCipher::kAes256Gcm && !teleop::HasAesNi()) {
+            std::cout << "AES-NI is not available on this CPU, AES-256-GCM is not checked"
+                      << std::endl;
+            continue;
+        }
+        CheckTestVector(cipher);
+        CheckRestart(cipher);
+    }
+    return test::Finish("encryption_test");
+}
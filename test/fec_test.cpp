@@ -0,0 +1,173 @@
+/**
+ * @file fec_test.cpp
+ * @brief Streams messages of varying length through FecEncoder and FecDecoder for every group
+ * layout, dropping as many packets of each group as it has parity packets, data or parity alike.
+ * Then restarts the sender, whose group counter starts over, while late packets from before the
+ * restart keep arriving. Fails unless every lost message is recovered byte for byte and exactly
+ * once, both before and right after the restart.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/fec.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+
+using Datagram = std::vector<uint8_t>;
+
+/** Message number of a run, its length varying so that lengths must be recovered too */
+Datagram MakeMessage(uint32_t run, uint32_t number)
+{
+    Datagram message(10 + number % 50);
+    for (size_t i = 0; i < message.size(); ++i) {
+        message[i] = static_cast<uint8_t>(run * 97 + number * 31 + i);
+    }
+    return message;
+}
+
+/** Datagrams of one group, data packets first, for messages first to first + group_size - 1 */
+std::vector<Datagram> EncodeGroup(teleop::FecEncoder& encoder, uint32_t run, uint32_t first)
+{
+    std::vector<Datagram> datagrams;
+    Datagram buffer(teleop::kMaxMessageSize);
+    for (uint32_t n = first; n < first + encoder.params().group_size; ++n) {
+        const Datagram message = MakeMessage(run, n);
+        const size_t size = encoder.EncodeData(message.data(), message.size(), buffer.data());
+        datagrams.emplace_back(buffer.begin(), buffer.begin() + size);
+    }
+    for (unsigned row = 0; row < encoder.parity_ready(); ++row) {
+        const size_t size = encoder.EncodeParity(row, buffer.data());
+        datagrams.emplace_back(buffer.begin(), buffer.begin() + size);
+    }
+    return datagrams;
+}
+
+/** Decode a datagram, adding the message it carries and those it recovered to received */
+void Deliver(teleop::FecDecoder& decoder, const Datagram& datagram, std::vector<Datagram>& received)
+{
+    const uint8_t* data = nullptr;
+    size_t size = decoder.Decode(datagram.data(), datagram.size(), data);
+    if (size > 0) {
+        received.emplace_back(data, data + size);
+    }
+    while ((size = decoder.PopRecovered(data)) > 0) {
+        received.emplace_back(data, data + size);
+    }
+}
+
+/** Number of messages of a run received exactly once, among numbers first to last */
+uint32_t CountReceived(std::vector<Datagram> received, uint32_t run, uint32_t first, uint32_t last)
+{
+    std::sort(received.begin(), received.end());
+    uint32_t count = 0;
+    for (uint32_t n = first; n <= last; ++n) {
+        const auto range = std::equal_range(received.begin(), received.end(), MakeMessage(run, n));
+        count += range.second - range.first == 1;
+    }
+    return count;
+}
+
+}
+
+int main()
+{
+    // Any parity_count packets of a group may be lost, whichever they are
+    std::mt19937 rng(1);
+    for (const unsigned group_size : {1u, 4u, 8u, teleop::kMaxFecGroupSize}) {
+        for (unsigned parity_count = 1; parity_count <= teleop::kMaxFecParityCount;
+             ++parity_count) {
+            teleop::FecParams params;
+            params.group_size = group_size;
+            params.parity_count = parity_count;
+            teleop::FecEncoder encoder(params);
+            teleop::FecDecoder decoder(params);
+            constexpr uint32_t kGroups = 200;
+            std::vector<Datagram> received;
+            uint64_t lost_data = 0;
+            for (uint32_t g = 0; g < kGroups; ++g) {
+                auto datagrams = EncodeGroup(encoder, 0, g * group_size);
+                std::vector<unsigned> order(datagrams.size());
+                for (unsigned i = 0; i < order.size(); ++i) {
+                    order[i] = i;
+                }
+                std::shuffle(order.begin(), order.end(), rng);
+                std::vector<bool> lost(datagrams.size(), false);
+                for (unsigned i = 0; i < parity_count; ++i) {
+                    lost[order[i]] = true;
+                    lost_data += order[i] < group_size;
+                }
+                for (size_t i = 0; i < datagrams.size(); ++i) {
+                    if (!lost[i]) {
+                        Deliver(decoder, datagrams[i], received);
+                    }
+                }
+            }
+            const std::string layout
+                = std::to_string(group_size) + "+" + std::to_string(parity_count);
+            test::Check(received.size() == kGroups * group_size
+                            && CountReceived(received, 0, 0, kGroups * group_size - 1)
+                                   == kGroups * group_size,
+                "every message is received exactly once with layout " + layout);
+            test::Check(decoder.stats().recovered_count == lost_data
+                            && decoder.stats().unrecoverable_count == 0
+                            && decoder.stats().malformed_count == 0,
+                "every lost data packet is recovered with layout " + layout);
+        }
+    }
+
+    // The sender restarts, and late packets from before keep arriving between the new ones
+    {
+        const teleop::FecParams params;
+        constexpr uint32_t kGroups = 1000;
+        teleop::FecDecoder decoder(params);
+        std::vector<Datagram> late;
+        std::vector<Datagram> received;
+        {
+            teleop::FecEncoder encoder(params);
+            for (uint32_t g = 0; g < kGroups; ++g) {
+                auto datagrams = EncodeGroup(encoder, 1, g * params.group_size);
+                for (size_t i = 0; i < datagrams.size(); ++i) {
+                    if (i == g % params.group_size) {
+                        late.push_back(datagrams[i]);
+                    } else {
+                        Deliver(decoder, datagrams[i], received);
+                    }
+                }
+            }
+        }
+        test::Check(decoder.stats().recovered_count == kGroups,
+            "a single loss in every group is recovered before the restart");
+
+        teleop::FecEncoder restarted(params);
+        received.clear();
+        for (uint32_t g = 0; g < kGroups; ++g) {
+            Deliver(decoder, late[g], received);
+            auto datagrams = EncodeGroup(restarted, 2, g * params.group_size);
+            for (size_t i = 0; i < datagrams.size(); ++i) {
+                if (i != g % params.group_size) {
+                    Deliver(decoder, datagrams[i], received);
+                }
+            }
+        }
+        test::Check(decoder.stats().restart_count == 1, "the restart is detected, only once");
+        // The new epoch is confirmed by the packets after the first group's loss, which it
+        // thus cannot recover
+        test::Check(decoder.stats().recovered_count == 2 * kGroups - 1,
+            "a single loss in every group is recovered right after the restart");
+        test::Check(
+            CountReceived(received, 2, 1, kGroups * params.group_size - 1)
+                == kGroups * params.group_size - 1,
+            "every other message of the restarted sender is received exactly once");
+    }
+
+    return test::Finish("fec_test");
+}
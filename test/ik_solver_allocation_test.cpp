@@ -0,0 +1,269 @@
+/**
+ * @file ik_solver_allocation_test.cpp
+ * @brief Tracks a moving Cartesian target with IkSolver once per emulated control cycle, as when
+ * following a non-Flexiv leader, while counting every heap allocation of the process. Fails if
+ * the solver allocates anything in steady state, or if the counting misses a kind of allocation.
+ * Then solves for a far target, and fails unless the iteration bound and, on a clock that moves
+ * on every read, the time bound cut the solve short, and every cut keeps the iterate with the
+ * smallest error so far.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/clock.hpp>
+#include <flexiv/omni/teleop/ik_solver.hpp>
+#include <flexiv/omni/teleop/kinematics.hpp>
+
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace flexiv::omni;
+
+// Heap allocations made while counting is enabled. glibc lets the executable interpose its
+// allocation functions and forward to the real allocator, which catches allocations from Eigen
+// and from every form of operator new alike, since libstdc++ implements them on top of these
+// =================================================================================================
+namespace {
+bool g_count_allocations = false;
+uint64_t g_allocation_count = 0;
+}
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void* __libc_valloc(size_t size);
+void* __libc_pvalloc(size_t size);
+
+void* malloc(size_t size)
+{
+    g_allocation_count += g_count_allocations;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    g_allocation_count += g_count_allocations;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    g_allocation_count += g_count_allocations;
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    g_allocation_count += g_count_allocations;
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    g_allocation_count += g_count_allocations;
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    g_allocation_count += g_count_allocations;
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void* p = __libc_memalign(alignment, size);
+    if (p == nullptr) {
+        return ENOMEM;
+    }
+    *ptr = p;
+    return 0;
+}
+
+void* valloc(size_t size)
+{
+    g_allocation_count += g_count_allocations;
+    return __libc_valloc(size);
+}
+
+void* pvalloc(size_t size)
+{
+    g_allocation_count += g_count_allocations;
+    return __libc_pvalloc(size);
+}
+}
+
+namespace {
+/** Number of control cycles tracked before counting starts */
+constexpr size_t kWarmUpCycles = 100;
+
+/** Over-aligned type, allocated by the aligned forms of operator new */
+struct alignas(64) OverAligned
+{
+    double data[8];
+};
+
+/** Time each read of the stepping clock moves it forward, half the default time bound [ns] */
+constexpr int64_t kClockStepNs = 100000;
+
+/** Clock that moves forward by kClockStepNs every time it is read, as if each iteration took so */
+class SteppingClock : public teleop::Clock
+{
+public:
+    int64_t NowNs() const override
+    {
+        clock_.Advance(kClockStepNs);
+        return clock_.NowNs();
+    }
+
+private:
+    mutable teleop::ManualClock clock_;
+};
+
+/** Keeps allocations observable so that the compiler cannot elide them */
+void* volatile g_sink = nullptr;
+
+/**
+ * @brief Count the allocations made by a function.
+ * @param[in] function Function to run.
+ * @return Number of allocations counted.
+ */
+template <class Function>
+uint64_t CountAllocations(Function&& function)
+{
+    g_allocation_count = 0;
+    g_count_allocations = true;
+    function();
+    g_count_allocations = false;
+    return g_allocation_count;
+}
+
+/** @brief Check that every kind of allocation is counted, else a pass would prove nothing */
+void CheckCounting()
+{
+    test::Check(CountAllocations([]() {
+        std::vector<double> v(16);
+        g_sink = v.data();
+    }) > 0,
+        "operator new is counted");
+    test::Check(CountAllocations([]() {
+        auto p = std::make_unique<OverAligned>();
+        g_sink = p.get();
+    }) > 0,
+        "aligned operator new is counted");
+    test::Check(CountAllocations([]() {
+        void* p = nullptr;
+        if (posix_memalign(&p, 64, 128) == 0) {
+            g_sink = p;
+            free(p);
+        }
+    }) > 0,
+        "posix_memalign is counted");
+    test::Check(CountAllocations([]() {
+        void* p = aligned_alloc(64, 128);
+        g_sink = p;
+        free(p);
+    }) > 0,
+        "aligned_alloc is counted");
+    test::Check(CountAllocations([]() {
+        void* p = calloc(4, 16);
+        g_sink = p;
+        p = realloc(p, 256);
+        g_sink = p;
+        free(p);
+    }) == 2,
+        "calloc and realloc are counted");
+}
+}
+
+int main()
+{
+    CheckCounting();
+
+    // Target trajectory: TCP poses of a smooth joint motion sampled at 1 kHz
+    const teleop::Kinematics kinematics;
+    const teleop::JointArray home = {0.0, -0.698, 0.0, 1.571, 0.0, 0.698, 0.0};
+    std::vector<Eigen::Isometry3d> targets(4000);
+    for (size_t k = 0; k < targets.size(); ++k) {
+        const double t = k * teleop::kLoopPeriod;
+        teleop::JointArray q = home;
+        for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+            q[i] += 0.3 * std::sin(2.0 * M_PI * 0.5 * t + i);
+        }
+        targets[k] = kinematics.ForwardKinematics(q);
+    }
+    // A target far from the seed, so that the iteration bound is hit too, on the way to which
+    // the error grows again after a few iterations
+    const Eigen::Isometry3d far_target
+        = kinematics.ForwardKinematics({-1.9, -1.4, 2.3, 1.6, 0.6, -1.1, 1.4});
+
+    // The wall time bound is lifted, so that a preempted solve still converges on a loaded host
+    teleop::IkParams params;
+    params.max_time_ns = 1000000000;
+    teleop::IkSolver solver(home, params);
+    for (size_t k = 0; k < kWarmUpCycles; ++k) {
+        solver.Solve(targets[k]);
+    }
+    uint64_t failures = 0;
+    const uint64_t tracking_allocations = CountAllocations([&]() {
+        for (size_t k = kWarmUpCycles; k < targets.size(); ++k) {
+            failures += !solver.Solve(targets[k]).converged;
+        }
+    });
+    const uint64_t far_allocations = CountAllocations([&]() {
+        solver.Reset(home);
+        solver.Solve(far_target);
+    });
+    std::cout << "Tracked " << targets.size() - kWarmUpCycles << " targets, " << failures
+              << " did not converge; allocations: " << tracking_allocations
+              << " while tracking, " << far_allocations << " for a far target" << std::endl;
+
+    test::Check(tracking_allocations == 0, "the solver never allocates while tracking");
+    test::Check(
+        far_allocations == 0, "the solver never allocates when the iteration bound is hit");
+    test::Check(failures == 0, "the solver converges on a smooth target trajectory");
+
+    // The far target takes every iteration there is, and cutting the solve short after fewer
+    // never does better
+    solver.Reset(home);
+    const auto far_result = solver.Solve(far_target);
+    test::Check(!far_result.converged && !far_result.timed_out
+                    && far_result.iterations == params.max_iterations,
+        "the far target hits the iteration bound");
+    double previous_error = std::numeric_limits<double>::infinity();
+    bool kept_best = true;
+    for (size_t n = 0; n <= params.max_iterations; ++n) {
+        teleop::IkParams cut = params;
+        cut.max_iterations = n;
+        teleop::IkSolver cut_solver(home, cut);
+        const auto& result = cut_solver.Solve(far_target);
+        const Eigen::Isometry3d pose = kinematics.ForwardKinematics(cut_solver.solution());
+        const double position_error = (far_target.translation() - pose.translation()).norm();
+        const double error = result.position_error * result.position_error
+                             + result.orientation_error * result.orientation_error;
+        kept_best = kept_best && std::abs(position_error - result.position_error) < 1e-12
+                    && error <= previous_error;
+        previous_error = error;
+    }
+    test::Check(kept_best,
+        "the solution kept is the one reported, and more iterations never leave a larger error");
+
+    // Every read of the clock takes half the time bound, so the solve stops after two iterations
+    const SteppingClock stepping_clock;
+    teleop::IkSolver timed_solver(home, teleop::IkParams(), teleop::DhParams::Rizon4(),
+        stepping_clock);
+    const auto& timed_result = timed_solver.Solve(far_target);
+    test::Check(timed_result.timed_out && !timed_result.converged
+                    && timed_result.iterations == 2,
+        "the far target hits the time bound, after "
+            + std::to_string(timed_result.iterations) + " iterations");
+    return test::Finish("ik_solver_allocation_test");
+}
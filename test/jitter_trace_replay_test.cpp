@@ -0,0 +1,350 @@
+/**
+ * @file jitter_trace_replay_test.cpp
+ * @brief Replays a packet arrival-time trace through the jitter buffer and compares adaptive
+ * depth with fixed depths. The leader stream is a known smooth joint trajectory sampled at 1 kHz,
+ * so the reconstruction error at the follower directly shows stutter, while the playout delay
+ * shows the latency the buffer adds. Traces are CSV files with one "send_time_ns,arrival_time_ns"
+ * line per packet, e.g. recorded from a production session; without one, a WAN-like trace is
+ * synthesized. Fails unless the adaptive buffer underruns less often than every fixed depth, keeps
+ * its p99 error within the best fixed depth's and a small bound, and its delay within max_depth_ns;
+ * unless a full buffer keeps the newest samples; and unless a shrink rate too slow to take a
+ * nanosecond off per cycle still shrinks the depth at that rate.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/jitter_buffer.hpp>
+#include <flexiv/omni/teleop/utility.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+/** One packet of a trace */
+struct TraceEntry
+{
+    int64_t send_time_ns;
+    int64_t arrival_time_ns;
+};
+
+/** Initial part of the replay left out of the statistics [ns] */
+constexpr int64_t kWarmUpNs = 1000000000;
+
+/** Bound of the adaptive buffer's p99 reconstruction error [rad] */
+constexpr double kMaxP99Error = 1e-4;
+
+/** Performance of a buffer over a replay */
+struct ReplayResult
+{
+    double mean_delay_ms = 0.0;
+    double p99_delay_ms = 0.0;
+    double p99_error = 0.0;
+    double max_error = 0.0;
+    teleop::JitterBufferMetrics metrics;
+};
+
+/** Ground truth leader trajectory of joint 1 [rad] */
+double TruePosition(int64_t t_ns)
+{
+    const double t = t_ns * 1e-9;
+    return 0.5 * std::sin(2.0 * M_PI * 0.5 * t) + 0.1 * std::sin(2.0 * M_PI * 2.0 * t);
+}
+
+/** Ground truth leader velocity of joint 1 [rad/s] */
+double TrueVelocity(int64_t t_ns)
+{
+    const double t = t_ns * 1e-9;
+    return 0.5 * 2.0 * M_PI * 0.5 * std::cos(2.0 * M_PI * 0.5 * t)
+           + 0.1 * 2.0 * M_PI * 2.0 * std::cos(2.0 * M_PI * 2.0 * t);
+}
+}
+
+/** @brief Print program usage help */
+void PrintHelp()
+{
+    // clang-format off
+    std::cout << "Optional arguments: [--trace <file>] [--save-trace <file>] [--duration <seconds>]" << std::endl;
+    std::cout << "                    [--base-delay-ms <ms>] [--jitter-ms <ms>] [--seed <seed>]" << std::endl;
+    std::cout << "    --trace          CSV trace of send_time_ns,arrival_time_ns to replay" << std::endl;
+    std::cout << "    --save-trace     Save the synthesized trace to a CSV file" << std::endl;
+    std::cout << "    --duration       Duration of the synthesized trace in seconds, default 60" << std::endl;
+    std::cout << "    --base-delay-ms  Minimum one-way delay of the synthesized trace, default 20" << std::endl;
+    std::cout << "    --jitter-ms      Mean extra delay of the synthesized trace, default 10" << std::endl;
+    std::cout << "    --seed           Random seed of the synthesized trace, default 1" << std::endl;
+    std::cout << std::endl;
+    // clang-format on
+}
+
+/** @brief Load a CSV trace, skipping blank and '#' comment lines */
+std::vector<TraceEntry> LoadTrace(const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open trace file: " + path);
+    }
+    std::vector<TraceEntry> trace;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream ss(line);
+        TraceEntry entry;
+        if (ss >> entry.send_time_ns >> entry.arrival_time_ns) {
+            trace.push_back(entry);
+        }
+    }
+    return trace;
+}
+
+/**
+ * @brief Synthesize a WAN-like trace: constant base delay plus exponentially distributed queuing
+ * delay, with occasional congestion bursts.
+ */
+std::vector<TraceEntry> SynthesizeTrace(
+    double duration, double base_delay_ms, double jitter_ms, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::exponential_distribution<double> queuing(1.0 / std::max(jitter_ms, 1e-3));
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<TraceEntry> trace;
+    const auto num_packets = static_cast<int64_t>(duration / teleop::kLoopPeriod);
+    double burst_ms = 0.0;
+    for (int64_t k = 0; k < num_packets; ++k) {
+        // Bursts start rarely and decay over ~100 ms
+        if (uniform(rng) < 0.0005) {
+            burst_ms = 4.0 * jitter_ms;
+        }
+        burst_ms *= 0.99;
+        const double delay_ms = base_delay_ms + queuing(rng) + burst_ms;
+        const int64_t send_time = k * teleop::kLoopPeriodNs;
+        trace.push_back({send_time, send_time + static_cast<int64_t>(delay_ms * 1e6)});
+    }
+    return trace;
+}
+
+/** @brief Replay a trace through a jitter buffer and print its performance */
+ReplayResult Replay(const std::string& name, const std::vector<TraceEntry>& trace,
+    const teleop::JitterBufferParams& params)
+{
+    // Deliver packets in arrival order
+    std::vector<TraceEntry> arrivals = trace;
+    std::stable_sort(arrivals.begin(), arrivals.end(),
+        [](const TraceEntry& a, const TraceEntry& b) {
+            return a.arrival_time_ns < b.arrival_time_ns;
+        });
+
+    teleop::JitterBuffer buffer(params);
+    teleop::StatePacket packet, sample;
+    std::vector<double> errors, delays;
+    errors.reserve(trace.size());
+    delays.reserve(trace.size());
+
+    // Receiver runs its own 1 kHz loop starting at the first arrival. The first second is a
+    // warm-up during which the delay estimates converge and is left out of the statistics
+    size_t next = 0;
+    const int64_t start = arrivals.front().arrival_time_ns;
+    const int64_t end = arrivals.back().arrival_time_ns;
+    for (int64_t now = start; now <= end; now += teleop::kLoopPeriodNs) {
+        for (; next < arrivals.size() && arrivals[next].arrival_time_ns <= now; ++next) {
+            const int64_t t = arrivals[next].send_time_ns;
+            packet.header.sequence = static_cast<uint64_t>(t / teleop::kLoopPeriodNs) + 1;
+            packet.header.send_time_ns = t;
+            packet.q[0] = TruePosition(t);
+            packet.dq[0] = TrueVelocity(t);
+            buffer.Push(packet, arrivals[next].arrival_time_ns);
+        }
+        if (!buffer.Pop(now, sample) || now - start < kWarmUpNs) {
+            continue;
+        }
+        // Compare against the true signal at the time being played out
+        const int64_t playout_delay = buffer.metrics().playout_delay_ns;
+        errors.push_back(std::abs(sample.q[0] - TruePosition(now - playout_delay)));
+        delays.push_back(playout_delay * 1e-6);
+    }
+
+    auto percentile = [](std::vector<double> v, double p) {
+        if (v.empty()) {
+            return 0.0;
+        }
+        std::sort(v.begin(), v.end());
+        return v[std::min(v.size() - 1, static_cast<size_t>(p / 100.0 * v.size()))];
+    };
+    ReplayResult result;
+    for (double d : delays) {
+        result.mean_delay_ms += d / delays.size();
+    }
+    result.p99_delay_ms = percentile(delays, 99);
+    result.p99_error = percentile(errors, 99);
+    result.max_error = percentile(errors, 100);
+    result.metrics = buffer.metrics();
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(12) << result.mean_delay_ms << std::setw(12)
+              << result.p99_delay_ms << std::setprecision(3) << std::setw(16)
+              << result.p99_error * 1e3 << std::setw(14) << result.max_error * 1e3 << std::setw(11)
+              << result.metrics.underrun_count << std::setw(13)
+              << result.metrics.extrapolated_count << std::setw(8) << result.metrics.late_count
+              << std::endl;
+    return result;
+}
+
+/** @brief Check that a full buffer evicts its oldest samples rather than the newest */
+void CheckOverflow()
+{
+    // A stall delivers more samples at once than the buffer holds
+    teleop::JitterBufferParams params;
+    params.max_depth_ns = 1000000000;
+    teleop::JitterBuffer buffer(params);
+    constexpr uint64_t kBurst = 1000;
+    teleop::StatePacket packet, sample;
+    for (uint64_t k = 1; k <= kBurst; ++k) {
+        packet.header.sequence = k;
+        packet.header.send_time_ns = static_cast<int64_t>(k) * teleop::kLoopPeriodNs;
+        buffer.Push(packet, static_cast<int64_t>(kBurst) * teleop::kLoopPeriodNs);
+    }
+    const auto metrics = buffer.metrics();
+    test::Check(metrics.overflow_count > 0
+                    && metrics.buffered_count + metrics.overflow_count == kBurst,
+        "a full buffer counts what it evicts");
+
+    // Once playout runs past everything buffered, the newest sample must still be there
+    buffer.Pop(10 * static_cast<int64_t>(kBurst) * teleop::kLoopPeriodNs, sample);
+    test::Check(sample.header.sequence == kBurst, "a full buffer keeps the newest sample");
+
+    // A sample older than everything in a full buffer is the one to drop
+    packet.header.sequence = 1;
+    packet.header.send_time_ns = teleop::kLoopPeriodNs;
+    buffer.Push(packet, 0);
+    test::Check(buffer.metrics().buffered_count <= metrics.buffered_count,
+        "a full buffer does not grow");
+}
+/** @brief Check that the depth shrinks at the configured rate, however slow */
+void CheckSlowShrink()
+{
+    // Half a nanosecond per 1 ms cycle
+    teleop::JitterBufferParams params;
+    params.shrink_rate_ns_per_s = 500;
+    teleop::JitterBuffer buffer(params);
+    teleop::StatePacket packet, sample;
+
+    // Playout running 10 ms past the only sample deepens the buffer by as much
+    packet.header.sequence = 1;
+    buffer.Push(packet, 0);
+    buffer.Pop(params.min_depth_ns + 10000000, sample);
+    const int64_t grown_depth_ns = buffer.metrics().depth_ns;
+
+    // Then 10 s of a stream without jitter, whose target depth is the minimum
+    constexpr int64_t kDurationNs = 10000000000;
+    const int64_t start_ns = 20000000;
+    for (int64_t t = start_ns; t <= start_ns + kDurationNs; t += teleop::kLoopPeriodNs) {
+        ++packet.header.sequence;
+        packet.header.send_time_ns = t;
+        buffer.Push(packet, t);
+        buffer.Pop(t, sample);
+    }
+    const int64_t shrunk_ns = grown_depth_ns - buffer.metrics().depth_ns;
+    const int64_t expected_ns = params.shrink_rate_ns_per_s * (kDurationNs / 1000000000);
+    test::Check(grown_depth_ns > params.min_depth_ns && std::abs(shrunk_ns - expected_ns) <= 10,
+        "a slow shrink rate shrinks the depth by " + std::to_string(expected_ns) + " ns in "
+            + std::to_string(kDurationNs / 1000000000) + " s, got " + std::to_string(shrunk_ns)
+            + " ns");
+}
+
+int main(int argc, char* argv[])
+{
+    // Program Setup
+    // =============================================================================================
+    if (teleop::utility::ProgramArgsExist(argc, argv, {"-h", "--help"})) {
+        PrintHelp();
+        return 1;
+    }
+
+    try {
+        std::vector<TraceEntry> trace;
+        const std::string trace_path = teleop::utility::ProgramArgValue(argc, argv, "--trace");
+        if (!trace_path.empty()) {
+            trace = LoadTrace(trace_path);
+            std::cout << "Loaded " << trace.size() << " packets from " << trace_path << std::endl;
+        } else {
+            const double duration
+                = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--duration", "60"));
+            const double base_delay_ms
+                = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--base-delay-ms", "20"));
+            const double jitter_ms
+                = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--jitter-ms", "10"));
+            const auto seed = static_cast<uint32_t>(
+                std::stoul(teleop::utility::ProgramArgValue(argc, argv, "--seed", "1")));
+            trace = SynthesizeTrace(duration, base_delay_ms, jitter_ms, seed);
+            std::cout << "Synthesized " << trace.size() << " packets, base delay " << base_delay_ms
+                      << " ms, mean jitter " << jitter_ms << " ms" << std::endl;
+
+            const std::string save_path
+                = teleop::utility::ProgramArgValue(argc, argv, "--save-trace");
+            if (!save_path.empty()) {
+                std::ofstream file(save_path);
+                file << "# send_time_ns,arrival_time_ns" << std::endl;
+                for (const auto& entry : trace) {
+                    file << entry.send_time_ns << "," << entry.arrival_time_ns << std::endl;
+                }
+            }
+        }
+        if (trace.size() < 2) {
+            throw std::runtime_error("Trace must contain at least 2 packets");
+        }
+
+        // Replay
+        // =========================================================================================
+        std::cout << std::endl
+                  << std::left << std::setw(18) << "Buffer" << std::right << std::setw(12)
+                  << "delay [ms]" << std::setw(12) << "p99 delay" << std::setw(16)
+                  << "p99 err [mrad]" << std::setw(14) << "max err" << std::setw(11)
+                  << "underruns" << std::setw(13) << "extrapolated" << std::setw(8) << "late"
+                  << std::endl;
+
+        const teleop::JitterBufferParams params;
+        const ReplayResult adaptive = Replay("adaptive", trace, params);
+        double best_fixed_p99_error = std::numeric_limits<double>::max();
+        for (int64_t fixed_ms : {5, 15, 40}) {
+            teleop::JitterBufferParams fixed;
+            fixed.min_depth_ns = fixed.max_depth_ns = fixed_ms * 1000000;
+            const ReplayResult baseline
+                = Replay("fixed " + std::to_string(fixed_ms) + " ms", trace, fixed);
+            test::Check(adaptive.metrics.underrun_count < baseline.metrics.underrun_count,
+                "adaptive depth underruns less often than a fixed depth of "
+                    + std::to_string(fixed_ms) + " ms");
+            best_fixed_p99_error = std::min(best_fixed_p99_error, baseline.p99_error);
+        }
+        std::cout << std::endl;
+
+        test::Check(adaptive.p99_error <= best_fixed_p99_error,
+            "adaptive depth reconstructs at least as well as the best fixed depth");
+        test::Check(adaptive.p99_error < kMaxP99Error, "adaptive depth keeps its p99 error small");
+        int64_t min_transit = std::numeric_limits<int64_t>::max();
+        for (const auto& entry : trace) {
+            min_transit = std::min(min_transit, entry.arrival_time_ns - entry.send_time_ns);
+        }
+        test::Check(adaptive.p99_delay_ms * 1e6 <= min_transit + params.max_depth_ns,
+            "adaptive depth stays within max_depth_ns");
+
+        CheckOverflow();
+        CheckSlowShrink();
+
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return test::Finish("jitter_trace_replay_test");
+}
@@ -0,0 +1,527 @@
+/**
+ * @file link_watchdog_test.cpp
+ * @brief Injects link outages into a teleop session and compares how the follower behaves with
+ * and without the link watchdog. A leader and a follower node drive two simulated arms in one
+ * thread, faster than real time, through an in-memory link with a fixed one-way delay that drops
+ * every packet in both directions during scripted outages, while an emulated operator swings the
+ * leader quickly. Without the watchdog the follower holds the last target, or follows the
+ * forecast with prediction enabled, and jumps onto the leader when the link returns. With it, the
+ * follower is braked to a jerk-limited stop within a few cycles and blends back. Per outage the
+ * detection latency, the peak acceleration and jerk of the command, the largest step of the
+ * command and the follower's speed at the end of the outage are reported. Fails if a watchdog run
+ * does not detect an outage in time, exceeds its limits while stopping, does not come to rest,
+ * trips on an outage shorter than its timeout, or does not resume tracking, once per outage and
+ * only after resume_updates leader states. Then resumes the watchdog alone onto a leader standing
+ * still far from where it stopped, and fails unless the blend stays within the same acceleration
+ * and jerk limits and ends on the leader.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/clock.hpp>
+#include <flexiv/omni/teleop/follower_node.hpp>
+#include <flexiv/omni/teleop/leader_node.hpp>
+#include <flexiv/omni/teleop/link_watchdog.hpp>
+#include <flexiv/omni/teleop/sim_robot.hpp>
+#include <flexiv/omni/teleop/utility.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+/** Emulated operator hand: joint impedance pulling the leader along a fast periodic motion */
+constexpr double kOperatorStiffness = 300.0;
+constexpr double kOperatorDamping = 20.0;
+constexpr double kOperatorAmplitude = 0.4;
+constexpr double kOperatorFreq = 0.6;
+
+/** Time after an outage ends that still counts towards it, to cover the resume [s] */
+constexpr double kRecoveryTime = 2.0;
+
+/** Offset of the leader from the origin when the watchdog alone resumes onto it [rad] */
+constexpr double kResumeGap = 0.8;
+
+/** Follower joint speed below which the arm is taken as at rest [rad/s] */
+constexpr double kRestSpeed = 1e-3;
+
+/**
+ * Relative margin on the stop limits: the velocity left over in the last cycle of a stop is
+ * removed in one, which exceeds the jerk limit by a fraction, and the derivatives of the command
+ * are taken from one cycle to the next
+ */
+constexpr double kLimitTolerance = 0.15;
+
+/** Scripted link outage */
+struct Outage
+{
+    double start_time;
+    double length;
+};
+
+/** One direction of the in-memory link */
+struct Channel
+{
+    struct Message
+    {
+        int64_t deliver_time_ns;
+        teleop::StatePacket packet;
+    };
+    std::deque<Message> queue;
+};
+
+/**
+ * Endpoint of an in-memory link that delivers every message a fixed delay after it was sent, on a
+ * shared clock, and loses every message sent while the link is down
+ */
+class FaultyLink : public teleop::Transport
+{
+public:
+    FaultyLink(const teleop::Clock& clock, int64_t delay_ns, const bool& link_up, Channel& tx,
+        Channel& rx)
+    : clock_(clock)
+    , delay_ns_(delay_ns)
+    , link_up_(link_up)
+    , tx_(tx)
+    , rx_(rx)
+    {
+    }
+
+    bool Send(const void* data, size_t size) override
+    {
+        if (size != sizeof(teleop::StatePacket)) {
+            return false;
+        }
+        if (!link_up_) {
+            return true;
+        }
+        Channel::Message message;
+        message.deliver_time_ns = clock_.NowNs() + delay_ns_;
+        std::memcpy(&message.packet, data, size);
+        tx_.queue.push_back(message);
+        return true;
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        if (rx_.queue.empty() || rx_.queue.front().deliver_time_ns > clock_.NowNs()
+            || capacity < sizeof(teleop::StatePacket)) {
+            return 0;
+        }
+        std::memcpy(buffer, &rx_.queue.front().packet, sizeof(teleop::StatePacket));
+        rx_.queue.pop_front();
+        return sizeof(teleop::StatePacket);
+    }
+
+private:
+    const teleop::Clock& clock_;
+    int64_t delay_ns_;
+    const bool& link_up_;
+    Channel& tx_;
+    Channel& rx_;
+};
+
+/** Simulated arm that remembers the joint command it was last streamed */
+class ProbedRobot : public teleop::RobotInterface
+{
+public:
+    teleop::RobotStates states() const override { return sim.states(); }
+
+    void StreamJointPosition(
+        const teleop::JointArray& positions, const teleop::JointArray& velocities) override
+    {
+        q_command = positions;
+        dq_command = velocities;
+        sim.StreamJointPosition(positions, velocities);
+    }
+
+    void StreamJointTorque(const teleop::JointArray& torques) override
+    {
+        sim.StreamJointTorque(torques);
+    }
+
+    teleop::SimRobot sim;
+
+    /** Command the arm holds, the last one streamed */
+    teleop::JointArray q_command = {};
+    teleop::JointArray dq_command = {};
+};
+
+/** Outcome of one outage */
+struct OutageResult
+{
+    /** Whether the watchdog took the link as lost */
+    bool tripped = false;
+
+    /** Time from the last leader state arriving to the watchdog tripping [ms] */
+    double detection_ms = 0.0;
+
+    /** Largest joint acceleration and jerk of the command while the watchdog stops the arm */
+    double stop_acceleration = 0.0;
+    double stop_jerk = 0.0;
+
+    /** Largest joint acceleration and jerk of the command over the outage and its recovery */
+    double peak_acceleration = 0.0;
+    double peak_jerk = 0.0;
+
+    /** Largest change of a joint position command from one cycle to the next [rad] */
+    double largest_step = 0.0;
+
+    /** Fastest follower joint at the end of the outage [rad/s] */
+    double end_speed = 0.0;
+
+    /** Leader states that arrived after the trip before the blend back started */
+    uint64_t updates_before_resume = 0;
+
+    /** Number of times the follower blended back onto the leader */
+    uint64_t resume_count = 0;
+
+    /** Whether the follower tracks the leader again at the end of the recovery */
+    bool tracking = false;
+};
+
+/** Setup of one run */
+struct Mode
+{
+    std::string name;
+    teleop::FollowerParams params;
+};
+}
+
+/** @brief Print program usage help */
+void PrintHelp()
+{
+    // clang-format off
+    std::cout << "Optional arguments: [--outages <list>] [--duration <seconds>] [--delay-ms <ms>] [--timeout-cycles <n>]" << std::endl;
+    std::cout << "    --outages         Comma-separated outages as <start time [s]>:<length [s]>," << std::endl;
+    std::cout << "                      default 2:0.005,4:0.3,7:2,11:0.03" << std::endl;
+    std::cout << "    --duration        Simulated duration of each run in seconds, default 14" << std::endl;
+    std::cout << "    --delay-ms        One-way delay of the link, default 5" << std::endl;
+    std::cout << "    --timeout-cycles  Cycles without a leader state before the watchdog trips, default 8" << std::endl;
+    std::cout << std::endl;
+    // clang-format on
+}
+
+/** @brief Simulate one session with the scripted outages and measure each of them */
+std::vector<OutageResult> Run(const std::vector<Outage>& outages, double duration,
+    int64_t delay_ns, const teleop::FollowerParams& follower_params)
+{
+    std::vector<OutageResult> results(outages.size());
+    teleop::ManualClock clock;
+    bool link_up = true;
+    Channel to_follower, to_leader;
+    FaultyLink leader_link(clock, delay_ns, link_up, to_follower, to_leader);
+    FaultyLink follower_link(clock, delay_ns, link_up, to_leader, to_follower);
+
+    teleop::SimRobot leader_robot;
+    ProbedRobot follower_robot;
+    teleop::LeaderNode leader(leader_robot, leader_link, {}, clock);
+    teleop::FollowerNode follower(follower_robot, follower_link, follower_params, clock);
+
+    const teleop::JointArray home = leader_robot.states().q;
+    const auto num_cycles = static_cast<size_t>(duration / teleop::kLoopPeriod);
+    teleop::JointArray q_prev = follower_robot.q_command, dq_prev = follower_robot.dq_command;
+    teleop::JointArray ddq_prev = {};
+    uint64_t received_prev = 0, trips_prev = 0, resumes_prev = 0, received_at_trip = 0;
+    auto state_prev = teleop::LinkWatchdogState::kWaiting;
+    int64_t last_arrival_ns = 0;
+    for (size_t cycle = 0; cycle < num_cycles; ++cycle) {
+        const auto now = static_cast<int64_t>(cycle) * teleop::kLoopPeriodNs;
+        clock.Set(now);
+        const double t = cycle * teleop::kLoopPeriod;
+
+        // The outage in effect, or whose recovery is, if any
+        size_t current = outages.size();
+        link_up = true;
+        for (size_t k = 0; k < outages.size(); ++k) {
+            const double end = outages[k].start_time + outages[k].length;
+            const double next
+                = k + 1 < outages.size() ? outages[k + 1].start_time : duration + kRecoveryTime;
+            if (t >= outages[k].start_time && t < std::min(end + kRecoveryTime, next)) {
+                current = k;
+                link_up = t >= end;
+            }
+        }
+
+        // Emulated operator swings joints 2 and 4
+        const double offset = kOperatorAmplitude * std::sin(2.0 * M_PI * kOperatorFreq * t);
+        teleop::JointArray q_operator = home;
+        q_operator[1] += offset;
+        q_operator[3] -= offset;
+        const auto leader_states = leader_robot.states();
+        teleop::JointArray tau_operator;
+        for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+            tau_operator[i] = kOperatorStiffness * (q_operator[i] - leader_states.q[i])
+                              - kOperatorDamping * leader_states.dq[i];
+        }
+        leader_robot.SetExternalJointTorque(tau_operator);
+
+        leader.Step();
+        follower.Step();
+        leader_robot.Step();
+        follower_robot.sim.Step();
+
+        const auto& status = follower.status();
+        if (status.received_count != received_prev) {
+            last_arrival_ns = now;
+            received_prev = status.received_count;
+        }
+        const auto& watchdog = status.link_watchdog;
+        const bool tripped = watchdog.trip_count != trips_prev;
+        trips_prev = watchdog.trip_count;
+        const uint64_t resumes = watchdog.resume_count - resumes_prev;
+        resumes_prev = watchdog.resume_count;
+        const bool stopping = watchdog.state == teleop::LinkWatchdogState::kStopping
+                              || watchdog.state == teleop::LinkWatchdogState::kHolding;
+        const bool blend_started = watchdog.state == teleop::LinkWatchdogState::kResuming
+                                   && state_prev != teleop::LinkWatchdogState::kResuming;
+        state_prev = watchdog.state;
+        if (tripped) {
+            received_at_trip = status.received_count;
+        }
+
+        // Derivatives of the command the arm holds
+        double acceleration = 0.0, jerk = 0.0, step = 0.0;
+        for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+            const double ddq
+                = (follower_robot.dq_command[i] - dq_prev[i]) / teleop::kLoopPeriod;
+            acceleration = std::max(acceleration, std::abs(ddq));
+            jerk = std::max(jerk, std::abs(ddq - ddq_prev[i]) / teleop::kLoopPeriod);
+            step = std::max(step, std::abs(follower_robot.q_command[i] - q_prev[i]));
+            ddq_prev[i] = ddq;
+        }
+        q_prev = follower_robot.q_command;
+        dq_prev = follower_robot.dq_command;
+        if (current == outages.size()) {
+            continue;
+        }
+
+        auto& result = results[current];
+        if (tripped && !result.tripped) {
+            result.tripped = true;
+            result.detection_ms = (now - last_arrival_ns) * 1e-6;
+        }
+        if (blend_started) {
+            result.updates_before_resume = status.received_count - received_at_trip;
+        }
+        result.resume_count += resumes;
+        result.tracking = watchdog.state == teleop::LinkWatchdogState::kTracking;
+        // The first cycle of the stop is measured against the command held before it
+        if (stopping && !tripped) {
+            result.stop_acceleration = std::max(result.stop_acceleration, acceleration);
+            result.stop_jerk = std::max(result.stop_jerk, jerk);
+        }
+        result.peak_acceleration = std::max(result.peak_acceleration, acceleration);
+        result.peak_jerk = std::max(result.peak_jerk, jerk);
+        result.largest_step = std::max(result.largest_step, step);
+        if (!link_up) {
+            result.end_speed = 0.0;
+            for (double dq : follower_robot.states().dq) {
+                result.end_speed = std::max(result.end_speed, std::abs(dq));
+            }
+        }
+    }
+    return results;
+}
+
+/**
+ * @brief Run the watchdog alone: track a swinging leader, lose the link until the follower holds,
+ * then resume onto the leader standing still kResumeGap away on every joint, so that the command
+ * moves by the blend alone, and check it.
+ */
+void CheckResumeBlend(const teleop::LinkWatchdogParams& params)
+{
+    teleop::LinkWatchdog watchdog(params);
+    teleop::JointArray q = {}, dq = {};
+    teleop::JointArray dq_prev = {}, ddq_prev = {};
+    double acceleration = 0.0, jerk = 0.0;
+    size_t blend_cycles = 0;
+    unsigned updates = 0;
+    const double omega = 2.0 * M_PI * kOperatorFreq;
+    for (size_t cycle = 0; cycle < 20000; ++cycle) {
+        const double t = cycle * teleop::kLoopPeriod;
+        const bool link_up = t < 1.0 || t >= 3.0;
+        if (t < 1.0) {
+            for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+                q[i] = kOperatorAmplitude * std::sin(omega * t);
+                dq[i] = kOperatorAmplitude * omega * std::cos(omega * t);
+            }
+        } else if (link_up) {
+            q.fill(kResumeGap);
+            dq.fill(0.0);
+        }
+        const auto state_prev = watchdog.metrics().state;
+        watchdog.Update(link_up, link_up, q, dq);
+        const auto state = watchdog.metrics().state;
+        if (t >= 3.0 && state_prev != teleop::LinkWatchdogState::kResuming) {
+            updates += link_up;
+        }
+
+        // Derivatives of the command, over the cycles the blend decides it
+        double ddq_max = 0.0, dddq_max = 0.0;
+        for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+            const double ddq = (dq[i] - dq_prev[i]) / teleop::kLoopPeriod;
+            ddq_max = std::max(ddq_max, std::abs(ddq));
+            dddq_max = std::max(dddq_max, std::abs(ddq - ddq_prev[i]) / teleop::kLoopPeriod);
+            ddq_prev[i] = ddq;
+        }
+        dq_prev = dq;
+        if (state == teleop::LinkWatchdogState::kResuming
+            || state_prev == teleop::LinkWatchdogState::kResuming) {
+            acceleration = std::max(acceleration, ddq_max);
+            jerk = std::max(jerk, dddq_max);
+            ++blend_cycles;
+        }
+        if (t >= 3.0 && state == teleop::LinkWatchdogState::kTracking) {
+            break;
+        }
+    }
+
+    const auto& metrics = watchdog.metrics();
+    test::Check(metrics.trip_count == 1 && metrics.resume_count == 1
+                    && metrics.state == teleop::LinkWatchdogState::kTracking,
+        "the watchdog alone stops once and resumes tracking once");
+    test::Check(updates == params.resume_updates,
+        "the blend starts with the resume_updates-th leader state, got "
+            + std::to_string(updates));
+    test::Check(blend_cycles * teleop::kLoopPeriodNs >= static_cast<size_t>(params.resume_blend_ns),
+        "the blend lasts at least resume_blend_ns");
+    test::Check(acceleration <= params.max_deceleration * (1.0 + kLimitTolerance)
+                    && jerk <= params.max_jerk * (1.0 + kLimitTolerance),
+        "the blend across a wide gap stays within the acceleration and jerk limits, got "
+            + std::to_string(acceleration) + " rad/s^2 and " + std::to_string(jerk)
+            + " rad/s^3");
+    bool on_leader = true;
+    for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+        on_leader = on_leader && std::abs(q[i] - kResumeGap) < 1e-9 && std::abs(dq[i]) < 1e-9;
+    }
+    test::Check(on_leader, "the blend ends on the leader's command");
+}
+
+int main(int argc, char* argv[])
+{
+    // Program Setup
+    // =============================================================================================
+    if (teleop::utility::ProgramArgsExist(argc, argv, {"-h", "--help"})) {
+        PrintHelp();
+        return 1;
+    }
+    std::vector<Outage> outages;
+    std::stringstream outage_list(teleop::utility::ProgramArgValue(
+        argc, argv, "--outages", "2:0.005,4:0.3,7:2,11:0.03"));
+    for (std::string item; std::getline(outage_list, item, ',');) {
+        const auto colon = item.find(':');
+        if (colon == std::string::npos) {
+            std::cerr << "Invalid outage: " << item << std::endl;
+            return 1;
+        }
+        outages.push_back({std::stod(item.substr(0, colon)), std::stod(item.substr(colon + 1))});
+    }
+    std::sort(outages.begin(), outages.end(),
+        [](const Outage& a, const Outage& b) { return a.start_time < b.start_time; });
+    const double duration
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--duration", "14"));
+    const auto delay_ns = static_cast<int64_t>(
+        std::stod(teleop::utility::ProgramArgValue(argc, argv, "--delay-ms", "5")) * 1e6);
+
+    teleop::FollowerParams hold;
+    teleop::FollowerParams predict = hold;
+    predict.use_prediction = true;
+    teleop::FollowerParams watchdog = hold;
+    watchdog.use_link_watchdog = true;
+    watchdog.link_watchdog.timeout_cycles = static_cast<unsigned>(
+        std::stoul(teleop::utility::ProgramArgValue(argc, argv, "--timeout-cycles", "8")));
+    teleop::FollowerParams watchdog_predict = watchdog;
+    watchdog_predict.use_prediction = true;
+    const std::vector<Mode> modes = {{"hold", hold}, {"predict", predict},
+        {"watchdog", watchdog}, {"watchdog+predict", watchdog_predict}};
+    const auto& limits = watchdog.link_watchdog;
+    const double timeout = limits.timeout_cycles * teleop::kLoopPeriod;
+
+    // Fault injection
+    // =============================================================================================
+    std::cout << "Outages of the link in both directions, operator swinging at "
+              << kOperatorFreq << " Hz, watchdog timeout " << limits.timeout_cycles
+              << " cycles, stop limits " << limits.max_deceleration << " rad/s^2 and "
+              << limits.max_jerk << " rad/s^3" << std::endl;
+    std::cout << std::setw(18) << "mode" << std::setw(10) << "outage[s]" << std::setw(10)
+              << "length[s]" << std::setw(12) << "detect[ms]" << std::setw(18)
+              << "stop acc/jerk" << std::setw(18) << "peak acc/jerk" << std::setw(12)
+              << "step[mrad]" << std::setw(14) << "end speed" << std::endl;
+    for (const auto& mode : modes) {
+        const auto results = Run(outages, duration, delay_ns, mode.params);
+        for (size_t k = 0; k < outages.size(); ++k) {
+            const auto& result = results[k];
+            std::cout << std::fixed << std::setw(18) << mode.name << std::setprecision(2)
+                      << std::setw(10) << outages[k].start_time << std::setprecision(3)
+                      << std::setw(10) << outages[k].length << std::setprecision(1)
+                      << std::setw(12);
+            if (result.tripped) {
+                std::cout << result.detection_ms;
+            } else {
+                std::cout << "-";
+            }
+            std::ostringstream stop, peak;
+            stop << std::fixed << std::setprecision(1) << result.stop_acceleration << "/"
+                 << result.stop_jerk;
+            peak << std::fixed << std::setprecision(0) << result.peak_acceleration << "/"
+                 << result.peak_jerk;
+            std::cout << std::setw(18) << (result.tripped ? stop.str() : "-") << std::setw(18)
+                      << peak.str() << std::setprecision(2) << std::setw(12)
+                      << result.largest_step * 1e3 << std::setprecision(4) << std::setw(14)
+                      << result.end_speed << std::endl;
+            if (!mode.params.use_link_watchdog) {
+                continue;
+            }
+
+            // The link is lost to the follower from the last leader state before the outage
+            std::ostringstream outage;
+            outage << " after the outage at " << std::defaultfloat << outages[k].start_time
+                   << " s with " << mode.name;
+            const bool expected = outages[k].length + teleop::kLoopPeriod > timeout;
+            test::Check(result.tripped == expected,
+                (expected ? "the link is taken as lost" : "the link is not taken as lost")
+                    + outage.str());
+            test::Check(result.tracking, "the follower tracks the leader again" + outage.str());
+            if (!result.tripped) {
+                continue;
+            }
+            test::Check(result.detection_ms <= timeout * 1e3 + 1e-6,
+                "the loss is detected within the timeout" + outage.str() + ", took "
+                    + std::to_string(result.detection_ms) + " ms");
+            test::Check(
+                result.stop_acceleration <= limits.max_deceleration * (1.0 + kLimitTolerance)
+                    && result.stop_jerk <= limits.max_jerk * (1.0 + kLimitTolerance),
+                "the stop stays within its acceleration and jerk limits" + outage.str());
+            // Long enough to brake from the operator's top speed
+            const double top_speed = 2.0 * M_PI * kOperatorFreq * kOperatorAmplitude;
+            const double stop_time = top_speed / limits.max_deceleration
+                                     + limits.max_deceleration / limits.max_jerk;
+            if (outages[k].length > timeout + stop_time + 0.5) {
+                test::Check(result.end_speed <= kRestSpeed,
+                    "the follower comes to rest" + outage.str() + ", still moving at "
+                        + std::to_string(result.end_speed) + " rad/s");
+            }
+            test::Check(result.updates_before_resume == limits.resume_updates,
+                "the follower blends back after resume_updates leader states" + outage.str()
+                    + ", got " + std::to_string(result.updates_before_resume));
+            test::Check(result.resume_count == 1, "the follower resumes once" + outage.str());
+        }
+    }
+    std::cout << std::endl;
+
+    // Resume
+    // =============================================================================================
+    CheckResumeBlend(limits);
+
+    return test::Finish("link_watchdog_test");
+}
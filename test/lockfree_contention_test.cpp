@@ -0,0 +1,188 @@
+/**
+ * @file lockfree_contention_test.cpp
+ * @brief Hands samples between an emulated 1 kHz control thread and an emulated network thread
+ * through SpscQueue and LatestValue, both ways, while extra reader threads hammer the mailbox. The
+ * network thread stalls for random times as a blocking socket would. Fails unless every sample
+ * the control thread produced reached the network thread exactly once and in order, i.e. no cycle
+ * was missed, no reader on either side ever saw a torn sample, and no hand-off of the control
+ * thread ever took as long as its cycle, however long the network thread stalled.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/data.hpp>
+#include <flexiv/omni/teleop/latest_value.hpp>
+#include <flexiv/omni/teleop/spsc_queue.hpp>
+#include <flexiv/omni/teleop/utility.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+/** Readers hammering the control thread's mailbox besides the network thread */
+constexpr size_t kExtraReaders = 2;
+
+/** Longest stall of the network thread between two drains of the queue [us] */
+constexpr int kMaxStallUs = 5000;
+
+/** Sample of one control cycle, its payload derived from its sequence number */
+struct Sample
+{
+    uint64_t sequence = 0;
+    std::array<double, 2 * teleop::kJointDoF> payload = {};
+};
+
+Sample MakeSample(uint64_t sequence)
+{
+    Sample sample;
+    sample.sequence = sequence;
+    for (size_t i = 0; i < sample.payload.size(); ++i) {
+        sample.payload[i] = static_cast<double>(sequence) * static_cast<double>(i + 1);
+    }
+    return sample;
+}
+
+/** Whether a sample is intact, i.e. all of its payload belongs to its sequence number */
+bool IsIntact(const Sample& sample)
+{
+    for (size_t i = 0; i < sample.payload.size(); ++i) {
+        if (sample.payload[i] != static_cast<double>(sample.sequence) * static_cast<double>(i + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Let the other threads run between spins when they have no core of their own */
+void Relax()
+{
+    if (std::thread::hardware_concurrency() < 2 + kExtraReaders) {
+        std::this_thread::yield();
+    }
+}
+}
+
+int main(int argc, char* argv[])
+{
+    const auto num_cycles = static_cast<uint64_t>(
+        std::stoull(teleop::utility::ProgramArgValue(argc, argv, "--cycles", "3000")));
+
+    // Allocated once up front, as in a real-time application
+    auto queue = std::make_unique<teleop::SpscQueue<Sample, 256>>();
+    auto to_network = std::make_unique<teleop::LatestValue<Sample>>();
+    auto to_control = std::make_unique<teleop::LatestValue<Sample>>();
+    std::atomic<bool> producing = {true};
+
+    // Emulated control thread: one sample per 1 ms cycle on an absolute schedule
+    uint64_t push_failures = 0, control_torn = 0, feedback_reads = 0;
+    std::chrono::nanoseconds longest_handoff {0};
+    std::thread control([&]() {
+        auto next = std::chrono::steady_clock::now();
+        for (uint64_t cycle = 1; cycle <= num_cycles; ++cycle) {
+            const Sample sample = MakeSample(cycle);
+            const auto start = std::chrono::steady_clock::now();
+            push_failures += !queue->TryPush(sample);
+            to_network->Write(sample);
+            Sample feedback;
+            if (to_control->TryRead(feedback)) {
+                ++feedback_reads;
+                control_torn += !IsIntact(feedback);
+            }
+            longest_handoff
+                = std::max(longest_handoff, std::chrono::steady_clock::now() - start);
+            next += std::chrono::nanoseconds(teleop::kLoopPeriodNs);
+            std::this_thread::sleep_until(next);
+        }
+        producing = false;
+    });
+
+    // Emulated network thread: drains the queue in bursts and answers through the other mailbox
+    uint64_t received = 0, missed = 0, reordered = 0, network_torn = 0;
+    std::thread network([&]() {
+        std::mt19937 rng(1);
+        std::uniform_int_distribution<int> stall_us(0, kMaxStallUs);
+        uint64_t expected = 1;
+        Sample sample;
+        while (true) {
+            const bool done = !producing.load();
+            while (queue->TryPop(sample)) {
+                ++received;
+                network_torn += !IsIntact(sample);
+                if (sample.sequence > expected) {
+                    missed += sample.sequence - expected;
+                } else if (sample.sequence < expected) {
+                    ++reordered;
+                    continue;
+                }
+                expected = sample.sequence + 1;
+                to_control->Write(MakeSample(sample.sequence));
+            }
+            if (done) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(stall_us(rng)));
+        }
+        missed += num_cycles + 1 - expected;
+    });
+
+    // Extra readers contending for the control thread's mailbox
+    std::vector<uint64_t> reader_torn(kExtraReaders, 0), reader_backwards(kExtraReaders, 0);
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < kExtraReaders; ++r) {
+        readers.emplace_back([&, r]() {
+            uint64_t last_version = 0, last_sequence = 0;
+            Sample sample;
+            while (producing.load(std::memory_order_relaxed)) {
+                uint64_t version;
+                if (to_network->TryRead(sample, &version)) {
+                    reader_torn[r] += !IsIntact(sample);
+                    reader_backwards[r] += version < last_version || sample.sequence < last_sequence;
+                    last_version = version;
+                    last_sequence = sample.sequence;
+                }
+                Relax();
+            }
+        });
+    }
+
+    control.join();
+    network.join();
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    uint64_t torn = network_torn + control_torn, backwards = 0;
+    for (size_t r = 0; r < kExtraReaders; ++r) {
+        torn += reader_torn[r];
+        backwards += reader_backwards[r];
+    }
+    std::cout << "Control thread produced " << num_cycles << " samples, network thread received "
+              << received << "; " << push_failures << " pushes failed, " << missed << " missed, "
+              << reordered << " out of order, " << torn << " torn, " << backwards
+              << " mailbox reads went backwards; control thread read " << feedback_reads
+              << " answers; longest hand-off " << longest_handoff.count() / 1000.0 << " us"
+              << std::endl;
+
+    test::Check(push_failures == 0, "the queue never fills up");
+    test::Check(missed == 0 && received == num_cycles, "every cycle's sample arrives");
+    test::Check(reordered == 0, "samples arrive in order");
+    test::Check(torn == 0, "no reader sees a torn sample");
+    test::Check(backwards == 0, "mailbox versions never go backwards");
+    test::Check(to_network->version() == num_cycles, "every write is counted");
+    test::Check(feedback_reads > 0, "answers reach the control thread");
+    test::Check(longest_handoff.count() < teleop::kLoopPeriodNs,
+        "every hand-off of the control thread fits in its cycle");
+    return test::Finish("lockfree_contention_test");
+}
@@ -0,0 +1,142 @@
+/**
+ * @file multipath_test.cpp
+ * @brief Sends messages over two paths to a MultipathTransport, first from one sender, then from
+ * a restarted one whose sequence starts over, while copies of the first one are still in flight.
+ * Fails unless each message is delivered exactly once, the restarted sender's messages are
+ * delivered once its epoch is confirmed though their sequence numbers are lower, late copies from
+ * before the restart are dropped, and after a second restart neither late copies of the first
+ * sender nor copies too large to receive cost a message of the third.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/multipath.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+/** One direction of a path, holding datagrams until they are delivered */
+class QueueTransport : public teleop::Transport
+{
+public:
+    bool Send(const void* data, size_t size) override
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        queue.emplace_back(bytes, bytes + size);
+        return true;
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        if (!delivering || queue.empty() || queue.front().size() > capacity) {
+            return 0;
+        }
+        const size_t size = queue.front().size();
+        std::memcpy(buffer, queue.front().data(), size);
+        queue.pop_front();
+        return size;
+    }
+
+    std::deque<std::vector<uint8_t>> queue;
+
+    /** Whether queued datagrams can be received, false while the path stalls */
+    bool delivering = true;
+};
+
+/** Message of a sender, its number within the run */
+void SendMessage(teleop::MultipathTransport& sender, uint64_t number)
+{
+    sender.Send(&number, sizeof(number));
+}
+
+/** Messages received until none is left, in order of delivery */
+std::vector<uint64_t> ReceiveAll(teleop::MultipathTransport& receiver)
+{
+    std::vector<uint64_t> numbers;
+    uint64_t number = 0;
+    while (receiver.Receive(&number, sizeof(number)) == sizeof(number)) {
+        numbers.push_back(number);
+    }
+    return numbers;
+}
+}
+
+int main()
+{
+    QueueTransport fast, slow;
+    teleop::MultipathTransport receiver({&fast, &slow});
+    {
+        teleop::MultipathTransport sender({&fast, &slow});
+        slow.delivering = false;
+        for (uint64_t n = 1; n <= 50; ++n) {
+            SendMessage(sender, n);
+        }
+        const auto numbers = ReceiveAll(receiver);
+        test::Check(numbers.size() == 50 && numbers.front() == 1 && numbers.back() == 50,
+            "every message of the first sender is delivered over the fast path");
+    }
+
+    // The sender restarts while its copies on the slow path are still in flight
+    const std::deque<std::vector<uint8_t>> late_first = slow.queue;
+    const uint64_t confirm = teleop::EpochTracker<uint32_t>::kConfirmCount;
+    teleop::MultipathTransport restarted({&fast, &slow});
+    for (uint64_t n = 101; n <= 110; ++n) {
+        SendMessage(restarted, n);
+    }
+    auto numbers = ReceiveAll(receiver);
+    test::Check(numbers.size() == 11 - confirm && numbers.front() == 100 + confirm
+                    && numbers.back() == 110,
+        "the restarted sender's messages are delivered once its epoch is confirmed");
+    test::Check(receiver.stats().restart_count == 1, "the restart is detected");
+
+    slow.delivering = true;
+    numbers = ReceiveAll(receiver);
+    test::Check(numbers.size() == confirm - 1 && numbers.front() == 101,
+        "the messages before the confirmation are delivered over the other path");
+    test::Check(receiver.stats().stale_count == 50 + confirm - 1
+                    && receiver.stats().duplicate_count == 11 - confirm,
+        "late copies from before the restart are stale, the restarted ones duplicates");
+    test::Check(receiver.stats().restart_count == 1, "late copies do not restart the receiver");
+
+    SendMessage(restarted, 111);
+    numbers = ReceiveAll(receiver);
+    test::Check(numbers.size() == 1 && numbers.front() == 111
+                    && receiver.stats().delivered_count == 61,
+        "the restarted sender's messages keep being delivered exactly once");
+
+    // A third sender, while late copies of the first keep arriving in between
+    teleop::MultipathTransport third({&fast, &slow});
+    for (uint64_t n = 201; n < 201 + confirm; ++n) {
+        SendMessage(third, n);
+    }
+    ReceiveAll(receiver);
+    test::Check(receiver.stats().restart_count == 2, "the second restart is detected");
+    size_t delivered = 0;
+    for (uint64_t n = 201 + confirm; n < 301 + confirm; ++n) {
+        fast.queue.push_back(late_first[n % late_first.size()]);
+        SendMessage(third, n);
+        numbers = ReceiveAll(receiver);
+        delivered += numbers.size() == 1 && numbers.front() == n;
+    }
+    test::Check(delivered == 100 && receiver.stats().restart_count == 2,
+        "late copies of the first sender never take over from the third");
+
+    // A copy too large for the caller's buffer must not mark its message as arrived
+    SendMessage(third, 400);
+    const std::vector<uint8_t> other_copy = slow.queue.back();
+    slow.queue.pop_back();
+    uint8_t small = 0;
+    test::Check(receiver.Receive(&small, sizeof(small)) == 0,
+        "a copy too large for the buffer is not delivered");
+    slow.queue.push_back(other_copy);
+    numbers = ReceiveAll(receiver);
+    test::Check(numbers.size() == 1 && numbers.front() == 400,
+        "a copy of the same message over another path still is");
+    return test::Finish("multipath_test");
+}
@@ -0,0 +1,376 @@
+/**
+ * @file rate_control_scenarios_test.cpp
+ * @brief Runs the adaptive send rate over a link whose bandwidth drops. A leader and a follower
+ * node drive two simulated arms in one thread, faster than real time, through an in-memory link
+ * that emulates a bottleneck router in each direction: a scripted bandwidth, a drop-tail queue
+ * and a fixed propagation delay. While the bandwidth is below what the full 1 kHz stream needs,
+ * the queue fills and every packet waits in it. Each scenario is run with the nodes streaming at
+ * the full rate and with the rate control plus target interpolation, and per phase of the script
+ * the send rate, one-way latency, loss and tracking error of the follower are reported. Fails
+ * unless the adaptive run lowers the rate when the bandwidth drops, ramps back up to the full rate
+ * when it returns, and, in every phase whose bandwidth carries the stream at the lowest rate with
+ * some headroom, keeps the p99 latency of packets sent once it settled within a bound above the
+ * propagation delay. A phase below the lowest rate, e.g. 0.5 Mbit/s against the 0.7 Mbit/s that
+ * 250 Hz needs, cannot be carried at all and is only reported.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/clock.hpp>
+#include <flexiv/omni/teleop/follower_node.hpp>
+#include <flexiv/omni/teleop/leader_node.hpp>
+#include <flexiv/omni/teleop/sim_robot.hpp>
+#include <flexiv/omni/teleop/utility.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+/** Emulated operator hand: joint impedance pulling the leader along a slow periodic motion */
+constexpr double kOperatorStiffness = 300.0;
+constexpr double kOperatorDamping = 20.0;
+constexpr double kOperatorAmplitude = 0.25;
+constexpr double kOperatorFreq = 0.5;
+
+/** IPv4 and UDP headers added to every datagram [bytes] */
+constexpr size_t kUdpOverhead = 28;
+
+/** Time after a bandwidth step before latencies are held to the bound [ns] */
+constexpr int64_t kSettleTimeNs = 3000000000;
+
+/**
+ * Headroom over the lowest rate a phase's bandwidth needs to be held to the latency bound. Closer
+ * to the lowest rate, the backlog left by the drop and by each probe for a higher rate drains too
+ * slowly to settle within a phase
+ */
+constexpr double kCarriedHeadroom = 1.4;
+
+/**
+ * Largest p99 queuing delay, on top of the propagation delay, of a settled phase, including the
+ * queue a probe for a higher rate builds until it is detected [ms]
+ */
+constexpr double kMaxSettledQueuingMs = 100.0;
+
+/** Bandwidth of the link from a point in time on */
+struct BandwidthStep
+{
+    double start_time;
+    double mbit_per_s;
+};
+
+/** Counters of one direction of the link, per phase of the script */
+struct ChannelStats
+{
+    uint64_t sent = 0;
+    uint64_t dropped = 0;
+    std::vector<double> latencies_ms;
+
+    /** Latencies of packets sent kSettleTimeNs or later after the phase started */
+    std::vector<double> settled_latencies_ms;
+};
+
+/**
+ * One direction of the in-memory link: a router that serializes packets onto the link at the
+ * scripted bandwidth, drops them once they would wait longer than its queue holds, and delivers
+ * them a fixed propagation delay after they left the queue
+ */
+struct Channel
+{
+    struct Message
+    {
+        int64_t send_time_ns;
+        int64_t deliver_time_ns;
+        bool settled;
+        size_t phase;
+        teleop::StatePacket packet;
+    };
+    std::deque<Message> queue;
+    int64_t busy_until_ns = 0;
+    double mbit_per_s = 0.0;
+    std::vector<ChannelStats>* stats = nullptr;
+    size_t phase = 0;
+    int64_t phase_start_ns = 0;
+};
+
+/** Endpoint of the in-memory link, on a shared clock */
+class BottleneckLink : public teleop::Transport
+{
+public:
+    BottleneckLink(const teleop::Clock& clock, int64_t propagation_ns, int64_t max_queue_ns,
+        Channel& tx, Channel& rx)
+    : clock_(clock)
+    , propagation_ns_(propagation_ns)
+    , max_queue_ns_(max_queue_ns)
+    , tx_(tx)
+    , rx_(rx)
+    {
+    }
+
+    bool Send(const void* data, size_t size) override
+    {
+        if (size != sizeof(teleop::StatePacket)) {
+            return false;
+        }
+        const int64_t now = clock_.NowNs();
+        auto& stats = (*tx_.stats)[tx_.phase];
+        ++stats.sent;
+        const int64_t start = std::max(now, tx_.busy_until_ns);
+        if (start - now > max_queue_ns_) {
+            ++stats.dropped;
+            return true;
+        }
+        const double bits = (size + kUdpOverhead) * 8.0;
+        tx_.busy_until_ns = start + static_cast<int64_t>(bits / tx_.mbit_per_s * 1e3);
+        Channel::Message message;
+        message.send_time_ns = now;
+        message.deliver_time_ns = tx_.busy_until_ns + propagation_ns_;
+        message.settled = now - tx_.phase_start_ns >= kSettleTimeNs;
+        message.phase = tx_.phase;
+        std::memcpy(&message.packet, data, size);
+        tx_.queue.push_back(message);
+        return true;
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        const int64_t now = clock_.NowNs();
+        if (rx_.queue.empty() || rx_.queue.front().deliver_time_ns > now
+            || capacity < sizeof(teleop::StatePacket)) {
+            return 0;
+        }
+        const auto& message = rx_.queue.front();
+        const double latency_ms = (now - message.send_time_ns) * 1e-6;
+        (*rx_.stats)[rx_.phase].latencies_ms.push_back(latency_ms);
+        if (message.settled) {
+            (*rx_.stats)[message.phase].settled_latencies_ms.push_back(latency_ms);
+        }
+        std::memcpy(buffer, &message.packet, sizeof(teleop::StatePacket));
+        rx_.queue.pop_front();
+        return sizeof(teleop::StatePacket);
+    }
+
+private:
+    const teleop::Clock& clock_;
+    int64_t propagation_ns_;
+    int64_t max_queue_ns_;
+    Channel& tx_;
+    Channel& rx_;
+};
+
+/** Outcome of one phase of the script */
+struct PhaseResult
+{
+    ChannelStats to_follower;
+    ChannelStats to_leader;
+
+    /** Sum of squared joint tracking errors of the follower, and number of cycles summed */
+    double squared_error = 0.0;
+    size_t cycles = 0;
+
+    /** Loop rate divider of the leader at the end of the phase */
+    unsigned leader_divider = 1;
+};
+
+/** Value at a quantile of samples, 0 if there are none */
+double Quantile(std::vector<double>& samples, double quantile)
+{
+    if (samples.empty()) {
+        return 0.0;
+    }
+    const auto index = static_cast<size_t>(quantile * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+}
+
+/** @brief Print program usage help */
+void PrintHelp()
+{
+    // clang-format off
+    std::cout << "Optional arguments: [--script <list>] [--duration <seconds>] [--delay-ms <ms>] [--queue-ms <ms>]" << std::endl;
+    std::cout << "    --script     Comma-separated bandwidth steps as <start time [s]>:<bandwidth [Mbit/s]>," << std::endl;
+    std::cout << "                 default 0:10,5:1,15:0.5,25:10" << std::endl;
+    std::cout << "    --duration   Simulated duration of each run in seconds, default 35" << std::endl;
+    std::cout << "    --delay-ms   One-way propagation delay, default 20" << std::endl;
+    std::cout << "    --queue-ms   Longest time a packet waits in the router queue before it is dropped, default 1000" << std::endl;
+    std::cout << std::endl;
+    // clang-format on
+}
+
+/** @brief Simulate one session through the scripted link and measure each phase */
+std::vector<PhaseResult> Run(const std::vector<BandwidthStep>& script, double duration,
+    int64_t propagation_ns, int64_t max_queue_ns, const teleop::LeaderParams& leader_params,
+    const teleop::FollowerParams& follower_params)
+{
+    std::vector<PhaseResult> results(script.size());
+    std::vector<ChannelStats> to_follower_stats(script.size()), to_leader_stats(script.size());
+    teleop::ManualClock clock;
+    Channel to_follower, to_leader;
+    to_follower.stats = &to_follower_stats;
+    to_leader.stats = &to_leader_stats;
+    BottleneckLink leader_link(clock, propagation_ns, max_queue_ns, to_follower, to_leader);
+    BottleneckLink follower_link(clock, propagation_ns, max_queue_ns, to_leader, to_follower);
+
+    teleop::SimRobot leader_robot, follower_robot;
+    teleop::LeaderNode leader(leader_robot, leader_link, leader_params, clock);
+    teleop::FollowerNode follower(follower_robot, follower_link, follower_params, clock);
+
+    const teleop::JointArray home = leader_robot.states().q;
+    const auto num_cycles = static_cast<size_t>(duration / teleop::kLoopPeriod);
+    size_t phase = 0;
+    for (size_t cycle = 0; cycle < num_cycles; ++cycle) {
+        clock.Set(static_cast<int64_t>(cycle) * teleop::kLoopPeriodNs);
+        const double t = cycle * teleop::kLoopPeriod;
+        while (phase + 1 < script.size() && t >= script[phase + 1].start_time) {
+            results[phase].leader_divider = leader.status().rate_control.rate_divider;
+            ++phase;
+            to_follower.phase_start_ns = to_leader.phase_start_ns = clock.NowNs();
+        }
+        to_follower.phase = to_leader.phase = phase;
+        to_follower.mbit_per_s = to_leader.mbit_per_s = script[phase].mbit_per_s;
+
+        // Emulated operator pushes joints 2 and 4 so the TCP moves up and down
+        const double offset = kOperatorAmplitude * std::sin(2.0 * M_PI * kOperatorFreq * t);
+        teleop::JointArray q_operator = home;
+        q_operator[1] += offset;
+        q_operator[3] -= offset;
+        const auto leader_states = leader_robot.states();
+        teleop::JointArray tau_operator;
+        for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+            tau_operator[i] = kOperatorStiffness * (q_operator[i] - leader_states.q[i])
+                              - kOperatorDamping * leader_states.dq[i];
+        }
+        leader_robot.SetExternalJointTorque(tau_operator);
+
+        leader.Step();
+        follower.Step();
+        leader_robot.Step();
+        follower_robot.Step();
+
+        // Tracking error of the follower against where the operator has the leader right now
+        const auto& q_leader = leader_robot.states().q;
+        const auto& q_follower = follower_robot.states().q;
+        for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+            const double error = q_leader[i] - q_follower[i];
+            results[phase].squared_error += error * error;
+        }
+        ++results[phase].cycles;
+    }
+    results[phase].leader_divider = leader.status().rate_control.rate_divider;
+    for (size_t i = 0; i < results.size(); ++i) {
+        results[i].to_follower = std::move(to_follower_stats[i]);
+        results[i].to_leader = std::move(to_leader_stats[i]);
+    }
+    return results;
+}
+
+int main(int argc, char* argv[])
+{
+    // Program Setup
+    // =============================================================================================
+    if (teleop::utility::ProgramArgsExist(argc, argv, {"-h", "--help"})) {
+        PrintHelp();
+        return 1;
+    }
+    std::vector<BandwidthStep> script;
+    std::stringstream script_list(
+        teleop::utility::ProgramArgValue(argc, argv, "--script", "0:10,5:1,15:0.5,25:10"));
+    for (std::string item; std::getline(script_list, item, ',');) {
+        const auto colon = item.find(':');
+        if (colon == std::string::npos) {
+            std::cerr << "Invalid bandwidth step: " << item << std::endl;
+            return 1;
+        }
+        script.push_back({std::stod(item.substr(0, colon)), std::stod(item.substr(colon + 1))});
+    }
+    if (script.empty() || script.front().start_time > 0.0
+        || std::any_of(
+            script.begin(), script.end(), [](const auto& s) { return s.mbit_per_s <= 0.0; })
+        || !std::is_sorted(script.begin(), script.end(),
+            [](const auto& a, const auto& b) { return a.start_time < b.start_time; })) {
+        std::cerr << "The script must start at 0 s, be in time order and have positive bandwidths"
+                  << std::endl;
+        return 1;
+    }
+    const double duration
+        = std::stod(teleop::utility::ProgramArgValue(argc, argv, "--duration", "35"));
+    const auto propagation_ns = static_cast<int64_t>(
+        std::stod(teleop::utility::ProgramArgValue(argc, argv, "--delay-ms", "20")) * 1e6);
+    const auto max_queue_ns = static_cast<int64_t>(
+        std::stod(teleop::utility::ProgramArgValue(argc, argv, "--queue-ms", "1000")) * 1e6);
+
+    teleop::LeaderParams full_leader, adaptive_leader;
+    teleop::FollowerParams full_follower, adaptive_follower;
+    adaptive_leader.use_rate_control = true;
+    adaptive_follower.use_rate_control = true;
+    adaptive_follower.use_target_interpolation = true;
+
+    // Benchmark
+    // =============================================================================================
+    const double full_rate_mbit_per_s
+        = (sizeof(teleop::StatePacket) + kUdpOverhead) * 8.0 / teleop::kLoopPeriod / 1e6;
+    const double lowest_rate_mbit_per_s
+        = full_rate_mbit_per_s / adaptive_leader.rate_control.max_rate_divider;
+    std::cout << "Full rate needs " << full_rate_mbit_per_s << " Mbit/s per direction, the lowest "
+              << lowest_rate_mbit_per_s << " Mbit/s" << std::endl;
+    std::cout << std::setw(10) << "rate" << std::setw(10) << "phase[s]" << std::setw(11)
+              << "Mbit/s" << std::setw(10) << "sent[Hz]" << std::setw(9) << "divider"
+              << std::setw(12) << "p50[ms]" << std::setw(12) << "p99[ms]" << std::setw(10)
+              << "loss[%]" << std::setw(14) << "rms err[rad]" << std::setw(14) << "settled p99"
+              << std::endl;
+    for (const bool adaptive : {false, true}) {
+        auto results = Run(script, duration, propagation_ns, max_queue_ns,
+            adaptive ? adaptive_leader : full_leader,
+            adaptive ? adaptive_follower : full_follower);
+        for (size_t i = 0; i < results.size(); ++i) {
+            auto& result = results[i];
+            const double settled_p99 = Quantile(result.to_follower.settled_latencies_ms, 0.99);
+            const double end = i + 1 < script.size() ? script[i + 1].start_time : duration;
+            const double length = std::max(std::min(end, duration) - script[i].start_time, 1e-9);
+            const auto& stats = result.to_follower;
+            std::cout << std::fixed << std::setw(10) << (adaptive ? "adaptive" : "full")
+                      << std::setprecision(0) << std::setw(4) << script[i].start_time << "-"
+                      << std::setw(5) << std::min(end, duration) << std::setprecision(1)
+                      << std::setw(11) << script[i].mbit_per_s << std::setprecision(0)
+                      << std::setw(10) << stats.sent / length << std::setw(9)
+                      << result.leader_divider << std::setprecision(1) << std::setw(12)
+                      << Quantile(result.to_follower.latencies_ms, 0.5) << std::setw(12)
+                      << Quantile(result.to_follower.latencies_ms, 0.99) << std::setw(10)
+                      << (stats.sent > 0 ? 100.0 * stats.dropped / stats.sent : 0.0)
+                      << std::setprecision(4) << std::setw(14)
+                      << std::sqrt(result.squared_error / std::max<size_t>(result.cycles, 1))
+                      << std::setprecision(1) << std::setw(14) << settled_p99 << std::endl;
+            if (!adaptive) {
+                continue;
+            }
+
+            // The rate must drop below full while the bandwidth does not carry it, and be back at
+            // full by the end of a long enough phase that does
+            std::ostringstream phase;
+            phase << " in the phase from " << std::defaultfloat << script[i].start_time << " s";
+            const bool settles = length * 1e9 > 2 * kSettleTimeNs;
+            if (script[i].mbit_per_s < full_rate_mbit_per_s) {
+                test::Check(result.leader_divider > 1, "the rate is lowered" + phase.str());
+            } else if (i > 0 && settles) {
+                test::Check(result.leader_divider == 1, "the rate ramps back up" + phase.str());
+            }
+            if (script[i].mbit_per_s >= kCarriedHeadroom * lowest_rate_mbit_per_s && settles) {
+                test::Check(!result.to_follower.settled_latencies_ms.empty()
+                                && settled_p99 <= propagation_ns * 1e-6 + kMaxSettledQueuingMs,
+                    "the p99 latency stays bounded" + phase.str());
+            }
+        }
+    }
+    std::cout << std::endl;
+
+    return test::Finish("rate_control_scenarios_test");
+}
@@ -0,0 +1,201 @@
+/**
+ * @file relay_test.cpp
+ * @brief Relays a session over localhost UDP while a third socket, which knows the session ID and
+ * has captured a datagram of the leader but not the session token, tries to divert the leader's
+ * traffic to itself. Fails unless the relay ignores every such datagram, keeps forwarding to the
+ * real leader, and still follows the leader to a new address when it proves the token. Then
+ * starts a relay only after both ends of another session, so that their first registrations are
+ * lost, and fails unless the ends register again and their messages get through.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/clock.hpp>
+#include <flexiv/omni/teleop/relay.hpp>
+#include <flexiv/omni/teleop/udp_transport.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+/** Relay port, the ends and the attacker use the ports above it */
+constexpr uint16_t kRelayPort = 26400;
+
+/** Longest wait for a relayed message [ns] */
+constexpr int64_t kTimeoutNs = 1000000000;
+
+/** Transport keeping a copy of the last datagram sent, as captured on the way */
+class CapturingTransport : public teleop::Transport
+{
+public:
+    explicit CapturingTransport(teleop::Transport& transport)
+    : transport_(transport)
+    {
+    }
+
+    bool Send(const void* data, size_t size) override
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        captured.assign(bytes, bytes + size);
+        return transport_.Send(data, size);
+    }
+
+    size_t Receive(void* buffer, size_t capacity) override
+    {
+        return transport_.Receive(buffer, capacity);
+    }
+
+    std::vector<uint8_t> captured;
+
+private:
+    teleop::Transport& transport_;
+};
+
+/** Wait for a message and return its first byte, 0 on timeout */
+uint8_t ReceiveMarker(teleop::Transport& transport)
+{
+    std::array<uint8_t, teleop::kMaxMessageSize> buffer;
+    const int64_t deadline = teleop::SteadyTimeNs() + kTimeoutNs;
+    while (teleop::SteadyTimeNs() < deadline) {
+        if (transport.Receive(buffer.data(), buffer.size()) > 0) {
+            return buffer[0];
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return 0;
+}
+
+/** Whether a raw socket receives anything within a short time */
+bool ReceivesAnything(teleop::Transport& transport)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::array<uint8_t, teleop::kMaxMessageSize> buffer;
+    bool received = false;
+    while (transport.Receive(buffer.data(), buffer.size()) > 0) {
+        received = true;
+    }
+    return received;
+}
+
+/** Send a one-byte message tagged with a marker */
+void SendMarker(teleop::Transport& transport, uint8_t marker)
+{
+    transport.Send(&marker, 1);
+}
+
+/** Let the relay thread handle what was sent */
+void Settle()
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+}
+
+int main()
+{
+    // SipHash-2-4 test vector of the paper: key 00..0f, message 00..0e
+    teleop::RelayToken key;
+    std::array<uint8_t, 15> message;
+    for (size_t i = 0; i < key.size(); ++i) {
+        key[i] = static_cast<uint8_t>(i);
+    }
+    for (size_t i = 0; i < message.size(); ++i) {
+        message[i] = static_cast<uint8_t>(i);
+    }
+    test::Check(teleop::detail::SipHash24(key, message.data(), message.size())
+                    == 0xa129ca6149be45e5,
+        "SipHash-2-4 reproduces its test vector");
+
+    teleop::RelayParams params;
+    params.port = kRelayPort;
+    teleop::RelayServer relay(params);
+    relay.Start();
+
+    const uint64_t session_id = 0x0123456789abcdef;
+    const teleop::RelayToken token = teleop::GenerateRelayToken();
+    teleop::UdpTransport leader_socket(kRelayPort + 1, "127.0.0.1", kRelayPort);
+    teleop::UdpTransport follower_socket(kRelayPort + 2, "127.0.0.1", kRelayPort);
+    teleop::UdpTransport attacker(kRelayPort + 3, "127.0.0.1", kRelayPort);
+    CapturingTransport leader_wire(leader_socket);
+    teleop::RelayTransport leader(leader_wire, session_id, token, teleop::RelayRole::kLeader);
+    teleop::RelayTransport follower(
+        follower_socket, session_id, token, teleop::RelayRole::kFollower);
+    Settle();
+
+    SendMarker(leader, 1);
+    test::Check(ReceiveMarker(follower) == 1, "the leader's message reaches the follower");
+    SendMarker(follower, 2);
+    test::Check(ReceiveMarker(leader) == 2, "the follower's message reaches the leader");
+
+    // The attacker replays the leader's datagram from its own address
+    attacker.Send(leader_wire.captured.data(), leader_wire.captured.size());
+    // ... registers as the leader under a token of its own
+    teleop::RelayTransport impostor(
+        attacker, session_id, teleop::GenerateRelayToken(), teleop::RelayRole::kLeader);
+    // ... and sends a datagram claiming to be the leader, without a valid tag
+    teleop::RelayHeader forged;
+    forged.role = static_cast<uint8_t>(teleop::RelayRole::kLeader);
+    forged.session_id = session_id;
+    forged.stamp = ~uint64_t {0} - 1;
+    std::array<uint8_t, sizeof(forged) + 1> datagram = {};
+    std::memcpy(datagram.data(), &forged, sizeof(forged));
+    attacker.Send(datagram.data(), datagram.size());
+    Settle();
+
+    SendMarker(follower, 3);
+    test::Check(ReceiveMarker(leader) == 3, "the follower's messages still reach the leader");
+    test::Check(!ReceivesAnything(attacker), "the attacker receives nothing");
+    auto sessions = relay.sessions();
+    test::Check(sessions.size() == 1 && sessions[0].address_change_count == 0
+                    && sessions[0].unauthentic_count == 3,
+        "the relay drops the replayed, wrongly registered and forged datagrams");
+
+    // The leader restarts on another port, and proves the token from there
+    teleop::UdpTransport moved_socket(kRelayPort + 4, "127.0.0.1", kRelayPort);
+    teleop::RelayTransport moved(moved_socket, session_id, token, teleop::RelayRole::kLeader);
+    Settle();
+    SendMarker(follower, 4);
+    test::Check(ReceiveMarker(moved) == 4, "the relay follows the leader to its new address");
+    sessions = relay.sessions();
+    test::Check(sessions.size() == 1 && sessions[0].address_change_count == 1,
+        "the move counts as one address change");
+
+    relay.Stop();
+
+    // Both ends start before the relay, their first registrations go nowhere
+    {
+        const uint16_t port = kRelayPort + 10;
+        teleop::UdpTransport leader_socket(port + 1, "127.0.0.1", port);
+        teleop::UdpTransport follower_socket(port + 2, "127.0.0.1", port);
+        teleop::RelayTransport leader(leader_socket, session_id, token, teleop::RelayRole::kLeader);
+        teleop::RelayTransport follower(
+            follower_socket, session_id, token, teleop::RelayRole::kFollower);
+        Settle();
+        teleop::RelayParams late_params;
+        late_params.port = port;
+        teleop::RelayServer late_relay(late_params);
+        late_relay.Start();
+
+        // Both ends keep to their control loop, sending and receiving every cycle
+        std::array<uint8_t, teleop::kMaxMessageSize> buffer;
+        bool arrived = false;
+        const int64_t deadline = teleop::SteadyTimeNs() + kTimeoutNs;
+        while (!arrived && teleop::SteadyTimeNs() < deadline) {
+            SendMarker(leader, 5);
+            arrived = follower.Receive(buffer.data(), buffer.size()) > 0 && buffer[0] == 5;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        test::Check(arrived, "the ends register again once the relay is up");
+        SendMarker(follower, 6);
+        test::Check(ReceiveMarker(leader) == 6, "the session works both ways");
+        late_relay.Stop();
+    }
+
+    return test::Finish("relay_test");
+}
@@ -0,0 +1,113 @@
+/**
+ * @file sequence_filter_test.cpp
+ * @brief Feeds SequenceFilter with reordered, duplicated and lost packets and with packets of a
+ * restarted peer. Fails unless only the newest packets are admitted, a duplicate never takes back
+ * a loss, a late packet does exactly once, a restart is admitted once confirmed while stragglers
+ * from before it are discarded, and after restarts A, B, C neither late packets of A nor stray
+ * packets of unknown epochs ever cost a packet of C.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/sequence_filter.hpp>
+
+#include <cstdint>
+
+using namespace flexiv::omni;
+
+namespace {
+constexpr uint32_t kEpoch = 0x1234;
+constexpr uint32_t kRestartedEpoch = 0x5678;
+constexpr uint32_t kThirdEpoch = 0x9abc;
+}
+
+int main()
+{
+    // Duplicates of packets that arrived must not count as recovered losses
+    {
+        teleop::SequenceFilter filter;
+        test::Check(filter.Accept(1, kEpoch) && filter.Accept(2, kEpoch)
+                        && filter.Accept(4, kEpoch) && filter.Accept(5, kEpoch),
+            "in-order packets are admitted");
+        test::Check(filter.lost_count() == 1, "a gap counts as lost");
+        test::Check(!filter.Accept(2, kEpoch) && !filter.Accept(5, kEpoch),
+            "duplicates are discarded");
+        test::Check(filter.lost_count() == 1, "duplicates do not take back a loss");
+        test::Check(!filter.Accept(3, kEpoch), "a late packet is discarded");
+        test::Check(filter.lost_count() == 0, "a late packet takes back its loss");
+        test::Check(!filter.Accept(3, kEpoch) && filter.lost_count() == 0,
+            "a duplicate of a late packet does not take back another loss");
+        test::Check(filter.stale_count() == 4, "all discarded packets count as stale");
+    }
+
+    // Gaps wider than the window stay counted, late packets beyond it are not taken back
+    {
+        teleop::SequenceFilter filter;
+        filter.Accept(1, kEpoch);
+        const uint64_t far = 1 + 3 * teleop::SequenceFilter::kWindow;
+        filter.Accept(far, kEpoch);
+        test::Check(filter.lost_count() == far - 2, "a wide gap counts as lost");
+        filter.Accept(2, kEpoch);
+        test::Check(filter.lost_count() == far - 2, "a packet older than the window stays lost");
+        filter.Accept(far - 1, kEpoch);
+        test::Check(
+            filter.lost_count() == far - 3, "a late packet within the window is taken back");
+        filter.Accept(far - 1, kEpoch);
+        test::Check(filter.lost_count() == far - 3, "its duplicate is not");
+    }
+
+    // A restarted peer starts over at 1 under a new epoch, taken once confirmed
+    {
+        teleop::SequenceFilter filter;
+        for (uint64_t s = 1; s <= 50; ++s) {
+            filter.Accept(s, kEpoch);
+        }
+        const unsigned confirm = teleop::EpochTracker<uint32_t>::kConfirmCount;
+        bool pending = true;
+        for (uint64_t s = 1; s < confirm; ++s) {
+            pending &= !filter.Accept(s, kRestartedEpoch) && filter.epoch() == kEpoch;
+        }
+        test::Check(pending && filter.restart_count() == 0,
+            "packets of a new epoch are discarded until it is confirmed");
+        test::Check(filter.Accept(confirm, kRestartedEpoch), "the confirming packet is admitted");
+        test::Check(filter.restart_count() == 1 && filter.epoch() == kRestartedEpoch,
+            "the restart is detected");
+        test::Check(!filter.Accept(51, kEpoch),
+            "a straggler from before the restart is discarded, though its sequence is higher");
+        test::Check(filter.Accept(confirm + 1, kRestartedEpoch)
+                        && filter.Accept(confirm + 2, kRestartedEpoch),
+            "the restarted sequence goes on being admitted");
+        test::Check(filter.restart_count() == 1 && filter.lost_count() == 0,
+            "stragglers neither restart the filter again nor count as lost");
+    }
+
+    // Restarts A, B, C: stragglers of A and stray packets must never lock out C
+    {
+        teleop::SequenceFilter filter;
+        const uint32_t epochs[] = {kEpoch, kRestartedEpoch, kThirdEpoch};
+        for (const uint32_t epoch : epochs) {
+            for (uint64_t s = 1; s <= 10; ++s) {
+                filter.Accept(s, epoch);
+            }
+        }
+        test::Check(filter.restart_count() == 2 && filter.epoch() == kThirdEpoch,
+            "both restarts are detected");
+        uint64_t accepted = 0;
+        for (uint64_t s = 11; s <= 1000; ++s) {
+            // A late packet of the first epoch, one of the second and a stray one in between
+            filter.Accept(s, kEpoch);
+            filter.Accept(s, kRestartedEpoch);
+            filter.Accept(s, static_cast<uint32_t>(0xdead0000 + s));
+            accepted += filter.Accept(s, kThirdEpoch);
+        }
+        test::Check(accepted == 990, "every packet of the live epoch is admitted");
+        test::Check(filter.restart_count() == 2 && filter.epoch() == kThirdEpoch,
+            "neither stragglers nor stray packets restart the filter");
+        test::Check(!filter.Accept(1001, kEpoch) && !filter.Accept(1002, kEpoch)
+                        && !filter.Accept(1003, kEpoch) && filter.epoch() == kThirdEpoch,
+            "a retired epoch is never taken again, however many of its packets arrive");
+    }
+
+    return test::Finish("sequence_filter_test");
+}
@@ -0,0 +1,141 @@
+/**
+ * @file state_compression_test.cpp
+ * @brief Streams compressed state packets from a sender that restarts midway, i.e. starts a new
+ * epoch with its sequence starting over, and then restarts again. Fails unless the decoder takes
+ * the new keyframes once the epoch is confirmed, never resolves a delta of the new epoch against a
+ * keyframe of the old one, and is not reset again by late keyframes from before the restart, not
+ * even by one from two epochs back.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#include "test_utility.hpp"
+
+#include <flexiv/omni/teleop/state_compression.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+using namespace flexiv::omni;
+
+namespace {
+constexpr uint32_t kEpoch = 0x1234;
+constexpr uint32_t kRestartedEpoch = 0x5678;
+constexpr uint32_t kThirdEpoch = 0x9abc;
+
+/** Sent packets of one epoch, indexed by sequence */
+using Stream = std::vector<std::vector<uint8_t>>;
+
+/** State of packet sequence of an epoch, different in every epoch */
+teleop::StatePacket MakePacket(uint64_t sequence, uint32_t epoch)
+{
+    teleop::StatePacket packet;
+    packet.header.epoch = epoch;
+    packet.header.sequence = sequence;
+    packet.header.send_time_ns = static_cast<int64_t>(sequence) * teleop::kLoopPeriodNs;
+    for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+        packet.q[i] = (epoch == kEpoch ? 0.1 : -0.5) + 1e-3 * static_cast<double>(sequence + i);
+    }
+    packet.tcp_pose = {0.5, 0.0, 0.3, 1.0, 0.0, 0.0, 0.0};
+    return packet;
+}
+
+/**
+ * @brief Encode packets 1 to count of an epoch, the peer acknowledging each keyframe at once.
+ * @return Encoded packets, indexed by sequence.
+ */
+Stream Encode(const teleop::CompressionParams& params, uint32_t epoch, uint64_t count)
+{
+    teleop::StateEncoder encoder(params);
+    Stream stream(count + 1);
+    for (uint64_t s = 1; s <= count; ++s) {
+        stream[s].resize(teleop::kMaxCompressedSize);
+        stream[s].resize(encoder.Encode(MakePacket(s, epoch), 0, stream[s].data()));
+        if (encoder.keyframe()) {
+            encoder.Acknowledge(static_cast<uint32_t>(s));
+        }
+    }
+    return stream;
+}
+
+/** Whether a decoded packet holds the state it was encoded from */
+bool Matches(const teleop::StatePacket& decoded, uint64_t sequence, uint32_t epoch)
+{
+    const teleop::StatePacket expected = MakePacket(sequence, epoch);
+    for (size_t i = 0; i < teleop::kJointDoF; ++i) {
+        if (std::abs(decoded.q[i] - expected.q[i]) > 1e-5) {
+            return false;
+        }
+    }
+    return decoded.header.sequence == sequence && decoded.header.epoch == epoch;
+}
+}
+
+int main()
+{
+    const teleop::CompressionParams params;
+    const Stream before = Encode(params, kEpoch, 300);
+    const Stream after = Encode(params, kRestartedEpoch, 150);
+
+    teleop::StateDecoder decoder(params);
+    teleop::CompressedPacketHeader header;
+    teleop::StatePacket packet;
+    auto decode = [&](const std::vector<uint8_t>& bytes) {
+        return decoder.Decode(bytes.data(), bytes.size(), header, packet);
+    };
+    using Result = teleop::StateDecoder::Result;
+
+    // Before the restart, everything decodes
+    bool all_decoded = true;
+    for (uint64_t s = 1; s < 250; ++s) {
+        all_decoded &= decode(before[s]) == Result::kDecoded && Matches(packet, s, kEpoch);
+    }
+    test::Check(all_decoded, "packets before the restart decode");
+    test::Check(decoder.ack() == 201, "the newest keyframe is acknowledged");
+
+    // The restarted sender's first keyframe is taken once its epoch is confirmed, though its
+    // sequence is far lower
+    test::Check(decode(after[1]) == Result::kDecoded && Matches(packet, 1, kRestartedEpoch),
+        "the first keyframe after the restart decodes");
+    test::Check(decoder.ack() == 201, "a keyframe of an unconfirmed epoch is not acknowledged");
+    bool confirmed = true;
+    for (uint64_t s = 2; s <= teleop::EpochTracker<uint32_t>::kConfirmCount; ++s) {
+        confirmed &= decode(after[s]) == Result::kDecoded && Matches(packet, s, kRestartedEpoch);
+    }
+    test::Check(confirmed, "deltas against the unconfirmed keyframe decode");
+    test::Check(decoder.ack() == 1, "the restarted sender's keyframe is acknowledged");
+
+    // Its keyframe 101 is lost: a delta against it must not resolve against the old keyframe 101
+    test::Check(decode(after[150]) == Result::kMissingBase,
+        "a delta of the new epoch never decodes against a keyframe of the old one");
+
+    // A late keyframe of the old epoch decodes on its own but does not reset the decoder again
+    test::Check(decode(before[201]) == Result::kDecoded && Matches(packet, 201, kEpoch),
+        "a late keyframe from before the restart decodes");
+    test::Check(decoder.ack() == 1, "a late keyframe does not take over the acknowledgement");
+    test::Check(decode(after[4]) == Result::kDecoded && Matches(packet, 4, kRestartedEpoch),
+        "packets of the new epoch keep decoding after a late keyframe");
+
+    // Once the keyframe arrives, deltas against it decode
+    decode(after[101]);
+    test::Check(decode(after[150]) == Result::kDecoded && Matches(packet, 150, kRestartedEpoch),
+        "a delta decodes once its keyframe of the same epoch arrived");
+
+    // A second restart, then late keyframes of both epochs before it
+    const Stream third = Encode(params, kThirdEpoch, 150);
+    for (uint64_t s = 1; s <= teleop::EpochTracker<uint32_t>::kConfirmCount; ++s) {
+        decode(third[s]);
+    }
+    test::Check(decoder.ack() == 1, "the second restart is taken");
+    test::Check(decode(before[101]) == Result::kDecoded && decode(after[101]) == Result::kDecoded,
+        "late keyframes of both epochs before decode");
+    all_decoded = true;
+    for (uint64_t s = teleop::EpochTracker<uint32_t>::kConfirmCount + 1; s <= 150; ++s) {
+        all_decoded &= decode(third[s]) == Result::kDecoded && Matches(packet, s, kThirdEpoch);
+    }
+    test::Check(all_decoded && decoder.ack() == 101,
+        "a late keyframe from two epochs back never locks out the live epoch");
+
+    return test::Finish("state_compression_test");
+}
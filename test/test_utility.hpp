@@ -0,0 +1,52 @@
+/**
+ * @file test_utility.hpp
+ * @brief Checking helpers shared by the tests. Each test reports every failed check and exits
+ * with the code returned by Finish(), non-zero if any check failed, so that CTest and CI fail.
+ * @copyright Copyright (C) 2016-2026 Flexiv Ltd. All Rights Reserved.
+ */
+
+#pragma once
+
+#include <iostream>
+#include <string>
+
+namespace test {
+
+/** Number of failed checks so far */
+inline int& FailureCount()
+{
+    static int count = 0;
+    return count;
+}
+
+/**
+ * @brief Record the outcome of a check, printing what was expected if it failed.
+ * @param[in] condition Whether the check passed.
+ * @param[in] what Description of what was expected.
+ * @return condition.
+ */
+inline bool Check(bool condition, const std::string& what)
+{
+    if (!condition) {
+        ++FailureCount();
+        std::cerr << "FAILED: " << what << std::endl;
+    }
+    return condition;
+}
+
+/**
+ * @brief Print the verdict of a test.
+ * @param[in] name Name of the test.
+ * @return Exit code of the test, 0 if all checks passed.
+ */
+inline int Finish(const std::string& name)
+{
+    if (FailureCount() > 0) {
+        std::cerr << name << ": " << FailureCount() << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << name << ": all checks passed" << std::endl;
+    return 0;
+}
+
+} /* namespace test */
@@ -0,0 +1,30 @@
+#!/bin/bash
+set -e
+echo ">>> Installing flexiv_omni_teleop dependencies"
+
+# Check if installation path is provided
+if [ $# -lt 1 ]; then
+  echo "Usage: bash build_and_install_dependencies.sh <install_dir> [num_parallel_jobs]"
+  exit 1
+fi
+
+# Absolute path of the installation directory
+INSTALL_DIR=$(realpath -m $1)
+mkdir -p $INSTALL_DIR
+echo "Dependencies will be installed to: $INSTALL_DIR"
+
+# Use specified number of parallel jobs, or all available cores by default
+if [ $# -ge 2 ]; then
+  export NUM_JOBS=$2
+else
+  export NUM_JOBS=$(nproc)
+fi
+echo "Number of parallel build jobs: $NUM_JOBS"
+
+# Clone sources into a cache directory next to this script and build one by one
+cd "$(dirname "$0")"
+mkdir -p cloned && cd cloned
+bash ../scripts/install_eigen.sh $INSTALL_DIR
+bash ../scripts/install_benchmark.sh $INSTALL_DIR
+
+echo ">>> Installed all dependencies"
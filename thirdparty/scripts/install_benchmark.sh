@@ -0,0 +1,22 @@
+#!/bin/bash
+set -e
+echo "Installing Google Benchmark"
+INSTALL_DIR=$1
+
+# Clone source code
+if [ ! -d benchmark ] ; then
+  git clone https://github.com/google/benchmark.git --branch v1.8.3 --depth 1
+fi
+cd benchmark
+
+# Configure CMake
+mkdir -p build && cd build
+cmake .. -DCMAKE_BUILD_TYPE=Release \
+         -DBENCHMARK_ENABLE_TESTING=OFF \
+         -DBENCHMARK_ENABLE_GTEST_TESTS=OFF \
+         -DBENCHMARK_ENABLE_WERROR=OFF \
+         -DCMAKE_INSTALL_PREFIX=$INSTALL_DIR
+
+# Build and install
+make install -j$NUM_JOBS
+echo "Installed Google Benchmark"
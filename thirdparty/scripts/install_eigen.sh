@@ -0,0 +1,21 @@
+#!/bin/bash
+set -e
+echo "Installing Eigen"
+INSTALL_DIR=$1
+
+# Clone source code
+if [ ! -d eigen ] ; then
+  git clone https://gitlab.com/libeigen/eigen.git --branch 3.4.0 --depth 1
+fi
+cd eigen
+
+# Configure CMake, header-only so no need to build
+mkdir -p build && cd build
+cmake .. -DCMAKE_BUILD_TYPE=Release \
+         -DBUILD_TESTING=OFF \
+         -DEIGEN_BUILD_DOC=OFF \
+         -DCMAKE_INSTALL_PREFIX=$INSTALL_DIR
+
+# Install
+make install
+echo "Installed Eigen"